@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Long-lived HWI helper for globed, to be used in conjunction with -hwisessionpath.
+
+Runs HWI commands in a single interpreter instead of starting the tool for
+every request. Requests and responses are framed as a 4 byte little endian
+length followed by a JSON object:
+
+    request:  {"id": <int>, "args": [<hwi command line arguments>]}
+    response: {"id": <int>, "stdout": <hwi output>, "stderr": <error text>}
+
+Requests are answered in order, a client may send several before reading the
+responses.
+"""
+
+import argparse
+import contextlib
+import io
+import json
+import os
+import struct
+import sys
+import traceback
+
+LENGTH_SIZE = 4
+MAX_FRAME_SIZE = 16 * 1024 * 1024
+
+
+def read_frame(stream):
+    header = stream.read(LENGTH_SIZE)
+    if len(header) < LENGTH_SIZE:
+        return None
+    (length,) = struct.unpack('<I', header)
+    if length > MAX_FRAME_SIZE:
+        raise ValueError(f'Frame too large: {length}')
+    data = stream.read(length)
+    if len(data) < length:
+        return None
+    return json.loads(data.decode('utf-8'))
+
+
+def write_frame(stream, obj):
+    data = json.dumps(obj).encode('utf-8')
+    stream.write(struct.pack('<I', len(data)) + data)
+    stream.flush()
+
+
+def run_command(process_commands, args):
+    # HWI may print prompts, keep them off the framed stream
+    out = io.StringIO()
+    try:
+        with contextlib.redirect_stdout(out):
+            result = process_commands(args)
+        return json.dumps(result), ''
+    except SystemExit:
+        # argparse exits on bad arguments after printing the usage
+        return '', out.getvalue() or 'Invalid HWI arguments'
+    except Exception:
+        return '', traceback.format_exc()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--tool', required=True, help='Path to the HWI tool, hwilib is imported from its directory')
+    args = parser.parse_args()
+
+    sys.path.insert(0, os.path.dirname(os.path.abspath(args.tool)))
+    from hwilib._cli import process_commands
+
+    stdin = sys.stdin.buffer
+    stdout = sys.stdout.buffer
+    # Nothing else may write to the framed stream
+    sys.stdout = sys.stderr
+
+    while True:
+        request = read_frame(stdin)
+        if request is None:
+            break
+        out, err = run_command(process_commands, request.get('args', []))
+        write_frame(stdout, {'id': request.get('id'), 'stdout': out, 'stderr': err})
+
+
+if __name__ == '__main__':
+    main()
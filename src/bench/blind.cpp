@@ -13,6 +13,9 @@
 
 #include <secp256k1_rangeproof.h>
 
+#include <functional>
+#include <set>
+
 
 static void Blind(benchmark::Bench& bench)
 {
@@ -64,3 +67,49 @@ static void Blind(benchmark::Bench& bench)
 
 BENCHMARK(Blind);
 
+// Indices shaped like the RCT blacklist: ~2000 indices spread over ~20000 outputs
+static std::vector<int64_t> MakeAnonIndices(int64_t spread)
+{
+    FastRandomContext rng(/*fDeterministic=*/true);
+    std::vector<int64_t> indices(2000);
+    for (auto& anon_index : indices) {
+        anon_index = 2000 + (int64_t)rng.randrange(spread);
+    }
+    return indices;
+}
+
+static void AnonIndexLookups(benchmark::Bench& bench, const std::function<bool(int64_t)>& contains)
+{
+    int64_t anon_index = 0;
+    bench.run([&] {
+        bool found = contains(anon_index);
+        ankerl::nanobench::doNotOptimizeAway(found);
+        anon_index = (anon_index + 7919) % 40000;
+    });
+}
+
+static void AnonIndexSet(benchmark::Bench& bench)
+{
+    std::vector<int64_t> indices = MakeAnonIndices(20000);
+    std::set<int64_t> filter(indices.begin(), indices.end());
+    AnonIndexLookups(bench, [&](int64_t anon_index) { return filter.count(anon_index) > 0; });
+}
+
+static void AnonIndexFilterBitmap(benchmark::Bench& bench)
+{
+    std::vector<int64_t> indices = MakeAnonIndices(20000);
+    AnonIndexFilter filter(indices.data(), indices.size());
+    AnonIndexLookups(bench, [&](int64_t anon_index) { return filter.Contains(anon_index); });
+}
+
+static void AnonIndexFilterSorted(benchmark::Bench& bench)
+{
+    // Too sparse for the bitmap
+    std::vector<int64_t> indices = MakeAnonIndices(int64_t{1} << 40);
+    AnonIndexFilter filter(indices.data(), indices.size());
+    AnonIndexLookups(bench, [&](int64_t anon_index) { return filter.Contains(anon_index); });
+}
+
+BENCHMARK(AnonIndexSet);
+BENCHMARK(AnonIndexFilterBitmap);
+BENCHMARK(AnonIndexFilterSorted);
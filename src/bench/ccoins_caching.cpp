@@ -4,6 +4,7 @@
 
 #include <bench/bench.h>
 #include <coins.h>
+#include <crypto/common.h>
 #include <policy/policy.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
@@ -55,4 +56,62 @@ static void CCoinsCaching(benchmark::Bench& bench)
     ECC_Stop();
 }
 
+// Coins added to a cache per run, mostly standard outputs with some CT outputs
+static void CCoinsCacheAddCoins(benchmark::Bench& bench)
+{
+    const size_t num_coins = 10000;
+
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    secp256k1_pedersen_commitment commitment;
+    memset(commitment.data, 0x09, 33);
+    for (size_t i = 0; i < num_coins; ++i) {
+        Coin coin(CTxOut(i % 10 == 0 ? 0 : 1 * COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<uint8_t>(20, 1) << OP_EQUALVERIFY << OP_CHECKSIG), 1, false);
+        if (i % 10 == 0) {
+            coin.nType = OUTPUT_CT;
+            coin.SetCommitment(commitment);
+        }
+        uint256 txid;
+        WriteLE64(txid.begin(), i);
+        coins.emplace_back(COutPoint(txid, 0), std::move(coin));
+    }
+
+    CCoinsView coins_dummy;
+    bench.batch(num_coins).unit("coin").run([&] {
+        CCoinsViewCache cache(&coins_dummy);
+        for (const auto& c : coins) {
+            cache.AddCoin(c.first, Coin(c.second), false);
+        }
+        assert(cache.GetCacheSize() == num_coins);
+    });
+}
+
+// Coins added to a child cache and flushed into its parent per run, covers
+// BatchWrite and releasing the child's pool in bulk
+static void CCoinsCacheFlush(benchmark::Bench& bench)
+{
+    const size_t num_coins = 10000;
+
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    for (size_t i = 0; i < num_coins; ++i) {
+        Coin coin(CTxOut(1 * COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<uint8_t>(20, 1) << OP_EQUALVERIFY << OP_CHECKSIG), 1, false);
+        uint256 txid;
+        WriteLE64(txid.begin(), i);
+        coins.emplace_back(COutPoint(txid, 0), std::move(coin));
+    }
+
+    CCoinsView coins_dummy;
+    bench.batch(num_coins).unit("coin").run([&] {
+        CCoinsViewCache parent(&coins_dummy);
+        CCoinsViewCache child(&parent);
+        for (const auto& c : coins) {
+            child.AddCoin(c.first, Coin(c.second), false);
+        }
+        bool success{child.Flush()};
+        assert(success);
+        assert(parent.GetCacheSize() == num_coins);
+    });
+}
+
 BENCHMARK(CCoinsCaching);
+BENCHMARK(CCoinsCacheAddCoins);
+BENCHMARK(CCoinsCacheFlush);
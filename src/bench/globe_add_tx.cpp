@@ -132,7 +132,7 @@ static std::shared_ptr<CHDWallet> CreateTestWallet(wallet::WalletContext& wallet
     return std::static_pointer_cast<CHDWallet>(wallet);
 }
 
-static void AddTx(benchmark::Bench& bench, const std::string from, const std::string to, const bool owned)
+static void AddTx(benchmark::Bench& bench, const std::string from, const std::string to, const bool owned, const bool bench_create = false)
 {
     TestingSetup test_setup{CBaseChainParams::REGTEST, {}, true};
     const auto context = util::AnyPtr<node::NodeContext>(&test_setup.m_node);
@@ -217,12 +217,19 @@ static void AddTx(benchmark::Bench& bench, const std::string from, const std::st
         StakeNBlocks(pwallet_a.get(), 2);
     }
 
-    CTransactionRef tx = CreateTxn(pwallet_a.get(), owned ? addr_b : addr_a, 1000, from_tx_type, to_tx_type);
+    if (bench_create) {
+        // Input selection, hiding output selection, range proofs and signing
+        bench.run([&] {
+            CreateTxn(pwallet_a.get(), addr_b, 1000, from_tx_type, to_tx_type);
+        });
+    } else {
+        CTransactionRef tx = CreateTxn(pwallet_a.get(), owned ? addr_b : addr_a, 1000, from_tx_type, to_tx_type);
 
-    bench.run([&] {
-        LOCK(pwallet_b.get()->cs_wallet);
-        pwallet_b.get()->AddToWalletIfInvolvingMe(tx, TxStateInMempool{}, true, false);
-    });
+        bench.run([&] {
+            LOCK(pwallet_b.get()->cs_wallet);
+            pwallet_b.get()->AddToWalletIfInvolvingMe(tx, TxStateInMempool{}, true, false);
+        });
+    }
 
     RemoveWallet(wallet_context, pwallet_a, std::nullopt);
     pwallet_a.reset();
@@ -252,6 +259,9 @@ static void GlobeAddTxAnonBlindOwned(benchmark::Bench& bench) { AddTx(bench, "an
 static void GlobeAddTxAnonAnonNotOwned(benchmark::Bench& bench) { AddTx(bench, "anon", "anon", false); }
 static void GlobeAddTxAnonAnonOwned(benchmark::Bench& bench) { AddTx(bench, "anon", "anon", true); }
 
+static void GlobeCreateTxBlindBlind(benchmark::Bench& bench) { AddTx(bench, "blind", "blind", true, true); }
+static void GlobeCreateTxAnonAnon(benchmark::Bench& bench) { AddTx(bench, "anon", "anon", true, true); }
+
 BENCHMARK(GlobeAddTxPlainPlainNotOwned);
 BENCHMARK(GlobeAddTxPlainPlainOwned);
 BENCHMARK(GlobeAddTxPlainBlindNotOwned);
@@ -272,3 +282,6 @@ BENCHMARK(GlobeAddTxAnonBlindNotOwned);
 BENCHMARK(GlobeAddTxAnonBlindOwned);
 BENCHMARK(GlobeAddTxAnonAnonNotOwned);
 BENCHMARK(GlobeAddTxAnonAnonOwned);
+
+BENCHMARK(GlobeCreateTxBlindBlind);
+BENCHMARK(GlobeCreateTxAnonAnon);
@@ -0,0 +1,97 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <interfaces/chain.h>
+#include <smsg/smessage.h>
+#include <test/util/setup_common.h>
+#include <wallet/hdwallet.h>
+
+#include <cassert>
+
+static const std::string bench_message = "A short test message 0123456789 !@#$%^&*()_+-=";
+
+struct SmsgBenchSetup
+{
+    TestingSetup test_setup{CBaseChainParams::MAIN, {}, true};
+    std::unique_ptr<interfaces::Chain> chain;
+    std::shared_ptr<CHDWallet> wallet;
+    CKeyID id_from, id_to;
+
+    SmsgBenchSetup()
+    {
+        smsgModule.m_node = &test_setup.m_node;
+        chain = interfaces::MakeChain(test_setup.m_node);
+        wallet = std::make_shared<CHDWallet>(chain.get(), "", *test_setup.m_node.args, wallet::CreateMockWalletDatabase());
+
+        CKey key_from, key_to;
+        key_from.MakeNewKey(true);
+        key_to.MakeNewKey(true);
+        {
+            auto spk_man = wallet->GetOrCreateLegacyScriptPubKeyMan();
+            assert(spk_man);
+            LOCK(spk_man->cs_KeyStore);
+            spk_man->AddKey(key_from);
+            spk_man->AddKey(key_to);
+        }
+        id_from = key_from.GetPubKey().GetID();
+        id_to = key_to.GetPubKey().GetID();
+
+        std::vector<std::shared_ptr<wallet::CWallet> > vpwallets;
+        assert(smsgModule.Start(wallet, vpwallets, false));
+    }
+
+    ~SmsgBenchSetup()
+    {
+        smsgModule.Shutdown();
+    }
+
+    void Encrypt(smsg::SecureMessage &smsg)
+    {
+        smsg.m_ttl = smsg::SMSG_SECONDS_IN_DAY;
+        assert(smsgModule.Encrypt(smsg, id_from, id_to, bench_message) == 0);
+    }
+};
+
+static void SmsgEncrypt(benchmark::Bench& bench)
+{
+    SmsgBenchSetup setup;
+
+    bench.run([&] {
+        smsg::SecureMessage smsg;
+        setup.Encrypt(smsg);
+    });
+}
+
+// Proof of work for a free message
+static void SmsgSetHash(benchmark::Bench& bench)
+{
+    SmsgBenchSetup setup;
+
+    smsg::SecureMessage smsg;
+    setup.Encrypt(smsg);
+    bench.run([&] {
+        assert(smsgModule.SetHash(&smsg, smsg.pPayload, smsg.nPayload) == 0);
+        smsg.timestamp++; // Search again from a different starting point
+    });
+}
+
+static void SmsgDecrypt(benchmark::Bench& bench)
+{
+    SmsgBenchSetup setup;
+
+    smsg::SecureMessage smsg;
+    setup.Encrypt(smsg);
+    assert(smsgModule.SetHash(&smsg, smsg.pPayload, smsg.nPayload) == 0);
+
+    bench.run([&] {
+        smsg::MessageData msg;
+        assert(smsgModule.Decrypt(false, setup.id_to, smsg, msg) == 0);
+    });
+}
+
+BENCHMARK(SmsgEncrypt);
+BENCHMARK(SmsgSetHash);
+BENCHMARK(SmsgDecrypt);
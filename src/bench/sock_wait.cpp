@@ -0,0 +1,82 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/sock.h>
+#include <util/sockepoll.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32 // Windows does not have socketpair(2).
+
+// Mimics the socket handler loop of a node with many peers of which only a
+// few have sent data: every iteration waits for readiness of the sockets.
+static constexpr size_t NUM_PEERS{500};
+static constexpr size_t NUM_ACTIVE_PEERS{5};
+
+struct SockPairs {
+    std::vector<std::shared_ptr<Sock>> local;
+    std::vector<std::shared_ptr<Sock>> remote;
+
+    SockPairs()
+    {
+        for (size_t i = 0; i < NUM_PEERS; ++i) {
+            int s[2];
+            int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, s);
+            assert(ret == 0);
+            local.push_back(std::make_shared<Sock>(s[0]));
+            remote.push_back(std::make_shared<Sock>(s[1]));
+        }
+        for (size_t i = 0; i < NUM_ACTIVE_PEERS; ++i) {
+            ssize_t sent = remote[i * (NUM_PEERS / NUM_ACTIVE_PEERS)]->Send("a", 1, 0);
+            assert(sent == 1);
+        }
+    }
+
+    Sock::EventsPerSock Generate() const
+    {
+        Sock::EventsPerSock events_per_sock;
+        for (const auto& sock : local) {
+            events_per_sock.emplace(sock, Sock::Events{Sock::RECV});
+        }
+        return events_per_sock;
+    }
+};
+
+static void SockWaitManyPoll(benchmark::Bench& bench)
+{
+    SockPairs pairs;
+    bench.run([&] {
+        Sock::EventsPerSock events_per_sock = pairs.Generate();
+        bool ok = events_per_sock.begin()->first->WaitMany(std::chrono::milliseconds{0}, events_per_sock);
+        assert(ok);
+    });
+}
+
+#ifdef USE_EPOLL
+static void SockWaitManyEpoll(benchmark::Bench& bench)
+{
+    SockPairs pairs;
+    SockEpoll epoll;
+    assert(epoll.IsValid());
+    for (const auto& sock : pairs.local) {
+        bool ok = epoll.Update(sock, Sock::RECV, /*edge_triggered=*/false);
+        assert(ok);
+    }
+    // The registrations persist, only the ready sockets are listed
+    SockEpoll::ReadySocks ready;
+    bench.run([&] {
+        bool ok = epoll.Wait(std::chrono::milliseconds{0}, ready);
+        assert(ok && ready.size() == NUM_ACTIVE_PEERS);
+    });
+}
+
+BENCHMARK(SockWaitManyEpoll);
+#endif // USE_EPOLL
+BENCHMARK(SockWaitManyPoll);
+
+#endif // WIN32
@@ -0,0 +1,49 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <arith_uint256.h>
+#include <chain.h>
+#include <consensus/amount.h>
+#include <pos/kernel.h>
+#include <primitives/transaction.h>
+#include <random.h>
+
+#include <vector>
+
+// Kernel search over a wallet's stakeable outputs for one timestamp, as done by the staking thread
+static void StakeKernelSearch(benchmark::Bench& bench)
+{
+    const size_t num_outputs = 1000;
+    FastRandomContext rng(/*fDeterministic=*/true);
+
+    CBlockIndex index_prev;
+    index_prev.nHeight = 1000000;
+    index_prev.nTime = 1650000000;
+    index_prev.bnStakeModifier = rng.rand256();
+
+    // Target is weighted by output value, set so that few outputs pass
+    uint32_t nBits = UintToArith256(uint256S("0000000000000000ffffffffffffffffffffffffffffffffffffffffffffffff")).GetCompact();
+
+    std::vector<COutPoint> prevouts;
+    std::vector<CAmount> values;
+    std::vector<uint32_t> block_from_times;
+    for (size_t i = 0; i < num_outputs; ++i) {
+        prevouts.emplace_back(rng.rand256(), rng.randrange(4));
+        values.push_back(rng.randrange(1000 * COIN) + 1);
+        block_from_times.push_back(index_prev.nTime - rng.randrange(60 * 60 * 24 * 30));
+    }
+
+    uint32_t nTime = index_prev.nTime + 16;
+    bench.batch(num_outputs).unit("output").run([&] {
+        uint256 hash_proof, target_proof;
+        for (size_t i = 0; i < num_outputs; ++i) {
+            CheckStakeKernelHash(&index_prev, nBits, block_from_times[i], values[i], prevouts[i], nTime, hash_proof, target_proof);
+        }
+        nTime += 16;
+    });
+}
+
+BENCHMARK(StakeKernelSearch);
@@ -0,0 +1,111 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <key.h>
+#include <key/stealth.h>
+#include <random.h>
+
+#include <cassert>
+#include <vector>
+
+static ec_point ToPoint(const CPubKey &pk)
+{
+    return ec_point(pk.begin(), pk.end());
+}
+
+struct StealthOutputs
+{
+    CKey scan_secret, spend_secret;
+    ec_point scan_pubkey, spend_pubkey;
+    std::vector<ec_point> ephem_pubkeys; // One per output
+    std::vector<ec_point> dest_pubkeys;
+
+    // Outputs are sent to the address with probability 1 / owned_ratio
+    explicit StealthOutputs(size_t num_outputs, size_t owned_ratio)
+    {
+        scan_secret.MakeNewKey(true);
+        spend_secret.MakeNewKey(true);
+        scan_pubkey = ToPoint(scan_secret.GetPubKey());
+        spend_pubkey = ToPoint(spend_secret.GetPubKey());
+
+        CKey other_scan, other_spend;
+        other_scan.MakeNewKey(true);
+        other_spend.MakeNewKey(true);
+
+        for (size_t i = 0; i < num_outputs; ++i) {
+            bool owned = i % owned_ratio == 0;
+            CKey ephem, shared;
+            ec_point dest;
+            do {
+                ephem.MakeNewKey(true);
+            } while (0 != StealthSecret(ephem,
+                owned ? scan_pubkey : ToPoint(other_scan.GetPubKey()),
+                owned ? spend_pubkey : ToPoint(other_spend.GetPubKey()), shared, dest));
+            ephem_pubkeys.push_back(ToPoint(ephem.GetPubKey()));
+            dest_pubkeys.push_back(dest);
+        }
+    }
+};
+
+static void StealthSend(benchmark::Bench& bench)
+{
+    ECC_Start();
+
+    StealthOutputs outputs(1, 1);
+
+    CKey ephem, shared;
+    ec_point dest;
+    ephem.MakeNewKey(true);
+
+    bench.run([&] {
+        StealthSecret(ephem, outputs.scan_pubkey, outputs.spend_pubkey, shared, dest);
+    });
+
+    ECC_Stop();
+}
+
+// Wallet side detection of a block's worth of stealth outputs, 1 in 10 owned
+static void StealthScanOutputs(benchmark::Bench& bench)
+{
+    ECC_Start();
+
+    StealthOutputs outputs(100, 10);
+
+    bench.batch(outputs.ephem_pubkeys.size()).unit("output").run([&] {
+        size_t found = 0;
+        for (size_t i = 0; i < outputs.ephem_pubkeys.size(); ++i) {
+            CKey shared;
+            ec_point dest;
+            if (0 != StealthSecret(outputs.scan_secret, outputs.ephem_pubkeys[i], outputs.spend_pubkey, shared, dest)) {
+                continue;
+            }
+            if (dest == outputs.dest_pubkeys[i]) {
+                found++;
+            }
+        }
+        assert(found == 10);
+    });
+
+    ECC_Stop();
+}
+
+static void StealthDeriveSpendKey(benchmark::Bench& bench)
+{
+    ECC_Start();
+
+    StealthOutputs outputs(1, 1);
+
+    CKey secret_out;
+    bench.run([&] {
+        StealthSecretSpend(outputs.scan_secret, outputs.ephem_pubkeys[0], outputs.spend_secret, secret_out);
+    });
+
+    ECC_Stop();
+}
+
+BENCHMARK(StealthSend);
+BENCHMARK(StealthScanOutputs);
+BENCHMARK(StealthDeriveSpendKey);
@@ -18,6 +18,9 @@
 #include <chain/ct_tainted.h>
 #include <chain/tx_blacklist.h>
 #include <chain/tx_whitelist.h>
+#include <memusage.h>
+
+#include <algorithm>
 #include <set>
 
 
@@ -27,9 +30,9 @@ secp256k1_bulletproof_generators *blind_gens = nullptr;
 
 static CBloomFilter ct_tainted_filter;
 static std::set<uint256> ct_whitelist;
-static std::set<int64_t> rct_whitelist;
-static std::set<int64_t> rct_blacklist;
-static std::set<int64_t> rct_whitelist2;
+static AnonIndexFilter rct_whitelist;
+static AnonIndexFilter rct_blacklist;
+static AnonIndexFilter rct_whitelist2;
 
 static int CountLeadingZeros(uint64_t nValueIn)
 {
@@ -142,22 +145,66 @@ int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &r
         &vRangeproof[0], vRangeproof.size()) == 1));
 }
 
+AnonIndexFilter::AnonIndexFilter(const int64_t indices[], size_t num_indices)
+    : m_sorted(indices, indices + num_indices)
+{
+    std::sort(m_sorted.begin(), m_sorted.end());
+    m_sorted.erase(std::unique(m_sorted.begin(), m_sorted.end()), m_sorted.end());
+    m_size = m_sorted.size();
+    if (m_sorted.empty()) {
+        return;
+    }
+
+    m_min = m_sorted.front();
+    uint64_t num_words = ((uint64_t)m_sorted.back() - (uint64_t)m_min) / 64 + 1;
+    if (num_words > m_sorted.size()) {
+        return;
+    }
+    m_bits.assign(num_words, 0);
+    for (int64_t anon_index : m_sorted) {
+        uint64_t bit = (uint64_t)anon_index - (uint64_t)m_min;
+        m_bits[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    m_sorted.clear();
+    m_sorted.shrink_to_fit();
+}
+
+bool AnonIndexFilter::Contains(int64_t anon_index) const
+{
+    if (!m_bits.empty()) {
+        if (anon_index < m_min) {
+            return false;
+        }
+        uint64_t bit = (uint64_t)anon_index - (uint64_t)m_min;
+        if (bit / 64 >= m_bits.size()) {
+            return false;
+        }
+        return (m_bits[bit / 64] >> (bit % 64)) & 1;
+    }
+    return std::binary_search(m_sorted.begin(), m_sorted.end(), anon_index);
+}
+
+size_t AnonIndexFilter::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(m_bits) + memusage::DynamicUsage(m_sorted);
+}
+
 void LoadRCTBlacklist(const int64_t indices[], size_t num_indices)
 {
-    rct_blacklist = std::set<int64_t>(indices, indices + num_indices);
-    LogPrintf("RCT blacklist size %d\n", rct_blacklist.size());
+    rct_blacklist = AnonIndexFilter(indices, num_indices);
+    LogPrintf("RCT blacklist size %d\n", rct_blacklist.Size());
 }
 
 void LoadRCTWhitelist(const int64_t indices[], size_t num_indices, int list_id)
 {
     switch (list_id) {
         case 1:
-            rct_whitelist = std::set<int64_t>(indices, indices + num_indices);
-            LogPrintf("RCT whitelist size %d\n", rct_whitelist.size());
+            rct_whitelist = AnonIndexFilter(indices, num_indices);
+            LogPrintf("RCT whitelist size %d\n", rct_whitelist.Size());
             break;
         case 2:
-            rct_whitelist2 = std::set<int64_t>(indices, indices + num_indices);
-            LogPrintf("RCT whitelist2 size %d\n", rct_whitelist2.size());
+            rct_whitelist2 = AnonIndexFilter(indices, num_indices);
+            LogPrintf("RCT whitelist2 size %d\n", rct_whitelist2.Size());
             break;
         default:
             LogPrintf("Error: Unknown RCT whitelist %d\n", list_id);
@@ -201,16 +248,16 @@ bool IsFrozenBlindOutput(const uint256 &txid)
 
 bool IsBlacklistedAnonOutput(int64_t anon_index)
 {
-    return rct_blacklist.count(anon_index);
+    return rct_blacklist.Contains(anon_index);
 }
 
 bool IsWhitelistedAnonOutput(int64_t anon_index, int64_t time, const Consensus::Params &consensus_params)
 {
     if (time >= consensus_params.exploit_fix_3_time &&
-        rct_whitelist2.count(anon_index)) {
+        rct_whitelist2.Contains(anon_index)) {
         return true;
     }
-    return rct_whitelist.count(anon_index);
+    return rct_whitelist.Contains(anon_index);
 }
 
 namespace globe {
@@ -23,6 +23,29 @@ int SelectRangeProofParameters(uint64_t nValueIn, uint64_t &minValue, int &expon
 
 int GetRangeProofInfo(const std::vector<uint8_t> &vRangeproof, int &rexp, int &rmantissa, CAmount &min_value, CAmount &max_value);
 
+/**
+ * Immutable set of anon output indices.
+ *
+ * Indices are kept in a bitmap over [min, max] when that takes less memory
+ * than a sorted array of the indices, otherwise in the sorted array.
+ */
+class AnonIndexFilter
+{
+private:
+    int64_t m_min{0};
+    std::vector<uint64_t> m_bits;
+    std::vector<int64_t> m_sorted;
+    size_t m_size{0};
+
+public:
+    AnonIndexFilter() = default;
+    AnonIndexFilter(const int64_t indices[], size_t num_indices);
+
+    bool Contains(int64_t anon_index) const;
+    size_t Size() const { return m_size; }
+    size_t DynamicMemoryUsage() const;
+};
+
 void LoadRCTBlacklist(const int64_t indices[], size_t num_indices);
 void LoadRCTWhitelist(const int64_t indices[], size_t num_indices, int list_id);
 void LoadCTWhitelist(const unsigned char *data, size_t data_length);
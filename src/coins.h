@@ -11,6 +11,7 @@
 #include <memusage.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
+#include <support/allocators/pool.h>
 #include <uint256.h>
 #include <util/hasher.h>
 
@@ -18,6 +19,7 @@
 #include <stdint.h>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <insight/addressindex.h>
 #include <insight/spentindex.h>
@@ -108,13 +110,55 @@ public:
     //! type of output (Globe)
     uint8_t nType = OUTPUT_STANDARD;
 
+private:
     //! commitment used for CT outputs (Globe)
-    secp256k1_pedersen_commitment commitment;
+    //! Kept out of line, the majority of coins are OUTPUT_STANDARD and would only pad the cache entry.
+    std::unique_ptr<secp256k1_pedersen_commitment> m_commitment;
 
+public:
     //! construct a Coin from a CTxOut and height/coinbase information.
     Coin(CTxOut&& outIn, int nHeightIn, bool fCoinBaseIn) : out(std::move(outIn)), fCoinBase(fCoinBaseIn), nHeight(nHeightIn) {}
     Coin(const CTxOut& outIn, int nHeightIn, bool fCoinBaseIn) : out(outIn), fCoinBase(fCoinBaseIn),nHeight(nHeightIn) {}
 
+    Coin(const Coin& other) : out(other.out), fCoinBase(other.fCoinBase), nHeight(other.nHeight), nType(other.nType)
+    {
+        if (other.m_commitment) {
+            m_commitment = std::make_unique<secp256k1_pedersen_commitment>(*other.m_commitment);
+        }
+    }
+    Coin(Coin&&) = default;
+
+    Coin& operator=(const Coin& other)
+    {
+        if (this != &other) {
+            out = other.out;
+            fCoinBase = other.fCoinBase;
+            nHeight = other.nHeight;
+            nType = other.nType;
+            m_commitment.reset();
+            if (other.m_commitment) {
+                m_commitment = std::make_unique<secp256k1_pedersen_commitment>(*other.m_commitment);
+            }
+        }
+        return *this;
+    }
+    Coin& operator=(Coin&&) = default;
+
+    //! commitment of a CT coin, all zeros if none is set
+    const secp256k1_pedersen_commitment& GetCommitment() const
+    {
+        static const secp256k1_pedersen_commitment null_commitment{};
+        return m_commitment ? *m_commitment : null_commitment;
+    }
+
+    void SetCommitment(const secp256k1_pedersen_commitment& commitment)
+    {
+        if (!m_commitment) {
+            m_commitment = std::make_unique<secp256k1_pedersen_commitment>();
+        }
+        *m_commitment = commitment;
+    }
+
     bool Matches(CTxOutBase *txo) const
     {
         if (!txo->IsType(nType)) {
@@ -128,7 +172,7 @@ public:
             return false;
         }
         if (nType == OUTPUT_CT
-            && memcmp(commitment.data, ((CTxOutCT*)txo)->commitment.data, 33) != 0) {
+            && memcmp(GetCommitment().data, ((CTxOutCT*)txo)->commitment.data, 33) != 0) {
             return false;
         }
         return true;
@@ -138,6 +182,7 @@ public:
         out.SetNull();
         fCoinBase = false;
         nHeight = 0;
+        m_commitment.reset();
     }
 
     //! empty constructor
@@ -157,7 +202,7 @@ public:
         if (!fGlobeMode) return;
         ::Serialize(s, nType);
         if (nType == OUTPUT_CT) {
-            s.write(AsBytes(Span{(char*)&commitment.data[0], 33}));
+            s.write(AsBytes(Span{(const char*)&GetCommitment().data[0], 33}));
         }
     }
 
@@ -171,7 +216,11 @@ public:
         if (!fGlobeMode) return;
         ::Unserialize(s, nType);
         if (nType == OUTPUT_CT) {
+            secp256k1_pedersen_commitment commitment;
             s.read(AsWritableBytes(Span{(char*)&commitment.data[0], 33}));
+            SetCommitment(commitment);
+        } else {
+            m_commitment.reset();
         }
     }
 
@@ -183,7 +232,8 @@ public:
     }
 
     size_t DynamicMemoryUsage() const {
-        return memusage::DynamicUsage(out.scriptPubKey);
+        return memusage::DynamicUsage(out.scriptPubKey) +
+            (m_commitment ? memusage::MallocUsage(sizeof(secp256k1_pedersen_commitment)) : 0);
     }
 };
 
@@ -253,7 +303,22 @@ struct CCoinsCacheEntry
     CCoinsCacheEntry(Coin&& coin_, unsigned char flag) : coin(std::move(coin_)), flags(flag) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+/**
+ * PoolAllocator's MAX_BLOCK_SIZE_BYTES parameter here uses sizeof the data, and adds the size
+ * of 4 pointers. We do not know the exact node size used in the std::unordered_node implementation
+ * because it is implementation defined. Most implementations have an overhead of 1 or 2 pointers,
+ * so nodes can be connected in a linked list, and in some cases the hash value is stored as well.
+ * Using an additional sizeof(void*)*4 for MAX_BLOCK_SIZE_BYTES should thus be sufficient so that
+ * all implementations can allocate the nodes from the PoolAllocator.
+ */
+using CCoinsMap = std::unordered_map<COutPoint,
+                                     CCoinsCacheEntry,
+                                     SaltedOutpointHasher,
+                                     std::equal_to<COutPoint>,
+                                     PoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>,
+                                                   sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void*) * 4>>;
+
+using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -343,11 +408,15 @@ public:
      */
     mutable uint256 hashBlock;
     mutable int nBlockHeight = 0;
+    /* The cache's nodes are allocated from here, must be declared before cacheCoins. */
+    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource{};
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
     mutable size_t cachedCoinsUsage;
 
+    uint64_t m_flush_count{0};
+
     mutable std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
     mutable std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
     mutable std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
@@ -432,6 +501,14 @@ public:
      */
     void EmplaceCoinInternalDANGER(COutPoint&& outpoint, Coin&& coin);
 
+    /**
+     * Add an unspent coin read from the base view, without marking it dirty.
+     * Has no effect if the cache already holds an entry for outpoint.
+     * The caller must ensure the coin matches the base view's current state.
+     * @sa node::InputPrefetcher
+     */
+    bool WarmCoin(const COutPoint& outpoint, Coin&& coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call
@@ -446,6 +523,9 @@ public:
      */
     bool Flush();
 
+    //! Number of times Flush() was called
+    uint64_t GetFlushCount() const { return m_flush_count; }
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is
      * not modified.
@@ -324,7 +324,7 @@ bool Consensus::CheckTxInputs(const CTransaction& tx, TxValidationState& state,
                 nStandard++;
             } else
             if (coin.nType == OUTPUT_CT) {
-                vpCommitsIn.push_back(&coin.commitment);
+                vpCommitsIn.push_back(&coin.GetCommitment());
                 nCt++;
 
                 if (coin.nHeight <= state.m_consensus_params->m_frozen_blinded_height) {
@@ -448,22 +448,8 @@ bool Consensus::CheckTxInputs(const CTransaction& tx, TxValidationState& state,
     }
 
     // Track blinded balances
-    state.tx_balances[BAL_IND_PLAIN_ADDED] = nPlainValueOut;
-    state.tx_balances[BAL_IND_PLAIN_REMOVED] = nValueIn;
-    if (!state.m_exploit_fix_2 || !state.m_spends_frozen_blinded) {
-        if (nRingCTInputs > 0) { // spending anon
-            state.tx_balances[BAL_IND_ANON_REMOVED] = nPlainValueOut + txfee;
-        } else
-        if (nCTInputs > 0) { // spending blind
-            state.tx_balances[BAL_IND_BLIND_REMOVED] = nPlainValueOut + txfee;
-        }
-    }
-    if (nRingCTOutputs > 0 && nValueIn > 0) {
-        state.tx_balances[BAL_IND_ANON_ADDED] = nValueIn - (nPlainValueOut + txfee);
-    }
-    if (nCTOutputs > 0 && nValueIn > 0) {
-        state.tx_balances[BAL_IND_BLIND_ADDED] = nValueIn - (nPlainValueOut + txfee);
-    }
+    Consensus::SetTxBalances(state.tx_balances, nValueIn, nPlainValueOut, txfee, nCTInputs, nRingCTInputs, nCTOutputs, nRingCTOutputs,
+                             state.m_exploit_fix_2 && state.m_spends_frozen_blinded);
     if (state.m_clamp_tx_version && nValueIn > 0 && nRingCTOutputs > 0 && nCTOutputs > 0) {
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-plain-in-mixed-out");
     }
@@ -538,6 +524,27 @@ bool Consensus::CheckTxInputs(const CTransaction& tx, TxValidationState& state,
     return true;
 }
 
+void Consensus::SetTxBalances(CAmount tx_balances[6], CAmount value_in, CAmount plain_value_out, CAmount txfee,
+                              size_t ct_inputs, size_t ringct_inputs, size_t ct_outputs, size_t ringct_outputs, bool redeems_frozen_blinded)
+{
+    tx_balances[BAL_IND_PLAIN_ADDED] = plain_value_out;
+    tx_balances[BAL_IND_PLAIN_REMOVED] = value_in;
+    if (!redeems_frozen_blinded) {
+        if (ringct_inputs > 0) { // spending anon
+            tx_balances[BAL_IND_ANON_REMOVED] = plain_value_out + txfee;
+        } else
+        if (ct_inputs > 0) { // spending blind
+            tx_balances[BAL_IND_BLIND_REMOVED] = plain_value_out + txfee;
+        }
+    }
+    if (ringct_outputs > 0 && value_in > 0) {
+        tx_balances[BAL_IND_ANON_ADDED] = value_in - (plain_value_out + txfee);
+    }
+    if (ct_outputs > 0 && value_in > 0) {
+        tx_balances[BAL_IND_BLIND_ADDED] = value_in - (plain_value_out + txfee);
+    }
+}
+
 
 
 static bool CheckStandardOutput(TxValidationState &state, const CTxOutStandard *p, CAmount &nValueOut)
@@ -581,7 +588,7 @@ static bool CheckBlindOutput(TxValidationState &state, const CTxOutCT *p)
 
     if (state.fBulletproofsActive) {
         rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
-            blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
+            state.m_blind_scratch ? state.m_blind_scratch : blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
             nullptr, &p->commitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0);
     } else {
         rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value,
@@ -625,7 +632,7 @@ bool CheckAnonOutput(TxValidationState &state, const CTxOutRingCT *p)
 
     if (state.fBulletproofsActive) {
         rv = secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind,
-            blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
+            state.m_blind_scratch ? state.m_blind_scratch : blind_scratch, blind_gens, p->vRangeproof.data(), p->vRangeproof.size(),
             nullptr, &p->commitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0);
     } else {
         rv = secp256k1_rangeproof_verify(secp256k1_ctx_blind, &min_value, &max_value,
@@ -7,6 +7,7 @@
 
 #include <consensus/amount.h>
 
+#include <cstddef>
 #include <stdint.h>
 #include <vector>
 
@@ -25,6 +26,13 @@ namespace Consensus {
  * Preconditions: tx.IsCoinBase() is false.
  */
 [[nodiscard]] bool CheckTxInputs(const CTransaction& tx, TxValidationState& state, const CCoinsViewCache& inputs, int nSpendHeight, CAmount& txfee);
+
+/**
+ * Set the plain, blind and anon balance changes of a transaction, indexed by BalanceIndexType.
+ * Blinded inputs are not removed from the blinded balances when redeems_frozen_blinded is set.
+ */
+void SetTxBalances(CAmount tx_balances[6], CAmount value_in, CAmount plain_value_out, CAmount txfee,
+                   size_t ct_inputs, size_t ringct_inputs, size_t ct_outputs, size_t ringct_outputs, bool redeems_frozen_blinded);
 } // namespace Consensus
 /** Auxiliary functions for transaction validation (ideally should not be exposed) */
 
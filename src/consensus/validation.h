@@ -12,6 +12,7 @@
 #include <primitives/transaction.h>
 #include <primitives/block.h>
 #include <consensus/params.h>
+#include <secp256k1.h>
 
 class PeerManager;
 class ChainstateManager;
@@ -173,6 +174,7 @@ public:
     int m_spend_height = 0;
     bool m_globe_mode = false;
     bool m_skip_rangeproof = false;
+    secp256k1_scratch_space *m_blind_scratch = nullptr; // Bulletproof scratch space, the shared blind_scratch if null
     const Consensus::Params *m_consensus_params = nullptr;
     bool m_preserve_state = false; // Don't clear error during ActivateBestChain (debug)
 
@@ -229,6 +231,7 @@ public:
 
         m_globe_mode = state_from.m_globe_mode;
         m_skip_rangeproof = state_from.m_skip_rangeproof;
+        m_blind_scratch = state_from.m_blind_scratch;
 
         m_clamp_tx_version = state_from.m_clamp_tx_version;
         m_exploit_fix_1 = state_from.m_exploit_fix_1;
@@ -6,6 +6,10 @@
 #include <pubkey.h>
 #include <logging.h>
 #include <outputtype.h>
+#include <crypto/common.h>
+#include <chrono>
+#include <deque>
+#include <memory>
 #if defined(WIN32) && !defined(__kernel_entry)
 // A workaround for boost 1.71 incompatibility with mingw-w64 compiler.
 // For details see https://github.com/bitcoin/bitcoin/pull/22348.
@@ -17,6 +21,8 @@
 #include <boost/algorithm/string.hpp>
 #ifdef WIN32
 #include <boost/process/windows.hpp>
+#else
+#include <poll.h>
 #endif
 
 RecursiveMutex cs_ledger;
@@ -177,6 +183,222 @@ private:
     std::string m_std_out;
     std::string m_std_err;
 };
+
+// Long-lived HWI helper, see contrib/hwi/hwi-session.py
+// Frames are a 4 byte little endian length followed by a json object
+class CSession
+{
+public:
+    ~CSession()
+    {
+        close();
+    }
+
+    // Set how long to wait for each response
+    void setTimeout(std::chrono::milliseconds timeout)
+    {
+        m_timeout = timeout;
+    }
+
+    // Check if the last receive gave up waiting for the response
+    bool timedOut() const
+    {
+        return m_timed_out;
+    }
+
+    // Start the helper process
+    bool open(const std::string& prog, const std::vector<std::string> &arg)
+    {
+        close();
+        try
+        {
+            m_in = std::make_unique<boost::process::opstream>();
+            m_out = std::make_unique<boost::process::ipstream>();
+    #ifdef WIN32
+            m_child = std::make_unique<boost::process::child>(prog, ::boost::process::windows::create_no_window, boost::process::args(arg),
+                                        boost::process::std_in < *m_in, boost::process::std_out > *m_out, boost::process::std_err > boost::process::null);
+    #else
+            m_child = std::make_unique<boost::process::child>(prog, boost::process::args(arg),
+                                        boost::process::std_in < *m_in, boost::process::std_out > *m_out, boost::process::std_err > boost::process::null);
+    #endif
+        }
+        catch(...)
+        {
+            close();
+            return false;
+        }
+        m_answered = 0;
+        return true;
+    }
+
+    // Check if the helper is running
+    bool isOpen()
+    {
+        return m_child && m_child->running();
+    }
+
+    // Number of requests answered since the helper was started
+    uint64_t answered() const
+    {
+        return m_answered;
+    }
+
+    // Send a request, the response is read later with receive
+    bool send(const std::vector<std::string> &arg)
+    {
+        if(!isOpen())
+            return false;
+
+        UniValue args(UniValue::VARR);
+        for(const std::string& a : arg)
+            args.push_back(a);
+        UniValue request(UniValue::VOBJ);
+        request.pushKV("id", m_next_id);
+        request.pushKV("args", args);
+
+        std::string data = request.write();
+        uint8_t header[4];
+        WriteLE32(header, data.size());
+        m_in->write((const char*)header, sizeof(header));
+        m_in->write(data.data(), data.size());
+        m_in->flush();
+        if(!m_in->good())
+            return false;
+
+        m_pending.push_back(m_next_id++);
+        return true;
+    }
+
+    // Read the response to the oldest request sent
+    bool receive(std::string& std_out, std::string& std_err)
+    {
+        std_out = "";
+        std_err = "";
+        if(m_pending.empty() || !m_out)
+        {
+            std_err = "No HWI session request pending";
+            return false;
+        }
+        int64_t id = m_pending.front();
+        m_pending.pop_front();
+
+        const auto deadline = std::chrono::steady_clock::now() + m_timeout;
+        uint8_t header[4];
+        if(!read((char*)header, sizeof(header), deadline))
+        {
+            std_err = m_timed_out ? "HWI session timed out" : "HWI session closed";
+            return false;
+        }
+        uint32_t size = ReadLE32(header);
+        if(size > MAX_FRAME_SIZE)
+        {
+            std_err = "HWI session frame too large";
+            return false;
+        }
+        std::string data(size, '\0');
+        if(!read(data.data(), size, deadline))
+        {
+            std_err = m_timed_out ? "HWI session timed out" : "HWI session closed";
+            return false;
+        }
+
+        UniValue response = json_get_object(json_read_doc(data));
+        if(!response.exists("id") || !response["id"].isNum() || response["id"].getInt<int64_t>() != id)
+        {
+            std_err = "Unexpected HWI session response";
+            return false;
+        }
+        std_out = json_get_key_string(response, "stdout");
+        std_err = json_get_key_string(response, "stderr");
+        m_answered++;
+        return true;
+    }
+
+    // Stop the helper process
+    void close()
+    {
+        if(m_in)
+            m_in->pipe().close();
+        if(m_child)
+        {
+            std::error_code ec;
+            if(m_child->running(ec))
+                m_child->terminate(ec);
+            m_child->wait(ec);
+        }
+        m_child.reset();
+        m_in.reset();
+        m_out.reset();
+        m_pending.clear();
+    }
+
+private:
+    // Wait until the helper's output can be read without blocking, or until deadline
+    bool waitReadable(std::chrono::steady_clock::time_point deadline)
+    {
+#ifdef WIN32
+        HANDLE handle = m_out->pipe().native_source();
+        while(true)
+        {
+            DWORD available = 0;
+            // A closed pipe is readable, the read then fails
+            if(!PeekNamedPipe(handle, nullptr, 0, nullptr, &available, nullptr) || available > 0)
+                return true;
+            if(std::chrono::steady_clock::now() >= deadline)
+                return false;
+            Sleep(10);
+        }
+#else
+        pollfd pfd{m_out->pipe().native_source(), POLLIN, 0};
+        while(true)
+        {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            int ret = poll(&pfd, 1, std::max<int64_t>(remaining.count(), 0));
+            if(ret > 0)
+                return true;
+            if(ret == 0 || errno != EINTR)
+                return false;
+        }
+#endif
+    }
+
+    // Read size bytes of the response, giving up at deadline
+    bool read(char* buf, size_t size, std::chrono::steady_clock::time_point deadline)
+    {
+        m_timed_out = false;
+        size_t done = 0;
+        while(done < size)
+        {
+            std::streamsize available = m_out->rdbuf()->in_avail();
+            if(available <= 0)
+            {
+                if(!waitReadable(deadline))
+                {
+                    m_timed_out = std::chrono::steady_clock::now() >= deadline;
+                    return false;
+                }
+                // Refills the buffer with what the pipe holds
+                available = 1;
+            }
+            std::streamsize count = std::min<std::streamsize>(available, size - done);
+            if(!m_out->read(buf + done, count))
+                return false;
+            done += count;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+    std::unique_ptr<boost::process::opstream> m_in;
+    std::unique_ptr<boost::process::ipstream> m_out;
+    std::unique_ptr<boost::process::child> m_child;
+    std::deque<int64_t> m_pending;
+    int64_t m_next_id = 0;
+    uint64_t m_answered = 0;
+    std::chrono::milliseconds m_timeout{std::chrono::seconds{DEFAULT_HWI_SESSION_TIMEOUT}};
+    bool m_timed_out = false;
+};
 }
 using namespace GlobeLedger_NS;
 
@@ -187,6 +409,7 @@ public:
     {
         toolPath = gArgs.GetArg("-hwitoolpath", "");
         toolExists = boost::filesystem::exists(toolPath);
+        initSessionPath();
         initToolPath();
 
         if(gArgs.GetChainName() != CBaseChainParams::MAIN)
@@ -194,7 +417,8 @@ public:
             ledgerMainPath = false;
         }
 
-        arguments << "--chain" << gArgs.GetChainName();
+        chainArguments << "--chain" << gArgs.GetChainName();
+        arguments.insert(arguments.end(), chainArguments.begin(), chainArguments.end());
 
         if(!toolExists)
         {
@@ -202,6 +426,118 @@ public:
         }
     }
 
+    void initSessionPath()
+    {
+        std::string sessionPath = gArgs.GetArg("-hwisessionpath", "");
+        if(sessionPath.empty())
+            return;
+
+        if(!boost::filesystem::exists(sessionPath))
+        {
+            LogPrintf("GlobeLedger(): HWI session helper not found %s\n", sessionPath);
+            return;
+        }
+
+        sessionProgram = sessionPath;
+#ifdef WIN32
+        if(boost::algorithm::iends_with(sessionPath, ".py"))
+        {
+            sessionArguments << sessionPath;
+            sessionProgram = boost::process::search_path("python3").string();
+            if(sessionProgram.empty())
+                sessionProgram = boost::process::search_path("python").string();
+        }
+#endif
+        sessionArguments << "--tool" << toolPath;
+        session.setTimeout(std::chrono::seconds{std::max<int64_t>(gArgs.GetIntArg("-hwisessiontimeout", DEFAULT_HWI_SESSION_TIMEOUT), 1)});
+        sessionEnabled = !sessionProgram.empty();
+    }
+
+    // Start the helper if needed, return true when requests go through it
+    bool openSession()
+    {
+        if(!sessionEnabled)
+            return false;
+        if(session.isOpen())
+            return true;
+        if(!pending.empty())
+            return false;
+        if(!session.open(sessionProgram, sessionArguments))
+        {
+            LogPrintf("GlobeLedger(): Failed to start HWI session helper %s\n", sessionProgram);
+            sessionEnabled = false;
+            return false;
+        }
+        LogPrint(BCLog::HDWALLET, "GlobeLedger(): Started HWI session helper\n");
+        return true;
+    }
+
+    // Send the command to the helper, or run the tool for it when there is no helper
+    void start(const std::vector<std::string>& command)
+    {
+        std::vector<std::string> args = chainArguments;
+        args.insert(args.end(), command.begin(), command.end());
+        if(openSession() && session.send(args))
+        {
+            pending.push_back(command);
+        }
+        else
+        {
+            args = arguments;
+            args.insert(args.end(), command.begin(), command.end());
+            process.start(toolPath, args);
+            fProcessStarted = true;
+        }
+        fStarted = true;
+    }
+
+    // Read the result of the oldest command started
+    void wait()
+    {
+        if(!pending.empty())
+        {
+            std::vector<std::string> command = pending.front();
+            pending.pop_front();
+            if(!session.receive(strStdout, strError))
+            {
+                if(session.timedOut())
+                {
+                    // The device didn't answer, running the tool would wait for it too
+                    LogPrintf("GlobeLedger(): HWI session helper timed out, stopping it\n");
+                    session.close();
+                    pending.clear();
+                    fStarted = fProcessStarted;
+                    return;
+                }
+                if(session.answered() == 0)
+                {
+                    // The helper can't run this tool, don't try it again
+                    LogPrintf("GlobeLedger(): HWI session helper failed, running the tool for each request\n");
+                    sessionEnabled = false;
+                }
+                session.close();
+
+                std::vector<std::string> args = arguments;
+                args.insert(args.end(), command.begin(), command.end());
+                process.start(toolPath, args);
+                waitProcess();
+            }
+        }
+        else if(fProcessStarted)
+        {
+            waitProcess();
+            fProcessStarted = false;
+        }
+        fStarted = !pending.empty() || fProcessStarted;
+    }
+
+    void waitProcess()
+    {
+        process.waitForFinished();
+        strStdout = process.readAllStandardOutput();
+        strError = process.readAllStandardError();
+    }
+
 #ifdef WIN32
     bool getToolPath(std::string pythonProgram)
     {
@@ -240,11 +576,18 @@ public:
     }
 
     std::atomic<bool> fStarted{false};
+    bool fProcessStarted = false;
     CProcess process;
+    CSession session;
+    std::deque<std::vector<std::string>> pending;
     std::string strStdout;
     std::string strError;
     std::string toolPath;
     std::vector<std::string> arguments;
+    std::vector<std::string> chainArguments;
+    std::string sessionProgram;
+    std::vector<std::string> sessionArguments;
+    bool sessionEnabled = false;
     bool toolExists = false;
     bool ledgerMainPath = true;
 };
@@ -306,6 +649,54 @@ bool GlobeLedger::signBlockHeader(const std::string &fingerprint, const std::str
     return endSignBlockHeader(fingerprint, header, path, vchSig);
 }
 
+bool GlobeLedger::signCoinStakeAndHeader(const std::string &fingerprint, std::string &psbt, const std::string &header, const std::string &path, std::vector<unsigned char> &vchSig)
+{
+    LOCK(cs_ledger);
+    // Check if tool exists
+    if(!toolExists())
+        return false;
+
+    // Sign PSBT transaction and block header
+    if(isStarted())
+        return false;
+
+    if(!beginSignTx(fingerprint, psbt))
+        return false;
+
+    if(d->pending.empty())
+    {
+        // No session, run the requests one after the other
+        wait();
+        if(!endSignTx(fingerprint, psbt))
+            return false;
+
+        if(!beginSignBlockHeader(fingerprint, header, path, vchSig))
+            return false;
+
+        wait();
+
+        return endSignBlockHeader(fingerprint, header, path, vchSig);
+    }
+
+    // Queue the header request before the transaction is signed
+    beginSignBlockHeader(fingerprint, header, path, vchSig);
+
+    wait();
+    if(!endSignTx(fingerprint, psbt))
+    {
+        // Read the header response but keep the error of the transaction
+        std::string strStdout = d->strStdout, strError = d->strError;
+        wait();
+        d->strStdout = strStdout;
+        d->strError = strError;
+        return false;
+    }
+
+    wait();
+
+    return endSignBlockHeader(fingerprint, header, path, vchSig);
+}
+
 bool GlobeLedger::isConnected(const std::string &fingerprint, bool stake)
 {
     // Check if a device is connected
@@ -434,20 +825,16 @@ void GlobeLedger::wait()
 {
     if(d->fStarted)
     {
-        d->process.waitForFinished();
-        d->strStdout = d->process.readAllStandardOutput();
-        d->strError = d->process.readAllStandardError();
-        d->fStarted = false;
+        d->wait();
     }
 }
 
 bool GlobeLedger::beginSignTx(const std::string &fingerprint, std::string &psbt)
 {
     // Execute command line
-    std::vector<std::string> arguments = d->arguments;
+    std::vector<std::string> arguments;
     arguments << "-f" << fingerprint << "signtx" << psbt;
-    d->process.start(d->toolPath, arguments);
-    d->fStarted = true;
+    d->start(arguments);
 
     return d->fStarted;
 }
@@ -470,10 +857,9 @@ bool GlobeLedger::endSignTx(const std::string &, std::string &psbt)
 bool GlobeLedger::beginSignBlockHeader(const std::string &fingerprint, const std::string &header, const std::string &path, std::vector<unsigned char> &)
 {
     // Execute command line
-    std::vector<std::string> arguments = d->arguments;
+    std::vector<std::string> arguments;
     arguments << "-f" << fingerprint << "signheader" << header << path;
-    d->process.start(d->toolPath, arguments);
-    d->fStarted = true;
+    d->start(arguments);
 
     return d->fStarted;
 }
@@ -498,10 +884,9 @@ bool GlobeLedger::endSignBlockHeader(const std::string &, const std::string &, c
 bool GlobeLedger::beginEnumerate(std::vector<LedgerDevice> &)
 {
     // Execute command line
-    std::vector<std::string> arguments = d->arguments;
+    std::vector<std::string> arguments;
     arguments << "enumerate";
-    d->process.start(d->toolPath, arguments);
-    d->fStarted = true;
+    d->start(arguments);
 
     return d->fStarted;
 }
@@ -541,10 +926,9 @@ bool GlobeLedger::endEnumerate(std::vector<LedgerDevice> &devices, bool stake)
 bool GlobeLedger::beginSignMessage(const std::string &fingerprint, const std::string &message, const std::string &path, std::string &)
 {
     // Execute command line
-    std::vector<std::string> arguments = d->arguments;
+    std::vector<std::string> arguments;
     arguments << "-f" << fingerprint << "signmessage" << message << path;
-    d->process.start(d->toolPath, arguments);
-    d->fStarted = true;
+    d->start(arguments);
 
     return d->fStarted;
 }
@@ -583,7 +967,7 @@ bool GlobeLedger::beginGetKeyPool(const std::string &fingerprint, int type, cons
     }
 
     // Execute command line
-    std::vector<std::string> arguments = d->arguments;
+    std::vector<std::string> arguments;
     arguments << "-f" << fingerprint << "getkeypool";
     if(descType != "")
         arguments << "--addr-type" << descType;
@@ -596,8 +980,7 @@ bool GlobeLedger::beginGetKeyPool(const std::string &fingerprint, int type, cons
         }
     }
     arguments << std::to_string(from) << std::to_string(to);
-    d->process.start(d->toolPath, arguments);
-    d->fStarted = true;
+    d->start(arguments);
 
     return d->fStarted;
 }
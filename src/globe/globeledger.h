@@ -7,6 +7,9 @@
 
 extern RecursiveMutex cs_ledger;
 
+/** Default seconds to wait for each response of the HWI session helper. */
+static constexpr int64_t DEFAULT_HWI_SESSION_TIMEOUT{300};
+
 class GlobeLedgerPriv;
 
 struct LedgerDevice
@@ -56,6 +59,19 @@ public:
      */
     bool signBlockHeader(const std::string& fingerprint, const std::string& header, const std::string& path, std::vector<unsigned char>& vchSig);
 
+    /**
+     * @brief signCoinStakeAndHeader Sign proof of stake transaction and block header,
+     * both requests are sent to the HWI session before waiting for the first signature.
+     * The header must commit to the coinstake txid, which signing witness inputs doesn't change.
+     * @param fingerprint Fingerprint of the ledger
+     * @param psbt Proof of stake transaction
+     * @param header Block header for the new block
+     * @param path HD key path
+     * @param vchSig Signature
+     * @return true/false
+     */
+    bool signCoinStakeAndHeader(const std::string& fingerprint, std::string& psbt, const std::string& header, const std::string& path, std::vector<unsigned char>& vchSig);
+
     /**
      * @brief isConnected Check if a device is connected
      * @param fingerprint Hardware wallet device fingerprint
@@ -153,6 +153,11 @@ void BaseIndex::ThreadSync()
     if (!m_synced) {
         auto& consensus_params = Params().GetConsensus();
 
+        if (!CustomBulkSync(pindex)) {
+            FatalError("%s: Failed to sync index %s in bulk", __func__, GetName());
+            return;
+        }
+
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
         while (true) {
@@ -124,6 +124,12 @@ protected:
     /// Undo update index entries for a newly connected block.
     virtual bool DisconnectBlock(const CBlock& block) { return true; }
 
+    /// Called by the sync thread before indexing blocks one at a time. May
+    /// index any number of active chain blocks following pindex in bulk,
+    /// advancing pindex and the best block index past them. Must return
+    /// early if m_interrupt is set.
+    [[nodiscard]] virtual bool CustomBulkSync(const CBlockIndex*& pindex) { return true; }
+
     virtual DB& GetDB() const = 0;
 
     /// Get the name of the index for display in logs.
@@ -4,8 +4,10 @@
 
 #include <chainparams.h>
 #include <coins.h>
+#include <consensus/tx_verify.h>
 #include <crypto/muhash.h>
 #include <index/coinstatsindex.h>
+#include <insight/balanceindex.h>
 #include <kernel/coinstats.h>
 #include <node/blockstorage.h>
 #include <serialize.h>
@@ -24,6 +26,11 @@ using node::UndoReadFromDisk;
 static constexpr uint8_t DB_BLOCK_HASH{'s'};
 static constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
 static constexpr uint8_t DB_MUHASH{'M'};
+static constexpr uint8_t DB_VERSION{'V'};
+
+//! Version 1 added the per output type counts and balances, version 2 takes
+//! the Globe block subsidy from the money supply
+static constexpr uint8_t COINSTATSINDEX_VERSION{2};
 
 namespace {
 
@@ -41,6 +48,11 @@ struct DBVal {
     CAmount total_unspendables_bip30;
     CAmount total_unspendables_scripts;
     CAmount total_unspendables_unclaimed_rewards;
+    uint64_t blind_output_count;
+    uint64_t anon_output_count;
+    CAmount total_plain_balance;
+    CAmount total_blind_balance;
+    CAmount total_anon_balance;
 
     SERIALIZE_METHODS(DBVal, obj)
     {
@@ -57,6 +69,11 @@ struct DBVal {
         READWRITE(obj.total_unspendables_bip30);
         READWRITE(obj.total_unspendables_scripts);
         READWRITE(obj.total_unspendables_unclaimed_rewards);
+        READWRITE(obj.blind_output_count);
+        READWRITE(obj.anon_output_count);
+        READWRITE(obj.total_plain_balance);
+        READWRITE(obj.total_blind_balance);
+        READWRITE(obj.total_anon_balance);
     }
 };
 
@@ -100,6 +117,110 @@ struct DBHashKey {
     }
 };
 
+//! Globe blocks have no fixed subsidy, the value a block creates is its change in money
+//! supply, plus the plain value it burns once burnt coins are removed from the money supply
+CAmount GetGlobeBlockSubsidy(const CBlock& block, const CBlockIndex& block_index, const Consensus::Params& consensus)
+{
+    CAmount subsidy{block_index.nMoneySupply - (block_index.pprev ? block_index.pprev->nMoneySupply : 0)};
+    if (block.nTime >= consensus.clamp_tx_version_time) {
+        for (const auto& tx : block.vtx) {
+            subsidy += tx->GetPlainValueBurned();
+        }
+    }
+    return subsidy;
+}
+
+//! The coins tx adds to the UTXO set, including unspendable outputs, see AddCoins
+std::vector<std::pair<COutPoint, Coin>> GetTxCoins(const CTransaction& tx, int height, uint64_t& anon_output_count)
+{
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    const bool is_coinbase{tx.IsCoinBase() || tx.IsCoinStake()};
+    if (tx.IsGlobeVersion()) {
+        for (uint32_t j = 0; j < tx.vpout.size(); ++j) {
+            const CTxOutBase* out{tx.vpout[j].get()};
+            if (out->IsType(OUTPUT_STANDARD)) {
+                coins.emplace_back(COutPoint{tx.GetHash(), j}, Coin{CTxOut{out->GetValue(), *out->GetPScriptPubKey()}, height, is_coinbase});
+            } else if (out->IsType(OUTPUT_CT)) {
+                Coin coin{CTxOut{0, *out->GetPScriptPubKey()}, height, is_coinbase};
+                coin.nType = OUTPUT_CT;
+                coin.SetCommitment(((const CTxOutCT*)out)->commitment);
+                coins.emplace_back(COutPoint{tx.GetHash(), j}, std::move(coin));
+            } else if (out->IsType(OUTPUT_RINGCT)) {
+                ++anon_output_count;
+            }
+        }
+        return coins;
+    }
+    for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+        coins.emplace_back(COutPoint{tx.GetHash(), j}, Coin{tx.vout[j], height, is_coinbase});
+    }
+    return coins;
+}
+
+//! Whether any ring member of an anon input is at or below the frozen anon index
+bool SpendsFrozenAnon(const CTxIn& txin, const Consensus::Params& consensus)
+{
+    uint32_t num_inputs, ring_size;
+    txin.GetAnonInfo(num_inputs, ring_size);
+    const std::vector<uint8_t>& vMI = txin.scriptWitness.stack[0];
+    size_t ofs = 0, nB = 0;
+    for (size_t k = 0; k < (size_t)num_inputs * ring_size; ++k) {
+        uint64_t anon_index = 0;
+        if (0 != part::GetVarInt(vMI, ofs, anon_index, nB)) {
+            return false;
+        }
+        ofs += nB;
+        if ((int64_t)anon_index <= consensus.m_frozen_anon_index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Add the plain, blind and anon balance changes of tx to balances, see CheckTxInputs
+void AddTxBalances(const CTransaction& tx, const CTxUndo* tx_undo, bool exploit_fix_2, const Consensus::Params& consensus, CAmount balances[3])
+{
+    CAmount tx_balances[6] = {0};
+    if (tx.IsCoinBase()) {
+        tx_balances[BAL_IND_PLAIN_ADDED] = tx.GetValueOut();
+    } else {
+        CAmount value_in{0};
+        size_t ct_inputs{0}, ringct_inputs{0};
+        bool spends_frozen_blinded{false};
+        for (const Coin& coin : Assert(tx_undo)->vprevout) {
+            if (coin.nType == OUTPUT_CT) {
+                ++ct_inputs;
+                spends_frozen_blinded |= coin.nHeight <= consensus.m_frozen_blinded_height;
+            } else {
+                value_in += coin.out.nValue;
+            }
+        }
+        for (const CTxIn& txin : tx.vin) {
+            if (txin.IsAnonInput()) {
+                ++ringct_inputs;
+                spends_frozen_blinded |= SpendsFrozenAnon(txin, consensus);
+            }
+        }
+
+        size_t standard_outputs{0}, ct_outputs{0}, ringct_outputs{0};
+        const CAmount plain_value_out{tx.GetPlainValueOut(standard_outputs, ct_outputs, ringct_outputs)};
+        CAmount txfee{0};
+        if (tx.IsCoinStake()) {
+            txfee = plain_value_out - value_in;
+        } else if (ct_inputs + ringct_inputs + ct_outputs + ringct_outputs > 0) {
+            tx.GetCTFee(txfee);
+        } else {
+            txfee = value_in - plain_value_out;
+        }
+        Consensus::SetTxBalances(tx_balances, value_in, plain_value_out, txfee, ct_inputs, ringct_inputs, ct_outputs, ringct_outputs,
+                                 exploit_fix_2 && spends_frozen_blinded);
+    }
+
+    balances[BAL_IND_PLAIN] += tx_balances[BAL_IND_PLAIN_ADDED] - tx_balances[BAL_IND_PLAIN_REMOVED];
+    balances[BAL_IND_BLIND] += tx_balances[BAL_IND_BLIND_ADDED] - tx_balances[BAL_IND_BLIND_REMOVED];
+    balances[BAL_IND_ANON] += tx_balances[BAL_IND_ANON_ADDED] - tx_balances[BAL_IND_ANON_REMOVED];
+}
+
 }; // namespace
 
 std::unique_ptr<CoinStatsIndex> g_coin_stats_index;
@@ -111,45 +232,64 @@ CoinStatsIndex::CoinStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t
     fs::create_directories(path);
 
     m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+
+    uint8_t version{0};
+    if (m_db->Exists(DB_MUHASH) && (!m_db->Read(DB_VERSION, version) || version < COINSTATSINDEX_VERSION)) {
+        LogPrintf("%s: Rebuilding %s, the database format has changed\n", __func__, GetName());
+        m_db.reset();
+        m_db = std::make_unique<CoinStatsIndex::DB>(path / "db", n_cache_size, f_memory, /*f_wipe=*/true);
+    }
+    m_db->Write(DB_VERSION, COINSTATSINDEX_VERSION);
 }
 
 bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 {
     CBlockUndo block_undo;
-    const CAmount block_subsidy{GetBlockSubsidy(block.height, Params().GetConsensus())};
+    const auto& consensus_params{Params().GetConsensus()};
+    // pindex variable gives indexing code access to node internals. It
+    // will be removed in upcoming commit
+    const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+    const CAmount block_subsidy{fGlobeMode ? WITH_LOCK(cs_main, return GetGlobeBlockSubsidy(*Assert(block.data), *pindex, consensus_params)) : GetBlockSubsidy(block.height, consensus_params)};
     m_total_subsidy += block_subsidy;
 
-    // Ignore genesis block
-    if (block.height > 0) {
-        // pindex variable gives indexing code access to node internals. It
-        // will be removed in upcoming commit
-        const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
-        if (!UndoReadFromDisk(block_undo, pindex)) {
-            return false;
-        }
+    CAmount block_balances[3] = {0};
+    CAmount money_supply{0};
+
+    // Ignore genesis block, the Globe genesis block creates spendable outputs
+    if (block.height > 0 || fGlobeMode) {
+        money_supply = WITH_LOCK(cs_main, return pindex->nMoneySupply);
 
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+        assert(block.data);
+        const bool has_undo{block.height > 0 || std::any_of(block.data->vtx.begin(), block.data->vtx.end(), [](const CTransactionRef& tx) { return !tx->IsCoinBase(); })};
+        if (has_undo && !UndoReadFromDisk(block_undo, pindex)) {
             return false;
         }
 
-        uint256 expected_block_hash{*Assert(block.prev_hash)};
-        if (read_out.first != expected_block_hash) {
-            LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
-                      read_out.first.ToString(), expected_block_hash.ToString());
+        if (block.height > 0) {
+            std::pair<uint256, DBVal> read_out;
+            if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+                return false;
+            }
 
-            if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
-                return error("%s: previous block header not found; expected %s",
-                             __func__, expected_block_hash.ToString());
+            uint256 expected_block_hash{*Assert(block.prev_hash)};
+            if (read_out.first != expected_block_hash) {
+                LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
+                          read_out.first.ToString(), expected_block_hash.ToString());
+
+                if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
+                    return error("%s: previous block header not found; expected %s",
+                                 __func__, expected_block_hash.ToString());
+                }
             }
         }
 
         // TODO: Deduplicate BIP30 related code
         bool is_bip30_block{(block.height == 91722 && block.hash == uint256S("0x00000000000271a2dc26e7667f8419f2e15416dc6955e5a6c6cdf3f2574dd08e")) ||
                             (block.height == 91812 && block.hash == uint256S("0x00000000000af0aed4792b1acee3d966af36cf5def14935db8de83d6f9306f2f"))};
+        const bool exploit_fix_2{block.data->nTime >= consensus_params.exploit_fix_2_time};
 
         // Add the new utxos created from the block
-        assert(block.data);
+        size_t undo_pos{0};
         for (size_t i = 0; i < block.data->vtx.size(); ++i) {
             const auto& tx{block.data->vtx.at(i)};
 
@@ -160,11 +300,7 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
                 continue;
             }
 
-            for (uint32_t j = 0; j < tx->vout.size(); ++j) {
-                const CTxOut& out{tx->vout[j]};
-                Coin coin{out, block.height, tx->IsCoinBase()};
-                COutPoint outpoint{tx->GetHash(), j};
-
+            for (const auto& [outpoint, coin] : GetTxCoins(*tx, block.height, m_anon_output_count)) {
                 // Skip unspendable coins
                 if (coin.out.scriptPubKey.IsUnspendable()) {
                     m_total_unspendable_amount += coin.out.nValue;
@@ -180,24 +316,33 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
                     m_total_new_outputs_ex_coinbase_amount += coin.out.nValue;
                 }
 
-                ++m_transaction_output_count;
+                if (coin.nType == OUTPUT_CT) {
+                    ++m_blind_output_count;
+                } else {
+                    ++m_transaction_output_count;
+                }
                 m_total_amount += coin.out.nValue;
                 m_bogo_size += GetBogoSize(coin.out.scriptPubKey);
             }
 
             // The coinbase tx has no undo data since no former output is spent
-            if (!tx->IsCoinBase()) {
-                const auto& tx_undo{block_undo.vtxundo.at(i - 1)};
-
-                for (size_t j = 0; j < tx_undo.vprevout.size(); ++j) {
-                    Coin coin{tx_undo.vprevout[j]};
+            const CTxUndo* tx_undo{tx->IsCoinBase() ? nullptr : &block_undo.vtxundo.at(undo_pos++)};
+            AddTxBalances(*tx, tx_undo, exploit_fix_2, consensus_params, block_balances);
+            if (tx_undo) {
+                // Anon inputs have no prevout and can't be mixed with other input types
+                for (size_t j = 0; j < tx_undo->vprevout.size(); ++j) {
+                    const Coin& coin{tx_undo->vprevout[j]};
                     COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
                     m_muhash.Remove(MakeUCharSpan(TxOutSer(outpoint, coin)));
 
                     m_total_prevout_spent_amount += coin.out.nValue;
 
-                    --m_transaction_output_count;
+                    if (coin.nType == OUTPUT_CT) {
+                        --m_blind_output_count;
+                    } else {
+                        --m_transaction_output_count;
+                    }
                     m_total_amount -= coin.out.nValue;
                     m_bogo_size -= GetBogoSize(coin.out.scriptPubKey);
                 }
@@ -209,11 +354,24 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
         m_total_unspendables_genesis_block += block_subsidy;
     }
 
+    // Balances are reset to the money supply at the second RCT exploit fix, see ConnectBlock
+    const auto& fix_height{consensus_params.exploit_fix_2_height};
+    if (fix_height && block.height == (int)fix_height) {
+        m_total_plain_balance = money_supply;
+        m_total_blind_balance = block_balances[BAL_IND_BLIND];
+        m_total_anon_balance = block_balances[BAL_IND_ANON];
+    } else {
+        m_total_plain_balance += block_balances[BAL_IND_PLAIN];
+        m_total_blind_balance += block_balances[BAL_IND_BLIND];
+        m_total_anon_balance += block_balances[BAL_IND_ANON];
+    }
+
     // If spent prevouts + block subsidy are still a higher amount than
     // new outputs + coinbase + current unspendable amount this means
     // the miner did not claim the full block reward. Unclaimed block
-    // rewards are also unspendable.
-    const CAmount unclaimed_rewards{(m_total_prevout_spent_amount + m_total_subsidy) - (m_total_new_outputs_ex_coinbase_amount + m_total_coinbase_amount + m_total_unspendable_amount)};
+    // rewards are also unspendable. Blinded and anon values are not in the
+    // UTXO set and are counted through their balances.
+    const CAmount unclaimed_rewards{(m_total_prevout_spent_amount + m_total_subsidy) - (m_total_new_outputs_ex_coinbase_amount + m_total_coinbase_amount + m_total_unspendable_amount + m_total_blind_balance + m_total_anon_balance)};
     m_total_unspendable_amount += unclaimed_rewards;
     m_total_unspendables_unclaimed_rewards += unclaimed_rewards;
 
@@ -231,6 +389,11 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
     value.second.total_unspendables_bip30 = m_total_unspendables_bip30;
     value.second.total_unspendables_scripts = m_total_unspendables_scripts;
     value.second.total_unspendables_unclaimed_rewards = m_total_unspendables_unclaimed_rewards;
+    value.second.blind_output_count = m_blind_output_count;
+    value.second.anon_output_count = m_anon_output_count;
+    value.second.total_plain_balance = m_total_plain_balance;
+    value.second.total_blind_balance = m_total_blind_balance;
+    value.second.total_anon_balance = m_total_anon_balance;
 
     uint256 out;
     m_muhash.Finalize(out);
@@ -346,6 +509,12 @@ std::optional<CCoinsStats> CoinStatsIndex::LookUpStats(const CBlockIndex& block_
     stats.total_unspendables_bip30 = entry.total_unspendables_bip30;
     stats.total_unspendables_scripts = entry.total_unspendables_scripts;
     stats.total_unspendables_unclaimed_rewards = entry.total_unspendables_unclaimed_rewards;
+    stats.nBlindTransactionOutputs = entry.blind_output_count;
+    stats.nAnonTransactionOutputs = entry.anon_output_count;
+    stats.money_supply = WITH_LOCK(cs_main, return block_index.nMoneySupply);
+    stats.total_plain_balance = entry.total_plain_balance;
+    stats.total_blind_balance = entry.total_blind_balance;
+    stats.total_anon_balance = entry.total_anon_balance;
 
     return stats;
 }
@@ -388,6 +557,11 @@ bool CoinStatsIndex::CustomInit(const std::optional<interfaces::BlockKey>& block
         m_total_unspendables_bip30 = entry.total_unspendables_bip30;
         m_total_unspendables_scripts = entry.total_unspendables_scripts;
         m_total_unspendables_unclaimed_rewards = entry.total_unspendables_unclaimed_rewards;
+        m_blind_output_count = entry.blind_output_count;
+        m_anon_output_count = entry.anon_output_count;
+        m_total_plain_balance = entry.total_plain_balance;
+        m_total_blind_balance = entry.total_blind_balance;
+        m_total_anon_balance = entry.total_anon_balance;
     }
 
     return true;
@@ -407,7 +581,7 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     CBlockUndo block_undo;
     std::pair<uint256, DBVal> read_out;
 
-    const CAmount block_subsidy{GetBlockSubsidy(pindex->nHeight, Params().GetConsensus())};
+    const CAmount block_subsidy{fGlobeMode ? GetGlobeBlockSubsidy(block, *pindex, Params().GetConsensus()) : GetBlockSubsidy(pindex->nHeight, Params().GetConsensus())};
     m_total_subsidy -= block_subsidy;
 
     // Ignore genesis block
@@ -433,14 +607,12 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     }
 
     // Remove the new UTXOs that were created from the block
+    size_t undo_pos{0};
     for (size_t i = 0; i < block.vtx.size(); ++i) {
         const auto& tx{block.vtx.at(i)};
 
-        for (uint32_t j = 0; j < tx->vout.size(); ++j) {
-            const CTxOut& out{tx->vout[j]};
-            COutPoint outpoint{tx->GetHash(), j};
-            Coin coin{out, pindex->nHeight, tx->IsCoinBase()};
-
+        uint64_t anon_output_count{0};
+        for (const auto& [outpoint, coin] : GetTxCoins(*tx, pindex->nHeight, anon_output_count)) {
             // Skip unspendable coins
             if (coin.out.scriptPubKey.IsUnspendable()) {
                 m_total_unspendable_amount -= coin.out.nValue;
@@ -456,31 +628,45 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
                 m_total_new_outputs_ex_coinbase_amount -= coin.out.nValue;
             }
 
-            --m_transaction_output_count;
+            if (coin.nType == OUTPUT_CT) {
+                --m_blind_output_count;
+            } else {
+                --m_transaction_output_count;
+            }
             m_total_amount -= coin.out.nValue;
             m_bogo_size -= GetBogoSize(coin.out.scriptPubKey);
         }
+        m_anon_output_count -= anon_output_count;
 
         // The coinbase tx has no undo data since no former output is spent
         if (!tx->IsCoinBase()) {
-            const auto& tx_undo{block_undo.vtxundo.at(i - 1)};
+            const auto& tx_undo{block_undo.vtxundo.at(undo_pos++)};
 
             for (size_t j = 0; j < tx_undo.vprevout.size(); ++j) {
-                Coin coin{tx_undo.vprevout[j]};
+                const Coin& coin{tx_undo.vprevout[j]};
                 COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
                 m_muhash.Insert(MakeUCharSpan(TxOutSer(outpoint, coin)));
 
                 m_total_prevout_spent_amount -= coin.out.nValue;
 
-                m_transaction_output_count++;
+                if (coin.nType == OUTPUT_CT) {
+                    m_blind_output_count++;
+                } else {
+                    m_transaction_output_count++;
+                }
                 m_total_amount += coin.out.nValue;
                 m_bogo_size += GetBogoSize(coin.out.scriptPubKey);
             }
         }
     }
 
-    const CAmount unclaimed_rewards{(m_total_new_outputs_ex_coinbase_amount + m_total_coinbase_amount + m_total_unspendable_amount) - (m_total_prevout_spent_amount + m_total_subsidy)};
+    // The balances can be reset at a block, restore them instead of reversing the block's changes
+    m_total_plain_balance = read_out.second.total_plain_balance;
+    m_total_blind_balance = read_out.second.total_blind_balance;
+    m_total_anon_balance = read_out.second.total_anon_balance;
+
+    const CAmount unclaimed_rewards{(m_total_new_outputs_ex_coinbase_amount + m_total_coinbase_amount + m_total_unspendable_amount + m_total_blind_balance + m_total_anon_balance) - (m_total_prevout_spent_amount + m_total_subsidy)};
     m_total_unspendable_amount -= unclaimed_rewards;
     m_total_unspendables_unclaimed_rewards -= unclaimed_rewards;
 
@@ -501,6 +687,8 @@ bool CoinStatsIndex::ReverseBlock(const CBlock& block, const CBlockIndex* pindex
     Assert(m_total_unspendables_bip30 == read_out.second.total_unspendables_bip30);
     Assert(m_total_unspendables_scripts == read_out.second.total_unspendables_scripts);
     Assert(m_total_unspendables_unclaimed_rewards == read_out.second.total_unspendables_unclaimed_rewards);
+    Assert(m_blind_output_count == read_out.second.blind_output_count);
+    Assert(m_anon_output_count == read_out.second.anon_output_count);
 
     return true;
 }
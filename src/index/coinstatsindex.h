@@ -16,6 +16,10 @@ struct CCoinsStats;
 
 /**
  * CoinStatsIndex maintains statistics on the UTXO set.
+ *
+ * Also records the number of blinded unspent outputs, the number of RingCT
+ * outputs created and the plain, blind and anon balances at each block, so
+ * the supply at any height is read without scanning the UTXO set.
  */
 class CoinStatsIndex final : public BaseIndex
 {
@@ -35,6 +39,11 @@ private:
     CAmount m_total_unspendables_bip30{0};
     CAmount m_total_unspendables_scripts{0};
     CAmount m_total_unspendables_unclaimed_rewards{0};
+    uint64_t m_blind_output_count{0};
+    uint64_t m_anon_output_count{0};
+    CAmount m_total_plain_balance{0};
+    CAmount m_total_blind_balance{0};
+    CAmount m_total_anon_balance{0};
 
     bool ReverseBlock(const CBlock& block, const CBlockIndex* pindex);
 
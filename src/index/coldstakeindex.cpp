@@ -0,0 +1,393 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/coldstakeindex.h>
+
+#include <chainparams.h>
+#include <dbwrapper.h>
+#include <key_io.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <pos/kernel.h>
+#include <primitives/block.h>
+#include <script/interpreter.h>
+#include <util/hasher.h>
+#include <util/parallel.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <unordered_set>
+
+using node::ReadBlockFromDisk;
+
+/** Blocks indexed per batch by the initial bulk sync. */
+static constexpr int BULK_SYNC_BATCH_BLOCKS{1000};
+
+std::unique_ptr<ColdStakeIndex> g_coldstake_index;
+
+/** Extract the stake and spend addresses of a coldstaked output, stake_solution is set to the stake key id. */
+static bool ParseColdStakeOutput(const CTxOutBase& o, ColdStakeIndexLinkKey& lk, valtype& stake_solution)
+{
+    if (!o.IsType(OUTPUT_STANDARD)) {
+        return false;
+    }
+    const CScript* ps = o.GetPScriptPubKey();
+    if (!ps->StartsWithICS()) {
+        return false;
+    }
+    CScript script_stake, script_spend;
+    if (!SplitConditionalCoinstakeScript(*ps, script_stake, script_spend)) {
+        return false;
+    }
+
+    std::vector<valtype> solutions;
+    lk.m_stake_type = Solver(script_stake, solutions);
+    if (lk.m_stake_type == TxoutType::PUBKEYHASH) {
+        memcpy(lk.m_stake_id.begin(), solutions[0].data(), 20);
+    } else
+    if (lk.m_stake_type == TxoutType::PUBKEYHASH256) {
+        lk.m_stake_id = CKeyID256(uint256(solutions[0]));
+    } else {
+        LogPrint(BCLog::COINDB, "%s: Ignoring unexpected stakescript type=%d.\n", __func__, globe::FromTxoutType(lk.m_stake_type));
+        return false;
+    }
+    stake_solution = solutions[0];
+
+    lk.m_spend_type = Solver(script_spend, solutions);
+    if (lk.m_spend_type == TxoutType::PUBKEYHASH || lk.m_spend_type == TxoutType::SCRIPTHASH) {
+        memcpy(lk.m_spend_id.begin(), solutions[0].data(), 20);
+    } else
+    if (lk.m_spend_type == TxoutType::PUBKEYHASH256 || lk.m_spend_type == TxoutType::SCRIPTHASH256) {
+        lk.m_spend_id = CKeyID256(uint256(solutions[0]));
+    } else {
+        LogPrint(BCLog::COINDB, "%s: Ignoring unexpected spendscript type=%d.\n", __func__, globe::FromTxoutType(lk.m_spend_type));
+        return false;
+    }
+    return true;
+}
+
+static ColdStakeIndexSpentKey MakeSpentKey(const ColdStakeIndexOutputValue& ov, const ColdStakeIndexOutputKey& ok)
+{
+    ColdStakeIndexSpentKey sk;
+    sk.m_stake_type = ov.m_link.m_stake_type;
+    sk.m_stake_id = ov.m_link.m_stake_id;
+    sk.m_spend_height = ov.m_spend_height;
+    sk.m_output = ok;
+    return sk;
+}
+
+ColdStakeIndex::ColdStakeIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, int sync_threads, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "coldstakeindex"), m_sync_threads(sync_threads)
+{
+    fs::path path{gArgs.GetDataDirNet() / "indexes" / "coldstake"};
+    fs::create_directories(path);
+
+    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+bool ColdStakeIndex::AppendWhitelistAddress(const std::string& addr)
+{
+    CTxDestination dest = DecodeDestination(addr);
+
+    if (dest.index() == DI::_PKHash) {
+        PKHash id = std::get<PKHash>(dest);
+        m_whitelist.emplace(id.begin(), id.end());
+        return true;
+    }
+    if (dest.index() == DI::_CKeyID256) {
+        CKeyID256 id256 = std::get<CKeyID256>(dest);
+        m_whitelist.emplace(id256.begin(), id256.end());
+        return true;
+    }
+
+    return error("%s: Failed to parse address %s.", __func__, addr);
+}
+
+bool ColdStakeIndex::WriteOutputs(const CBlock& block, int height, std::vector<Spend>& spends) const
+{
+    CDBBatch batch(*m_db);
+    for (const auto& tx : block.vtx) {
+        const uint256& txid = tx->GetHash();
+        for (size_t n = 0; n < tx->vpout.size(); ++n) {
+            const auto& o = tx->vpout[n];
+            ColdStakeIndexOutputValue ov;
+            valtype stake_solution;
+            if (!ParseColdStakeOutput(*o, ov.m_link, stake_solution)) {
+                continue;
+            }
+            if (!m_whitelist.empty() && !m_whitelist.count(stake_solution)) {
+                continue;
+            }
+            ov.m_link.m_height = height;
+            ov.m_value = o->GetValue();
+            if (tx->IsCoinStake()) {
+                ov.m_flags |= CSI_FROM_STAKE;
+            }
+
+            ColdStakeIndexOutputKey ok(txid, n);
+            ColdStakeIndexUnspentValue uv;
+            uv.m_value = ov.m_value;
+            uv.m_flags = ov.m_flags;
+            batch.Write(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov);
+            batch.Write(std::make_pair(DB_CSINDEX_UNSPENT, std::make_pair(ov.m_link, ok)), uv);
+        }
+
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+        for (const auto& in : tx->vin) {
+            if (in.IsAnonInput()) {
+                continue;
+            }
+            spends.push_back({in.prevout, txid, height});
+        }
+    }
+
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: WriteBatch failed.", __func__);
+    }
+    return true;
+}
+
+bool ColdStakeIndex::WriteSpends(const std::vector<Spend>& spends) const
+{
+    CDBBatch batch(*m_db);
+    for (const auto& spend : spends) {
+        ColdStakeIndexOutputKey ok(spend.prevout.hash, spend.prevout.n);
+        ColdStakeIndexOutputValue ov;
+        if (!m_db->Read(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov)) {
+            continue;
+        }
+        if (ov.m_spend_height >= 0) {
+            // Written before an unclean shutdown, drop the stale spent entry
+            batch.Erase(std::make_pair(DB_CSINDEX_SPENT, MakeSpentKey(ov, ok)));
+        }
+        ov.m_spend_height = spend.height;
+        ov.m_spend_txid = spend.txid;
+        batch.Write(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov);
+        batch.Erase(std::make_pair(DB_CSINDEX_UNSPENT, std::make_pair(ov.m_link, ok)));
+        batch.Write(std::make_pair(DB_CSINDEX_SPENT, MakeSpentKey(ov, ok)), ov);
+    }
+
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: WriteBatch failed.", __func__);
+    }
+    return true;
+}
+
+bool ColdStakeIndex::UndoBlock(const CBlock& block) const
+{
+    // A block may be undone twice, by DisconnectBlock and again by
+    // CustomRewind, only entries still matching the block are changed.
+    CDBBatch batch(*m_db);
+    std::unordered_set<COutPoint, SaltedOutpointHasher> erased_outputs;
+    for (const auto& tx : block.vtx) {
+        const uint256& txid = tx->GetHash();
+        for (size_t n = 0; n < tx->vpout.size(); ++n) {
+            const auto& o = tx->vpout[n];
+            if (!o->IsType(OUTPUT_STANDARD) || !o->GetPScriptPubKey()->StartsWithICS()) {
+                continue;
+            }
+            ColdStakeIndexOutputKey ok(txid, n);
+            ColdStakeIndexOutputValue ov;
+            if (!m_db->Read(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov)) {
+                continue;
+            }
+            batch.Erase(std::make_pair(DB_CSINDEX_OUTPUT, ok));
+            batch.Erase(std::make_pair(DB_CSINDEX_UNSPENT, std::make_pair(ov.m_link, ok)));
+            if (ov.m_spend_height >= 0) {
+                batch.Erase(std::make_pair(DB_CSINDEX_SPENT, MakeSpentKey(ov, ok)));
+            }
+            erased_outputs.emplace(txid, n);
+        }
+    }
+    for (const auto& tx : block.vtx) {
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+        for (const auto& in : tx->vin) {
+            if (in.IsAnonInput() || erased_outputs.count(in.prevout)) {
+                continue;
+            }
+            ColdStakeIndexOutputKey ok(in.prevout.hash, in.prevout.n);
+            ColdStakeIndexOutputValue ov;
+            if (!m_db->Read(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov) ||
+                ov.m_spend_txid != tx->GetHash()) {
+                continue;
+            }
+            ColdStakeIndexUnspentValue uv;
+            uv.m_value = ov.m_value;
+            uv.m_flags = ov.m_flags;
+            batch.Erase(std::make_pair(DB_CSINDEX_SPENT, MakeSpentKey(ov, ok)));
+            batch.Write(std::make_pair(DB_CSINDEX_UNSPENT, std::make_pair(ov.m_link, ok)), uv);
+            ov.m_spend_height = -1;
+            ov.m_spend_txid.SetNull();
+            batch.Write(std::make_pair(DB_CSINDEX_OUTPUT, ok), ov);
+        }
+    }
+
+    if (!m_db->WriteBatch(batch)) {
+        return error("%s: WriteBatch failed.", __func__);
+    }
+    return true;
+}
+
+bool ColdStakeIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    if (!block.data) {
+        return error("%s: Block data missing.", __func__);
+    }
+    // Outputs are written first so spends within the block find them
+    std::vector<Spend> spends;
+    return WriteOutputs(*block.data, block.height, spends) &&
+           WriteSpends(spends);
+}
+
+bool ColdStakeIndex::DisconnectBlock(const CBlock& block)
+{
+    return UndoBlock(block);
+}
+
+bool ColdStakeIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    LOCK(cs_main);
+    const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+    const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+    const auto& consensus_params{Params().GetConsensus()};
+
+    do {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, iter_tip, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, iter_tip->GetBlockHash().ToString());
+        }
+        if (!UndoBlock(block)) {
+            return false;
+        }
+        iter_tip = iter_tip->GetAncestor(iter_tip->nHeight - 1);
+    } while (new_tip_index != iter_tip);
+
+    return true;
+}
+
+bool ColdStakeIndex::CustomBulkSync(const CBlockIndex*& pindex)
+{
+    if (m_sync_threads <= 1) {
+        return true;
+    }
+    const auto& consensus_params{Params().GetConsensus()};
+
+    // Blocks deeper than MAX_REORG_DEPTH can't be disconnected, the outputs of
+    // a batch are all written before its spends are applied so the blocks
+    // within a batch can be indexed in any order.
+    while (!m_interrupt) {
+        std::vector<const CBlockIndex*> blocks;
+        {
+            LOCK(cs_main);
+            const CChain& active_chain = m_chainstate->m_chain;
+            if (pindex && !active_chain.Contains(pindex)) {
+                return true; // Rewound by the sync loop
+            }
+            const int start_height = pindex ? pindex->nHeight + 1 : 0;
+            const int end_height = std::min(start_height + BULK_SYNC_BATCH_BLOCKS, active_chain.Height() - MAX_REORG_DEPTH);
+            for (int height = start_height; height < end_height; ++height) {
+                blocks.push_back(active_chain[height]);
+            }
+        }
+        if (blocks.empty()) {
+            return true;
+        }
+
+        std::vector<std::vector<Spend>> spends(blocks.size());
+        if (!util::ParallelFor(blocks.size(), m_sync_threads, [&](size_t i) {
+                try {
+                    CBlock block;
+                    if (!ReadBlockFromDisk(block, blocks[i], consensus_params)) {
+                        return error("%s: Failed to read block %s from disk",
+                                     __func__, blocks[i]->GetBlockHash().ToString());
+                    }
+                    return WriteOutputs(block, blocks[i]->nHeight, spends[i]);
+                } catch (const std::exception& e) {
+                    return error("%s: %s", __func__, e.what());
+                }
+            })) {
+            return false;
+        }
+        if (!util::ParallelFor(spends.size(), m_sync_threads, [&](size_t i) {
+                try {
+                    return WriteSpends(spends[i]);
+                } catch (const std::exception& e) {
+                    return error("%s: %s", __func__, e.what());
+                }
+            })) {
+            return false;
+        }
+
+        pindex = blocks.back();
+        SetBestBlockIndex(pindex);
+        // No need to handle errors in Commit, see BaseIndex::ThreadSync.
+        Commit();
+        LogPrint(BCLog::COINDB, "Syncing %s with block chain in bulk, at height %d\n", GetName(), pindex->nHeight);
+    }
+    return true;
+}
+
+bool ColdStakeIndex::FindUnspent(TxoutType stake_type, const CKeyID256& stake_id, int height, std::vector<Output>& outputs) const
+{
+    std::unique_ptr<CDBIterator> it(m_db->NewIterator());
+
+    ColdStakeIndexLinkKey seek_link;
+    seek_link.m_stake_type = stake_type;
+    seek_link.m_stake_id = stake_id;
+    std::pair<uint8_t, std::pair<ColdStakeIndexLinkKey, ColdStakeIndexOutputKey>> key;
+    for (it->Seek(std::make_pair(DB_CSINDEX_UNSPENT, seek_link)); it->Valid(); it->Next()) {
+        if (!it->GetKey(key) || key.first != DB_CSINDEX_UNSPENT) {
+            break;
+        }
+        const ColdStakeIndexLinkKey& lk = key.second.first;
+        if (lk.m_stake_type != stake_type || lk.m_stake_id != stake_id ||
+            (int)lk.m_height > height) {
+            break;
+        }
+        ColdStakeIndexUnspentValue uv;
+        if (!it->GetValue(uv)) {
+            return error("%s: Failed to read unspent output %s.", __func__, key.second.second.m_txnid.ToString());
+        }
+        outputs.push_back({lk, key.second.second, uv.m_value, uv.m_flags});
+    }
+
+    // Outputs spent after height, only present if height is below the best block
+    ColdStakeIndexSpentKey seek_spent;
+    seek_spent.m_stake_type = stake_type;
+    seek_spent.m_stake_id = stake_id;
+    seek_spent.m_spend_height = height + 1;
+    seek_spent.m_output = ColdStakeIndexOutputKey(uint256(), 0);
+    std::pair<uint8_t, ColdStakeIndexSpentKey> spent_key;
+    for (it->Seek(std::make_pair(DB_CSINDEX_SPENT, seek_spent)); it->Valid(); it->Next()) {
+        if (!it->GetKey(spent_key) || spent_key.first != DB_CSINDEX_SPENT) {
+            break;
+        }
+        const ColdStakeIndexSpentKey& sk = spent_key.second;
+        if (sk.m_stake_type != stake_type || sk.m_stake_id != stake_id) {
+            break;
+        }
+        ColdStakeIndexOutputValue ov;
+        if (!it->GetValue(ov)) {
+            return error("%s: Failed to read spent output %s.", __func__, sk.m_output.m_txnid.ToString());
+        }
+        if ((int)ov.m_link.m_height > height) {
+            continue;
+        }
+        outputs.push_back({ov.m_link, sk.m_output, ov.m_value, ov.m_flags});
+    }
+
+    std::sort(outputs.begin(), outputs.end(), [](const Output& a, const Output& b) {
+        return std::make_tuple(a.link.m_height, globe::FromTxoutType(a.link.m_spend_type), a.link.m_spend_id, a.outpoint.m_txnid, (uint32_t)a.outpoint.m_n) <
+               std::make_tuple(b.link.m_height, globe::FromTxoutType(b.link.m_spend_type), b.link.m_spend_id, b.outpoint.m_txnid, (uint32_t)b.outpoint.m_n);
+    });
+    return true;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_INDEX_COLDSTAKEINDEX_H
+#define GLOBE_INDEX_COLDSTAKEINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <insight/csindex.h>
+#include <primitives/transaction.h>
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+/** Maximum number of threads indexing blocks during the initial bulk sync. */
+static constexpr int MAX_CSINDEX_SYNC_THREADS{8};
+
+/**
+ * ColdStakeIndex records the coldstaked outputs of every stake address.
+ *
+ * Each output is stored by outpoint with its stake and spend addresses. The
+ * outputs of a stake address are also kept in an unspent set ordered by
+ * height, and moved to a spent set ordered by spend height when spent, so the
+ * outputs unspent at any height are found without reading every output the
+ * address ever had.
+ *
+ * The initial sync indexes ranges of blocks deeper than MAX_REORG_DEPTH on
+ * several threads.
+ */
+class ColdStakeIndex final : public BaseIndex
+{
+public:
+    struct Output {
+        ColdStakeIndexLinkKey link;
+        ColdStakeIndexOutputKey outpoint;
+        CAmount value{0};
+        uint8_t flags{0};
+    };
+
+private:
+    struct Spend {
+        COutPoint prevout;
+        uint256 txid;
+        int height;
+    };
+
+    std::unique_ptr<BaseIndex::DB> m_db;
+    const int m_sync_threads;
+    std::set<std::vector<uint8_t>> m_whitelist;
+
+    bool AllowPrune() const override { return false; }
+
+    /// Write the coldstaked outputs created in block and collect its spends.
+    bool WriteOutputs(const CBlock& block, int height, std::vector<Spend>& spends) const;
+
+    /// Move the outputs spent to the spent set, spends of outputs not indexed are ignored.
+    bool WriteSpends(const std::vector<Spend>& spends) const;
+
+    /// Remove the outputs created in block and restore the outputs it spent.
+    bool UndoBlock(const CBlock& block) const;
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    bool DisconnectBlock(const CBlock& block) override;
+
+    bool CustomBulkSync(const CBlockIndex*& pindex) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit ColdStakeIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, int sync_threads, bool f_memory = false, bool f_wipe = false);
+
+    /// Only index outputs staking to addr, can be called more than once. Must
+    /// be called before Start().
+    bool AppendWhitelistAddress(const std::string& addr);
+
+    /// Get the outputs staking to stake_id created at or below height and
+    /// unspent at height, ordered by height, spend address and outpoint.
+    bool FindUnspent(TxoutType stake_type, const CKeyID256& stake_id, int height, std::vector<Output>& outputs) const;
+};
+
+/// The global coldstake index, used by listcoldstakeunspent. May be null.
+extern std::unique_ptr<ColdStakeIndex> g_coldstake_index;
+
+#endif // GLOBE_INDEX_COLDSTAKEINDEX_H
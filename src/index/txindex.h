@@ -25,11 +25,7 @@ private:
     bool AllowPrune() const override { return false; }
 
 protected:
-    bool CustomInit(const std::optional<interfaces::BlockKey>& block) override;
     bool CustomAppend(const interfaces::BlockInfo& block) override;
-    bool DisconnectBlock(const CBlock& block) override;
-
-    bool IndexCSOutputs(const interfaces::BlockInfo& block);
 
 public:
     BaseIndex::DB& GetDB() const override;
@@ -48,11 +44,6 @@ public:
     /// @return  true if transaction is found, false otherwise
     bool FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
     bool FindTx(const uint256& tx_hash, CBlockHeader& header, CTransactionRef& tx) const;
-
-    bool AppendCSAddress(std::string addr);
-
-    bool m_cs_index = false;
-    std::set<std::vector<uint8_t> > m_cs_index_whitelist;
 };
 
 /// The global transaction index, used in GetTransaction. May be null.
@@ -0,0 +1,123 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/voteindex.h>
+
+#include <compat/endian.h>
+#include <dbwrapper.h>
+#include <primitives/block.h>
+#include <util/system.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
+
+namespace {
+
+struct DBHeightKey {
+    int height;
+
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_BLOCK_HEIGHT);
+        ser_writedata32be(s, height);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_BLOCK_HEIGHT) {
+            throw std::ios_base::failure("Invalid format for voteindex DB height key");
+        }
+        height = ser_readdata32be(s);
+    }
+};
+
+}; // namespace
+
+std::unique_ptr<VoteIndex> g_vote_index;
+
+bool GetCoinStakeVoteToken(const CTransaction& tx, uint32_t& vote_token)
+{
+    if (!tx.IsCoinStake() || tx.vpout.empty() || !tx.vpout[0]->IsType(OUTPUT_DATA)) {
+        return false;
+    }
+    // Matches the vote logged by ContextualCheckBlock, the vote must follow the height
+    const std::vector<uint8_t>& vData = ((CTxOutData*)tx.vpout[0].get())->vData;
+    if (vData.size() < 9 || vData[4] != DO_VOTE) {
+        return false;
+    }
+    memcpy(&vote_token, &vData[5], 4);
+    vote_token = le32toh(vote_token);
+    return true;
+}
+
+VoteIndex::VoteIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "voteindex")
+{
+    fs::path path{gArgs.GetDataDirNet() / "indexes" / "votes"};
+    fs::create_directories(path);
+
+    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+bool VoteIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    assert(block.data);
+    Entry entry;
+    entry.block_hash = block.hash;
+    if (!block.data->vtx.empty() && block.data->vtx[0]->IsCoinStake()) {
+        entry.coinstake = true;
+        GetCoinStakeVoteToken(*block.data->vtx[0], entry.vote_token);
+    }
+    return m_db->Write(DBHeightKey(block.height), entry);
+}
+
+bool VoteIndex::ForEachVote(int height_start, int height_end, const std::function<bool(int height, const Entry& entry)>& fn) const
+{
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    DBHeightKey key{height_start};
+    db_it->Seek(key);
+
+    for (int height = height_start; height <= height_end; ++height) {
+        if (!db_it->GetKey(key) || key.height != height) {
+            return error("%s: unexpected key in %s: expected (%c, %d)",
+                         __func__, GetName(), DB_BLOCK_HEIGHT, height);
+        }
+        Entry entry;
+        if (!db_it->GetValue(entry)) {
+            return error("%s: unable to read value in %s at key (%c, %d)",
+                         __func__, GetName(), DB_BLOCK_HEIGHT, height);
+        }
+        if (!fn(height, entry)) {
+            return false;
+        }
+        db_it->Next();
+    }
+    return true;
+}
+
+bool ForEachActiveChainVote(ChainstateManager& chainman, int height_start, int height_end, const std::function<void(int height, const VoteIndex::Entry& entry)>& fn)
+{
+    if (!g_vote_index || !g_vote_index->BlockUntilSyncedToCurrentChain()) {
+        return false;
+    }
+    LOCK(cs_main);
+    const CChain& active_chain = chainman.ActiveChain();
+    height_start = std::max(height_start, 0);
+    height_end = std::min(height_end, active_chain.Height());
+    return g_vote_index->ForEachVote(height_start, height_end, [&](int height, const VoteIndex::Entry& entry) {
+        if (entry.block_hash != active_chain[height]->GetBlockHash()) {
+            return false;
+        }
+        fn(height, entry);
+        return true;
+    });
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_INDEX_VOTEINDEX_H
+#define GLOBE_INDEX_VOTEINDEX_H
+
+#include <index/base.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <functional>
+
+class ChainstateManager;
+
+/**
+ * VoteIndex records the vote token cast by the coinstake of every block, keyed
+ * by height, so votes over a height range can be tallied without reading the
+ * blocks from disk.
+ *
+ * Entries are overwritten when a block at the same height is connected, after a
+ * reorg entries may refer to blocks no longer in the active chain and callers
+ * must compare the block hash.
+ */
+class VoteIndex final : public BaseIndex
+{
+public:
+    struct Entry {
+        uint256 block_hash;
+        bool coinstake{false};
+        uint32_t vote_token{0}; // 0 if the coinstake casts no vote
+
+        SERIALIZE_METHODS(Entry, obj) { READWRITE(obj.block_hash, obj.coinstake, obj.vote_token); }
+    };
+
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit VoteIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Call fn for the entries from height_start to height_end inclusive, in
+    /// height order. Returns false if an entry is missing or fn returns false.
+    bool ForEachVote(int height_start, int height_end, const std::function<bool(int height, const Entry& entry)>& fn) const;
+};
+
+/// Extract the vote token from the data output of a coinstake, returns false if no vote is cast.
+bool GetCoinStakeVoteToken(const CTransaction& tx, uint32_t& vote_token);
+
+/// The global vote index, used by tallyvotes. May be null.
+extern std::unique_ptr<VoteIndex> g_vote_index;
+
+/// Call fn for the g_vote_index entries of the active chain blocks from height_start to height_end.
+/// Returns false if the vote index is not available, still syncing or out of step with the active chain,
+/// fn may have been called for some entries already.
+bool ForEachActiveChainVote(ChainstateManager& chainman, int height_start, int height_end, const std::function<void(int height, const VoteIndex::Entry& entry)>& fn);
+
+#endif // GLOBE_INDEX_VOTEINDEX_H
@@ -26,7 +26,9 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/coldstakeindex.h>
 #include <index/txindex.h>
+#include <index/voteindex.h>
 #include <init/common.h>
 #include <interfaces/chain.h>
 #include <interfaces/init.h>
@@ -43,6 +45,7 @@
 #include <node/caches.h>
 #include <node/chainstate.h>
 #include <node/context.h>
+#include <node/inputprefetcher.h>
 #include <node/interface_ui.h>
 #include <node/mempool_args.h>
 #include <node/mempool_persist_args.h>
@@ -87,6 +90,7 @@
 #include <smsg/manager.h>
 #include <smsg/rpcsmessage.h>
 #include <insight/rpc.h>
+#include <globe/globeledger.h>
 #include <pos/miner.h>
 #include <pos/kernel.h>
 #include <core_io.h>
@@ -141,6 +145,7 @@ using kernel::ValidationCacheSizes;
 using node::ApplyArgsManOptions;
 using node::CacheSizes;
 using node::CalculateCacheSizes;
+using node::DEFAULT_BLOCKINDEXSNAPSHOT;
 using node::DEFAULT_PERSIST_MEMPOOL;
 using node::DEFAULT_PRINTPRIORITY;
 using node::DEFAULT_STOPAFTERBLOCKIMPORT;
@@ -308,6 +313,12 @@ void Interrupt(NodeContext& node)
     if (g_coin_stats_index) {
         g_coin_stats_index->Interrupt();
     }
+    if (g_vote_index) {
+        g_vote_index->Interrupt();
+    }
+    if (g_coldstake_index) {
+        g_coldstake_index->Interrupt();
+    }
 }
 
 void Shutdown(NodeContext& node)
@@ -364,6 +375,10 @@ void Shutdown(NodeContext& node)
         DumpMempool(*node.mempool, MempoolPath(*node.args));
     }
 
+    if (fGlobeMode && node.chainman) {
+        globe::DumpDelayedBlocks(globe::DelayedBlocksPath(*node.args));
+    }
+
     // Drop transactions we were still watching, and record fee estimations.
     if (node.fee_estimator) node.fee_estimator->Flush();
 
@@ -390,6 +405,14 @@ void Shutdown(NodeContext& node)
         g_coin_stats_index->Stop();
         g_coin_stats_index.reset();
     }
+    if (g_vote_index) {
+        g_vote_index->Stop();
+        g_vote_index.reset();
+    }
+    if (g_coldstake_index) {
+        g_coldstake_index->Stop();
+        g_coldstake_index.reset();
+    }
     ForEachBlockFilterIndex([](BlockFilterIndex& index) { index.Stop(); });
     DestroyAllBlockFilterIndexes();
 
@@ -407,6 +430,7 @@ void Shutdown(NodeContext& node)
                 chainstate->ResetCoinsViews();
             }
         }
+        node.chainman->m_blockman.WriteBlockIndexSnapshot();
         pstorageresult.reset();
         globalState.reset();
         globalSealEngine.reset();
@@ -527,6 +551,7 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-alertnotify=<cmd>", "Execute command when an alert is raised (%s in cmd is replaced by message)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     argsman.AddArg("-assumevalid=<hex>", strprintf("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s, signet: %s)", defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex(), signetChainParams->GetConsensus().defaultAssumeValid.GetHex()), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockindexsnapshot", strprintf("Write the block index to a snapshot file at shutdown and load it at startup, only entries written since are read from the block index database (default: %u)", DEFAULT_BLOCKINDEXSNAPSHOT), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksdir=<dir>", "Specify directory to hold blocks subdirectory for *.dat files (default: <datadir>)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-fastprune", "Use smaller block files and lower minimum prune height for testing purposes", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
 #if HAVE_SYSTEM
@@ -547,6 +572,9 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-minimumchainwork=<hex>", strprintf("Minimum work assumed to exist on a valid chain in hex (default: %s, testnet: %s, signet: %s)", defaultChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnetChainParams->GetConsensus().nMinimumChainWork.GetHex(), signetChainParams->GetConsensus().nMinimumChainWork.GetHex()), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     argsman.AddArg("-par=<n>", strprintf("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-loadblockthreads=<n>", strprintf("Set the number of threads checking blocks ahead of validation while reindexing or importing with -loadblock (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)", -GetNumCores(), MAX_LOADBLOCK_THREADS, DEFAULT_LOADBLOCK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-prefetchthreads=<n>", strprintf("Number of threads used to read the inputs of the next block from the UTXO database while a block is being connected, 0 to disable (default: %d)", node::DEFAULT_INPUT_PREFETCH_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-stakeprecheckthreads=<n>", strprintf("Number of threads checking the coinstake signatures and kernel hashes of the blocks to connect next during initial block download, 0 to disable (default: %d)", DEFAULT_STAKE_PRECHECK_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool", strprintf("Whether to save the mempool on shutdown and load on restart (default: %u)", DEFAULT_PERSIST_MEMPOOL), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-pid=<file>", strprintf("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)", GLOBE_PID_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by enabling pruning (deleting) of old blocks. This allows the pruneblockchain RPC to be called to delete specific blocks and enables automatic pruning of old blocks if a target size in MiB is provided. This mode is incompatible with -txindex. "
@@ -577,6 +605,7 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-balancesindex", strprintf("Maintain a balances index per block (default: %u)", globe::DEFAULT_BALANCESINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-csindex", strprintf("Maintain an index of outputs by coldstaking address (default: %u)", globe::DEFAULT_CSINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-cswhitelist", strprintf("Only index coldstaked outputs with matching stake address. Can be specified multiple times."), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-voteindex", strprintf("Maintain an index of the votes cast by coinstakes, used by the tallyvotes and getproposalvotes RPCs (default: %u)", globe::DEFAULT_VOTEINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
     argsman.AddArg("-dbmaxopenfiles", strprintf("Maximum number of open files parameter passed to level-db (default: %u)", globe::DEFAULT_DB_MAX_OPEN_FILES), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dbcompression", strprintf("Database compression parameter passed to level-db (default: %s)", globe::DEFAULT_DB_COMPRESSION ? "true" : "false"), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -621,6 +650,7 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-listenonion", strprintf("Automatically create Tor onion service (default: %d)", DEFAULT_LISTEN_ONION), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxconnections=<n>", strprintf("Maintain at most <n> connections to peers (default: %u). This limit does not apply to connections manually added via -addnode or the addnode RPC, which have a separate limit of %u.", DEFAULT_MAX_PEER_CONNECTIONS, MAX_ADDNODE_CONNECTIONS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxreceivebuffer=<n>", strprintf("Maximum per-connection receive buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXRECEIVEBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
+    argsman.AddArg("-msgprocthreads=<n>", strprintf("Number of threads processing secure messaging traffic in parallel to the message handler thread, messages of one peer are always processed in order (0 to %d, default: %d)", MAX_MSGPROC_THREADS, DEFAULT_MSGPROC_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxsendbuffer=<n>", strprintf("Maximum per-connection send buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXSENDBUFFER), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxtimeadjustment", strprintf("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by outbound peers forward or backward by this amount (default: %u seconds).", DEFAULT_MAX_TIME_ADJUSTMENT), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-maxuploadtarget=<n>", strprintf("Tries to keep outbound traffic under the given target per 24h. Limit does not apply to peers with 'download' permission or blocks created within past week. 0 = no limit (default: %s). Optional suffix units [k|K|m|M|g|G|t|T] (default: M). Lowercase is 1000 base while uppercase is 1024 base", DEFAULT_MAX_UPLOAD_TARGET), ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -644,6 +674,8 @@ void SetupServerArgs(ArgsManager& argsman)
     argsman.AddArg("-dgpstorage", "Receiving data from DGP via storage (default: -dgpevm)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-dgpevm", "Receiving data from DGP via a contract call (default: -dgpevm)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
     argsman.AddArg("-hwitoolpath=<path>", "Specify HWI tool path", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-hwisessionpath=<path>", "Specify HWI session helper path, runs all HWI requests in one long-lived process (see contrib/hwi)", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-hwisessiontimeout=<n>", strprintf("Seconds to wait for each response of the HWI session helper before stopping it (default: %d)", DEFAULT_HWI_SESSION_TIMEOUT), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #ifdef USE_UPNP
 #if USE_UPNP
     argsman.AddArg("-upnp", "Use UPnP to map the listening port (default: 1 when listening and no -proxy)", ArgsManager::ALLOW_ANY, OptionsCategory::CONNECTION);
@@ -690,6 +722,8 @@ void SetupServerArgs(ArgsManager& argsman)
     // Globe
     argsman.AddArg("-zmqpubhashwtx=<address>", "Enable publish hash transaction received by wallets in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsmsg=<address>", "Enable publish secure message in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawanonout=<address>", "Enable publish anon outputs of connected and disconnected blocks in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubkeyimage=<address>", "Enable publish key images spent in connected and disconnected blocks in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-serverkeyzmq=<secret_key>", "Base64 encoded string of the z85 encoded secret key for CurveZMQ.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-newserverkeypairzmq", "Generate new key pair for CurveZMQ, print and exit.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-whitelistzmq=<IP address or network>", "Whitelist peers connecting from the given IP address (e.g. 1.2.3.4) or CIDR notated network (e.g. 1.2.3.0/24). Can be specified multiple times.", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
@@ -708,6 +742,8 @@ void SetupServerArgs(ArgsManager& argsman)
     // Globe
     hidden_args.emplace_back("-zmqpubhashwtx=<address>");
     hidden_args.emplace_back("-zmqpubsmsg=<address>");
+    hidden_args.emplace_back("-zmqpubrawanonout=<address>");
+    hidden_args.emplace_back("-zmqpubkeyimage=<address>");
     hidden_args.emplace_back("-serverkeyzmq=<secret_key>");
     hidden_args.emplace_back("-newserverkeypairzmq");
     hidden_args.emplace_back("-whitelistzmq=<IP address or network>");
@@ -1553,6 +1589,19 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         StartScriptCheckWorkerThreads(script_threads);
     }
 
+    g_input_prefetch_threads = std::clamp<int>(args.GetIntArg("-prefetchthreads", node::DEFAULT_INPUT_PREFETCH_THREADS), 0, MAX_SCRIPTCHECK_THREADS);
+    LogPrintf("Input prefetching uses %d threads\n", g_input_prefetch_threads);
+    g_stake_precheck_threads = std::clamp<int>(args.GetIntArg("-stakeprecheckthreads", DEFAULT_STAKE_PRECHECK_THREADS), 0, MAX_SCRIPTCHECK_THREADS);
+    LogPrintf("Stake prechecking uses %d threads\n", g_stake_precheck_threads);
+
+    int loadblock_threads = args.GetIntArg("-loadblockthreads", DEFAULT_LOADBLOCK_THREADS);
+    if (loadblock_threads <= 0) {
+        // -loadblockthreads=0 means autodetect, -loadblockthreads=-n leaves n cores free
+        loadblock_threads += GetNumCores();
+    }
+    g_loadblock_threads = std::clamp(loadblock_threads, 0, MAX_LOADBLOCK_THREADS);
+    LogPrintf("Block loading uses %d check threads\n", g_loadblock_threads);
+
     assert(!node.scheduler);
     node.scheduler = std::make_unique<CScheduler>();
 
@@ -1873,6 +1922,7 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         csl_args.spent_index = args.GetBoolArg("-spentindex", globe::DEFAULT_SPENTINDEX);
         csl_args.timestamp_index = args.GetBoolArg("-timestampindex", globe::DEFAULT_TIMESTAMPINDEX);
         csl_args.balances_index = args.GetBoolArg("-balancesindex", globe::DEFAULT_BALANCESINDEX);
+        csl_args.block_index_snapshot = args.GetBoolArg("-blockindexsnapshot", DEFAULT_BLOCKINDEXSNAPSHOT);
         options.args = csl_args;
 
         options.coins_error_cb = [] {
@@ -1963,13 +2013,6 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         }
 
         g_txindex = std::make_unique<TxIndex>(interfaces::MakeChain(node), cache_sizes.tx_index, false, fReindex);
-
-        if (gArgs.GetBoolArg("-csindex", globe::DEFAULT_CSINDEX)) {
-            g_txindex->m_cs_index = true;
-            for (const auto &addr : gArgs.GetArgs("-cswhitelist")) {
-                g_txindex->AppendCSAddress(addr);
-            }
-        }
         if (!g_txindex->Start()) {
             return false;
         }
@@ -1989,6 +2032,24 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         }
     }
 
+    if (args.GetBoolArg("-voteindex", globe::DEFAULT_VOTEINDEX)) {
+        g_vote_index = std::make_unique<VoteIndex>(interfaces::MakeChain(node), /* cache size */ 0, false, fReindex);
+        if (!g_vote_index->Start()) {
+            return false;
+        }
+    }
+
+    if (args.GetBoolArg("-csindex", globe::DEFAULT_CSINDEX)) {
+        g_coldstake_index = std::make_unique<ColdStakeIndex>(interfaces::MakeChain(node), /* cache size */ 0,
+            std::min(GetNumCores(), MAX_CSINDEX_SYNC_THREADS), false, fReindex);
+        for (const auto &addr : args.GetArgs("-cswhitelist")) {
+            g_coldstake_index->AppendWhitelistAddress(addr);
+        }
+        if (!g_coldstake_index->Start()) {
+            return false;
+        }
+    }
+
     // ********************************************************* Step 9: load wallet
     for (const auto& client : node.chain_clients) {
         if (!client->load()) {
@@ -2128,6 +2189,7 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     connOptions.m_msgproc = node.peerman.get();
     connOptions.nSendBufferMaxSize = 1000 * args.GetIntArg("-maxsendbuffer", DEFAULT_MAXSENDBUFFER);
     connOptions.nReceiveFloodSize = 1000 * args.GetIntArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
+    connOptions.m_msgproc_threads = std::clamp<int>(args.GetIntArg("-msgprocthreads", DEFAULT_MSGPROC_THREADS), 0, MAX_MSGPROC_THREADS);
     connOptions.m_added_nodes = args.GetArgs("-addnode");
     connOptions.nMaxOutboundLimit = *opt_max_upload;
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
@@ -7,9 +7,9 @@
 
 #include <script/standard.h>
 
-constexpr uint8_t DB_TXINDEX_CSOUTPUT{'O'};
-constexpr uint8_t DB_TXINDEX_CSLINK{'L'};
-constexpr uint8_t DB_TXINDEX_CSBESTBLOCK{'C'};
+constexpr uint8_t DB_CSINDEX_OUTPUT{'O'};
+constexpr uint8_t DB_CSINDEX_UNSPENT{'U'};
+constexpr uint8_t DB_CSINDEX_SPENT{'S'};
 
 enum CSIndexFlags
 {
@@ -42,23 +42,6 @@ public:
     }
 };
 
-class ColdStakeIndexOutputValue
-{
-public:
-    CAmount m_value = 0;
-    uint8_t m_flags = 0; // Mark outputs resulting from coldstaking
-    int m_spend_height = -1;
-    uint256 m_spend_txid;
-
-    SERIALIZE_METHODS(ColdStakeIndexOutputValue, obj)
-    {
-        READWRITE(obj.m_value);
-        READWRITE(obj.m_flags);
-        READWRITE(obj.m_spend_height);
-        READWRITE(obj.m_spend_txid);
-    }
-};
-
 class ColdStakeIndexLinkKey
 {
 public:
@@ -98,4 +81,64 @@ public:
     }
 };
 
+class ColdStakeIndexOutputValue
+{
+public:
+    CAmount m_value = 0;
+    uint8_t m_flags = 0; // Mark outputs resulting from coldstaking
+    int m_spend_height = -1;
+    uint256 m_spend_txid;
+    ColdStakeIndexLinkKey m_link; // Stake and spend ids and the height the output was created at
+
+    SERIALIZE_METHODS(ColdStakeIndexOutputValue, obj)
+    {
+        READWRITE(obj.m_value);
+        READWRITE(obj.m_flags);
+        READWRITE(obj.m_spend_height);
+        READWRITE(obj.m_spend_txid);
+        READWRITE(obj.m_link);
+    }
+};
+
+/** Unspent outputs by stake id, keyed by the link key and the output */
+class ColdStakeIndexUnspentValue
+{
+public:
+    CAmount m_value = 0;
+    uint8_t m_flags = 0;
+
+    SERIALIZE_METHODS(ColdStakeIndexUnspentValue, obj)
+    {
+        READWRITE(obj.m_value);
+        READWRITE(obj.m_flags);
+    }
+};
+
+/** Spent outputs by stake id and spend height, to list the outputs unspent at a past height */
+class ColdStakeIndexSpentKey
+{
+public:
+    TxoutType m_stake_type = TxoutType::NONSTANDARD;
+    CKeyID256 m_stake_id;
+    unsigned int m_spend_height = 0;
+    ColdStakeIndexOutputKey m_output;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, globe::FromTxoutType(m_stake_type));
+        s.write(AsBytes(Span{(char*)m_stake_id.begin(), size_t((m_stake_type == TxoutType::PUBKEYHASH256) ? 32 : 20)}));
+        ser_writedata32be(s, m_spend_height);
+        m_output.Serialize(s);
+    }
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        uint8_t stake_type = ser_readdata8(s);
+        m_stake_type = globe::ToTxoutType(stake_type);
+        m_stake_id.SetNull();
+        s.read(AsWritableBytes(Span{m_stake_id.begin(), size_t((m_stake_type == TxoutType::PUBKEYHASH256) ? 32 : 20)}));
+        m_spend_height = ser_readdata32be(s);
+        m_output.Unserialize(s);
+    }
+};
+
 #endif // GLOBE_INSIGHT_CSINDEX_H
@@ -160,6 +160,34 @@ bool GetAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash,
     return true;
 };
 
+bool ForEachAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, int type, int start, int end,
+                         const std::function<bool(const CAddressIndexKey&, CAmount)> &fn)
+{
+    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
+    if (!fAddressIndex) {
+        return error("Address index not enabled");
+    }
+    if (!pblocktree->ForEachAddressIndex(addressHash, type, start, end, fn)) {
+        return error("Unable to get txids for address");
+    }
+
+    return true;
+};
+
+bool ForEachAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash, int type,
+                           const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)> &fn)
+{
+    auto& pblocktree{chainman.m_blockman.m_block_tree_db};
+    if (!fAddressIndex) {
+        return error("Address index not enabled");
+    }
+    if (!pblocktree->ForEachAddressUnspentIndex(addressHash, type, fn)) {
+        return error("Unable to get txids for address");
+    }
+
+    return true;
+};
+
 bool GetBlockBalances(ChainstateManager &chainman, const uint256 &block_hash, BlockBalances &balances)
 {
     auto& pblocktree{chainman.m_blockman.m_block_tree_db};
@@ -173,6 +201,54 @@ bool GetBlockBalances(ChainstateManager &chainman, const uint256 &block_hash, Bl
     return true;
 };
 
+bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type)
+{
+    if (dest.index() == DI::_PKHash) {
+        const PKHash &id = std::get<PKHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_PUBKEY_ADDRESS;
+        return true;
+    }
+    if (dest.index() == DI::_ScriptHash) {
+        const ScriptHash& id = std::get<ScriptHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_SCRIPT_ADDRESS;
+        return true;
+    }
+    if (dest.index() == DI::_CKeyID256) {
+        const CKeyID256& id = std::get<CKeyID256>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_PUBKEY_ADDRESS_256;
+        return true;
+    }
+    if (dest.index() == DI::_CScriptID256) {
+        const CScriptID256& id = std::get<CScriptID256>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_SCRIPT_ADDRESS_256;
+        return true;
+    }
+    if (dest.index() == DI::_WitnessV0KeyHash) {
+        const WitnessV0KeyHash& id = std::get<WitnessV0KeyHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 20);
+        type = ADDR_INDT_WITNESS_V0_KEYHASH;
+        return true;
+    }
+    if (dest.index() == DI::_WitnessV0ScriptHash) {
+        const WitnessV0ScriptHash& id = std::get<WitnessV0ScriptHash>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_WITNESS_V0_SCRIPTHASH;
+        return true;
+    }
+    if (dest.index() == DI::_WitnessV1Taproot) {
+        const WitnessV1Taproot& id = std::get<WitnessV1Taproot>(dest);
+        memcpy(hashBytes.begin(), id.begin(), 32);
+        type = ADDR_INDT_WITNESS_V1_TAPROOT;
+        return true;
+    }
+    type = ADDR_INDT_UNKNOWN;
+    return false;
+}
+
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address)
 {
     if (type == ADDR_INDT_SCRIPT_ADDRESS) {
@@ -10,8 +10,10 @@
 #include <threadsafety.h>
 
 #include <consensus/amount.h>
+#include <script/standard.h>
 #include <sync.h>
 #include <stdint.h>
+#include <functional>
 #include <vector>
 #include <string>
 #include <utility>
@@ -46,8 +48,14 @@ bool GetAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, in
                      int start = 0, int end = 0);
 bool GetAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash, int type,
                        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
+/** Stream index records to fn without collecting them, iteration stops when fn returns false */
+bool ForEachAddressIndex(ChainstateManager &chainman, const uint256 &addressHash, int type, int start, int end,
+                         const std::function<bool(const CAddressIndexKey&, CAmount)> &fn);
+bool ForEachAddressUnspent(ChainstateManager &chainman, const uint256 &addressHash, int type,
+                           const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)> &fn);
 bool GetBlockBalances(ChainstateManager &chainman, const uint256 &block_hash, BlockBalances &balances);
 
+bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type);
 bool getAddressFromIndex(const int &type, const uint256 &hash, std::string &address);
 
 #endif // GLOBE_INSIGHT_INSIGHT_H
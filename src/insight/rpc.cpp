@@ -2,6 +2,8 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <insight/rpc.h>
+
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <rpc/server_util.h>
@@ -10,6 +12,7 @@
 #include <util/strencodings.h>
 #include <insight/insight.h>
 #include <insight/csindex.h>
+#include <index/coldstakeindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <validation.h>
@@ -25,53 +28,6 @@
 // Avoid initialization-order-fiasco
 #define _UNIX_EPOCH_TIME "UNIX epoch time"
 
-static bool GetIndexKey(const CTxDestination &dest, uint256 &hashBytes, int &type) {
-    if (dest.index() == DI::_PKHash) {
-        const PKHash &id = std::get<PKHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_PUBKEY_ADDRESS;
-        return true;
-    }
-    if (dest.index() == DI::_ScriptHash) {
-        const ScriptHash& id = std::get<ScriptHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_SCRIPT_ADDRESS;
-        return true;
-    }
-    if (dest.index() == DI::_CKeyID256) {
-        const CKeyID256& id = std::get<CKeyID256>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_PUBKEY_ADDRESS_256;
-        return true;
-    }
-    if (dest.index() == DI::_CScriptID256) {
-        const CScriptID256& id = std::get<CScriptID256>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_SCRIPT_ADDRESS_256;
-        return true;
-    }
-    if (dest.index() == DI::_WitnessV0KeyHash) {
-        const WitnessV0KeyHash& id = std::get<WitnessV0KeyHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 20);
-        type = ADDR_INDT_WITNESS_V0_KEYHASH;
-        return true;
-    }
-    if (dest.index() == DI::_WitnessV0ScriptHash) {
-        const WitnessV0ScriptHash& id = std::get<WitnessV0ScriptHash>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_WITNESS_V0_SCRIPTHASH;
-        return true;
-    }
-    if (dest.index() == DI::_WitnessV1Taproot) {
-        const WitnessV1Taproot& id = std::get<WitnessV1Taproot>(dest);
-        memcpy(hashBytes.begin(), id.begin(), 32);
-        type = ADDR_INDT_WITNESS_V1_TAPROOT;
-        return true;
-    }
-    type = ADDR_INDT_UNKNOWN;
-    return false;
-}
-
 bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint256, int> > &addresses)
 {
     if (params[0].isStr()) {
@@ -675,7 +631,7 @@ static void AddAddress(CScript *script, UniValue &uv)
     }
 }
 
-static UniValue blockToDeltasJSON(ChainstateManager& chainman, const CBlock& block, const CBlockIndex* blockindex, const CTxMemPool *pmempool)
+UniValue blockToDeltasJSON(ChainstateManager& chainman, const CBlock& block, const CBlockIndex* blockindex, const CTxMemPool *pmempool)
 {
     CChain &active_chain = chainman.ActiveChain();
     UniValue result(UniValue::VOBJ);
@@ -1316,30 +1272,26 @@ static RPCHelpMan listcoldstakeunspent()
 {
     RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VNUM}, true);
 
-    if (!g_txindex) {
-        throw JSONRPCError(RPC_MISC_ERROR, "Requires -txindex enabled");
-    }
-    if (!g_txindex->m_cs_index) {
+    if (!g_coldstake_index) {
         throw JSONRPCError(RPC_MISC_ERROR, "Requires -csindex enabled");
     }
     ChainstateManager &chainman = EnsureAnyChainman(request.context);
 
-    ColdStakeIndexLinkKey seek_key;
+    TxoutType stake_type;
+    CKeyID256 stake_id;
     CTxDestination stake_dest = DecodeDestination(request.params[0].get_str(), true);
     if (stake_dest.index() == DI::_PKHash) {
-        seek_key.m_stake_type = TxoutType::PUBKEYHASH;
+        stake_type = TxoutType::PUBKEYHASH;
         PKHash id = std::get<PKHash>(stake_dest);
-        memcpy(seek_key.m_stake_id.begin(), id.begin(), 20);
+        memcpy(stake_id.begin(), id.begin(), 20);
     } else
     if (stake_dest.index() == DI::_CKeyID256) {
-        seek_key.m_stake_type = TxoutType::PUBKEYHASH256;
-        seek_key.m_stake_id = std::get<CKeyID256>(stake_dest);
+        stake_type = TxoutType::PUBKEYHASH256;
+        stake_id = std::get<CKeyID256>(stake_dest);
     } else {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unrecognised stake address type.");
     }
 
-    CDBWrapper &db = g_txindex->GetDB();
-
     LOCK(cs_main);
 
     int height = !request.params[1].isNull() ? request.params[1].getInt<int>() : -1;
@@ -1370,80 +1322,61 @@ static RPCHelpMan listcoldstakeunspent()
         }
     }
 
-    UniValue rv(UniValue::VARR);
-
-    std::unique_ptr<CDBIterator> it(db.NewIterator());
-    it->Seek(std::make_pair(DB_TXINDEX_CSLINK, seek_key));
+    std::vector<ColdStakeIndex::Output> outputs;
+    if (!g_coldstake_index->FindUnspent(stake_type, stake_id, height, outputs)) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read coldstake index.");
+    }
 
+    UniValue rv(UniValue::VARR);
     int min_kernel_depth = Params().GetStakeMinConfirmations();
-    std::pair<uint8_t, ColdStakeIndexLinkKey> key;
-    while (it->Valid() && it->StartsWith(DB_TXINDEX_CSLINK) && it->GetKey(key)) {
-        ColdStakeIndexLinkKey &lk = key.second;
-
-        if (key.first != DB_TXINDEX_CSLINK ||
-            lk.m_stake_id != seek_key.m_stake_id ||
-            (int)lk.m_height > height)
-            break;
+    for (const auto &out : outputs) {
+        const ColdStakeIndexLinkKey &lk = out.link;
+        if (mature_only &&
+            (!all_staked || !(out.flags & CSI_FROM_STAKE))) {
+            int depth = height - lk.m_height;
+            int depth_required = std::min(min_kernel_depth-1, (int)(height / 2));
+            if (depth < depth_required) {
+                continue;
+            }
+        }
 
-        std::vector <ColdStakeIndexOutputKey> oks;
-        ColdStakeIndexOutputValue ov;
         UniValue output(UniValue::VOBJ);
+        output.pushKV("height", (int)lk.m_height);
+        output.pushKV("value", out.value);
 
-        if (it->GetValue(oks)) {
-            for (const auto &ok : oks) {
-                if (db.Read(std::make_pair(DB_TXINDEX_CSOUTPUT, ok), ov) &&
-                    (ov.m_spend_height == -1 || ov.m_spend_height > height)) {
-
-                    if (mature_only &&
-                        (!all_staked || !(ov.m_flags & CSI_FROM_STAKE))) {
-                        int depth = height - lk.m_height;
-                        int depth_required = std::min(min_kernel_depth-1, (int)(height / 2));
-                        if (depth < depth_required) {
-                            continue;
-                        }
-                    }
-
-                    UniValue output(UniValue::VOBJ);
-                    output.pushKV("height", (int)lk.m_height);
-                    output.pushKV("value", ov.m_value);
-
-                    if (show_outpoints) {
-                        output.pushKV("txid", ok.m_txnid.ToString());
-                        output.pushKV("n", ok.m_n);
-                    }
-
-                    switch (lk.m_spend_type) {
-                        case TxoutType::PUBKEYHASH: {
-                            PKHash idk;
-                            memcpy(idk.begin(), lk.m_spend_id.begin(), 20);
-                            output.pushKV("addrspend", EncodeDestination(idk));
-                            }
-                            break;
-                        case TxoutType::PUBKEYHASH256:
-                            output.pushKV("addrspend", EncodeDestination(lk.m_spend_id));
-                            break;
-                        case TxoutType::SCRIPTHASH: {
-                            ScriptHash ids;
-                            memcpy(ids.begin(), lk.m_spend_id.begin(), 20);
-                            output.pushKV("addrspend", EncodeDestination(ids));
-                            }
-                            break;
-                        case TxoutType::SCRIPTHASH256: {
-                            CScriptID256 ids;
-                            memcpy(ids.begin(), lk.m_spend_id.begin(), 32);
-                            output.pushKV("addrspend", EncodeDestination(ids));
-                            }
-                            break;
-                        default:
-                            output.pushKV("addrspend", "unknown_type");
-                            break;
-                    }
+        if (show_outpoints) {
+            output.pushKV("txid", out.outpoint.m_txnid.ToString());
+            output.pushKV("n", out.outpoint.m_n);
+        }
 
-                    rv.push_back(output);
+        switch (lk.m_spend_type) {
+            case TxoutType::PUBKEYHASH: {
+                PKHash idk;
+                memcpy(idk.begin(), lk.m_spend_id.begin(), 20);
+                output.pushKV("addrspend", EncodeDestination(idk));
                 }
-            }
+                break;
+            case TxoutType::PUBKEYHASH256:
+                output.pushKV("addrspend", EncodeDestination(lk.m_spend_id));
+                break;
+            case TxoutType::SCRIPTHASH: {
+                ScriptHash ids;
+                memcpy(ids.begin(), lk.m_spend_id.begin(), 20);
+                output.pushKV("addrspend", EncodeDestination(ids));
+                }
+                break;
+            case TxoutType::SCRIPTHASH256: {
+                CScriptID256 ids;
+                memcpy(ids.begin(), lk.m_spend_id.begin(), 32);
+                output.pushKV("addrspend", EncodeDestination(ids));
+                }
+                break;
+            default:
+                output.pushKV("addrspend", "unknown_type");
+                break;
         }
-        it->Next();
+
+        rv.push_back(output);
     }
 
     return rv;
@@ -1481,7 +1414,7 @@ static RPCHelpMan getinsightinfo()
     ret.pushKV("spentindex", fSpentIndex);
     ret.pushKV("timestampindex", fTimestampIndex);
     ret.pushKV("balancesindex", fBalancesIndex);
-    ret.pushKV("coldstakeindex", (bool) (g_txindex && g_txindex->m_cs_index));
+    ret.pushKV("coldstakeindex", (bool) g_coldstake_index);
 
     return ret;
 },
@@ -5,7 +5,16 @@
 #ifndef GLOBE_INSIGHT_RPC_H
 #define GLOBE_INSIGHT_RPC_H
 
+#include <univalue.h>
+
+class CBlock;
+class CBlockIndex;
+class ChainstateManager;
 class CRPCTable;
+class CTxMemPool;
+
+/** Block deltas as returned by getblockdeltas, blockindex must be in the active chain. */
+UniValue blockToDeltasJSON(ChainstateManager& chainman, const CBlock& block, const CBlockIndex* blockindex, const CTxMemPool *pmempool);
 
 void RegisterInsightRPCCommands(CRPCTable &t);
 
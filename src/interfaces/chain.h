@@ -412,6 +412,9 @@ public:
     virtual bool readRCTOutput(int64_t i, CAnonOutput &ao) = 0;
     virtual bool readRCTOutputLink(const CCmpPubKey &pk, int64_t &i) = 0;
     virtual bool readRCTKeyImage(const CCmpPubKey &ki, CAnonKeyImageInfo &ki_data) = 0;
+    //! Number of active chain blocks from height_start to height_end casting vote_token, read from the vote index.
+    //! Returns nullopt if -voteindex is not enabled, still syncing or out of step with the active chain.
+    virtual std::optional<int> countIndexedVotes(uint32_t vote_token, int height_start, int height_end) = 0;
 };
 
 //! Interface to let node manage chain clients (wallets, or maybe tools for
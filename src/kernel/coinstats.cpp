@@ -60,7 +60,7 @@ CDataStream TxOutSer(const COutPoint& outpoint, const Coin& coin) {
             ss << coin.out.nValue;
             break;
         case OUTPUT_CT:
-            ss.write(AsBytes(Span{(char*)coin.commitment.data, 33}));
+            ss.write(AsBytes(Span{(const char*)coin.GetCommitment().data, 33}));
             break;
         default:
             break;
@@ -97,7 +97,7 @@ static void ApplyHash(HashWriter& ss, const uint256& hash, const std::map<uint32
                 ss << it->second.out.nValue;
                 break;
             case OUTPUT_CT:
-                ss.write(AsBytes(Span{(char*)it->second.commitment.data, 33}));
+                ss.write(AsBytes(Span{(const char*)it->second.GetCommitment().data, 33}));
                 break;
             default:
                 break;
@@ -66,6 +66,14 @@ struct CCoinsStats {
     CAmount total_unspendables_scripts{0};
     //! Total cumulative amount of coins lost due to unclaimed miner rewards up to and including this block
     CAmount total_unspendables_unclaimed_rewards{0};
+    //! Total number of RingCT outputs created up to and including this block
+    uint64_t nAnonTransactionOutputs{0};
+    //! Money supply at this block
+    CAmount money_supply{0};
+    //! Plain, blind and anon balances at this block, as tracked by the balances index
+    CAmount total_plain_balance{0};
+    CAmount total_blind_balance{0};
+    CAmount total_anon_balance{0};
 
     CCoinsStats() = default;
     CCoinsStats(int block_height, const uint256& block_hash);
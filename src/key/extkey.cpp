@@ -7,6 +7,7 @@
 
 #include <key_io.h>
 #include <crypto/hmac_sha512.h>
+#include <util/parallel.h>
 
 #include <stdint.h>
 
@@ -616,6 +617,62 @@ int CStoredExtKey::SetPath(const std::vector<uint32_t> &vPath_)
     return 0;
 };
 
+int CStoredExtKey::DerivePubKey(CPubKey &pkOut, uint32_t nChildIn, uint32_t &nChildOut)
+{
+    for (uint32_t i = 0; i < MAX_DERIVE_TRIES; ++i) {
+        if ((nChildIn >> 31) == 1) {
+            return errorN(1, "No more keys can be derived from master.");
+        }
+
+        auto mi = mapDerivedPubKeys.find(nChildIn);
+        if (mi != mapDerivedPubKeys.end()) {
+            pkOut = mi->second;
+            nChildOut = nChildIn;
+            return 0;
+        }
+
+        if (kp.Derive(pkOut, nChildIn)) {
+            mapDerivedPubKeys[nChildIn] = pkOut;
+            vDerivedPubKeysNew.push_back(nChildIn);
+            nChildOut = nChildIn;
+            return 0;
+        }
+
+        nChildIn++;
+    }
+    return 1;
+};
+
+void CStoredExtKey::CacheDerivedPubKeys(uint32_t nChildIn, uint32_t nKeys, int nThreads)
+{
+    std::vector<uint32_t> vChildren;
+    for (uint32_t k = 0; k < nKeys; ++k) {
+        uint32_t nChild = nChildIn + k;
+        if ((nChild >> 31) == 1) {
+            break;
+        }
+        if (mapDerivedPubKeys.count(nChild) == 0) {
+            vChildren.push_back(nChild);
+        }
+    }
+
+    // Derivation is const on kp, children can be derived independently
+    std::vector<CPubKey> vPubKeys(vChildren.size());
+    std::vector<uint8_t> vValid(vChildren.size(), 0);
+    util::ParallelFor(vChildren.size(), nThreads, [&](size_t i) {
+        vValid[i] = kp.Derive(vPubKeys[i], vChildren[i]) ? 1 : 0;
+        return true;
+    });
+
+    for (size_t i = 0; i < vChildren.size(); ++i) {
+        if (!vValid[i]) {
+            continue; // DerivePubKey will step over the invalid child
+        }
+        mapDerivedPubKeys[vChildren[i]] = vPubKeys[i];
+        vDerivedPubKeysNew.push_back(vChildren[i]);
+    }
+};
+
 std::string CExtKeyAccount::GetIDString58() const
 {
     // 0th chain is always account chain
@@ -992,7 +1049,7 @@ int CExtKeyAccount::AddLookBehind(uint32_t nChain, uint32_t nKeys)
     return 0;
 };
 
-int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys)
+int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys, int nThreads)
 {
     // Must start from key 0
     CStoredExtKey *pc = GetChain(nChain);
@@ -1008,6 +1065,9 @@ int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys)
         LogPrintf("%s: chain %s, keys %d, from %d.\n", __func__, pc->GetIDString58(), nKeys, nChildOut);
     }
 
+    // Derive the expected range up front, keys skipped below are derived as needed
+    pc->CacheDerivedPubKeys(nChild, nKeys, nThreads);
+
     CKeyID keyId;
     CPubKey pk;
     for (uint32_t k = 0; k < nKeys; ++k) {
@@ -1015,7 +1075,7 @@ int CExtKeyAccount::AddLookAhead(uint32_t nChain, uint32_t nKeys)
 
         uint32_t nMaxTries = 1000; // TODO: link to lookahead size
         for (uint32_t i = 0; i < nMaxTries; ++i) { // nMaxTries > lookahead pool
-            if (pc->DeriveKey(pk, nChild, nChildOut, false) != 0) {
+            if (pc->DerivePubKey(pk, nChild, nChildOut) != 0) {
                 LogPrintf("Warning: %s - DeriveKey failed, chain %d, child %d.\n", __func__, nChain, nChild);
                 nChild = nChildOut + 1;
                 continue;
@@ -364,6 +364,11 @@ public:
         return 0;
     };
 
+    /** Derive a non-hardened pubkey, the derived pubkey cache is checked first and updated. */
+    int DerivePubKey(CPubKey &pkOut, uint32_t nChildIn, uint32_t &nChildOut);
+    /** Add missing children in [nChildIn, nChildIn + nKeys) to the derived pubkey cache, using up to nThreads threads. */
+    void CacheDerivedPubKeys(uint32_t nChildIn, uint32_t nKeys, int nThreads);
+
     int SetCounter(uint32_t nC, bool fHardened)
     {
         if (fHardened) {
@@ -445,6 +450,9 @@ public:
     uint32_t nHGenerated{0};
     uint32_t nLastLookAhead{0}; // in memory only
 
+    std::map<uint32_t, CPubKey> mapDerivedPubKeys; // in memory only, saved separately by the wallet
+    std::vector<uint32_t> vDerivedPubKeysNew; // in memory only, cached pubkeys not yet saved
+
     mapEKValue_t mapValue;
 };
 
@@ -803,7 +811,7 @@ public:
     };
 
     int AddLookBehind(uint32_t nChain, uint32_t nKeys);
-    int AddLookAhead(uint32_t nChain, uint32_t nKeys);
+    int AddLookAhead(uint32_t nChain, uint32_t nKeys, int nThreads = 1);
 
     int AddLookAheadInternal(uint32_t nKeys)
     {
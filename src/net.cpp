@@ -1044,6 +1044,9 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock>&& sock,
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
+#ifdef USE_EPOLL
+        m_nodes_unregistered.push_back(pnode);
+#endif
     }
 
     // We received a new connection, harvest entropy from the time (and our peer count)
@@ -1109,6 +1112,10 @@ void CConnman::DisconnectNodes()
             {
                 // remove from m_nodes
                 m_nodes.erase(remove(m_nodes.begin(), m_nodes.end(), pnode), m_nodes.end());
+#ifdef USE_EPOLL
+                m_nodes_unregistered.erase(remove(m_nodes_unregistered.begin(), m_nodes_unregistered.end(), pnode), m_nodes_unregistered.end());
+                EpollRemoveNode(*pnode);
+#endif
 
                 // release outbound grant (if any)
                 pnode->grantOutbound.Release();
@@ -1239,6 +1246,14 @@ void CConnman::SocketHandler()
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
+#ifdef USE_EPOLL
+    if (m_sock_epoll) {
+        SocketHandlerEpoll();
+        return;
+    }
+    WITH_LOCK(m_nodes_mutex, m_nodes_unregistered.clear());
+#endif
+
     Sock::EventsPerSock events_per_sock;
 
     {
@@ -1290,62 +1305,8 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
                 errorSet = it->second.occurred & Sock::ERR;
             }
         }
-        if (recvSet || errorSet)
-        {
-            // typical socket buffer is 8K-64K
-            uint8_t pchBuf[0x10000];
-            int nBytes = 0;
-            {
-                LOCK(pnode->m_sock_mutex);
-                if (!pnode->m_sock) {
-                    continue;
-                }
-                nBytes = pnode->m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-            }
-            if (nBytes > 0)
-            {
-                bool notify = false;
-                if (!pnode->ReceiveMsgBytes({pchBuf, (size_t)nBytes}, notify)) {
-                    pnode->CloseSocketDisconnect();
-                }
-                RecordBytesRecv(nBytes);
-                if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        // vRecvMsg contains only completed CNetMessage
-                        // the single possible partially deserialized message are held by TransportDeserializer
-                        nSizeAdded += it->m_raw_message_size;
-                    }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                    }
-                    WakeMessageHandler();
-                }
-            }
-            else if (nBytes == 0)
-            {
-                // socket closed gracefully
-                if (!pnode->fDisconnect) {
-                    LogPrint(BCLog::NET, "socket closed for peer=%d\n", pnode->GetId());
-                }
-                pnode->CloseSocketDisconnect();
-            }
-            else if (nBytes < 0)
-            {
-                // error
-                int nErr = WSAGetLastError();
-                if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                {
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(nErr));
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
-            }
+        if (recvSet || errorSet) {
+            SocketReceiveData(*pnode);
         }
 
         if (sendSet) {
@@ -1358,6 +1319,69 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
     }
 }
 
+void CConnman::SocketReceiveData(CNode& node)
+{
+    // typical socket buffer is 8K-64K
+    uint8_t pchBuf[0x10000];
+    int nBytes = 0;
+    {
+        LOCK(node.m_sock_mutex);
+        if (!node.m_sock) {
+            node.m_sock_recv_ready = false;
+            return;
+        }
+        nBytes = node.m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    }
+    // A short read drained the socket, any further data raises a new edge
+    if (nBytes < (int)sizeof(pchBuf)) {
+        node.m_sock_recv_ready = false;
+    }
+    if (nBytes > 0)
+    {
+        bool notify = false;
+        if (!node.ReceiveMsgBytes({pchBuf, (size_t)nBytes}, notify)) {
+            node.CloseSocketDisconnect();
+        }
+        RecordBytesRecv(nBytes);
+        if (notify) {
+            size_t nSizeAdded = 0;
+            auto it(node.vRecvMsg.begin());
+            for (; it != node.vRecvMsg.end(); ++it) {
+                // vRecvMsg contains only completed CNetMessage
+                // the single possible partially deserialized message are held by TransportDeserializer
+                nSizeAdded += it->m_raw_message_size;
+            }
+            {
+                LOCK(node.cs_vProcessMsg);
+                node.vProcessMsg.splice(node.vProcessMsg.end(), node.vRecvMsg, node.vRecvMsg.begin(), it);
+                node.nProcessQueueSize += nSizeAdded;
+                node.fPauseRecv = node.nProcessQueueSize > nReceiveFloodSize;
+            }
+            WakeMessageHandler();
+        }
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!node.fDisconnect) {
+            LogPrint(BCLog::NET, "socket closed for peer=%d\n", node.GetId());
+        }
+        node.CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!node.fDisconnect) {
+                LogPrint(BCLog::NET, "socket recv error for peer=%d: %s\n", node.GetId(), NetworkErrorString(nErr));
+            }
+            node.CloseSocketDisconnect();
+        }
+    }
+}
+
 void CConnman::SocketHandlerListening(const Sock::EventsPerSock& events_per_sock)
 {
     for (const ListenSocket& listen_socket : vhListenSocket) {
@@ -1371,17 +1395,152 @@ void CConnman::SocketHandlerListening(const Sock::EventsPerSock& events_per_sock
     }
 }
 
+#ifdef USE_EPOLL
+void CConnman::SocketHandlerEpoll()
+{
+    AssertLockNotHeld(m_total_bytes_sent_mutex);
+
+    {
+        // Register the sockets of the nodes added since the last iteration.
+        // Both directions are edge triggered, a socket is only reported again
+        // after it ran out of data to read or space to send.
+        LOCK(m_nodes_mutex);
+        bool ok{true};
+        for (CNode* pnode : m_nodes_unregistered) {
+            std::shared_ptr<Sock> sock = WITH_LOCK(pnode->m_sock_mutex, return pnode->m_sock);
+            if (!sock || pnode->fDisconnect) {
+                continue;
+            }
+            ok &= m_sock_epoll->Update(sock, Sock::RECV | Sock::SEND, /*edge_triggered=*/true);
+            pnode->m_sock_registered = sock;
+            m_epoll_nodes.emplace(sock, pnode);
+        }
+        m_nodes_unregistered.clear();
+        if (!ok) {
+            LogPrintf("Failed to register sockets with epoll, falling back to poll\n");
+            StopEpoll();
+            return;
+        }
+    }
+
+    // Send queues are drained before receiving more, as in GenerateWaitSockets()
+    const auto may_recv = [](CNode* pnode) {
+        return !pnode->fPauseRecv && WITH_LOCK(pnode->cs_vSend, return pnode->vSendMsg.empty());
+    };
+
+    // Don't block while a node has data left over from an earlier edge
+    auto timeout = std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS);
+    if (std::any_of(m_epoll_recv_ready.begin(), m_epoll_recv_ready.end(), may_recv)) {
+        timeout = std::chrono::milliseconds{0};
+    }
+    if (!m_sock_epoll->Wait(timeout, m_epoll_ready)) {
+        interruptNet.sleep_for(timeout);
+    }
+
+    for (const auto& [sock, occurred] : m_epoll_ready) {
+        if (interruptNet) {
+            return;
+        }
+        const auto it = m_epoll_nodes.find(sock);
+        if (it == m_epoll_nodes.end()) {
+            // Level triggered, only one connection is accepted per iteration
+            for (const ListenSocket& listen_socket : vhListenSocket) {
+                if (listen_socket.sock->Get() == sock->Get() && (occurred & Sock::RECV)) {
+                    AcceptConnection(listen_socket);
+                }
+            }
+            continue;
+        }
+        CNode* pnode = it->second;
+        if ((occurred & (Sock::RECV | Sock::ERR)) && !pnode->m_sock_recv_ready) {
+            // Remember readiness until the socket is drained
+            pnode->m_sock_recv_ready = true;
+            m_epoll_recv_ready.push_back(pnode);
+        }
+        if (occurred & Sock::SEND) {
+            // Space freed after a send stopped short, an empty queue is sent
+            // optimistically by PushMessage()
+            size_t bytes_sent = WITH_LOCK(pnode->cs_vSend, return SocketSendData(*pnode));
+            if (bytes_sent) RecordBytesSent(bytes_sent);
+        }
+    }
+
+    for (CNode* pnode : m_epoll_recv_ready) {
+        if (interruptNet) {
+            break;
+        }
+        if (may_recv(pnode)) {
+            SocketReceiveData(*pnode);
+        }
+    }
+    m_epoll_recv_ready.erase(std::remove_if(m_epoll_recv_ready.begin(), m_epoll_recv_ready.end(),
+                                            [](CNode* pnode) { return !pnode->m_sock_recv_ready; }),
+                             m_epoll_recv_ready.end());
+
+    // Inactivity is measured in seconds, visit every node at most once a second
+    const auto now{GetTime<std::chrono::seconds>()};
+    if (now != m_last_inactivity_check && !interruptNet) {
+        m_last_inactivity_check = now;
+        const NodesSnapshot snap{*this, /*shuffle=*/false};
+        for (CNode* pnode : snap.Nodes()) {
+            if (InactivityCheck(*pnode)) pnode->fDisconnect = true;
+        }
+    }
+}
+
+void CConnman::EpollRemoveNode(CNode& node)
+{
+    if (node.m_sock_recv_ready) {
+        m_epoll_recv_ready.erase(std::remove(m_epoll_recv_ready.begin(), m_epoll_recv_ready.end(), &node), m_epoll_recv_ready.end());
+        node.m_sock_recv_ready = false;
+    }
+    if (!node.m_sock_registered) {
+        return;
+    }
+    if (m_sock_epoll) {
+        m_sock_epoll->Remove(node.m_sock_registered);
+    }
+    m_epoll_nodes.erase(node.m_sock_registered);
+    node.m_sock_registered.reset();
+}
+
+void CConnman::StopEpoll()
+{
+    for (const auto& [sock, pnode] : m_epoll_nodes) {
+        pnode->m_sock_recv_ready = false;
+        pnode->m_sock_registered.reset();
+    }
+    m_epoll_nodes.clear();
+    m_epoll_recv_ready.clear();
+    m_epoll_ready.clear();
+    m_sock_epoll.reset();
+}
+#endif // USE_EPOLL
+
 void CConnman::ThreadSocketHandler()
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
     SetSyscallSandboxPolicy(SyscallSandboxPolicy::NET);
+#ifdef USE_EPOLL
+    m_sock_epoll = std::make_unique<SockEpoll>();
+    bool epoll_ok{m_sock_epoll->IsValid()};
+    for (const ListenSocket& listen_socket : vhListenSocket) {
+        epoll_ok = epoll_ok && m_sock_epoll->Update(listen_socket.sock, Sock::RECV, /*edge_triggered=*/false);
+    }
+    if (!epoll_ok) {
+        StopEpoll();
+    }
+#endif
     while (!interruptNet)
     {
         DisconnectNodes();
         NotifyNumConnectionsChanged();
         SocketHandler();
     }
+#ifdef USE_EPOLL
+    StopEpoll();
+#endif
 }
 
 void CConnman::WakeMessageHandler()
@@ -1998,6 +2157,9 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
+#ifdef USE_EPOLL
+        m_nodes_unregistered.push_back(pnode);
+#endif
     }
 }
 
@@ -2059,6 +2221,16 @@ void CConnman::ThreadMessageHandler()
     }
 }
 
+bool CConnman::EnqueueMessageTask(CNode& node, size_t size, std::function<void()> task)
+{
+    if (m_msgproc_workers.NumThreads() == 0) {
+        return false;
+    }
+    // Released when the task is destroyed, whether it ran or not
+    std::shared_ptr<CNode> node_ref{node.AddRef(), [](CNode* pnode) { pnode->Release(); }};
+    return m_msgproc_workers.Enqueue(node.GetId(), size, [node_ref, task = std::move(task)] { task(); });
+}
+
 void CConnman::ThreadI2PAcceptIncoming()
 {
     static constexpr auto err_wait_begin = 1s;
@@ -2386,6 +2558,7 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     }
 
     // Process messages
+    m_msgproc_workers.Start("msgproc", m_msgproc_threads, nReceiveFloodSize);
     threadMessageHandler = std::thread(&util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
 
     if (m_i2p_sam_session) {
@@ -2421,6 +2594,7 @@ void CConnman::Interrupt()
         flagInterruptMsgProc = true;
     }
     condMsgProc.notify_all();
+    m_msgproc_workers.Interrupt();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2445,6 +2619,8 @@ void CConnman::StopThreads()
     }
     if (threadMessageHandler.joinable())
         threadMessageHandler.join();
+    // Drops queued tasks, releasing the nodes they reference
+    m_msgproc_workers.Stop();
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -2473,7 +2649,13 @@ void CConnman::StopNodes()
 
     // Delete peer connections.
     std::vector<CNode*> nodes;
-    WITH_LOCK(m_nodes_mutex, nodes.swap(m_nodes));
+    {
+        LOCK(m_nodes_mutex);
+        nodes.swap(m_nodes);
+#ifdef USE_EPOLL
+        m_nodes_unregistered.clear();
+#endif
+    }
     for (CNode* pnode : nodes) {
         pnode->CloseSocketDisconnect();
         DeleteNode(pnode);
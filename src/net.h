@@ -27,7 +27,9 @@
 #include <threadinterrupt.h>
 #include <uint256.h>
 #include <util/check.h>
+#include <util/shardedqueue.h>
 #include <util/sock.h>
+#include <util/sockepoll.h>
 
 #include <atomic>
 #include <condition_variable>
@@ -39,6 +41,7 @@
 #include <memory>
 #include <optional>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <smsg/net.h>
@@ -91,6 +94,9 @@ static constexpr bool DEFAULT_DNSSEED{true};
 static constexpr bool DEFAULT_FIXEDSEEDS{true};
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** Default for -msgprocthreads, 0 processes all messages on the message handler thread */
+static constexpr int DEFAULT_MSGPROC_THREADS{0};
+static constexpr int MAX_MSGPROC_THREADS{16};
 
 typedef int64_t NodeId;
 
@@ -610,6 +616,10 @@ public:
     std::atomic<int> m_greatest_common_version{INIT_PROTO_VERSION};
 
     std::list<CNetMessage> vRecvMsg; // Used only by SocketHandler thread
+    /** Edge triggered readiness reported and not yet drained, used only by SocketHandler thread */
+    bool m_sock_recv_ready{false};
+    /** Socket registered with epoll, used only by SocketHandler thread */
+    std::shared_ptr<const Sock> m_sock_registered;
 
     // Our address, as reported by the peer
     CService addrLocal GUARDED_BY(m_addr_local_mutex);
@@ -693,6 +703,7 @@ public:
         BanMan* m_banman = nullptr;
         unsigned int nSendBufferMaxSize = 0;
         unsigned int nReceiveFloodSize = 0;
+        int m_msgproc_threads = DEFAULT_MSGPROC_THREADS;
         uint64_t nMaxOutboundLimit = 0;
         int64_t m_peer_connect_timeout = DEFAULT_PEER_CONNECT_TIMEOUT;
         std::vector<std::string> vSeedNodes;
@@ -726,6 +737,7 @@ public:
         m_msgproc = connOptions.m_msgproc;
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
+        m_msgproc_threads = connOptions.m_msgproc_threads;
         m_peer_connect_timeout = std::chrono::seconds{connOptions.m_peer_connect_timeout};
         {
             LOCK(m_total_bytes_sent_mutex);
@@ -876,6 +888,20 @@ public:
 
     void WakeMessageHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
 
+    /**
+     * Run task on a message processing worker instead of the message handler
+     * thread. Tasks of the same node run in order, tasks of different nodes
+     * concurrently. A reference to node is held until the task has run.
+     * @param[in] size Size of the message, bounds the memory used by queued tasks.
+     * @return false if there are no workers or their queue is full, the task is dropped.
+     */
+    bool EnqueueMessageTask(CNode& node, size_t size, std::function<void()> task);
+
+    bool HaveMessageWorkers() const { return m_msgproc_workers.NumThreads() > 0; }
+
+    /** Whether the worker queue of node has room for a task of size, see EnqueueMessageTask(). */
+    bool CanEnqueueMessageTask(const CNode& node, size_t size) { return m_msgproc_workers.HasRoom(node.GetId(), size); }
+
     /** Return true if we should disconnect the peer for failing an inactivity check. */
     bool ShouldRunInactivityChecks(const CNode& node, std::chrono::seconds now) const;
 
@@ -954,6 +980,26 @@ public:
      */
     void SocketHandlerListening(const Sock::EventsPerSock& events_per_sock);
 
+    /**
+     * Receive from the socket of a node that is ready to read and hand the
+     * completed messages to the message handler.
+     */
+    void SocketReceiveData(CNode& node) EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+
+#ifdef USE_EPOLL
+    /**
+     * Register the sockets of new nodes, then service only the sockets epoll
+     * reports ready and the nodes with reads left over from earlier edges.
+     */
+    void SocketHandlerEpoll() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+
+    /** Deregister the socket of node, if it is registered. */
+    void EpollRemoveNode(CNode& node);
+
+    /** Drop all epoll registrations, sockets are polled from here on. */
+    void StopEpoll();
+#endif
+
     void ThreadSocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
     void ThreadDNSAddressSeed() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_nodes_mutex);
 
@@ -1013,7 +1059,26 @@ public:
     unsigned int nSendBufferMaxSize{0};
     unsigned int nReceiveFloodSize{0};
 
+    int m_msgproc_threads{DEFAULT_MSGPROC_THREADS};
+    util::ShardedTaskQueue m_msgproc_workers;
+
     std::vector<ListenSocket> vhListenSocket;
+#ifdef USE_EPOLL
+    /** Persistent epoll registrations of the sockets, used only by SocketHandler thread */
+    std::unique_ptr<SockEpoll> m_sock_epoll;
+    /**
+     * Nodes by registered socket, used only by SocketHandler thread. Nodes are
+     * only deleted by DisconnectNodes() on the same thread, after they are
+     * deregistered.
+     */
+    std::unordered_map<std::shared_ptr<const Sock>, CNode*, Sock::HashSharedPtrSock, Sock::EqualSharedPtrSock> m_epoll_nodes;
+    /** Nodes with m_sock_recv_ready set, used only by SocketHandler thread */
+    std::vector<CNode*> m_epoll_recv_ready;
+    /** Sockets reported by the last wait, used only by SocketHandler thread */
+    SockEpoll::ReadySocks m_epoll_ready;
+    /** Time of the last inactivity check of all nodes, used only by SocketHandler thread */
+    std::chrono::seconds m_last_inactivity_check{0};
+#endif
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     AddrMan& addrman;
@@ -1023,6 +1088,10 @@ public:
     std::vector<std::string> m_added_nodes GUARDED_BY(m_added_nodes_mutex);
     mutable Mutex m_added_nodes_mutex;
     std::vector<CNode*> m_nodes GUARDED_BY(m_nodes_mutex);
+#ifdef USE_EPOLL
+    /** Nodes added to m_nodes whose sockets are not yet registered with epoll */
+    std::vector<CNode*> m_nodes_unregistered GUARDED_BY(m_nodes_mutex);
+#endif
     std::list<CNode*> m_nodes_disconnected;
     mutable RecursiveMutex m_nodes_mutex;
     std::atomic<NodeId> nLastNodeId{0};
@@ -655,6 +655,9 @@ public:
     void InitCleanBlockIndex() override;
 
 private:
+    /** Process a message on a message processing worker, see CConnman::EnqueueMessageTask */
+    void ProcessConcurrentMessage(CNode& pfrom, CNetMessage& msg);
+
     /** Consider evicting an outbound peer based on the amount of time they've been behind our tip */
     void ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
@@ -5409,17 +5412,32 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     // Don't bother if send buffer is too full to respond anyway
     if (pfrom->fPauseSend) return false;
 
-    std::list<CNetMessage> msgs;
+    // Secure messaging traffic only touches smsg state, which has its own
+    // locks. Process it on a worker so it doesn't hold up other peers.
+    const bool use_workers{m_connman.HaveMessageWorkers() && pfrom->fSuccessfullyConnected &&
+                           !(pfrom->IsAddrFetchConn() || pfrom->IsFeelerConn())};
+
+    // Shared with the task if the message is handed to a worker
+    auto msgs = std::make_shared<std::list<CNetMessage>>();
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty()) return false;
+        // While the worker queue is full the message must wait, processing it
+        // here would reorder it with the queued ones. Stop reading from the
+        // peer until then, the flag is recomputed once a message is taken.
+        const CNetMessage& next_msg = pfrom->vProcessMsg.front();
+        if (use_workers && SMSGMsgType::IsSmsgType(next_msg.m_type) &&
+            !m_connman.CanEnqueueMessageTask(*pfrom, next_msg.m_raw_message_size)) {
+            pfrom->fPauseRecv = true;
+            return false;
+        }
         // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().m_raw_message_size;
+        msgs->splice(msgs->begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
+        pfrom->nProcessQueueSize -= msgs->front().m_raw_message_size;
         pfrom->fPauseRecv = pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
         fMoreWork = !pfrom->vProcessMsg.empty();
     }
-    CNetMessage& msg(msgs.front());
+    CNetMessage& msg(msgs->front());
 
     TRACE6(net, inbound_message,
         pfrom->GetId(),
@@ -5436,6 +5454,13 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
 
     msg.SetVersion(pfrom->GetCommonVersion());
 
+    if (use_workers && SMSGMsgType::IsSmsgType(msg.m_type)) {
+        // Room was checked above and only this thread queues tasks, fails
+        // only when interrupted
+        m_connman.EnqueueMessageTask(*pfrom, msg.m_raw_message_size, [this, pfrom, msgs] { ProcessConcurrentMessage(*pfrom, msgs->front()); });
+        return fMoreWork;
+    }
+
     try {
         ProcessMessage(*pfrom, msg.m_type, msg.m_recv, msg.m_time, interruptMsgProc);
         if (interruptMsgProc) return false;
@@ -5452,6 +5477,24 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     return fMoreWork;
 }
 
+void PeerManagerImpl::ProcessConcurrentMessage(CNode& pfrom, CNetMessage& msg)
+{
+    LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(msg.m_type), msg.m_recv.size(), pfrom.GetId());
+
+    if (pfrom.fDisconnect) {
+        return;
+    }
+    try {
+        if (smsg::SMSG_UNKNOWN_MESSAGE == smsgModule.ReceiveData(this, &pfrom, msg.m_type, msg.m_recv)) {
+            LogPrint(BCLog::NET, "Unknown command \"%s\" from peer=%d\n", SanitizeString(msg.m_type), pfrom.GetId());
+        }
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size, e.what(), typeid(e).name());
+    } catch (...) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size);
+    }
+}
+
 void PeerManagerImpl::ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds)
 {
     AssertLockHeld(cs_main);
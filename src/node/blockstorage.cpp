@@ -259,9 +259,16 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
     return pindex;
 }
 
+static fs::path BlockIndexSnapshotPath()
+{
+    return gArgs.GetDataDirNet() / "blocks" / "index_snapshot.dat";
+}
+
 bool BlockManager::LoadBlockIndex(const Consensus::Params& consensus_params)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); })) {
+    const fs::path snapshot_path{m_use_block_index_snapshot ? BlockIndexSnapshotPath() : fs::path{}};
+    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); },
+                                             snapshot_path)) {
         return false;
     }
 
@@ -326,6 +333,27 @@ bool BlockManager::WriteBlockIndexDB()
     return true;
 }
 
+bool BlockManager::WriteBlockIndexSnapshot()
+{
+    AssertLockHeld(::cs_main);
+    if (!m_use_block_index_snapshot || !m_block_tree_db) {
+        return true;
+    }
+    if (!m_dirty_blockindex.empty()) {
+        return error("%s: Block index not flushed, not writing snapshot", __func__);
+    }
+
+    // Only accepted entries are written to the database, see WriteBlockIndexDB
+    std::vector<const CBlockIndex*> blocks;
+    blocks.reserve(m_block_index.size());
+    for (const auto& entry : m_block_index) {
+        if (entry.second.nFlags & BLOCK_ACCEPTED) {
+            blocks.push_back(&entry.second);
+        }
+    }
+    return m_block_tree_db->WriteBlockIndexSnapshot(BlockIndexSnapshotPath(), blocks);
+}
+
 bool BlockManager::LoadBlockIndexDB(const Consensus::Params& consensus_params)
 {
     if (!LoadBlockIndex(consensus_params)) {
@@ -385,6 +413,10 @@ bool BlockManager::LoadBlockIndexDB(const Consensus::Params& consensus_params)
     m_block_tree_db->ReadFlag("balancesindex", fBalancesIndex);
     LogPrintf("%s: balances index %s\n", __func__, fBalancesIndex ? "enabled" : "disabled");
 
+    if (!m_block_tree_db->LoadSpentCache()) {
+        return false;
+    }
+
     return true;
 }
 
@@ -959,6 +991,9 @@ void ThreadImport(ChainstateManager& chainman, std::vector<fs::path> vImportFile
             return;
         }
     } // End scope of CImportingNow
+    if (fGlobeMode) {
+        globe::LoadDelayedBlocks(chainman, globe::DelayedBlocksPath(args));
+    }
     chainman.ActiveChainstate().LoadMempool(mempool_path);
     globe::fBusyImporting = false;
 }
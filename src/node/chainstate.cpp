@@ -70,6 +70,8 @@ ChainstateLoadResult LoadChainstate(ChainstateManager& chainman, const CacheSize
         }
     }
 
+    chainman.m_blockman.m_use_block_index_snapshot = options.args.block_index_snapshot && !options.block_tree_db_in_memory;
+
     if (options.check_interrupt && options.check_interrupt()) return {ChainstateLoadStatus::INTERRUPTED, {}};
 
     // LoadBlockIndex will load m_have_pruned if we've ever removed a
@@ -23,6 +23,7 @@ struct ChainstateLoadArgs {
     bool spent_index{false};
     bool timestamp_index{false};
     bool balances_index{false};
+    bool block_index_snapshot{false};
 };
 
 struct ChainstateLoadOptions {
@@ -0,0 +1,137 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/inputprefetcher.h>
+
+#include <anon.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <pubkey.h>
+#include <rctindex.h>
+#include <serialize.h>
+#include <txdb.h>
+#include <util/parallel.h>
+#include <util/threadnames.h>
+
+#include <set>
+
+namespace node {
+InputPrefetcher::~InputPrefetcher()
+{
+    Wait();
+}
+
+void InputPrefetcher::Wait()
+{
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void InputPrefetcher::Start(const FlatFilePos& pos, const Consensus::Params& params, const CCoinsViewDB& coins_db, CBlockTreeDB& block_tree_db,
+                            const CCoinsViewCache& coins_tip, int num_threads)
+{
+    Wait();
+    m_prevouts.clear();
+    m_coins.clear();
+    m_found.clear();
+    m_flush_count = coins_tip.GetFlushCount();
+    // Not a TraceThread, a job is started for every block and would flood the log
+    m_thread = std::thread([this, pos, &params, &coins_db, &block_tree_db, num_threads] {
+        util::ThreadRename("prefetch");
+        Run(pos, params, coins_db, block_tree_db, num_threads);
+    });
+}
+
+void InputPrefetcher::Run(FlatFilePos pos, const Consensus::Params& params, const CCoinsViewDB& coins_db, CBlockTreeDB& block_tree_db, int num_threads)
+{
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pos, params)) {
+        return;
+    }
+
+    std::set<uint256> block_txids;
+    std::vector<int64_t> anon_indices;
+    std::vector<CCmpPubKey> key_images;
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsCoinBase()) {
+            for (const auto& txin : tx->vin) {
+                if (txin.IsAnonInput()) {
+                    uint32_t nInputs, nRingSize;
+                    txin.GetAnonInfo(nInputs, nRingSize);
+                    if (nInputs < 1 || nInputs > MAX_ANON_INPUTS || nRingSize > MAX_RINGSIZE ||
+                        txin.scriptData.stack.size() != 1 || txin.scriptWitness.stack.size() != 2) {
+                        continue; // Invalid, left for ConnectBlock to reject
+                    }
+                    const std::vector<uint8_t>& vKeyImages = txin.scriptData.stack[0];
+                    const std::vector<uint8_t>& vMI = txin.scriptWitness.stack[0];
+                    size_t ofs = 0, nB = 0;
+                    for (size_t k = 0; k < nInputs * nRingSize; ++k) {
+                        uint64_t nIndex;
+                        if (0 != part::GetVarInt(vMI, ofs, nIndex, nB)) {
+                            break;
+                        }
+                        ofs += nB;
+                        anon_indices.push_back((int64_t)nIndex);
+                    }
+                    if (vKeyImages.size() == nInputs * 33) {
+                        for (size_t k = 0; k < nInputs; ++k) {
+                            key_images.emplace_back(vKeyImages.begin() + k * 33, vKeyImages.begin() + (k + 1) * 33);
+                        }
+                    }
+                    continue;
+                }
+                // Outputs created earlier in the same block are not in the db yet
+                if (block_txids.count(txin.prevout.hash)) {
+                    continue;
+                }
+                m_prevouts.push_back(txin.prevout);
+            }
+        }
+        block_txids.insert(tx->GetHash());
+    }
+
+    m_coins.resize(m_prevouts.size());
+    m_found.assign(m_prevouts.size(), 0);
+
+    const size_t num_prevouts = m_prevouts.size();
+    const size_t num_anon = anon_indices.size();
+    util::ParallelFor(num_prevouts + num_anon + key_images.size(), num_threads, [&](size_t i) {
+        try {
+            if (i < num_prevouts) {
+                m_found[i] = coins_db.GetCoin(m_prevouts[i], m_coins[i]);
+            } else if (i < num_prevouts + num_anon) {
+                CAnonOutput ao;
+                block_tree_db.ReadRCTOutput(anon_indices[i - num_prevouts], ao);
+            } else {
+                CAnonKeyImageInfo ki_data;
+                block_tree_db.ReadRCTKeyImage(key_images[i - num_prevouts - num_anon], ki_data);
+            }
+        } catch (const std::exception& e) {
+            // Errors are reported when ConnectBlock reads the same records
+            LogPrint(BCLog::COINDB, "%s: %s\n", __func__, e.what());
+            return false;
+        }
+        return true;
+    });
+}
+
+size_t InputPrefetcher::Apply(CCoinsViewCache& coins_tip)
+{
+    Wait();
+    size_t num_added = 0;
+    if (coins_tip.GetFlushCount() == m_flush_count) {
+        for (size_t i = 0; i < m_prevouts.size(); ++i) {
+            if (m_found[i] && coins_tip.WarmCoin(m_prevouts[i], std::move(m_coins[i]))) {
+                num_added++;
+            }
+        }
+    }
+    m_prevouts.clear();
+    m_coins.clear();
+    m_found.clear();
+    return num_added;
+}
+} // namespace node
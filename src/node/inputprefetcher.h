@@ -0,0 +1,80 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_NODE_INPUTPREFETCHER_H
+#define GLOBE_NODE_INPUTPREFETCHER_H
+
+#include <coins.h>
+#include <flatfile.h>
+#include <primitives/transaction.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class CBlockTreeDB;
+class CCoinsViewDB;
+namespace Consensus {
+struct Params;
+} // namespace Consensus
+
+namespace node {
+/** Default number of threads used to prefetch the inputs of the next block, 0 disables. */
+static constexpr int DEFAULT_INPUT_PREFETCH_THREADS{4};
+
+/**
+ * Reads the coins spent by an upcoming block from the coins db on worker
+ * threads, so that ConnectBlock finds them in the coins cache instead of
+ * blocking on leveldb.
+ *
+ * Anon outputs referenced by ring members and the key images of anon inputs
+ * are read as well. They have no in-memory cache, reading them only pulls
+ * the records into leveldb's block cache and the OS page cache.
+ *
+ * Start() and Apply() must be called from the same thread, with cs_main held
+ * from one to the other so the databases can't be replaced or written to
+ * from under the workers.
+ */
+class InputPrefetcher
+{
+private:
+    std::thread m_thread;
+    uint64_t m_flush_count{0};
+
+    //! Written by the job thread only, read after it has been joined
+    std::vector<COutPoint> m_prevouts;
+    std::vector<Coin> m_coins;
+    std::vector<char> m_found;
+
+    void Run(FlatFilePos pos, const Consensus::Params& params, const CCoinsViewDB& coins_db, CBlockTreeDB& block_tree_db, int num_threads);
+
+public:
+    InputPrefetcher() = default;
+    ~InputPrefetcher();
+
+    InputPrefetcher(const InputPrefetcher&) = delete;
+    InputPrefetcher& operator=(const InputPrefetcher&) = delete;
+
+    /**
+     * Start reading the inputs of the block stored at pos, returns immediately.
+     * Any previous job is discarded.
+     */
+    void Start(const FlatFilePos& pos, const Consensus::Params& params, const CCoinsViewDB& coins_db, CBlockTreeDB& block_tree_db,
+               const CCoinsViewCache& coins_tip, int num_threads);
+
+    /**
+     * Wait for the running job and add the coins it found to coins_tip.
+     * Coins already in the cache are left untouched. Nothing is added if
+     * coins_tip was flushed since Start(), as the reads may predate the flush.
+     * Returns the number of coins added.
+     */
+    size_t Apply(CCoinsViewCache& coins_tip);
+
+    /** Wait for the running job, if any. */
+    void Wait();
+};
+} // namespace node
+
+#endif // GLOBE_NODE_INPUTPREFETCHER_H
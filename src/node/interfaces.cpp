@@ -8,6 +8,7 @@
 #include <chainparams.h>
 #include <deploymentstatus.h>
 #include <external_signer.h>
+#include <index/voteindex.h>
 #include <init.h>
 #include <interfaces/chain.h>
 #include <interfaces/handler.h>
@@ -852,6 +853,18 @@ public:
         LOCK(::cs_main);
         return m_node.chainman->m_blockman.m_block_tree_db->ReadRCTKeyImage(ki, ki_data);
     }
+    std::optional<int> countIndexedVotes(uint32_t vote_token, int height_start, int height_end) override
+    {
+        int num_votes = 0;
+        if (!ForEachActiveChainVote(chainman(), height_start, height_end, [&](int height, const VoteIndex::Entry& entry) {
+                if (entry.coinstake && entry.vote_token == vote_token) {
+                    num_votes++;
+                }
+            })) {
+            return std::nullopt;
+        }
+        return num_votes;
+    }
 };
 } // namespace
 } // namespace node
@@ -6,10 +6,54 @@
 #ifndef GLOBE_NODE_UTXO_SNAPSHOT_H
 #define GLOBE_NODE_UTXO_SNAPSHOT_H
 
+#include <consensus/amount.h>
 #include <uint256.h>
 #include <serialize.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace node {
+//! Version of the snapshot file format, see SnapshotChunk.
+static constexpr uint32_t SNAPSHOT_VERSION{2};
+
+//! Maximum number of items serialized into one SnapshotChunk.
+static constexpr uint32_t SNAPSHOT_CHUNK_ITEMS{50000};
+
+//! Maximum number of threads writing or loading a snapshot.
+static constexpr int MAX_SNAPSHOT_THREADS{8};
+
+//! Number of parts the coins are split into by the first byte of the txid,
+//! each part is read from the coins db by one thread while writing.
+static constexpr int SNAPSHOT_COIN_PARTS{16};
+
+//! Contents of a SnapshotChunk.
+enum SnapshotSection : uint8_t {
+    SNAPSHOT_END = 0,          //!< Last chunk of the file, has no items
+    SNAPSHOT_COINS = 1,        //!< COutPoint, Coin
+    SNAPSHOT_ANON_OUTPUTS = 2, //!< int64_t index, CAnonOutput
+    SNAPSHOT_KEY_IMAGES = 3,   //!< CCmpPubKey key image, CAnonKeyImageInfo
+    SNAPSHOT_SPENT_CACHE = 4,  //!< COutPoint, SpentCoin
+};
+
+/**
+ * A run of serialized items of one section of a snapshot.
+ *
+ * The snapshot file is the SnapshotMetadata followed by chunks. All
+ * SNAPSHOT_COINS chunks come first, then the RCT tables (Globe mode only),
+ * and the file ends with a SNAPSHOT_END chunk. Chunks are independent of
+ * each other, so they can be serialized and deserialized on several threads.
+ */
+class SnapshotChunk
+{
+public:
+    uint8_t m_section{SNAPSHOT_END};
+    uint32_t m_count{0};
+    std::vector<unsigned char> m_data;
+
+    SERIALIZE_METHODS(SnapshotChunk, obj) { READWRITE(obj.m_section, obj.m_count, obj.m_data); }
+};
+
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo Chainstate can be constructed.
 class SnapshotMetadata
@@ -23,6 +67,15 @@ public:
     //! during snapshot load to estimate progress of UTXO set reconstruction.
     uint64_t m_coins_count = 0;
 
+    //! Format version of the file, must be SNAPSHOT_VERSION.
+    uint32_t m_version = SNAPSHOT_VERSION;
+
+    //! The number of anon outputs (nAnonOutputs) and the money supply at the
+    //! base block, which are set in the block index as the blocks below the
+    //! snapshot are not connected.
+    int64_t m_anon_output_count = 0;
+    CAmount m_money_supply = 0;
+
     SnapshotMetadata() { }
     SnapshotMetadata(
         const uint256& base_blockhash,
@@ -31,7 +84,7 @@ public:
             m_base_blockhash(base_blockhash),
             m_coins_count(coins_count) { }
 
-    SERIALIZE_METHODS(SnapshotMetadata, obj) { READWRITE(obj.m_base_blockhash, obj.m_coins_count); }
+    SERIALIZE_METHODS(SnapshotMetadata, obj) { READWRITE(obj.m_base_blockhash, obj.m_coins_count, obj.m_version, obj.m_anon_output_count, obj.m_money_supply); }
 };
 } // namespace node
 
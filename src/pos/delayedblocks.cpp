@@ -0,0 +1,102 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos/delayedblocks.h>
+
+#include <primitives/block.h>
+#include <serialize.h>
+#include <version.h>
+
+#include <cassert>
+
+DelayedBlock::DelayedBlock(const std::shared_ptr<const CBlock>& pblock, int node_id, int64_t time)
+    : m_time(time), m_pblock(pblock), m_node_id(node_id)
+{
+    m_size = ::GetSerializeSize(*pblock, PROTOCOL_VERSION);
+}
+
+DelayedBlock DelayedBlockQueue::EraseBlock(std::unordered_map<uint256, DelayedBlock, BlockHasher>::iterator it)
+{
+    const uint256 block_hash = it->first;
+    DelayedBlock block = std::move(it->second);
+
+    auto range = m_children.equal_range(block.m_pblock->hashPrevBlock);
+    for (auto c = range.first; c != range.second; ++c) {
+        if (c->second == block_hash) {
+            m_children.erase(c);
+            break;
+        }
+    }
+    m_by_time.erase({block.m_time, block_hash});
+    assert(m_total_size >= block.m_size);
+    m_total_size -= block.m_size;
+    m_blocks.erase(it);
+    return block;
+}
+
+bool DelayedBlockQueue::Insert(const std::shared_ptr<const CBlock>& pblock, int node_id, int64_t time)
+{
+    const uint256 block_hash = pblock->GetHash();
+    auto ret = m_blocks.emplace(block_hash, DelayedBlock(pblock, node_id, time));
+    if (!ret.second) {
+        return false;
+    }
+    m_children.emplace(pblock->hashPrevBlock, block_hash);
+    m_by_time.emplace(time, block_hash);
+    m_total_size += ret.first->second.m_size;
+    return true;
+}
+
+std::optional<DelayedBlock> DelayedBlockQueue::Erase(const uint256& block_hash)
+{
+    auto it = m_blocks.find(block_hash);
+    if (it == m_blocks.end()) {
+        return std::nullopt;
+    }
+    return EraseBlock(it);
+}
+
+std::vector<DelayedBlock> DelayedBlockQueue::TakeChildren(const uint256& prev_hash)
+{
+    std::vector<uint256> child_hashes;
+    auto range = m_children.equal_range(prev_hash);
+    for (auto c = range.first; c != range.second; ++c) {
+        child_hashes.push_back(c->second);
+    }
+
+    std::vector<DelayedBlock> children;
+    for (const auto& child_hash : child_hashes) {
+        if (auto block = Erase(child_hash)) {
+            children.push_back(std::move(*block));
+        }
+    }
+    return children;
+}
+
+std::optional<DelayedBlock> DelayedBlockQueue::TakeOldest()
+{
+    if (m_by_time.empty()) {
+        return std::nullopt;
+    }
+    return Erase(m_by_time.begin()->second);
+}
+
+std::vector<DelayedBlock> DelayedBlockQueue::TakeExpired(int64_t cutoff_time)
+{
+    std::vector<DelayedBlock> expired;
+    while (!m_by_time.empty() && m_by_time.begin()->first < cutoff_time) {
+        expired.push_back(*Erase(m_by_time.begin()->second));
+    }
+    return expired;
+}
+
+std::vector<DelayedBlock> DelayedBlockQueue::GetAll() const
+{
+    std::vector<DelayedBlock> blocks;
+    blocks.reserve(m_blocks.size());
+    for (const auto& entry : m_by_time) {
+        blocks.push_back(m_blocks.at(entry.second));
+    }
+    return blocks;
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_POS_DELAYEDBLOCKS_H
+#define GLOBE_POS_DELAYEDBLOCKS_H
+
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class CBlock;
+
+class DelayedBlock
+{
+public:
+    DelayedBlock(const std::shared_ptr<const CBlock>& pblock, int node_id, int64_t time);
+    int64_t m_time;
+    std::shared_ptr<const CBlock> m_pblock;
+    int m_node_id;
+    size_t m_size; // Serialized size of the block
+};
+
+/**
+ * Proof of stake blocks received before their parent's stake modifier is
+ * known, waiting for the parent to be connected.
+ *
+ * Blocks are indexed by their own hash, by their parent's hash so the
+ * children of a newly connected block are found without a scan, and by
+ * arrival time for expiry and eviction.
+ * Not thread safe, callers must provide their own locking.
+ */
+class DelayedBlockQueue
+{
+private:
+    std::unordered_map<uint256, DelayedBlock, BlockHasher> m_blocks;
+    std::unordered_multimap<uint256, uint256, BlockHasher> m_children;
+    std::set<std::pair<int64_t, uint256>> m_by_time;
+    size_t m_total_size{0};
+
+    DelayedBlock EraseBlock(std::unordered_map<uint256, DelayedBlock, BlockHasher>::iterator it);
+
+public:
+    bool Have(const uint256& block_hash) const { return m_blocks.count(block_hash); }
+
+    /** Add a block, returns false if it is already queued. */
+    bool Insert(const std::shared_ptr<const CBlock>& pblock, int node_id, int64_t time);
+
+    /** Remove and return the block with block_hash. */
+    std::optional<DelayedBlock> Erase(const uint256& block_hash);
+
+    /** Remove and return all blocks building on prev_hash. */
+    std::vector<DelayedBlock> TakeChildren(const uint256& prev_hash);
+
+    /** Remove and return the block that arrived first. */
+    std::optional<DelayedBlock> TakeOldest();
+
+    /** Remove and return all blocks that arrived before cutoff_time. */
+    std::vector<DelayedBlock> TakeExpired(int64_t cutoff_time);
+
+    /** Return all blocks, oldest first. */
+    std::vector<DelayedBlock> GetAll() const;
+
+    size_t Size() const { return m_blocks.size(); }
+    size_t TotalSize() const { return m_total_size; }
+    bool Empty() const { return m_blocks.empty(); }
+};
+
+#endif // GLOBE_POS_DELAYEDBLOCKS_H
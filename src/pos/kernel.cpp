@@ -21,66 +21,6 @@
 #include <node/transaction.h>
 #include <validation.h>
 
-/* Calculate the difficulty for a given block index.
- * Duplicated from rpc/blockchain.cpp for linking
- */
-static double GetDifficulty(const CBlockIndex* blockindex)
-{
-    CHECK_NONFATAL(blockindex);
-
-    int nShift = (blockindex->nBits >> 24) & 0xff;
-    double dDiff =
-        (double)0x0000ffff / (double)(blockindex->nBits & 0x00ffffff);
-
-    while (nShift < 29)
-    {
-        dDiff *= 256.0;
-        nShift++;
-    }
-    while (nShift > 29)
-    {
-        dDiff /= 256.0;
-        nShift--;
-    }
-
-    return dDiff;
-}
-
-double GetPoSKernelPS(CBlockIndex *pindex)
-{
-    LOCK(cs_main);
-
-    CBlockIndex *pindexPrevStake = nullptr;
-
-    int nBestHeight = pindex->nHeight;
-
-    int nPoSInterval = 72; // blocks sampled
-    double dStakeKernelsTriedAvg = 0;
-    int nStakesHandled = 0, nStakesTime = 0;
-
-    while (pindex && nStakesHandled < nPoSInterval) {
-        if (pindex->IsProofOfStake()) {
-            if (pindexPrevStake) {
-                dStakeKernelsTriedAvg += GetDifficulty(pindexPrevStake) * 4294967296.0;
-                nStakesTime += pindexPrevStake->nTime - pindex->nTime;
-                nStakesHandled++;
-            }
-            pindexPrevStake = pindex;
-        }
-        pindex = pindex->pprev;
-    }
-
-    double result = 0;
-
-    if (nStakesTime) {
-        result = dStakeKernelsTriedAvg / nStakesTime;
-    }
-
-    result *= Params().GetStakeTimestampMask(nBestHeight) + 1;
-
-    return result;
-}
-
 /**
  * Stake Modifier (hash modifier of proof-of-stake):
  * The purpose of stake modifier is to prevent a txout (coin) owner from
@@ -93,8 +33,13 @@ uint256 ComputeStakeModifierV2(const CBlockIndex *pindexPrev, const uint256 &ker
     if (!pindexPrev)
         return uint256();  // genesis block's modifier is 0
 
+    return ComputeStakeModifierV2(pindexPrev->bnStakeModifier, kernel);
+}
+
+uint256 ComputeStakeModifierV2(const uint256 &prev_modifier, const uint256 &kernel)
+{
     CDataStream ss(SER_GETHASH, 0);
-    ss << kernel << pindexPrev->bnStakeModifier;
+    ss << kernel << prev_modifier;
     return Hash(ss);
 }
 
@@ -121,11 +66,10 @@ uint256 ComputeStakeModifierV2(const CBlockIndex *pindexPrev, const uint256 &ker
  *   quantities so as to generate blocks faster, degrading the system back into
  *   a proof-of-work situation.
  */
-bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
+bool CheckStakeKernelHash(const uint256 &bnStakeModifier,
     uint32_t nBits, uint32_t nBlockFromTime,
     CAmount prevOutAmount, const COutPoint &prevout, uint32_t nTime,
-    uint256 &hashProofOfStake, uint256 &targetProofOfStake,
-    bool fPrintProofOfStake)
+    uint256 &hashProofOfStake, uint256 &targetProofOfStake)
 {
     // CheckStakeKernelHashV2
 
@@ -149,15 +93,28 @@ bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
 
     targetProofOfStake = ArithToUint256(bnTarget);
 
-    const uint256 &bnStakeModifier = pindexPrev->bnStakeModifier;
-    int nStakeModifierHeight = pindexPrev->nHeight;
-    int64_t nStakeModifierTime = pindexPrev->nTime;
-
     CDataStream ss(SER_GETHASH, 0);
     ss << bnStakeModifier;
     ss << nBlockFromTime << prevout.hash << prevout.n << nTime;
     hashProofOfStake = Hash(ss);
 
+    // Now check if proof-of-stake hash meets target protocol
+    return UintToArith256(hashProofOfStake) <= bnTarget;
+}
+
+bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
+    uint32_t nBits, uint32_t nBlockFromTime,
+    CAmount prevOutAmount, const COutPoint &prevout, uint32_t nTime,
+    uint256 &hashProofOfStake, uint256 &targetProofOfStake,
+    bool fPrintProofOfStake)
+{
+    const uint256 &bnStakeModifier = pindexPrev->bnStakeModifier;
+    int nStakeModifierHeight = pindexPrev->nHeight;
+    int64_t nStakeModifierTime = pindexPrev->nTime;
+
+    bool passed = CheckStakeKernelHash(bnStakeModifier, nBits, nBlockFromTime,
+        prevOutAmount, prevout, nTime, hashProofOfStake, targetProofOfStake);
+
     if (fPrintProofOfStake) {
         LogPrintf("%s: using modifier=%s at height=%d timestamp=%s\n",
             __func__, bnStakeModifier.ToString(), nStakeModifierHeight,
@@ -168,8 +125,7 @@ bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
             hashProofOfStake.ToString());
     }
 
-    // Now check if proof-of-stake hash meets target protocol
-    if (UintToArith256(hashProofOfStake) > bnTarget) {
+    if (!passed) {
         return false;
     }
 
@@ -186,6 +142,14 @@ bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
     return true;
 }
 
+uint256 GetStakeCheckKey(const CTransaction &tx, const CScript &kernelPubKey, CAmount amount,
+    const uint256 &bnStakeModifier, uint32_t nBlockFromTime, unsigned int nBits, uint32_t nTime)
+{
+    HashWriter hasher{};
+    hasher << tx.GetWitnessHash() << kernelPubKey << amount << bnStakeModifier << nBlockFromTime << nBits << nTime;
+    return hasher.GetHash();
+}
+
 bool GetKernelInfo(const CBlockIndex *blockindex, const CTransaction &tx, uint256 &hash, CAmount &value, CScript &script, uint256 &blockhash)
 {
     if (!blockindex->pprev) {
@@ -283,21 +247,27 @@ bool CheckProofOfStake(Chainstate &chain_state, BlockValidationState &state, con
     amount = coin.out.nValue;
     nBlockFromTime = pindex->GetBlockTime();
 
-    const CScript &scriptSig = txin.scriptSig;
-    const CScriptWitness *witness = &txin.scriptWitness;
-    ScriptError serror = SCRIPT_ERR_OK;
-    std::vector<uint8_t> vchAmount(8);
-    part::SetAmount(vchAmount, amount);
-    // Redundant: all inputs are checked later during CheckInputs
-    if (!VerifyScript(scriptSig, kernelPubKey, witness, STANDARD_SCRIPT_VERIFY_FLAGS, TransactionSignatureChecker(&tx, 0, vchAmount, MissingDataBehavior::FAIL), &serror)) {
-        LogPrintf("ERROR: %s: verify-script-failed, txn %s, reason %s\n", __func__, tx.GetHash().ToString(), ScriptErrorString(serror));
-        return state.Invalid(BlockValidationResult::DOS_100, "verify-cs-script-failed");
-    }
+    // Skip the signature and kernel hash checks if they passed ahead of time
+    const uint256 stake_check_key = GetStakeCheckKey(tx, kernelPubKey, amount, pindexPrev->bnStakeModifier, nBlockFromTime, nBits, nTime);
+    if (!chain_state.m_stake_prechecker.Take(stake_check_key, hashProofOfStake, targetProofOfStake)) {
+        const CScript &scriptSig = txin.scriptSig;
+        const CScriptWitness *witness = &txin.scriptWitness;
+        ScriptError serror = SCRIPT_ERR_OK;
+        std::vector<uint8_t> vchAmount(8);
+        part::SetAmount(vchAmount, amount);
+        // Redundant: all inputs are checked later during CheckInputs
+        if (!VerifyScript(scriptSig, kernelPubKey, witness, STANDARD_SCRIPT_VERIFY_FLAGS, TransactionSignatureChecker(&tx, 0, vchAmount, MissingDataBehavior::FAIL), &serror)) {
+            LogPrintf("ERROR: %s: verify-script-failed, txn %s, reason %s\n", __func__, tx.GetHash().ToString(), ScriptErrorString(serror));
+            return state.Invalid(BlockValidationResult::DOS_100, "verify-cs-script-failed");
+        }
 
-    if (!CheckStakeKernelHash(pindexPrev, nBits, nBlockFromTime,
-        amount, txin.prevout, nTime, hashProofOfStake, targetProofOfStake, LogAcceptCategory(BCLog::POS, BCLog::Level::Debug))) {
-        LogPrintf("WARNING: %s: Check kernel failed on coinstake %s, hashProof=%s\n", __func__, tx.GetHash().ToString(), hashProofOfStake.ToString());
-        return state.Invalid(BlockValidationResult::DOS_1, "check-kernel-failed");
+        if (!CheckStakeKernelHash(pindexPrev, nBits, nBlockFromTime,
+            amount, txin.prevout, nTime, hashProofOfStake, targetProofOfStake, LogAcceptCategory(BCLog::POS, BCLog::Level::Debug))) {
+            LogPrintf("WARNING: %s: Check kernel failed on coinstake %s, hashProof=%s\n", __func__, tx.GetHash().ToString(), hashProofOfStake.ToString());
+            return state.Invalid(BlockValidationResult::DOS_1, "check-kernel-failed");
+        }
+    } else {
+        LogPrint(BCLog::POS, "%s: Using the precheck of coinstake %s\n", __func__, tx.GetHash().ToString());
     }
 
     // Ensure the input scripts all match and that the total output value to the input script is not less than the total input value.
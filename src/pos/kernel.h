@@ -23,12 +23,11 @@ class BlockValidationState;
 
 static const int MAX_REORG_DEPTH = 1024;
 
-double GetPoSKernelPS(CBlockIndex *pindex);
-
 /**
  * Compute the hash modifier for proof-of-stake
  */
 uint256 ComputeStakeModifierV2(const CBlockIndex *pindexPrev, const uint256 &kernel);
+uint256 ComputeStakeModifierV2(const uint256 &prev_modifier, const uint256 &kernel);
 
 /**
  * Check whether stake kernel meets hash target
@@ -40,6 +39,23 @@ bool CheckStakeKernelHash(const CBlockIndex *pindexPrev,
     uint256 &hashProofOfStake, uint256 &targetProofOfStake,
     bool fPrintProofOfStake=false);
 
+/**
+ * Check whether stake kernel meets hash target, with the stake modifier of
+ * the previous block given directly
+ * Sets hashProofOfStake on success return
+ */
+bool CheckStakeKernelHash(const uint256 &bnStakeModifier,
+    uint32_t nBits, uint32_t nBlockFromTime,
+    CAmount prevOutAmount, const COutPoint &prevout, uint32_t nTimeTx,
+    uint256 &hashProofOfStake, uint256 &targetProofOfStake);
+
+/**
+ * Hash of everything the coinstake signature and kernel hash checks of
+ * CheckProofOfStake depend on, identifies a check that passed ahead of time
+ */
+uint256 GetStakeCheckKey(const CTransaction &tx, const CScript &kernelPubKey, CAmount amount,
+    const uint256 &bnStakeModifier, uint32_t nBlockFromTime, unsigned int nBits, uint32_t nTime);
+
 /**
  * Get kernel hash and value for blockindex and coinstake tx
  */
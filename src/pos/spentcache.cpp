@@ -0,0 +1,192 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos/spentcache.h>
+
+#include <algorithm>
+
+void SpentCoinCache::FilterBucket(uint32_t height)
+{
+    AssertLockHeld(m_mutex);
+    auto it = m_buckets.find(height);
+    if (it == m_buckets.end()) {
+        return;
+    }
+    auto& outpoints = it->second;
+    outpoints.erase(std::remove_if(outpoints.begin(), outpoints.end(), [&](const COutPoint& outpoint) {
+        auto mi = m_coins.find(outpoint);
+        return mi == m_coins.end() || mi->second.spent_height != height;
+    }), outpoints.end());
+    if (outpoints.empty()) {
+        m_buckets.erase(it);
+    }
+}
+
+std::set<uint32_t> SpentCoinCache::Add(const std::vector<std::pair<COutPoint, SpentCoin>>& coins)
+{
+    LOCK(m_mutex);
+    std::set<uint32_t> changed, moved_from;
+    for (const auto& [outpoint, spent_coin] : coins) {
+        auto [it, inserted] = m_coins.emplace(outpoint, spent_coin);
+        if (!inserted) {
+            if (it->second.spent_height == spent_coin.spent_height) {
+                it->second = spent_coin;
+                changed.insert(spent_coin.spent_height);
+                continue;
+            }
+            moved_from.insert(it->second.spent_height);
+            it->second = spent_coin;
+        }
+        m_buckets[spent_coin.spent_height].push_back(outpoint);
+        changed.insert(spent_coin.spent_height);
+    }
+    for (uint32_t height : moved_from) {
+        FilterBucket(height);
+        changed.insert(height);
+    }
+    return changed;
+}
+
+std::set<uint32_t> SpentCoinCache::Remove(const std::vector<std::pair<COutPoint, SpentCoin>>& coins)
+{
+    LOCK(m_mutex);
+    std::set<uint32_t> changed;
+    for (const auto& entry : coins) {
+        auto it = m_coins.find(entry.first);
+        if (it == m_coins.end()) {
+            continue;
+        }
+        changed.insert(it->second.spent_height);
+        m_coins.erase(it);
+    }
+    for (uint32_t height : changed) {
+        FilterBucket(height);
+    }
+    return changed;
+}
+
+std::vector<uint32_t> SpentCoinCache::Drop(uint32_t from_height, uint32_t to_height)
+{
+    LOCK(m_mutex);
+    std::vector<uint32_t> dropped;
+    if (from_height >= to_height) {
+        return dropped;
+    }
+    auto begin = m_buckets.lower_bound(from_height);
+    auto end = m_buckets.lower_bound(to_height);
+    for (auto it = begin; it != end; ++it) {
+        for (const auto& outpoint : it->second) {
+            m_coins.erase(outpoint);
+        }
+        dropped.push_back(it->first);
+    }
+    m_buckets.erase(begin, end);
+    return dropped;
+}
+
+void SpentCoinCache::Apply(const SpentCoinCacheUpdate& update)
+{
+    Remove(update.remove);
+    Add(update.add);
+    Drop(update.drop_from, update.drop_to);
+}
+
+std::map<uint32_t, std::vector<std::pair<COutPoint, Coin>>> SpentCoinCache::GetChangedBuckets(const SpentCoinCacheUpdate& update) const
+{
+    LOCK(m_mutex);
+    const auto dropped = [&](uint32_t height) {
+        return height >= update.drop_from && height < update.drop_to;
+    };
+
+    // The state of each outpoint update touches once applied, nullptr if removed
+    std::map<COutPoint, const SpentCoin*> changed;
+    for (const auto& entry : update.remove) {
+        changed[entry.first] = nullptr;
+    }
+    for (const auto& [outpoint, spent_coin] : update.add) {
+        changed[outpoint] = &spent_coin;
+    }
+
+    std::set<uint32_t> heights;
+    for (const auto& [outpoint, spent_coin] : changed) {
+        auto it = m_coins.find(outpoint);
+        if (it != m_coins.end()) {
+            heights.insert(it->second.spent_height);
+        }
+        if (spent_coin) {
+            heights.insert(spent_coin->spent_height);
+        }
+    }
+    if (update.drop_from < update.drop_to) {
+        for (auto it = m_buckets.lower_bound(update.drop_from); it != m_buckets.end() && it->first < update.drop_to; ++it) {
+            heights.insert(it->first);
+        }
+    }
+
+    std::map<uint32_t, std::vector<std::pair<COutPoint, Coin>>> buckets;
+    for (uint32_t height : heights) {
+        auto& bucket = buckets[height];
+        auto it = m_buckets.find(height);
+        if (dropped(height) || it == m_buckets.end()) {
+            continue;
+        }
+        for (const auto& outpoint : it->second) {
+            // Changed coins are added below
+            if (!changed.count(outpoint)) {
+                bucket.emplace_back(outpoint, m_coins.at(outpoint).coin);
+            }
+        }
+    }
+    for (const auto& [outpoint, spent_coin] : changed) {
+        if (spent_coin && !dropped(spent_coin->spent_height)) {
+            buckets[spent_coin->spent_height].emplace_back(outpoint, spent_coin->coin);
+        }
+    }
+    return buckets;
+}
+
+bool SpentCoinCache::Get(const COutPoint& outpoint, SpentCoin& coin) const
+{
+    LOCK(m_mutex);
+    auto it = m_coins.find(outpoint);
+    if (it == m_coins.end()) {
+        return false;
+    }
+    coin = it->second;
+    return true;
+}
+
+std::vector<std::pair<COutPoint, Coin>> SpentCoinCache::GetBucket(uint32_t height) const
+{
+    LOCK(m_mutex);
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    auto it = m_buckets.find(height);
+    if (it == m_buckets.end()) {
+        return coins;
+    }
+    coins.reserve(it->second.size());
+    for (const auto& outpoint : it->second) {
+        coins.emplace_back(outpoint, m_coins.at(outpoint).coin);
+    }
+    return coins;
+}
+
+std::vector<std::pair<COutPoint, SpentCoin>> SpentCoinCache::GetAll() const
+{
+    LOCK(m_mutex);
+    std::vector<std::pair<COutPoint, SpentCoin>> coins;
+    coins.reserve(m_coins.size());
+    for (const auto& [height, outpoints] : m_buckets) {
+        for (const auto& outpoint : outpoints) {
+            coins.emplace_back(outpoint, m_coins.at(outpoint));
+        }
+    }
+    return coins;
+}
+
+size_t SpentCoinCache::Size() const
+{
+    LOCK(m_mutex);
+    return m_coins.size();
+}
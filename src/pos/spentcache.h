@@ -0,0 +1,81 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_POS_SPENTCACHE_H
+#define GLOBE_POS_SPENTCACHE_H
+
+#include <coins.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** Changes to the spent cache, written to the database before they are applied in memory. */
+struct SpentCoinCacheUpdate
+{
+    std::vector<std::pair<COutPoint, SpentCoin>> add;
+    //! Only the outpoints are used
+    std::vector<std::pair<COutPoint, SpentCoin>> remove;
+    //! Drop the buckets from drop_from up to but not including drop_to
+    uint32_t drop_from{0};
+    uint32_t drop_to{0};
+};
+
+/**
+ * The recently spent coins, kept so stakes with kernels spent near the tip
+ * can be checked.
+ *
+ * Coins are bucketed by the height they were spent at. Each bucket is
+ * persisted as one record, so the coins spent by a block are written at once
+ * and dropped at once when the block falls out of the window.
+ */
+class SpentCoinCache
+{
+private:
+    mutable Mutex m_mutex;
+    //! Outpoints spent at each height
+    std::map<uint32_t, std::vector<COutPoint>> m_buckets GUARDED_BY(m_mutex);
+    std::unordered_map<COutPoint, SpentCoin, SaltedOutpointHasher> m_coins GUARDED_BY(m_mutex);
+
+    /** Remove the outpoints no longer spent at height from its bucket. */
+    void FilterBucket(uint32_t height) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+public:
+    /** Add coins to the buckets of their spent heights, returns the heights of the buckets changed. */
+    std::set<uint32_t> Add(const std::vector<std::pair<COutPoint, SpentCoin>>& coins) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Remove the outpoints of coins, returns the heights of the buckets changed. */
+    std::set<uint32_t> Remove(const std::vector<std::pair<COutPoint, SpentCoin>>& coins) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Drop the buckets from from_height up to but not including to_height, returns their heights. */
+    std::vector<uint32_t> Drop(uint32_t from_height, uint32_t to_height) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Remove, add, then drop the buckets of update. */
+    void Apply(const SpentCoinCacheUpdate& update) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * The contents every bucket changed by update would have once it is
+     * applied, empty for the buckets it would erase. The cache is unchanged.
+     */
+    std::map<uint32_t, std::vector<std::pair<COutPoint, Coin>>> GetChangedBuckets(const SpentCoinCacheUpdate& update) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    bool Get(const COutPoint& outpoint, SpentCoin& coin) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** The coins of the bucket at height, the spent height is implied. */
+    std::vector<std::pair<COutPoint, Coin>> GetBucket(uint32_t height) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Every coin, ordered by spent height. */
+    std::vector<std::pair<COutPoint, SpentCoin>> GetAll() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+#endif // GLOBE_POS_SPENTCACHE_H
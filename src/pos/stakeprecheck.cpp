@@ -0,0 +1,245 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos/stakeprecheck.h>
+
+#include <chain.h>
+#include <coins.h>
+#include <flatfile.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <policy/policy.h>
+#include <pos/kernel.h>
+#include <primitives/block.h>
+#include <script/interpreter.h>
+#include <serialize.h>
+#include <txdb.h>
+#include <util/parallel.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <map>
+
+namespace {
+/** The stake of one block of the window. */
+struct StakeCheck {
+    size_t block_pos; // Position of the block in the window
+    uint256 prev_modifier;
+    CScript kernel_script;
+    CAmount amount{0};
+    int coin_height{-1};
+    bool resolved{false};
+    bool passed{false};
+    uint256 key;
+    uint256 hash_proof;
+    uint256 target;
+};
+} // namespace
+
+void StakePrechecker::Run(Chainstate& chainstate, const std::vector<CBlockIndex*>& blocks, int num_threads)
+{
+    AssertLockHeld(cs_main);
+    const CBlockIndex* tip = chainstate.m_chain.Tip();
+    if (blocks.empty() || !tip || blocks.back()->pprev != tip) {
+        return;
+    }
+    {
+        LOCK(m_mutex);
+        const CBlockIndex* next = blocks.back();
+        if (m_last && m_last->GetAncestor(next->nHeight) == next) {
+            return;
+        }
+        if (m_passed.size() > MAX_STAKE_PRECHECKS) {
+            // Checks of blocks that were never connected
+            m_passed.clear();
+        }
+    }
+
+    const Consensus::Params& params = chainstate.m_params.GetConsensus();
+    std::vector<const CBlockIndex*> window(blocks.rbegin(), blocks.rend());
+    std::vector<FlatFilePos> positions;
+    for (const CBlockIndex* pindex : window) {
+        positions.push_back(pindex->GetBlockPos());
+    }
+
+    std::vector<std::shared_ptr<CBlock>> block_data(window.size());
+    std::vector<char> read_ok(window.size(), 0);
+    util::ParallelFor(window.size(), num_threads, [&](size_t i) {
+        block_data[i] = std::make_shared<CBlock>();
+        read_ok[i] = node::ReadBlockFromDisk(*block_data[i], positions[i], params);
+        return true;
+    });
+
+    // Chain the stake modifiers through the window the way ConnectBlock sets
+    // them, and collect the outputs the window creates. The window ends at
+    // the first block that couldn't be read.
+    std::vector<StakeCheck> checks;
+    std::map<uint256, size_t> window_txs;
+    uint256 modifier = tip->bnStakeModifier;
+    size_t num_blocks = 0;
+    for (; num_blocks < window.size() && read_ok[num_blocks]; ++num_blocks) {
+        const CBlock& block = *block_data[num_blocks];
+        if (block.IsProofOfStake()) {
+            StakeCheck check;
+            check.block_pos = num_blocks;
+            check.prev_modifier = modifier;
+            checks.push_back(std::move(check));
+            modifier = ComputeStakeModifierV2(modifier, block.vtx[0]->vin[0].prevout.hash);
+        } else {
+            modifier = uint256();
+        }
+        for (const auto& tx : block.vtx) {
+            window_txs.emplace(tx->GetHash(), num_blocks);
+        }
+    }
+    if (num_blocks == 0) {
+        return;
+    }
+    {
+        LOCK(m_mutex);
+        m_blocks.clear();
+        for (size_t i = 0; i < num_blocks; ++i) {
+            m_blocks.emplace_back(window[i], block_data[i]);
+        }
+        if (checks.empty()) {
+            m_last = window[num_blocks - 1];
+            return;
+        }
+    }
+
+    // Kernels in the coins cache can only be read here
+    const CCoinsViewCache& coins_tip = chainstate.CoinsTip();
+    for (auto& check : checks) {
+        const COutPoint& kernel = block_data[check.block_pos]->vtx[0]->vin[0].prevout;
+        if (!coins_tip.HaveCoinInCache(kernel)) {
+            continue;
+        }
+        const Coin& coin = coins_tip.AccessCoin(kernel);
+        if (!coin.IsSpent() && coin.nType == OUTPUT_STANDARD) {
+            check.kernel_script = coin.out.scriptPubKey;
+            check.amount = coin.out.nValue;
+            check.coin_height = coin.nHeight;
+            check.resolved = true;
+        }
+    }
+
+    const CCoinsViewDB& coins_db = chainstate.CoinsDB();
+    CBlockTreeDB& block_tree_db = *chainstate.m_blockman.m_block_tree_db;
+    util::ParallelFor(checks.size(), num_threads, [&](size_t i) {
+        StakeCheck& check = checks[i];
+        const CBlock& block = *block_data[check.block_pos];
+        const CTransaction& tx = *block.vtx[0];
+        const COutPoint& kernel = tx.vin[0].prevout;
+
+        try {
+            if (!check.resolved) {
+                auto it = window_txs.find(kernel.hash);
+                if (it != window_txs.end()) {
+                    // Created by an earlier block of the window
+                    if (it->second >= check.block_pos) {
+                        return true;
+                    }
+                    const CBlock& block_from = *block_data[it->second];
+                    for (const auto& txn : block_from.vtx) {
+                        if (txn->GetHash() != kernel.hash) {
+                            continue;
+                        }
+                        if (kernel.n < txn->vpout.size() && txn->vpout[kernel.n]->IsStandardOutput()) {
+                            check.kernel_script = *txn->vpout[kernel.n]->GetPScriptPubKey();
+                            check.amount = txn->vpout[kernel.n]->GetValue();
+                            check.coin_height = window[it->second]->nHeight;
+                            check.resolved = true;
+                        }
+                        break;
+                    }
+                } else {
+                    Coin coin;
+                    SpentCoin spent_coin;
+                    if (!coins_db.GetCoin(kernel, coin) || coin.IsSpent()) {
+                        if (!block_tree_db.ReadSpentCache(kernel, spent_coin)) {
+                            return true;
+                        }
+                        coin = spent_coin.coin;
+                    }
+                    if (coin.nType == OUTPUT_STANDARD) {
+                        check.kernel_script = coin.out.scriptPubKey;
+                        check.amount = coin.out.nValue;
+                        check.coin_height = coin.nHeight;
+                        check.resolved = true;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            // Errors are reported when CheckProofOfStake reads the same records
+            LogPrint(BCLog::POS, "%s: %s\n", __func__, e.what());
+            return true;
+        }
+        if (!check.resolved) {
+            return true;
+        }
+
+        const CBlockIndex* pindex_from = check.coin_height <= tip->nHeight ?
+            chainstate.m_chain[check.coin_height] : window[check.coin_height - tip->nHeight - 1];
+        if (!pindex_from) {
+            return true;
+        }
+        const uint32_t block_from_time = pindex_from->GetBlockTime();
+
+        std::vector<uint8_t> vchAmount(8);
+        part::SetAmount(vchAmount, check.amount);
+        if (!VerifyScript(tx.vin[0].scriptSig, check.kernel_script, &tx.vin[0].scriptWitness, STANDARD_SCRIPT_VERIFY_FLAGS,
+                          TransactionSignatureChecker(&tx, 0, vchAmount, MissingDataBehavior::FAIL))) {
+            return true;
+        }
+        if (!CheckStakeKernelHash(check.prev_modifier, block.nBits, block_from_time, check.amount, kernel, block.nTime,
+                                  check.hash_proof, check.target)) {
+            return true;
+        }
+        check.key = GetStakeCheckKey(tx, check.kernel_script, check.amount, check.prev_modifier, block_from_time, block.nBits, block.nTime);
+        check.passed = true;
+        return true;
+    });
+
+    size_t num_passed = 0;
+    LOCK(m_mutex);
+    for (const auto& check : checks) {
+        if (check.passed) {
+            m_passed[check.key] = {check.hash_proof, check.target};
+            num_passed++;
+        }
+    }
+    m_last = window[num_blocks - 1];
+    LogPrint(BCLog::POS, "%s: %u of %u stakes passed, blocks %d to %d\n", __func__, num_passed, checks.size(), window.front()->nHeight, m_last->nHeight);
+}
+
+bool StakePrechecker::Take(const uint256& key, uint256& hash_proof, uint256& target)
+{
+    LOCK(m_mutex);
+    auto it = m_passed.find(key);
+    if (it == m_passed.end()) {
+        return false;
+    }
+    hash_proof = it->second.first;
+    target = it->second.second;
+    m_passed.erase(it);
+    return true;
+}
+
+size_t StakePrechecker::Size() const
+{
+    LOCK(m_mutex);
+    return m_passed.size();
+}
+
+std::shared_ptr<const CBlock> StakePrechecker::TakeBlock(const CBlockIndex* pindex)
+{
+    LOCK(m_mutex);
+    auto it = std::find_if(m_blocks.begin(), m_blocks.end(), [&](const auto& entry) { return entry.first == pindex; });
+    if (it == m_blocks.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<const CBlock> block = std::move(it->second);
+    m_blocks.erase(m_blocks.begin(), it + 1);
+    return block;
+}
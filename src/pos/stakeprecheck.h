@@ -0,0 +1,77 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_POS_STAKEPRECHECK_H
+#define GLOBE_POS_STAKEPRECHECK_H
+
+#include <sync.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern RecursiveMutex cs_main;
+
+class CBlock;
+class CBlockIndex;
+class Chainstate;
+
+/** Default number of threads checking the stakes of the blocks ahead of the tip during IBD, 0 disables. */
+static constexpr int DEFAULT_STAKE_PRECHECK_THREADS{4};
+
+/** Maximum number of checks kept waiting for their block to be connected. */
+static constexpr size_t MAX_STAKE_PRECHECKS{1024};
+
+/**
+ * Checks the coinstake signatures and kernel hashes of a window of blocks
+ * ahead of the tip on several threads, so ConnectBlock doesn't have to run
+ * the checks one block at a time.
+ *
+ * Kernels are found in the coins db, the spent cache, or in the outputs of
+ * earlier blocks of the window. The stake modifiers are chained through the
+ * window from the tip. Only the checks that pass are kept, keyed by
+ * GetStakeCheckKey(), so CheckProofOfStake reuses a result only if every
+ * input of the check is unchanged and runs the check itself otherwise.
+ *
+ * The blocks read for the window are kept until they are connected, so
+ * ConnectTip doesn't read them from disk again.
+ */
+class StakePrechecker
+{
+private:
+    mutable Mutex m_mutex;
+    std::unordered_map<uint256, std::pair<uint256, uint256>, SaltedTxidHasher> m_passed GUARDED_BY(m_mutex);
+    //! Last block of the most recent window
+    const CBlockIndex* m_last GUARDED_BY(m_mutex){nullptr};
+    //! Blocks of the most recent window not taken yet, in ascending height order
+    std::vector<std::pair<const CBlockIndex*, std::shared_ptr<const CBlock>>> m_blocks GUARDED_BY(m_mutex);
+
+public:
+    /**
+     * Check the stakes of blocks, the blocks to connect next in descending
+     * height order ending at a child of the tip of chainstate. Does nothing
+     * if the lowest block was part of the previous window.
+     */
+    void Run(Chainstate& chainstate, const std::vector<CBlockIndex*>& blocks, int num_threads) EXCLUSIVE_LOCKS_REQUIRED(cs_main, !m_mutex);
+
+    /**
+     * If a check with key passed, set the kernel hash and target it produced,
+     * forget the check and return true.
+     */
+    bool Take(const uint256& key, uint256& hash_proof, uint256& target) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Return the block read for pindex by the most recent window, or nullptr.
+     * The block and the blocks of the window below it are forgotten.
+     */
+    std::shared_ptr<const CBlock> TakeBlock(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+#endif // GLOBE_POS_STAKEPRECHECK_H
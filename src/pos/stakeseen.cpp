@@ -0,0 +1,74 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos/stakeseen.h>
+
+#include <cassert>
+
+SeenStakeKernels::SeenStakeKernels(size_t max_size) : m_max_size(max_size)
+{
+    assert(m_max_size > 0);
+    m_kernels.reserve(m_max_size);
+    m_ring.reserve(m_max_size);
+}
+
+void SeenStakeKernels::InsertNew(const COutPoint& kernel, const uint256& block_hash)
+{
+    if (m_ring.size() < m_max_size) {
+        m_ring.push_back(kernel);
+    } else {
+        m_kernels.erase(m_ring[m_ring_pos]);
+        m_ring[m_ring_pos] = kernel;
+        m_ring_pos = (m_ring_pos + 1) % m_max_size;
+    }
+    m_kernels.emplace(kernel, block_hash);
+}
+
+void SeenStakeKernels::Insert(const COutPoint& kernel, const uint256& block_hash)
+{
+    LOCK(m_mutex);
+    auto it = m_kernels.find(kernel);
+    if (it != m_kernels.end()) {
+        it->second = block_hash;
+        return;
+    }
+    InsertNew(kernel, block_hash);
+}
+
+bool SeenStakeKernels::CheckUnique(const COutPoint& kernel, const uint256& block_hash, uint256& first_seen, bool fUpdate)
+{
+    LOCK(m_mutex);
+    auto it = m_kernels.find(kernel);
+    if (it != m_kernels.end()) {
+        if (it->second == block_hash) {
+            return true;
+        }
+        first_seen = it->second;
+        return false;
+    }
+    if (fUpdate) {
+        InsertNew(kernel, block_hash);
+    }
+    return true;
+}
+
+bool SeenStakeKernels::Have(const COutPoint& kernel) const
+{
+    LOCK(m_mutex);
+    return m_kernels.count(kernel);
+}
+
+void SeenStakeKernels::Clear()
+{
+    LOCK(m_mutex);
+    m_kernels.clear();
+    m_ring.clear();
+    m_ring_pos = 0;
+}
+
+size_t SeenStakeKernels::Size() const
+{
+    LOCK(m_mutex);
+    return m_kernels.size();
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_POS_STAKESEEN_H
+#define GLOBE_POS_STAKESEEN_H
+
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <uint256.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Stake kernels used by recently seen blocks, mapped to the first block seen
+ * using them.
+ *
+ * Holds at most max_size kernels, when full the kernel added first is
+ * evicted. Insert, lookup and eviction are constant time: the kernels are
+ * kept in a hash map and their insertion order in a fixed size ring.
+ * Thread safe, callers don't need to hold cs_main.
+ */
+class SeenStakeKernels
+{
+private:
+    mutable Mutex m_mutex;
+    const size_t m_max_size;
+    std::unordered_map<COutPoint, uint256, SaltedOutpointHasher> m_kernels GUARDED_BY(m_mutex);
+    std::vector<COutPoint> m_ring GUARDED_BY(m_mutex); // Insertion order, oldest at m_ring_pos once full
+    size_t m_ring_pos GUARDED_BY(m_mutex){0};
+
+    void InsertNew(const COutPoint& kernel, const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+public:
+    explicit SeenStakeKernels(size_t max_size);
+
+    /** Set the block for kernel, overwriting any existing value. */
+    void Insert(const COutPoint& kernel, const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Return true if kernel is unseen or was first seen in block_hash.
+     * Otherwise return false and set first_seen to the block it was first seen in.
+     * If fUpdate is set an unseen kernel is inserted.
+     */
+    bool CheckUnique(const COutPoint& kernel, const uint256& block_hash, uint256& first_seen, bool fUpdate) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    bool Have(const COutPoint& kernel) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+#endif // GLOBE_POS_STAKESEEN_H
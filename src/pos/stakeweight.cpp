@@ -0,0 +1,210 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <pos/stakeweight.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <util/check.h>
+#include <validation.h>
+
+#include <algorithm>
+
+/* Calculate the difficulty for a given block index.
+ * Duplicated from rpc/blockchain.cpp for linking
+ */
+static double GetDifficulty(const CBlockIndex* blockindex)
+{
+    CHECK_NONFATAL(blockindex);
+
+    int nShift = (blockindex->nBits >> 24) & 0xff;
+    double dDiff =
+        (double)0x0000ffff / (double)(blockindex->nBits & 0x00ffffff);
+
+    while (nShift < 29)
+    {
+        dDiff *= 256.0;
+        nShift++;
+    }
+    while (nShift > 29)
+    {
+        dDiff /= 256.0;
+        nShift--;
+    }
+
+    return dDiff;
+}
+
+double GetPoSKernelPS(const CBlockIndex *pindex)
+{
+    LOCK(cs_main);
+
+    if (pindex == globe::g_network_stake_weight.Tip()) {
+        return globe::g_network_stake_weight.Weight();
+    }
+
+    const CBlockIndex *pindexPrevStake = nullptr;
+
+    int nBestHeight = pindex->nHeight;
+
+    int nPoSInterval = NetworkStakeWeight::NUM_SAMPLES; // blocks sampled
+    double dStakeKernelsTriedAvg = 0;
+    int nStakesHandled = 0, nStakesTime = 0;
+
+    while (pindex && nStakesHandled < nPoSInterval) {
+        if (pindex->IsProofOfStake()) {
+            if (pindexPrevStake) {
+                dStakeKernelsTriedAvg += GetDifficulty(pindexPrevStake) * 4294967296.0;
+                nStakesTime += pindexPrevStake->nTime - pindex->nTime;
+                nStakesHandled++;
+            }
+            pindexPrevStake = pindex;
+        }
+        pindex = pindex->pprev;
+    }
+
+    double result = 0;
+
+    if (nStakesTime) {
+        result = dStakeKernelsTriedAvg / nStakesTime;
+    }
+
+    result *= Params().GetStakeTimestampMask(nBestHeight) + 1;
+
+    return result;
+}
+
+void NetworkStakeWeight::AddSample(const CBlockIndex* pindex)
+{
+    if (m_last_stake) {
+        Sample sample;
+        sample.pindex = pindex;
+        sample.prev_stake = m_last_stake;
+        sample.kernels_tried = GetDifficulty(pindex) * 4294967296.0;
+        sample.time = (int64_t)pindex->nTime - (int64_t)m_last_stake->nTime;
+        sample.window_kernels_tried = sample.kernels_tried;
+        sample.window_time = sample.time;
+        if (!m_samples.empty()) {
+            const Sample& prev = m_samples.back();
+            sample.window_kernels_tried += prev.window_kernels_tried;
+            sample.window_time += prev.window_time;
+            if (m_samples.size() >= NUM_SAMPLES) {
+                const Sample& dropped = m_samples[m_samples.size() - NUM_SAMPLES];
+                sample.window_kernels_tried -= dropped.kernels_tried;
+                sample.window_time -= dropped.time;
+            }
+        }
+        const double weight = sample.window_time ? sample.window_kernels_tried / sample.window_time : 0.0;
+        if (m_samples.empty()) {
+            sample.smoothed = weight;
+        } else {
+            const double alpha = 2.0 / (SMOOTHING_SAMPLES + 1);
+            sample.smoothed = m_samples.back().smoothed + alpha * (weight - m_samples.back().smoothed);
+        }
+
+        m_samples.push_back(sample);
+        if (m_samples.size() > MAX_SAMPLES) {
+            m_samples.pop_front();
+            m_complete = false;
+        }
+    }
+    m_last_stake = pindex;
+}
+
+void NetworkStakeWeight::Rebuild(const CBlockIndex* tip)
+{
+    m_samples.clear();
+    m_last_stake = nullptr;
+
+    std::vector<const CBlockIndex*> stakes;
+    const CBlockIndex* pindex = tip;
+    for (; pindex && stakes.size() <= NUM_SAMPLES; pindex = pindex->pprev) {
+        if (pindex->IsProofOfStake()) {
+            stakes.push_back(pindex);
+        }
+    }
+    m_complete = !pindex;
+
+    for (auto it = stakes.rbegin(); it != stakes.rend(); ++it) {
+        AddSample(*it);
+    }
+    // Partial windows would skew the average, restart it from the current estimate
+    if (!m_samples.empty()) {
+        const Sample& last = m_samples.back();
+        const double weight = last.window_time ? last.window_kernels_tried / last.window_time : 0.0;
+        for (auto& sample : m_samples) {
+            sample.smoothed = weight;
+        }
+    }
+    m_tip = tip;
+}
+
+void NetworkStakeWeight::SetTip(const CBlockIndex* tip)
+{
+    AssertLockHeld(::cs_main);
+    if (!tip) {
+        return;
+    }
+
+    int fork_height = tip->nHeight;
+    if (m_tip) {
+        // Drop the samples of disconnected blocks
+        const CBlockIndex* fork = LastCommonAncestor(m_tip, tip);
+        fork_height = fork->nHeight;
+        while (!m_samples.empty() && m_samples.back().pindex->nHeight > fork_height) {
+            m_last_stake = m_samples.back().prev_stake;
+            m_samples.pop_back();
+        }
+        // Only the first proof of stake block has no sample
+        if (m_last_stake && m_last_stake->nHeight > fork_height) {
+            m_last_stake = nullptr;
+        }
+        m_tip = fork;
+    }
+
+    if (!m_tip || (m_samples.size() < NUM_SAMPLES && !m_complete)) {
+        Rebuild(tip);
+    } else {
+        std::vector<const CBlockIndex*> connected;
+        for (const CBlockIndex* pindex = tip; pindex != m_tip; pindex = pindex->pprev) {
+            connected.push_back(pindex);
+        }
+        for (auto it = connected.rbegin(); it != connected.rend(); ++it) {
+            if ((*it)->IsProofOfStake()) {
+                AddSample(*it);
+            }
+        }
+        m_tip = tip;
+    }
+
+    double weight = 0.0, smoothed = 0.0;
+    if (!m_samples.empty()) {
+        const Sample& last = m_samples.back();
+        weight = last.window_time ? last.window_kernels_tried / last.window_time : 0.0;
+        smoothed = last.smoothed;
+    }
+    const double mask = Params().GetStakeTimestampMask(tip->nHeight) + 1;
+    m_weight = weight * mask;
+    m_smoothed = smoothed * mask;
+    m_height = tip->nHeight;
+
+    LOCK(m_history_mutex);
+    while (!m_history.empty() && m_history.back().height > fork_height) {
+        m_history.pop_back();
+    }
+    if (tip->nHeight % HISTORY_INTERVAL == 0 &&
+        (m_history.empty() || m_history.back().height < tip->nHeight)) {
+        m_history.push_back({tip->nHeight, tip->GetBlockTime(), m_weight, m_smoothed});
+        if (m_history.size() > MAX_HISTORY) {
+            m_history.pop_front();
+        }
+    }
+}
+
+std::vector<NetworkStakeWeight::HistoryEntry> NetworkStakeWeight::GetHistory(size_t count) const
+{
+    LOCK(m_history_mutex);
+    count = std::min(count, m_history.size());
+    return {m_history.end() - count, m_history.end()};
+}
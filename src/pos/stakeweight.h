@@ -0,0 +1,100 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_POS_STAKEWEIGHT_H
+#define GLOBE_POS_STAKEWEIGHT_H
+
+#include <pos/kernel.h>
+#include <sync.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class CBlockIndex;
+
+/**
+ * Estimate the stake weight of the network from the difficulty and spacing
+ * of the last proof of stake blocks up to pindex, walks the chain.
+ */
+double GetPoSKernelPS(const CBlockIndex *pindex);
+
+/**
+ * Network stake weight of the active chain, updated as the tip changes so it
+ * can be read without cs_main and without walking the chain.
+ *
+ * Each proof of stake block adds a sample of its kernels tried and the time
+ * since the previous proof of stake block, the estimate is taken over the last
+ * NUM_SAMPLES samples as GetPoSKernelPS does. Samples are kept back to
+ * MAX_SAMPLES so a disconnected tip is undone by dropping its sample, deeper
+ * reorgs fall back to a walk of NUM_SAMPLES blocks.
+ *
+ * A smoothed estimate, an exponential moving average over SMOOTHING_SAMPLES
+ * samples, is recorded every HISTORY_INTERVAL blocks for longer horizon
+ * series. The history is built as blocks are connected and starts empty.
+ */
+class NetworkStakeWeight
+{
+public:
+    static constexpr size_t NUM_SAMPLES{72};
+    static constexpr size_t MAX_SAMPLES{NUM_SAMPLES + MAX_REORG_DEPTH};
+    static constexpr size_t SMOOTHING_SAMPLES{720};
+    static constexpr int HISTORY_INTERVAL{30};
+    static constexpr size_t MAX_HISTORY{1440};
+
+    struct HistoryEntry {
+        int height;
+        int64_t time;
+        double weight;
+        double smoothed;
+    };
+
+private:
+    struct Sample {
+        const CBlockIndex* pindex;
+        const CBlockIndex* prev_stake;
+        double kernels_tried;
+        int64_t time;
+        double window_kernels_tried; // Over the last NUM_SAMPLES samples up to this one
+        int64_t window_time;
+        double smoothed;
+    };
+
+    std::deque<Sample> m_samples GUARDED_BY(::cs_main);
+    //! m_samples reach back to the first proof of stake block
+    bool m_complete GUARDED_BY(::cs_main){false};
+    //! Block the samples are up to date with
+    const CBlockIndex* m_tip GUARDED_BY(::cs_main){nullptr};
+    //! Last proof of stake block at or below m_tip
+    const CBlockIndex* m_last_stake GUARDED_BY(::cs_main){nullptr};
+
+    std::atomic<int> m_height{-1};
+    std::atomic<double> m_weight{0.0};
+    std::atomic<double> m_smoothed{0.0};
+
+    mutable Mutex m_history_mutex;
+    std::deque<HistoryEntry> m_history GUARDED_BY(m_history_mutex);
+
+    void AddSample(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    void Rebuild(const CBlockIndex* tip) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+public:
+    /** Follow the active chain to tip, called whenever the tip changes. */
+    void SetTip(const CBlockIndex* tip) EXCLUSIVE_LOCKS_REQUIRED(::cs_main, !m_history_mutex);
+
+    /** Block the estimate is for, nullptr before the first tip is set. */
+    const CBlockIndex* Tip() const EXCLUSIVE_LOCKS_REQUIRED(::cs_main) { return m_tip; }
+
+    /** Height of the tip the estimate is for, -1 before the first tip is set. */
+    int Height() const { return m_height.load(); }
+    double Weight() const { return m_weight.load(); }
+    double SmoothedWeight() const { return m_smoothed.load(); }
+
+    /** Return up to count history entries, oldest first. */
+    std::vector<HistoryEntry> GetHistory(size_t count) const EXCLUSIVE_LOCKS_REQUIRED(!m_history_mutex);
+};
+
+#endif // GLOBE_POS_STAKEWEIGHT_H
@@ -12,6 +12,11 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <insight/addressindex.h>
+#include <insight/insight.h>
+#include <insight/rpc.h>
+#include <insight/spentindex.h>
+#include <key_io.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
@@ -926,6 +931,323 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+static bool ParseRESTAddress(HTTPRequest* req, const std::string& address, uint256& hash_bytes, int& type)
+{
+    if (!fAddressIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+    if (!GetIndexKey(DecodeDestination(address), hash_bytes, type)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + SanitizeString(address));
+    }
+    return true;
+}
+
+static bool rest_address_utxos(const std::any& context, HTTPRequest* req, const std::string& address, RESTResponseFormat rf)
+{
+    uint256 hash_bytes;
+    int type;
+    if (!ParseRESTAddress(req, address, hash_bytes, type)) return false;
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        // Records are written as stored in the index: key then value
+        CDataStream ss_utxos(SER_NETWORK, PROTOCOL_VERSION);
+        if (!ForEachAddressUnspent(chainman, hash_bytes, type, [&](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
+                ss_utxos << key << value;
+                return true;
+            })) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+        }
+        if (rf == RESTResponseFormat::HEX) {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ss_utxos) + "\n");
+        } else {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ss_utxos.str());
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue utxos(UniValue::VARR);
+        if (!ForEachAddressUnspent(chainman, hash_bytes, type, [&](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
+                UniValue output(UniValue::VOBJ);
+                output.pushKV("address", address);
+                output.pushKV("txid", key.txhash.GetHex());
+                output.pushKV("outputIndex", (int)key.index);
+                output.pushKV("script", HexStr(value.script));
+                output.pushKV("satoshis", value.satoshis);
+                output.pushKV("height", value.blockHeight);
+                utxos.push_back(output);
+                return true;
+            })) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, utxos.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, hex, json)");
+    }
+    }
+}
+
+static bool rest_address_deltas(const std::any& context, HTTPRequest* req, const std::string& address, RESTResponseFormat rf)
+{
+    uint256 hash_bytes;
+    int type;
+    if (!ParseRESTAddress(req, address, hash_bytes, type)) return false;
+
+    int32_t start = 0, end = 0;
+    const auto raw_start{req->GetQueryParameter("start")};
+    const auto raw_end{req->GetQueryParameter("end")};
+    if (raw_start || raw_end) {
+        if (!raw_start || !raw_end || !ParseInt32(*raw_start, &start) || !ParseInt32(*raw_end, &end) ||
+            start <= 0 || end < start) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid range, expected 0 < start <= end");
+        }
+    }
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        // Records are written as stored in the index: key then amount
+        CDataStream ss_deltas(SER_NETWORK, PROTOCOL_VERSION);
+        if (!ForEachAddressIndex(chainman, hash_bytes, type, start, end, [&](const CAddressIndexKey& key, CAmount value) {
+                ss_deltas << key << value;
+                return true;
+            })) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+        }
+        if (rf == RESTResponseFormat::HEX) {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ss_deltas) + "\n");
+        } else {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ss_deltas.str());
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue deltas(UniValue::VARR);
+        if (!ForEachAddressIndex(chainman, hash_bytes, type, start, end, [&](const CAddressIndexKey& key, CAmount value) {
+                UniValue delta(UniValue::VOBJ);
+                delta.pushKV("satoshis", value);
+                delta.pushKV("txid", key.txhash.GetHex());
+                delta.pushKV("index", (int)key.index);
+                delta.pushKV("blockindex", (int)key.txindex);
+                delta.pushKV("height", key.blockHeight);
+                delta.pushKV("address", address);
+                deltas.push_back(delta);
+                return true;
+            })) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read address index");
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, deltas.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, hex, json)");
+    }
+    }
+}
+
+static bool rest_address(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path = SplitString(param, '/');
+
+    if (path.size() == 2 && path[0] == "utxos") {
+        return rest_address_utxos(context, req, path[1], rf);
+    }
+    if (path.size() == 2 && path[0] == "deltas") {
+        return rest_address_deltas(context, req, path[1], rf);
+    }
+    return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/address/<utxos|deltas>/<address>.<bin|hex|json>");
+}
+
+static bool rest_spentinfo(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, strURIPart);
+
+    if (!fSpentIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    }
+
+    const size_t pos_sep{param.find('-')};
+    uint256 txid;
+    int32_t n;
+    if (pos_sep == std::string::npos || !ParseHashStr(param.substr(0, pos_sep), txid) ||
+        !ParseInt32(param.substr(pos_sep + 1), &n) || n < 0) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid outpoint, expected <txid>-<n>");
+    }
+
+    const NodeContext* const node = GetNodeContext(context, req);
+    if (!node) return false;
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+
+    CSpentIndexValue value;
+    if (!GetSpentIndex(*maybe_chainman, CSpentIndexKey(txid, n), value, node->mempool.get())) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Unable to get spent info");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        CDataStream ss_spent(SER_NETWORK, PROTOCOL_VERSION);
+        ss_spent << value;
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ss_spent.str());
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("txid", value.txid.GetHex());
+        obj.pushKV("index", (int)value.inputIndex);
+        obj.pushKV("height", value.blockHeight);
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, obj.write() + "\n");
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, json)");
+    }
+    }
+}
+
+/**
+ * Write the binary form of the getblockdeltas result.
+ *
+ * @returns false if the spent info of an input is missing.
+ */
+static bool WriteBlockDeltas(ChainstateManager& chainman, const CBlock& block, int height, const CTxMemPool* mempool, CDataStream& ss)
+{
+    ss << block.GetHash() << height;
+    WriteCompactSize(ss, block.vtx.size());
+    for (const auto& tx : block.vtx) {
+        ss << tx->GetHash();
+        if (tx->IsCoinBase()) {
+            WriteCompactSize(ss, 0);
+        } else {
+            WriteCompactSize(ss, tx->vin.size());
+            for (size_t j = 0; j < tx->vin.size(); ++j) {
+                const CTxIn& input = tx->vin[j];
+                CSpentIndexValue spent_info;
+                if (!GetSpentIndex(chainman, CSpentIndexKey(input.prevout.hash, input.prevout.n), spent_info, mempool)) {
+                    return false;
+                }
+                ss << (uint32_t)j << input.prevout << spent_info.satoshis << spent_info.addressType << spent_info.addressHash;
+            }
+        }
+        WriteCompactSize(ss, tx->vpout.size());
+        for (size_t k = 0; k < tx->vpout.size(); ++k) {
+            const CTxOutBase* out = tx->vpout[k].get();
+            ss << (uint32_t)k << out->GetType();
+            switch (out->GetType()) {
+            case OUTPUT_STANDARD: {
+                const CTxOutStandard* s = (const CTxOutStandard*)out;
+                ss << s->nValue << s->scriptPubKey;
+                break;
+            }
+            case OUTPUT_CT: {
+                const CTxOutCT* s = (const CTxOutCT*)out;
+                ss << Span<const unsigned char>(s->commitment.data, 33) << s->scriptPubKey;
+                break;
+            }
+            case OUTPUT_RINGCT: {
+                const CTxOutRingCT* s = (const CTxOutRingCT*)out;
+                ss << Span<const unsigned char>(s->pk.begin(), 33) << Span<const unsigned char>(s->commitment.data, 33);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static bool rest_blockdeltas(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    if (!fSpentIndex) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Spent index is not enabled");
+    }
+
+    const NodeContext* const node = GetNodeContext(context, req);
+    if (!node) return false;
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+
+    CBlock block;
+    LOCK(cs_main);
+    const CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+    if (!pblockindex || !chainman.ActiveChain().Contains(pblockindex)) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found in the active chain");
+    }
+    if (chainman.m_blockman.IsBlockPruned(pblockindex))
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+    if (!ReadBlockFromDisk(block, pblockindex, chainman.GetParams().GetConsensus()))
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        CDataStream ss_deltas(SER_NETWORK, PROTOCOL_VERSION);
+        if (!WriteBlockDeltas(chainman, block, pblockindex->nHeight, node->mempool.get(), ss_deltas)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Spent information not available");
+        }
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ss_deltas.str());
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        std::string str_json;
+        try {
+            str_json = blockToDeltasJSON(chainman, block, pblockindex, node->mempool.get()).write() + "\n";
+        } catch (const UniValue& obj_error) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, find_value(obj_error, "message").get_str());
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, str_json);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, json)");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -940,6 +1262,9 @@ static const struct {
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/address/", rest_address},
+      {"/rest/spentinfo/", rest_spentinfo},
+      {"/rest/blockdeltas/", rest_blockdeltas},
 };
 
 void StartREST(const std::any& context)
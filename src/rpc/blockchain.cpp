@@ -38,6 +38,7 @@
 #include <undo.h>
 #include <univalue.h>
 #include <util/check.h>
+#include <util/parallel.h>
 #include <util/strencodings.h>
 #include <util/system.h>
 #include <util/translation.h>
@@ -48,11 +49,14 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 
 #include <pos/kernel.h>
+#include <pos/stakeweight.h>
 #include <pos/miner.h>
 
 using kernel::CCoinsStats;
@@ -61,6 +65,7 @@ using kernel::CoinStatsHashType;
 using node::BlockManager;
 using node::NodeContext;
 using node::ReadBlockFromDisk;
+using node::SnapshotChunk;
 using node::SnapshotMetadata;
 using node::UndoReadFromDisk;
 
@@ -942,6 +947,7 @@ static RPCHelpMan gettxoutsetinfo()
                         {RPCResult::Type::STR_HEX, "bestblock", "The hash of the block at which these statistics are calculated"},
                         {RPCResult::Type::NUM, "txouts", "The number of unspent transaction outputs"},
                         {RPCResult::Type::NUM, "txouts_blinded", /*optional=*/true, "The number of blinded unspent transaction outputs"},
+                        {RPCResult::Type::NUM, "txouts_anon", /*optional=*/true, "The number of RingCT outputs created (only available if coinstatsindex is used)"},
                         {RPCResult::Type::NUM, "bogosize", "Database-independent, meaningless metric indicating the UTXO set size"},
                         {RPCResult::Type::STR_HEX, "hash_serialized_2", /*optional=*/true, "The serialized hash (only present if 'hash_serialized_2' hash_type is chosen)"},
                         {RPCResult::Type::STR_HEX, "muhash", /*optional=*/true, "The serialized hash (only present if 'muhash' hash_type is chosen)"},
@@ -949,6 +955,13 @@ static RPCHelpMan gettxoutsetinfo()
                         {RPCResult::Type::NUM, "disk_size", /*optional=*/true, "The estimated size of the chainstate on disk (not available when coinstatsindex is used)"},
                         {RPCResult::Type::STR_AMOUNT, "total_amount", "The total amount of coins in the UTXO set"},
                         {RPCResult::Type::STR_AMOUNT, "total_unspendable_amount", /*optional=*/true, "The total amount of coins permanently excluded from the UTXO set (only available if coinstatsindex is used)"},
+                        {RPCResult::Type::OBJ, "supply", /*optional=*/true, "The money supply at this block height (only available if coinstatsindex is used)",
+                        {
+                            {RPCResult::Type::STR_AMOUNT, "moneysupply", "The total money supply"},
+                            {RPCResult::Type::STR_AMOUNT, "plain", "The plain balance, as in getblockbalances"},
+                            {RPCResult::Type::STR_AMOUNT, "blind", "The blind balance, as in getblockbalances"},
+                            {RPCResult::Type::STR_AMOUNT, "anon", "The anon balance, as in getblockbalances"},
+                        }},
                         {RPCResult::Type::OBJ, "block_info", /*optional=*/true, "Info on amounts in the block at this block height (only available if coinstatsindex is used)",
                         {
                             {RPCResult::Type::STR_AMOUNT, "prevout_spent", "Total amount of all prevouts spent in this block"},
@@ -1032,6 +1045,9 @@ static RPCHelpMan gettxoutsetinfo()
         ret.pushKV("txouts", (int64_t)stats.nTransactionOutputs);
         if (fGlobeMode) {
             ret.pushKV("txouts_blinded", (int64_t)stats.nBlindTransactionOutputs);
+            if (stats.index_used) {
+                ret.pushKV("txouts_anon", (int64_t)stats.nAnonTransactionOutputs);
+            }
         }
         ret.pushKV("bogosize", (int64_t)stats.nBogoSize);
         if (hash_type == CoinStatsHashType::HASH_SERIALIZED) {
@@ -1048,6 +1064,15 @@ static RPCHelpMan gettxoutsetinfo()
         } else {
             ret.pushKV("total_unspendable_amount", ValueFromAmount(stats.total_unspendable_amount));
 
+            if (fGlobeMode) {
+                UniValue supply(UniValue::VOBJ);
+                supply.pushKV("moneysupply", ValueFromAmount(stats.money_supply));
+                supply.pushKV("plain", ValueFromAmount(stats.total_plain_balance));
+                supply.pushKV("blind", ValueFromAmount(stats.total_blind_balance));
+                supply.pushKV("anon", ValueFromAmount(stats.total_anon_balance));
+                ret.pushKV("supply", supply);
+            }
+
             CCoinsStats prev_stats{};
             if (pindex->nHeight > 0) {
                 const std::optional<CCoinsStats> maybe_prev_stats = GetUTXOStats(coins_view, *blockman, hash_type, node.rpc_interruption_point, pindex->pprev, index_requested);
@@ -1295,6 +1320,7 @@ RPCHelpMan getblockchaininfo()
                 {RPCResult::Type::STR_AMOUNT, "moneysupply", /*optional=*/true, "the total amount of coin in the network"},
                 {RPCResult::Type::NUM, "blockindexsize", /*optional=*/true, "the total number of blockheaders loaded"},
                 {RPCResult::Type::NUM, "delayedblocks", /*optional=*/true, "the number of blocks received out of order delayed until gaps close."},
+                {RPCResult::Type::NUM, "delayedblocksbytes", /*optional=*/true, "the total serialized size of the delayed blocks."},
                 {RPCResult::Type::NUM, "difficulty", "the current difficulty"},
                 {RPCResult::Type::NUM_TIME, "time", "The block time expressed in " + UNIX_EPOCH_TIME},
                 {RPCResult::Type::NUM_TIME, "mediantime", "The median block time expressed in " + UNIX_EPOCH_TIME},
@@ -1330,6 +1356,7 @@ RPCHelpMan getblockchaininfo()
         obj.pushKV("moneysupply", ValueFromAmount(tip.nMoneySupply));
         obj.pushKV("blockindexsize", (int)chainman.BlockIndex().size());
         obj.pushKV("delayedblocks", (int)globe::CountDelayedBlocks());
+        obj.pushKV("delayedblocksbytes", (uint64_t)globe::DelayedBlocksBytes());
     }
     obj.pushKV("difficulty", GetDifficulty(&tip));
     PushTime(obj, "time", tip.GetBlockTime());
@@ -2417,6 +2444,64 @@ static RPCHelpMan getposdifficulty()
     };
 }
 
+static RPCHelpMan getnetstakeweight()
+{
+    return RPCHelpMan{"getnetstakeweight",
+            "\nReturns the estimated network stake weight at the tip and a history of smoothed estimates.\n"
+            "The estimate is tracked as blocks are connected, the history is sampled every " + ToString(NetworkStakeWeight::HISTORY_INTERVAL) + " blocks since the node started.\n",
+            {
+                {"count", RPCArg::Type::NUM, RPCArg::Default{0}, "The number of history entries to return, most recent last (max " + ToString(NetworkStakeWeight::MAX_HISTORY) + ")."},
+            },
+            RPCResult{
+                RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::NUM, "height", "the height the estimate is for"},
+                    {RPCResult::Type::NUM, "netstakeweight", "the stake weight of the network over the last " + ToString(NetworkStakeWeight::NUM_SAMPLES) + " proof of stake blocks"},
+                    {RPCResult::Type::NUM, "smoothed", "the stake weight of the network averaged over about " + ToString(NetworkStakeWeight::SMOOTHING_SAMPLES) + " proof of stake blocks"},
+                    {RPCResult::Type::ARR, "history", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::NUM, "height", "the block height"},
+                            {RPCResult::Type::NUM_TIME, "time", "the block time expressed in " + UNIX_EPOCH_TIME},
+                            {RPCResult::Type::NUM, "netstakeweight", "the stake weight of the network"},
+                            {RPCResult::Type::NUM, "smoothed", "the smoothed stake weight of the network"},
+                        }},
+                    }},
+                }},
+            RPCExamples{
+                HelpExampleCli("getnetstakeweight", "48")
+        + HelpExampleRpc("getnetstakeweight", "48")
+    },
+    [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const int count = request.params[0].isNull() ? 0 : request.params[0].getInt<int>();
+    if (count < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+
+    const NetworkStakeWeight& tracker = globe::g_network_stake_weight;
+    UniValue history(UniValue::VARR);
+    for (const auto& entry : tracker.GetHistory(count)) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("height", entry.height);
+        obj.pushKV("time", entry.time);
+        obj.pushKV("netstakeweight", (uint64_t)entry.weight);
+        obj.pushKV("smoothed", (uint64_t)entry.smoothed);
+        history.push_back(obj);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("height", tracker.Height());
+    result.pushKV("netstakeweight", (uint64_t)tracker.Weight());
+    result.pushKV("smoothed", (uint64_t)tracker.SmoothedWeight());
+    result.pushKV("history", history);
+
+    return result;
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2426,7 +2511,8 @@ static RPCHelpMan dumptxoutset()
 {
     return RPCHelpMan{
         "dumptxoutset",
-        "Write the serialized UTXO set to disk.",
+        "Write the serialized UTXO set to disk.\n"
+        "In Globe mode the RCT tables (anon outputs, key images and spent cache) are included.",
         {
             {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the output file. If relative, will be prefixed by datadir."},
         },
@@ -2478,6 +2564,160 @@ static RPCHelpMan dumptxoutset()
     };
 }
 
+namespace {
+/** Reads one part of the UTXO set or of an RCT table into snapshot chunks. */
+class SnapshotPartReader
+{
+public:
+    bool m_done{false};
+
+    virtual ~SnapshotPartReader() = default;
+
+    //! Serialize up to SNAPSHOT_CHUNK_ITEMS items into chunk, sets m_done
+    //! once the part is exhausted. Must not throw.
+    virtual void ReadChunk(SnapshotChunk& chunk) = 0;
+};
+
+/** The coins with the first byte of the txid in [begin, end). */
+class SnapshotCoinsReader final : public SnapshotPartReader
+{
+private:
+    std::unique_ptr<CCoinsViewCursor> m_cursor;
+    const int m_end;
+
+public:
+    SnapshotCoinsReader(const CCoinsViewDB& coins_db, int begin, int end) : m_end(end)
+    {
+        uint256 start;
+        *start.begin() = begin;
+        m_cursor = coins_db.Cursor(COutPoint{start, 0});
+    }
+
+    void ReadChunk(SnapshotChunk& chunk) override
+    {
+        chunk.m_section = node::SNAPSHOT_COINS;
+        CDataStream stream{SER_DISK, CLIENT_VERSION};
+        COutPoint key;
+        Coin coin;
+        while (chunk.m_count < node::SNAPSHOT_CHUNK_ITEMS) {
+            if (!m_cursor->Valid() || !m_cursor->GetKey(key) || *key.hash.begin() >= m_end) {
+                m_done = true;
+                break;
+            }
+            if (m_cursor->GetValue(coin)) {
+                stream << key << coin;
+                ++chunk.m_count;
+            }
+            m_cursor->Next();
+        }
+        chunk.m_data.assign(UCharCast(stream.data()), UCharCast(stream.data() + stream.size()));
+    }
+};
+
+template <typename V>
+bool ReadTableValue(CDBIterator& cursor, V& value)
+{
+    return cursor.GetValue(value);
+}
+
+bool ReadTableValue(CDBIterator& cursor, CAnonKeyImageInfo& value)
+{
+    // Versions before 0.19.2.15 store only the txid
+    if (cursor.GetValueSize() < 36) {
+        value.height = -1; // unset
+        return cursor.GetValue(value.txid);
+    }
+    return cursor.GetValue(value);
+}
+
+/** The entries of a block tree db table with keys (prefix, K). */
+template <typename K, typename V>
+class SnapshotTableReader final : public SnapshotPartReader
+{
+private:
+    std::unique_ptr<CDBIterator> m_cursor;
+    const uint8_t m_prefix;
+    const node::SnapshotSection m_section;
+    const std::function<bool(const K&)> m_filter;
+
+public:
+    SnapshotTableReader(CBlockTreeDB& block_tree_db, uint8_t prefix, node::SnapshotSection section, std::function<bool(const K&)> filter = nullptr)
+        : m_cursor(block_tree_db.NewIterator()), m_prefix(prefix), m_section(section), m_filter(std::move(filter))
+    {
+        m_cursor->Seek(prefix);
+    }
+
+    void ReadChunk(SnapshotChunk& chunk) override
+    {
+        chunk.m_section = m_section;
+        CDataStream stream{SER_DISK, CLIENT_VERSION};
+        std::pair<uint8_t, K> key;
+        V value;
+        while (chunk.m_count < node::SNAPSHOT_CHUNK_ITEMS) {
+            if (!m_cursor->Valid() || !m_cursor->GetKey(key) || key.first != m_prefix) {
+                m_done = true;
+                break;
+            }
+            if ((!m_filter || m_filter(key.second)) && ReadTableValue(*m_cursor, value)) {
+                stream << key.second << value;
+                ++chunk.m_count;
+            }
+            m_cursor->Next();
+        }
+        chunk.m_data.assign(UCharCast(stream.data()), UCharCast(stream.data() + stream.size()));
+    }
+};
+
+/** The spent cache, copied from memory when the snapshot is started. */
+class SnapshotSpentCacheReader final : public SnapshotPartReader
+{
+private:
+    const std::vector<std::pair<COutPoint, SpentCoin>> m_coins;
+    size_t m_next{0};
+
+public:
+    explicit SnapshotSpentCacheReader(const CBlockTreeDB& block_tree_db) : m_coins(block_tree_db.GetSpentCache()) {}
+
+    void ReadChunk(SnapshotChunk& chunk) override
+    {
+        chunk.m_section = node::SNAPSHOT_SPENT_CACHE;
+        CDataStream stream{SER_DISK, CLIENT_VERSION};
+        for (; m_next < m_coins.size() && chunk.m_count < node::SNAPSHOT_CHUNK_ITEMS; ++m_next) {
+            stream << m_coins[m_next].first << m_coins[m_next].second;
+            ++chunk.m_count;
+        }
+        m_done = m_next >= m_coins.size();
+        chunk.m_data.assign(UCharCast(stream.data()), UCharCast(stream.data() + stream.size()));
+    }
+};
+
+/**
+ * Write the chunks of parts to afile until every part is exhausted.
+ *
+ * Each round reads the next chunk of every part on num_threads threads, then
+ * writes the chunks in part order, so the file doesn't depend on the number
+ * of threads and at most one chunk per part is held in memory.
+ */
+void WriteSnapshotParts(AutoFile& afile, std::vector<std::unique_ptr<SnapshotPartReader>>& parts, int num_threads, const std::function<void()>& interruption_point)
+{
+    std::vector<SnapshotChunk> chunks;
+    while (!parts.empty()) {
+        interruption_point();
+        chunks.assign(parts.size(), SnapshotChunk{});
+        util::ParallelFor(parts.size(), num_threads, [&](size_t i) {
+            parts[i]->ReadChunk(chunks[i]);
+            return true;
+        });
+        for (const auto& chunk : chunks) {
+            if (chunk.m_count > 0) {
+                afile << chunk;
+            }
+        }
+        parts.erase(std::remove_if(parts.begin(), parts.end(), [](const auto& part) { return part->m_done; }), parts.end());
+    }
+}
+} // namespace
+
 UniValue CreateUTXOSnapshot(
     NodeContext& node,
     Chainstate& chainstate,
@@ -2485,15 +2725,15 @@ UniValue CreateUTXOSnapshot(
     const fs::path& path,
     const fs::path& temppath)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor;
+    std::vector<std::unique_ptr<SnapshotPartReader>> coin_parts, rct_parts;
     std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex* tip;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
         // between (i) flushing coins cache to disk (coinsdb), (ii) getting stats
-        // based upon the coinsdb, and (iii) constructing a cursor to the
-        // coinsdb for use below this block.
+        // based upon the coinsdb, and (iii) constructing the cursors to the
+        // coinsdb and RCT tables for use below this block.
         //
         // Cursors returned by leveldb iterate over snapshots, so the contents
         // of the pcursor will not be affected by simultaneous writes during
@@ -2511,8 +2751,23 @@ UniValue CreateUTXOSnapshot(
             throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
         }
 
-        pcursor = chainstate.CoinsDB().Cursor();
         tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
+
+        for (int i = 0; i < node::SNAPSHOT_COIN_PARTS; ++i) {
+            coin_parts.push_back(std::make_unique<SnapshotCoinsReader>(chainstate.CoinsDB(),
+                i * 256 / node::SNAPSHOT_COIN_PARTS, (i + 1) * 256 / node::SNAPSHOT_COIN_PARTS));
+        }
+        if (fGlobeMode) {
+            // The output links are not written, they are rebuilt from the outputs
+            CBlockTreeDB& block_tree_db{*chainstate.m_blockman.m_block_tree_db};
+            const int64_t anon_output_count{tip->nAnonOutputs};
+            rct_parts.push_back(std::make_unique<SnapshotTableReader<int64_t, CAnonOutput>>(
+                block_tree_db, DB_RCTOUTPUT, node::SNAPSHOT_ANON_OUTPUTS,
+                [anon_output_count](const int64_t& index) { return index <= anon_output_count; }));
+            rct_parts.push_back(std::make_unique<SnapshotTableReader<CCmpPubKey, CAnonKeyImageInfo>>(
+                block_tree_db, DB_RCTKEYIMAGE, node::SNAPSHOT_KEY_IMAGES));
+            rct_parts.push_back(std::make_unique<SnapshotSpentCacheReader>(block_tree_db));
+        }
     }
 
     LOG_TIME_SECONDS(strprintf("writing UTXO snapshot at height %s (%s) to file %s (via %s)",
@@ -2521,22 +2776,16 @@ UniValue CreateUTXOSnapshot(
 
     SnapshotMetadata metadata{tip->GetBlockHash(), maybe_stats->coins_count, tip->nChainTx};
 
-    afile << metadata;
-
-    COutPoint key;
-    Coin coin;
-    unsigned int iter{0};
+    metadata.m_anon_output_count = tip->nAnonOutputs;
+    metadata.m_money_supply = tip->nMoneySupply;
 
-    while (pcursor->Valid()) {
-        if (iter % 5000 == 0) node.rpc_interruption_point();
-        ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            afile << key;
-            afile << coin;
-        }
+    afile << metadata;
 
-        pcursor->Next();
-    }
+    // All coins are written before the RCT tables
+    const int num_threads{std::min(GetNumCores(), node::MAX_SNAPSHOT_THREADS)};
+    WriteSnapshotParts(afile, coin_parts, num_threads, node.rpc_interruption_point);
+    WriteSnapshotParts(afile, rct_parts, num_threads, node.rpc_interruption_point);
+    afile << SnapshotChunk{};
 
     afile.fclose();
 
@@ -2576,6 +2825,7 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scantxoutset},
         {"blockchain", &getblockfilter},
         {"blockchain", &getposdifficulty},
+        {"blockchain", &getnetstakeweight},
         {"hidden", &invalidateblock},
         {"hidden", &reconsiderblock},
         {"hidden", &waitfornewblock},
@@ -201,6 +201,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "rehashblock", 2, "addtxns" },
     { "verifycommitment", 2, "amount" },
     { "getposdifficulty", 0, "height" },
+    { "getnetstakeweight", 0, "count" },
     { "filteraddresses", 2, "sort_code" },
     { "filteraddresses", 5, "show_path" },
     { "reservebalance", 0, "enabled" },
@@ -216,6 +217,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "tallyvotes", 0, "proposal" },
     { "tallyvotes", 1, "height_start" },
     { "tallyvotes", 2, "height_end" },
+    { "getproposalvotes", 0, "proposal" },
+    { "getproposalvotes", 1, "height_start" },
+    { "getproposalvotes", 2, "height_end" },
 
     { "sendtypeto", 2, "outputs" },
     { "sendtypeto", 5, "ringsize" },
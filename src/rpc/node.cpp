@@ -7,7 +7,9 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/coldstakeindex.h>
 #include <index/txindex.h>
+#include <index/voteindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
 #include <interfaces/init.h>
@@ -464,6 +466,14 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_vote_index) {
+        result.pushKVs(SummaryToJSON(g_vote_index->GetSummary(), index_name));
+    }
+
+    if (g_coldstake_index) {
+        result.pushKVs(SummaryToJSON(g_coldstake_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
@@ -930,7 +930,7 @@ bool SignTransaction(CMutableTransaction& mtx, const SigningProvider* keystore,
         if (coin->second.nType == OUTPUT_CT) {
             amount = 0; // Bypass amount check
             vchAmount.resize(33);
-            memcpy(vchAmount.data(), coin->second.commitment.data, 33);
+            memcpy(vchAmount.data(), coin->second.GetCommitment().data, 33);
         } else {
             input_errors[i] = _("Bad input type");
             continue;
@@ -8,6 +8,8 @@
 #include <sync.h>
 #include <threadsafety.h>
 
+#include <string>
+
 const uint32_t SMSG_RCVCOUNT_REDUCE = 200;
 
 namespace SMSGMsgType {
@@ -20,6 +22,9 @@ extern const char *HAVE;
 extern const char *WANT;
 extern const char *MSG;
 extern const char *IGNORING;
+
+/** Return true if msg_type is one of the secure messaging message types. */
+bool IsSmsgType(const std::string& msg_type);
 };
 
 class PeerBucket
@@ -61,6 +61,7 @@ Notes:
 
 #include <stdint.h>
 #include <time.h>
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 #include <errno.h>
@@ -84,6 +85,11 @@ const char *IGNORING="smsgIgnore";
 const static std::string allTypes[] = {
     PING, PONG, DISABLED, INV, SHOW, HAVE, WANT, MSG, IGNORING
 };
+
+bool IsSmsgType(const std::string& msg_type)
+{
+    return std::find(std::begin(allTypes), std::end(allTypes), msg_type) != std::end(allTypes);
+}
 } // namespace SMSGMsgType
 
 namespace smsg {
@@ -1317,6 +1323,7 @@ int CSMSG::ReceiveData(PeerManager *peerLogic, CNode *pfrom, const std::string &
 
     if (m_node->chainman->ActiveChainstate().IsInitialBlockDownload()) { // Wait until chain synced
         if (strCommand == SMSGMsgType::PING) {
+            LOCK(pfrom->smsgData.cs_smsg_net);
             pfrom->smsgData.lastSeen = -1; // Mark node as requiring a response once chain is synced
         }
         return SMSG_NO_ERROR;
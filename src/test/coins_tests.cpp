@@ -550,6 +550,64 @@ BOOST_AUTO_TEST_CASE(ccoins_serialization)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_ct_commitment)
+{
+    Coin coin_std(CTxOut(100, CScript() << OP_TRUE), 1, false);
+    const size_t usage_std = coin_std.DynamicMemoryUsage();
+
+    secp256k1_pedersen_commitment commitment;
+    memset(commitment.data, 0x09, 33);
+    Coin coin_ct(CTxOut(0, CScript() << OP_TRUE), 1, false);
+    coin_ct.nType = OUTPUT_CT;
+    coin_ct.SetCommitment(commitment);
+    BOOST_CHECK_EQUAL(coin_ct.DynamicMemoryUsage(), usage_std + memusage::MallocUsage(sizeof(secp256k1_pedersen_commitment)));
+
+    // Copies own their commitment
+    Coin coin_copy(coin_ct);
+    coin_ct.Clear();
+    BOOST_CHECK_EQUAL(coin_ct.DynamicMemoryUsage(), 0U);
+    BOOST_CHECK(coin_ct.GetCommitment().data[0] == 0);
+    BOOST_CHECK(memcmp(coin_copy.GetCommitment().data, commitment.data, 33) == 0);
+
+    bool globe_mode = fGlobeMode;
+    fGlobeMode = true;
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << coin_copy;
+    Coin coin_read;
+    ss >> coin_read;
+    fGlobeMode = globe_mode;
+    BOOST_CHECK(coin_read.nType == OUTPUT_CT);
+    BOOST_CHECK(memcmp(coin_read.GetCommitment().data, commitment.data, 33) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_warm_coin)
+{
+    CCoinsViewTest base;
+    CCoinsViewCacheTest cache(&base);
+
+    COutPoint outpoint(InsecureRand256(), 0);
+    Coin coin(CTxOut(1000, CScript() << OP_TRUE), 1, false);
+    BOOST_CHECK(cache.WarmCoin(outpoint, Coin(coin)));
+    BOOST_CHECK(cache.HaveCoinInCache(outpoint));
+    BOOST_CHECK_EQUAL(cache.AccessCoin(outpoint).out.nValue, 1000);
+    BOOST_CHECK_EQUAL(cache.DynamicMemoryUsage() - memusage::DynamicUsage(cache.map()), coin.DynamicMemoryUsage());
+
+    // Existing entries are not overwritten, spent coins are not added
+    Coin coin_other(CTxOut(2000, CScript() << OP_TRUE), 1, false);
+    BOOST_CHECK(!cache.WarmCoin(outpoint, std::move(coin_other)));
+    BOOST_CHECK_EQUAL(cache.AccessCoin(outpoint).out.nValue, 1000);
+    COutPoint outpoint_spent(InsecureRand256(), 0);
+    BOOST_CHECK(!cache.WarmCoin(outpoint_spent, Coin()));
+    BOOST_CHECK(!cache.HaveCoinInCache(outpoint_spent));
+
+    // Warmed coins are not dirty, flushing doesn't write them to the base
+    BOOST_CHECK_EQUAL(cache.GetFlushCount(), 0U);
+    cache.SetBestBlock(InsecureRand256(), 1);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK_EQUAL(cache.GetFlushCount(), 1U);
+    BOOST_CHECK(!base.HaveCoin(outpoint));
+}
+
 const static COutPoint OUTPOINT;
 const static CAmount SPENT = -1;
 const static CAmount ABSENT = -2;
@@ -611,7 +669,8 @@ void GetCoinsMapEntry(const CCoinsMap& map, CAmount& value, char& flags)
 
 void WriteCoinsViewEntry(CCoinsView& view, CAmount value, char flags)
 {
-    CCoinsMap map;
+    CCoinsMapMemoryResource resource;
+    CCoinsMap map{0, CCoinsMap::hasher{}, CCoinsMap::key_equal{}, &resource};
     InsertCoinsMapEntry(map, value, flags);
     BOOST_CHECK(view.BatchWrite(map, {}));
 }
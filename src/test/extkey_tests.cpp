@@ -554,6 +554,34 @@ BOOST_AUTO_TEST_CASE(extkey_account)
     BOOST_CHECK(pak->nKey == 3);
 }
 
+BOOST_AUTO_TEST_CASE(extkey_derived_pubkey_cache)
+{
+    CStoredExtKey sek, sekCheck;
+    const uint8_t seed[32] = {1};
+    sek.kp.SetSeed(seed, sizeof(seed));
+    sekCheck.kp = sek.kp;
+
+    sek.CacheDerivedPubKeys(0, 20, 4);
+    BOOST_CHECK(sek.mapDerivedPubKeys.size() == 20);
+    BOOST_CHECK(sek.vDerivedPubKeysNew.size() == 20);
+
+    CPubKey pk, pkCheck;
+    uint32_t nChildOut, nChildOutCheck;
+    for (uint32_t k = 0; k < 25; ++k) {
+        BOOST_CHECK(0 == sek.DerivePubKey(pk, k, nChildOut));
+        BOOST_CHECK(0 == sekCheck.DeriveKey(pkCheck, k, nChildOutCheck, false));
+        BOOST_CHECK(nChildOut == nChildOutCheck);
+        BOOST_CHECK(pk == pkCheck);
+    }
+    BOOST_CHECK(sek.mapDerivedPubKeys.size() == 25);
+    BOOST_CHECK(sek.vDerivedPubKeysNew.size() == 25);
+
+    // Cached entries are not derived again
+    sek.vDerivedPubKeysNew.clear();
+    sek.CacheDerivedPubKeys(10, 20, 4);
+    BOOST_CHECK(sek.vDerivedPubKeysNew.size() == 5);
+}
+
 BOOST_AUTO_TEST_CASE(extkey_misc_keys)
 {
     uint32_t nTest = 1;
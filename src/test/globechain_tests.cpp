@@ -10,7 +10,12 @@
 #include <consensus/merkle.h>
 #include <consensus/tx_verify.h>
 #include <key/extkey.h>
+#include <pos/delayedblocks.h>
 #include <pos/kernel.h>
+#include <pos/spentcache.h>
+#include <pos/stakeprecheck.h>
+#include <pos/stakeseen.h>
+#include <pos/stakeweight.h>
 #include <chainparams.h>
 #include <blind.h>
 #include <validation.h>
@@ -20,6 +25,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <limits>
+
 bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
@@ -782,4 +789,294 @@ BOOST_AUTO_TEST_CASE(taproot)
     }
 }
 
+BOOST_AUTO_TEST_CASE(delayed_block_queue)
+{
+    auto make_block = [](const uint256 &prev_hash, uint32_t nonce) {
+        auto pblock = std::make_shared<CBlock>();
+        pblock->hashPrevBlock = prev_hash;
+        pblock->nNonce = nonce;
+        return pblock;
+    };
+
+    DelayedBlockQueue queue;
+    uint256 parent_a = InsecureRand256(), parent_b = InsecureRand256();
+    auto a1 = make_block(parent_a, 1), a2 = make_block(parent_a, 2), b1 = make_block(parent_b, 3);
+
+    BOOST_CHECK(queue.Insert(a1, 1, 100));
+    BOOST_CHECK(queue.Insert(b1, 2, 101));
+    BOOST_CHECK(queue.Insert(a2, 3, 102));
+    BOOST_CHECK(!queue.Insert(a1, 4, 103));
+    BOOST_CHECK_EQUAL(queue.Size(), 3U);
+    BOOST_CHECK_EQUAL(queue.TotalSize(), 3 * ::GetSerializeSize(*a1, PROTOCOL_VERSION));
+    BOOST_CHECK(queue.Have(b1->GetHash()));
+
+    // Children are found by parent hash
+    std::vector<DelayedBlock> children = queue.TakeChildren(parent_a);
+    BOOST_CHECK_EQUAL(children.size(), 2U);
+    BOOST_CHECK(!queue.Have(a1->GetHash()) && !queue.Have(a2->GetHash()));
+    BOOST_CHECK(queue.TakeChildren(parent_a).empty());
+    BOOST_CHECK_EQUAL(queue.Size(), 1U);
+
+    // Oldest first
+    BOOST_CHECK(queue.Insert(a1, 1, 50));
+    BOOST_CHECK(queue.TakeOldest()->m_pblock->GetHash() == a1->GetHash());
+    BOOST_CHECK_EQUAL(queue.GetAll().size(), 1U);
+
+    // Expiry
+    BOOST_CHECK(queue.Insert(a2, 1, 200));
+    BOOST_CHECK(queue.TakeExpired(101).empty());
+    std::vector<DelayedBlock> expired = queue.TakeExpired(150);
+    BOOST_CHECK_EQUAL(expired.size(), 1U);
+    BOOST_CHECK(expired[0].m_pblock->GetHash() == b1->GetHash());
+    BOOST_CHECK(queue.Erase(a2->GetHash()));
+    BOOST_CHECK(queue.Empty());
+    BOOST_CHECK_EQUAL(queue.TotalSize(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(seen_stake_kernels)
+{
+    SeenStakeKernels seen(3);
+    std::vector<COutPoint> kernels;
+    std::vector<uint256> block_hashes;
+    for (size_t i = 0; i < 5; ++i) {
+        kernels.emplace_back(InsecureRand256(), i);
+        block_hashes.push_back(InsecureRand256());
+    }
+
+    uint256 first_seen;
+    BOOST_CHECK(seen.CheckUnique(kernels[0], block_hashes[0], first_seen, false));
+    BOOST_CHECK(!seen.Have(kernels[0]));
+    BOOST_CHECK(seen.CheckUnique(kernels[0], block_hashes[0], first_seen, true));
+    BOOST_CHECK(seen.Have(kernels[0]));
+
+    // Same block passes, another block using the kernel fails
+    BOOST_CHECK(seen.CheckUnique(kernels[0], block_hashes[0], first_seen, true));
+    BOOST_CHECK(!seen.CheckUnique(kernels[0], block_hashes[1], first_seen, true));
+    BOOST_CHECK(first_seen == block_hashes[0]);
+
+    // Insert overwrites without taking another slot
+    seen.Insert(kernels[0], block_hashes[1]);
+    BOOST_CHECK(seen.CheckUnique(kernels[0], block_hashes[1], first_seen, true));
+    BOOST_CHECK_EQUAL(seen.Size(), 1U);
+
+    // Oldest kernels are evicted first
+    for (size_t i = 1; i < 5; ++i) {
+        seen.Insert(kernels[i], block_hashes[i]);
+    }
+    BOOST_CHECK_EQUAL(seen.Size(), 3U);
+    BOOST_CHECK(!seen.Have(kernels[0]));
+    BOOST_CHECK(!seen.Have(kernels[1]));
+    for (size_t i = 2; i < 5; ++i) {
+        BOOST_CHECK(seen.Have(kernels[i]));
+    }
+
+    seen.Clear();
+    BOOST_CHECK_EQUAL(seen.Size(), 0U);
+    BOOST_CHECK(!seen.Have(kernels[4]));
+}
+
+BOOST_AUTO_TEST_CASE(stake_precheck_key)
+{
+    CBlockIndex index_prev;
+    index_prev.nHeight = 1000;
+    index_prev.nTime = 1650000000;
+    index_prev.bnStakeModifier = InsecureRand256();
+
+    // The overloads taking the stake modifier directly match the block index ones
+    const uint256 kernel_txid = InsecureRand256();
+    BOOST_CHECK(ComputeStakeModifierV2(&index_prev, kernel_txid) == ComputeStakeModifierV2(index_prev.bnStakeModifier, kernel_txid));
+
+    uint32_t nBits = UintToArith256(uint256S("00ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff")).GetCompact();
+    const COutPoint prevout(kernel_txid, 1);
+    for (int i = 0; i < 16; ++i) {
+        const uint32_t nTime = index_prev.nTime + 16 * i;
+        uint256 hash_a, target_a, hash_b, target_b;
+        bool passed_a = CheckStakeKernelHash(&index_prev, nBits, index_prev.nTime - 1000, 10 * COIN, prevout, nTime, hash_a, target_a);
+        bool passed_b = CheckStakeKernelHash(index_prev.bnStakeModifier, nBits, index_prev.nTime - 1000, 10 * COIN, prevout, nTime, hash_b, target_b);
+        BOOST_CHECK_EQUAL(passed_a, passed_b);
+        BOOST_CHECK(hash_a == hash_b);
+        BOOST_CHECK(target_a == target_b);
+    }
+
+    // The key depends on every input of the checks
+    CMutableTransaction mtx;
+    mtx.nVersion = GLOBE_TXN_VERSION;
+    mtx.vin.emplace_back(prevout);
+    const CTransaction tx(mtx);
+    const CScript script = CScript() << OP_TRUE;
+    const uint256 key = GetStakeCheckKey(tx, script, 10 * COIN, index_prev.bnStakeModifier, 100, nBits, 200);
+    BOOST_CHECK(key == GetStakeCheckKey(tx, script, 10 * COIN, index_prev.bnStakeModifier, 100, nBits, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, CScript() << OP_FALSE, 10 * COIN, index_prev.bnStakeModifier, 100, nBits, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, script, 11 * COIN, index_prev.bnStakeModifier, 100, nBits, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, script, 10 * COIN, InsecureRand256(), 100, nBits, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, script, 10 * COIN, index_prev.bnStakeModifier, 101, nBits, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, script, 10 * COIN, index_prev.bnStakeModifier, 100, nBits + 1, 200));
+    BOOST_CHECK(key != GetStakeCheckKey(tx, script, 10 * COIN, index_prev.bnStakeModifier, 100, nBits, 216));
+
+    StakePrechecker prechecker;
+    uint256 hash_proof, target;
+    BOOST_CHECK(!prechecker.Take(key, hash_proof, target));
+    BOOST_CHECK_EQUAL(prechecker.Size(), 0U);
+    BOOST_CHECK(!prechecker.TakeBlock(&index_prev));
+}
+
+static void BuildStakeChain(std::vector<CBlockIndex>& blocks, const CBlockIndex* fork, size_t length)
+{
+    blocks.resize(length);
+    for (size_t i = 0; i < length; ++i) {
+        CBlockIndex& block = blocks[i];
+        block.pprev = i > 0 ? &blocks[i - 1] : const_cast<CBlockIndex*>(fork);
+        block.nHeight = block.pprev ? block.pprev->nHeight + 1 : 0;
+        block.nTime = (block.pprev ? block.pprev->nTime : 1600000000) + 16 + InsecureRandRange(200);
+        block.nBits = 0x1e00ffff - InsecureRandRange(0xff00);
+        if (block.nHeight > 0 && InsecureRandRange(8) != 0) {
+            block.SetProofOfStake();
+        }
+        block.BuildSkip();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(network_stake_weight)
+{
+    LOCK(cs_main);
+    std::vector<CBlockIndex> main_chain, fork_chain;
+    BuildStakeChain(main_chain, nullptr, 400);
+
+    // Tracked estimate matches walking the chain while blocks are connected one by one
+    NetworkStakeWeight tracker;
+    BOOST_CHECK_EQUAL(tracker.Height(), -1);
+    for (const auto& block : main_chain) {
+        tracker.SetTip(&block);
+        BOOST_CHECK(tracker.Tip() == &block);
+        BOOST_CHECK_CLOSE(tracker.Weight(), GetPoSKernelPS(&block), 0.0001);
+    }
+    BOOST_CHECK_EQUAL(tracker.Height(), 399);
+    BOOST_CHECK_EQUAL(tracker.GetHistory(1000).size(), 400U / NetworkStakeWeight::HISTORY_INTERVAL + 1);
+
+    // Disconnecting the tip drops its sample
+    tracker.SetTip(&main_chain[398]);
+    BOOST_CHECK_CLOSE(tracker.Weight(), GetPoSKernelPS(&main_chain[398]), 0.0001);
+
+    // Reorg to a fork
+    BuildStakeChain(fork_chain, &main_chain[250], 100);
+    for (const auto& block : fork_chain) {
+        tracker.SetTip(&block);
+        BOOST_CHECK_CLOSE(tracker.Weight(), GetPoSKernelPS(&block), 0.0001);
+    }
+    std::vector<NetworkStakeWeight::HistoryEntry> history = tracker.GetHistory(2);
+    BOOST_CHECK_EQUAL(history.size(), 2U);
+    BOOST_CHECK_EQUAL(history.back().height, 330);
+
+    // Starting from a tip walks back once
+    NetworkStakeWeight restarted;
+    restarted.SetTip(&fork_chain.back());
+    BOOST_CHECK_CLOSE(restarted.Weight(), tracker.Weight(), 0.0001);
+    BOOST_CHECK_CLOSE(restarted.SmoothedWeight(), restarted.Weight(), 0.0001);
+    BOOST_CHECK(restarted.GetHistory(10).empty());
+}
+
+BOOST_AUTO_TEST_CASE(anon_index_filter)
+{
+    // Dense indices use the bitmap, duplicates and order don't matter
+    const int64_t dense[] = {2400, 2221, 2239, 2301, 2400, 2290, 2350};
+    AnonIndexFilter dense_filter(dense, std::size(dense));
+    BOOST_CHECK_EQUAL(dense_filter.Size(), 6U);
+    for (int64_t anon_index : dense) {
+        BOOST_CHECK(dense_filter.Contains(anon_index));
+    }
+    BOOST_CHECK(!dense_filter.Contains(0));
+    BOOST_CHECK(!dense_filter.Contains(2220));
+    BOOST_CHECK(!dense_filter.Contains(2222));
+    BOOST_CHECK(!dense_filter.Contains(2401));
+    BOOST_CHECK(!dense_filter.Contains(std::numeric_limits<int64_t>::max()));
+
+    // Sparse indices fall back to the sorted array
+    const int64_t sparse[] = {1, int64_t{1} << 40, 100, std::numeric_limits<int64_t>::max()};
+    AnonIndexFilter sparse_filter(sparse, std::size(sparse));
+    BOOST_CHECK_EQUAL(sparse_filter.Size(), 4U);
+    for (int64_t anon_index : sparse) {
+        BOOST_CHECK(sparse_filter.Contains(anon_index));
+    }
+    BOOST_CHECK(!sparse_filter.Contains(2));
+    BOOST_CHECK(!sparse_filter.Contains((int64_t{1} << 40) - 1));
+
+    AnonIndexFilter empty;
+    BOOST_CHECK_EQUAL(empty.Size(), 0U);
+    BOOST_CHECK(!empty.Contains(0));
+}
+
+BOOST_AUTO_TEST_CASE(spent_coin_cache)
+{
+    SpentCoinCache cache;
+    std::vector<std::pair<COutPoint, SpentCoin>> coins;
+    for (uint32_t height = 10; height < 14; ++height) {
+        for (uint32_t n = 0; n < 3; ++n) {
+            Coin coin(CTxOut(height * 100 + n, CScript() << OP_TRUE), height - 5, false);
+            coins.emplace_back(COutPoint(InsecureRand256(), n), SpentCoin(coin, height));
+        }
+    }
+    BOOST_CHECK(cache.Add(coins) == std::set<uint32_t>({10, 11, 12, 13}));
+    BOOST_CHECK_EQUAL(cache.Size(), 12U);
+
+    SpentCoin spent_coin;
+    BOOST_CHECK(cache.Get(coins[4].first, spent_coin));
+    BOOST_CHECK_EQUAL(spent_coin.spent_height, 11U);
+    BOOST_CHECK_EQUAL(spent_coin.coin.out.nValue, 1101);
+    BOOST_CHECK_EQUAL(cache.GetBucket(11).size(), 3U);
+    BOOST_CHECK(cache.GetBucket(14).empty());
+
+    // Disconnecting the block at 13 empties its bucket
+    std::vector<std::pair<COutPoint, SpentCoin>> disconnected(coins.begin() + 9, coins.end());
+    BOOST_CHECK(cache.Remove(disconnected) == std::set<uint32_t>({13}));
+    BOOST_CHECK(cache.GetBucket(13).empty());
+    BOOST_CHECK(!cache.Get(coins[10].first, spent_coin));
+
+    // A coin spent again at another height moves between buckets
+    coins[0].second.spent_height = 12;
+    BOOST_CHECK(cache.Add({coins[0]}) == std::set<uint32_t>({10, 12}));
+    BOOST_CHECK_EQUAL(cache.GetBucket(10).size(), 2U);
+    BOOST_CHECK_EQUAL(cache.GetBucket(12).size(), 4U);
+
+    // Only the buckets in the range are dropped
+    BOOST_CHECK(cache.Drop(11, 12) == std::vector<uint32_t>({11}));
+    BOOST_CHECK_EQUAL(cache.GetBucket(10).size(), 2U);
+    BOOST_CHECK(cache.Drop(0, 12) == std::vector<uint32_t>({10}));
+    BOOST_CHECK_EQUAL(cache.Size(), 4U);
+    BOOST_CHECK(!cache.Get(coins[4].first, spent_coin));
+    BOOST_CHECK(cache.Get(coins[0].first, spent_coin));
+    auto all = cache.GetAll();
+    BOOST_CHECK_EQUAL(all.size(), 4U);
+    for (const auto& entry : all) {
+        BOOST_CHECK_EQUAL(entry.second.spent_height, 12U);
+    }
+
+    // Updates are previewed without changing the cache
+    SpentCoinCacheUpdate update;
+    update.remove = {coins[6]};
+    update.add = {coins[9]};
+    auto changed = cache.GetChangedBuckets(update);
+    BOOST_CHECK_EQUAL(changed.size(), 2U);
+    BOOST_CHECK_EQUAL(changed[12].size(), 3U);
+    BOOST_CHECK_EQUAL(changed[13].size(), 1U);
+    BOOST_CHECK_EQUAL(cache.GetBucket(12).size(), 4U);
+    BOOST_CHECK(!cache.Get(coins[9].first, spent_coin));
+    cache.Apply(update);
+    for (const auto& [height, bucket] : changed) {
+        BOOST_CHECK_EQUAL(cache.GetBucket(height).size(), bucket.size());
+    }
+    BOOST_CHECK(!cache.Get(coins[6].first, spent_coin));
+    BOOST_CHECK(cache.Get(coins[9].first, spent_coin));
+
+    // Dropped buckets are previewed empty
+    SpentCoinCacheUpdate drop;
+    drop.drop_from = 13;
+    drop.drop_to = 14;
+    changed = cache.GetChangedBuckets(drop);
+    BOOST_CHECK_EQUAL(changed.size(), 1U);
+    BOOST_CHECK(changed[13].empty());
+    cache.Apply(drop);
+    BOOST_CHECK(cache.GetBucket(13).empty());
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
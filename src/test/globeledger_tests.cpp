@@ -0,0 +1,142 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <globe/globeledger.h>
+
+#include <fs.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+#include <util/system.h>
+
+#include <boost/process/search_path.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace {
+//! Stand-in for hwilib, signs with the arguments it was given
+const std::string STUB_HWILIB_CLI{R"(import base64
+import sys
+import threading
+import time
+
+
+def request_queued():
+    # Peeking blocks until a request arrives, give up after a while
+    result = []
+    thread = threading.Thread(target=lambda: result.append(len(sys.stdin.buffer.peek(1)) > 0), daemon=True)
+    thread.start()
+    thread.join(2)
+    return bool(result and result[0])
+
+
+def process_commands(args):
+    if 'sleep' in args:
+        time.sleep(30)
+    if 'signtx' in args:
+        # The header request is sent before the transaction response is read
+        return {'psbt': args[-1] + (' pipelined' if request_queued() else '')}
+    if 'signheader' in args:
+        return {'signature': base64.b64encode(bytes.fromhex(args[-2])[:65]).decode()}
+    return {'signature': ' '.join(args)}
+)"};
+
+void WriteText(const fs::path& path, const std::string& text)
+{
+    std::ofstream file;
+    file.open(path);
+    file << text;
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(globeledger_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(hwi_session_framing)
+{
+    const fs::path session_path{fs::PathFromString(HWI_SESSION_SCRIPT)};
+    if (!fs::exists(session_path) || boost::process::search_path("python3").empty()) {
+        BOOST_TEST_MESSAGE("Skipping, python3 or contrib/hwi/hwi-session.py not found");
+        return;
+    }
+
+    // hwi-session.py imports hwilib from the directory of the tool
+    const fs::path tool_dir{m_path_root / "hwi"};
+    fs::create_directories(tool_dir / "hwilib");
+    WriteText(tool_dir / "hwi.py", "");
+    WriteText(tool_dir / "hwilib" / "__init__.py", "");
+    WriteText(tool_dir / "hwilib" / "_cli.py", STUB_HWILIB_CLI);
+    gArgs.ForceSetArg("-hwitoolpath", fs::PathToString(tool_dir / "hwi.py"));
+    gArgs.ForceSetArg("-hwisessionpath", fs::PathToString(session_path));
+
+    {
+        GlobeLedger ledger;
+        std::string signature;
+        BOOST_CHECK(ledger.signMessage("00000000", "message", "m/0", signature));
+        BOOST_CHECK(EndsWith(signature, "-f 00000000 signmessage message m/0"));
+
+        // Requests and responses larger than the pipe buffers, escaped in the json
+        const std::string message = std::string(200000, 'a') + "\"\\\né";
+        BOOST_CHECK(ledger.signMessage("00000000", message, "m/1", signature));
+        BOOST_CHECK(EndsWith(signature, "signmessage " + message + " m/1"));
+
+        // Responses come from the same helper in order
+        for (int i = 0; i < 10; ++i) {
+            BOOST_CHECK(ledger.signMessage("00000000", strprintf("message %d", i), "m/0", signature));
+            BOOST_CHECK(EndsWith(signature, strprintf("message %d m/0", i)));
+        }
+
+        const std::string header = HexStr(std::vector<unsigned char>(80, 0x5a));
+        std::vector<unsigned char> sig;
+        std::string psbt = "psbt";
+        BOOST_CHECK(ledger.signCoinStake("00000000", psbt));
+        BOOST_CHECK_EQUAL(psbt, "psbt");
+        BOOST_CHECK(ledger.signBlockHeader("00000000", header, "m/0", sig));
+        BOOST_CHECK(sig == std::vector<unsigned char>(65, 0x5a));
+
+        // Both requests are written before the first response is read
+        psbt = "psbt";
+        sig.clear();
+        BOOST_CHECK(ledger.signCoinStakeAndHeader("00000000", psbt, header, "m/0", sig));
+        BOOST_CHECK_EQUAL(psbt, "psbt pipelined");
+        BOOST_CHECK(sig == std::vector<unsigned char>(65, 0x5a));
+    }
+
+    gArgs.ForceSetArg("-hwisessiontimeout", "2");
+    {
+        GlobeLedger ledger;
+        std::string signature;
+        BOOST_CHECK(!ledger.signMessage("00000000", "sleep", "m/0", signature));
+        BOOST_CHECK_EQUAL(ledger.errorMessage(), "HWI session timed out");
+
+        // The helper is started again for the next request
+        BOOST_CHECK(ledger.signMessage("00000000", "message", "m/0", signature));
+        BOOST_CHECK(EndsWith(signature, "-f 00000000 signmessage message m/0"));
+
+        // A timed out pair drops the queued header request with the helper
+        const std::string header = HexStr(std::vector<unsigned char>(80, 0x5a));
+        std::vector<unsigned char> sig;
+        std::string psbt = "sleep";
+        BOOST_CHECK(!ledger.signCoinStakeAndHeader("00000000", psbt, header, "m/0", sig));
+        BOOST_CHECK_EQUAL(ledger.errorMessage(), "HWI session timed out");
+        BOOST_CHECK(sig.empty());
+
+        psbt = "psbt";
+        BOOST_CHECK(ledger.signCoinStakeAndHeader("00000000", psbt, header, "m/0", sig));
+        BOOST_CHECK_EQUAL(psbt, "psbt pipelined");
+        BOOST_CHECK(sig == std::vector<unsigned char>(65, 0x5a));
+    }
+
+    gArgs.ForceSetArg("-hwitoolpath", "");
+    gArgs.ForceSetArg("-hwisessionpath", "");
+    gArgs.ForceSetArg("-hwisessiontimeout", strprintf("%d", DEFAULT_HWI_SESSION_TIMEOUT));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
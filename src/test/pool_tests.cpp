@@ -0,0 +1,95 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <memusage.h>
+#include <support/allocators/pool.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating)
+{
+    auto resource = PoolResource<8, 8>(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 1024U);
+
+    // Freed blocks are reused
+    void* block = resource.Allocate(8, 8);
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK(block == resource.Allocate(8, 8));
+
+    // Sizes are rounded up to the alignment, 1..8 bytes share a free list
+    void* b1 = resource.Allocate(1, 1);
+    resource.Deallocate(b1, 1, 1);
+    BOOST_CHECK(b1 == resource.Allocate(8, 8));
+
+    // Large or overaligned blocks bypass the pool
+    void* large = resource.Allocate(16, 8);
+    void* aligned = resource.Allocate(8, 16);
+    BOOST_CHECK(reinterpret_cast<uintptr_t>(aligned) % 16 == 0);
+    resource.Deallocate(large, 16, 8);
+    resource.Deallocate(aligned, 8, 16);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(allocate_chunks)
+{
+    auto resource = PoolResource<8, 8>(64);
+
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 8; ++i) {
+        blocks.push_back(resource.Allocate(8, 8));
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1U);
+
+    // The first chunk is full
+    blocks.push_back(resource.Allocate(8, 8));
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+
+    // Freeing everything keeps the chunks until the resource is destroyed
+    for (void* p : blocks) {
+        resource.Deallocate(p, 8, 8);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+    for (size_t i = 0; i < 9; ++i) {
+        resource.Allocate(8, 8);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(memusage_test)
+{
+    auto std_map = std::unordered_map<int64_t, int64_t>{};
+
+    using Map = std::unordered_map<int64_t,
+                                   int64_t,
+                                   std::hash<int64_t>,
+                                   std::equal_to<int64_t>,
+                                   PoolAllocator<std::pair<const int64_t, int64_t>,
+                                                 sizeof(std::pair<const int64_t, int64_t>) + sizeof(void*) * 4>>;
+    auto resource = Map::allocator_type::ResourceType(1024);
+    Map resource_map{0, std::hash<int64_t>{}, std::equal_to<int64_t>{}, &resource};
+
+    for (int64_t i = 0; i < 1000; ++i) {
+        std_map[i];
+        resource_map[i];
+
+        // The pool's usage is counted in whole chunks, it is never less than
+        // the nodes actually stored.
+        BOOST_CHECK(memusage::DynamicUsage(resource_map) >= resource.NumAllocatedChunks() * resource.ChunkSizeBytes());
+    }
+
+    // Allocating in chunks shouldn't use much more than allocating each node
+    BOOST_TEST_MESSAGE("std_map " << memusage::DynamicUsage(std_map) << ", resource_map " << memusage::DynamicUsage(resource_map));
+    BOOST_CHECK(memusage::DynamicUsage(resource_map) <= memusage::DynamicUsage(std_map) * 1.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <test/util/setup_common.h>
 #include <threadinterrupt.h>
 #include <util/sock.h>
+#include <util/sockepoll.h>
 #include <util/system.h>
 
 #include <boost/test/unit_test.hpp>
@@ -157,6 +158,74 @@ BOOST_AUTO_TEST_CASE(recv_until_terminator_limit)
     receiver.join();
 }
 
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(epoll_wait)
+{
+    int s[2];
+    CreateSocketPair(s);
+
+    auto sock0 = std::make_shared<Sock>(s[0]);
+    auto sock1 = std::make_shared<Sock>(s[1]);
+
+    SockEpoll epoll;
+    BOOST_REQUIRE(epoll.IsValid());
+    BOOST_REQUIRE(epoll.Update(sock0, Sock::RECV, /*edge_triggered=*/true));
+    BOOST_REQUIRE(epoll.Update(sock1, Sock::SEND, /*edge_triggered=*/false));
+    epoll.RemoveUnused();
+    BOOST_CHECK_EQUAL(epoll.Size(), 2U);
+
+    Sock::EventsPerSock events_per_sock;
+    events_per_sock.emplace(sock0, Sock::Events{Sock::RECV});
+    events_per_sock.emplace(sock1, Sock::Events{Sock::SEND});
+
+    // Nothing to read yet, level triggered SEND is reported on every wait
+    for (int i = 0; i < 2; ++i) {
+        BOOST_REQUIRE(epoll.Wait(0ms, events_per_sock));
+        BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, 0);
+        BOOST_CHECK_EQUAL(events_per_sock.at(sock1).occurred, Sock::SEND);
+    }
+
+    // Edge triggered RECV is reported once per arrival of data
+    BOOST_REQUIRE_EQUAL(sock1->Send("a", 1, 0), 1);
+    BOOST_REQUIRE(epoll.Wait(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, Sock::RECV);
+    BOOST_REQUIRE(epoll.Wait(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, 0);
+
+    // Changing the registration re-arms it and reports the unread data again
+    BOOST_REQUIRE(epoll.Update(sock0, Sock::RECV, /*edge_triggered=*/false));
+    BOOST_REQUIRE(epoll.Update(sock1, Sock::SEND, /*edge_triggered=*/false));
+    epoll.RemoveUnused();
+    BOOST_REQUIRE(epoll.Wait(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, Sock::RECV);
+
+    // Sockets not updated since the last sweep are dropped
+    BOOST_REQUIRE(epoll.Update(sock1, Sock::SEND, /*edge_triggered=*/false));
+    epoll.RemoveUnused();
+    BOOST_CHECK_EQUAL(epoll.Size(), 1U);
+    BOOST_REQUIRE(epoll.Wait(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, 0);
+
+    // Only the sockets that are ready are listed
+    SockEpoll::ReadySocks ready;
+    BOOST_REQUIRE(epoll.Wait(0ms, ready));
+    BOOST_REQUIRE_EQUAL(ready.size(), 1U);
+    BOOST_CHECK(ready[0].first == sock1);
+    BOOST_CHECK_EQUAL(ready[0].second, Sock::SEND);
+
+    // A socket registered with unread data is reported, a removed one is not
+    BOOST_REQUIRE(epoll.Update(sock0, Sock::RECV | Sock::SEND, /*edge_triggered=*/true));
+    epoll.Remove(sock1);
+    BOOST_CHECK_EQUAL(epoll.Size(), 1U);
+    BOOST_REQUIRE(epoll.Wait(0ms, ready));
+    BOOST_REQUIRE_EQUAL(ready.size(), 1U);
+    BOOST_CHECK(ready[0].first == sock0);
+    BOOST_CHECK_EQUAL(ready[0].second, Sock::RECV | Sock::SEND);
+    BOOST_REQUIRE(epoll.Wait(0ms, ready));
+    BOOST_CHECK(ready.empty());
+}
+#endif // USE_EPOLL
+
 #endif /* WIN32 */
 
 BOOST_AUTO_TEST_SUITE_END()
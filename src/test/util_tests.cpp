@@ -14,10 +14,13 @@
 #include <test/util/str.h>
 #include <uint256.h>
 #include <util/getuniquepath.h>
+#include <util/lrucache.h>
 #include <util/message.h> // For MessageSign(), MessageVerify(), MESSAGE_MAGIC
 #include <util/moneystr.h>
 #include <util/overflow.h>
+#include <util/parallel.h>
 #include <util/readwritefile.h>
+#include <util/shardedqueue.h>
 #include <util/spanparsing.h>
 #include <util/strencodings.h>
 #include <util/string.h>
@@ -27,6 +30,7 @@
 
 #include <array>
 #include <fstream>
+#include <future>
 #include <limits>
 #include <map>
 #include <optional>
@@ -2785,4 +2789,104 @@ BOOST_AUTO_TEST_CASE(util_WriteBinaryFile)
     BOOST_CHECK(valid);
     BOOST_CHECK_EQUAL(actual_text, expected_text);
 }
+
+BOOST_AUTO_TEST_CASE(util_ParallelFor)
+{
+    for (int threads : {0, 1, 4}) {
+        std::vector<std::atomic<int>> counts(1000);
+        BOOST_CHECK(util::ParallelFor(counts.size(), threads, [&](size_t i) {
+            counts[i]++;
+            return true;
+        }));
+        for (const auto& c : counts) {
+            BOOST_CHECK_EQUAL(c.load(), 1);
+        }
+    }
+
+    // A failing item is reported
+    BOOST_CHECK(!util::ParallelFor(1000, 4, [](size_t i) { return i != 10; }));
+    BOOST_CHECK(util::ParallelFor(0, 4, [](size_t) { return false; }));
+}
+
+BOOST_AUTO_TEST_CASE(util_LRUCache)
+{
+    util::LRUCache<int, int> cache(3);
+    int value;
+    for (int i = 0; i < 3; ++i) {
+        cache.Insert(i, i * 10);
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+
+    // Touch 0 so 1 becomes the least recently used
+    BOOST_CHECK(cache.Get(0, value));
+    BOOST_CHECK_EQUAL(value, 0);
+    cache.Insert(3, 30);
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+    BOOST_CHECK(!cache.Get(1, value));
+    BOOST_CHECK(cache.Get(0, value));
+    BOOST_CHECK(cache.Get(3, value));
+    BOOST_CHECK_EQUAL(value, 30);
+
+    // Updating an entry doesn't grow the cache
+    cache.Insert(3, 31);
+    BOOST_CHECK_EQUAL(cache.Size(), 3U);
+    BOOST_CHECK(cache.Get(3, value));
+    BOOST_CHECK_EQUAL(value, 31);
+
+    cache.Erase(3);
+    BOOST_CHECK(!cache.Get(3, value));
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+
+    cache.SetMaxSize(1);
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    cache.SetMaxSize(0);
+    cache.Insert(4, 40);
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(util_ShardedTaskQueue)
+{
+    util::ShardedTaskQueue queue;
+    BOOST_CHECK(!queue.Enqueue(0, 1, [] {}));
+
+    constexpr int num_keys{8}, tasks_per_key{100};
+    queue.Start("test", 3, tasks_per_key * num_keys);
+    BOOST_CHECK_EQUAL(queue.NumThreads(), 3U);
+
+    // Tasks of a key run on one thread, in order
+    std::vector<std::vector<int>> results(num_keys);
+    std::atomic<int> num_done{0};
+    for (int i = 0; i < tasks_per_key; ++i) {
+        for (int key = 0; key < num_keys; ++key) {
+            BOOST_REQUIRE(queue.Enqueue(key, 1, [&results, &num_done, key, i] {
+                results[key].push_back(i);
+                ++num_done;
+            }));
+        }
+    }
+    while (num_done < num_keys * tasks_per_key) {
+        UninterruptibleSleep(1ms);
+    }
+    for (const auto& result : results) {
+        BOOST_REQUIRE_EQUAL(result.size(), size_t{tasks_per_key});
+        for (int i = 0; i < tasks_per_key; ++i) {
+            BOOST_CHECK_EQUAL(result[i], i);
+        }
+    }
+
+    // A full shard refuses tasks, an empty one takes a task of any size
+    std::promise<void> started, blocker;
+    std::shared_future<void> blocked{blocker.get_future()};
+    BOOST_REQUIRE(queue.Enqueue(0, 1, [&started, blocked] { started.set_value(); blocked.wait(); }));
+    started.get_future().wait();
+    BOOST_CHECK(queue.Enqueue(0, 1000000, [] {}));
+    BOOST_CHECK(!queue.Enqueue(3, 1, [] {}));
+    BOOST_CHECK(queue.Enqueue(1, 1, [] {}));
+    blocker.set_value();
+
+    // Pending tasks are destroyed without running
+    queue.Stop();
+    BOOST_CHECK_EQUAL(queue.NumThreads(), 0U);
+    BOOST_CHECK(!queue.Enqueue(0, 1, [] {}));
+}
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include <consensus/validation.h>
 #include <node/utxo_snapshot.h>
 #include <random.h>
+#include <rctindex.h>
 #include <rpc/blockchain.h>
 #include <sync.h>
 #include <test/util/chainstate.h>
@@ -14,12 +15,15 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <txdb.h>
+
 #include <tinyformat.h>
 
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
 
+using node::SnapshotChunk;
 using node::SnapshotMetadata;
 
 BOOST_FIXTURE_TEST_SUITE(validation_chainstatemanager_tests, ChainTestingSetup)
@@ -194,14 +198,16 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot, TestChain100Setup)
     // Should not load malleated snapshots
     BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
         m_node, m_path_root, [](AutoFile& auto_infile, SnapshotMetadata& metadata) {
-            // A UTXO is missing but count is correct
-            metadata.m_coins_count -= 1;
-
-            COutPoint outpoint;
-            Coin coin;
+            // A chunk of UTXOs is missing but count is correct
+            SnapshotChunk chunk;
+            auto_infile >> chunk;
 
-            auto_infile >> outpoint;
-            auto_infile >> coin;
+            metadata.m_coins_count -= chunk.m_count;
+    }));
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        m_node, m_path_root, [](AutoFile& auto_infile, SnapshotMetadata& metadata) {
+            // Unknown format version
+            metadata.m_version += 1;
     }));
     BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
         m_node, m_path_root, [](AutoFile& auto_infile, SnapshotMetadata& metadata) {
@@ -312,6 +318,125 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot, TestChain100Setup)
         loaded_snapshot_blockhash);
 }
 
+//! Test that a Globe mode snapshot carries the anon outputs, key images and
+//! spent cache, written to the block tree db only once the snapshot is valid.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot_rct, TestChain100Setup)
+{
+    ChainstateManager& chainman = *Assert(m_node.chainman);
+    CBlockTreeDB& block_tree_db = *chainman.m_blockman.m_block_tree_db;
+    mineBlocks(10);
+
+    // The coins hash doesn't depend on the mode, only the RCT sections do
+    const bool globe_mode = fGlobeMode;
+    fGlobeMode = true;
+
+    constexpr int64_t num_anon_outputs{2};
+    std::vector<std::pair<int64_t, CAnonOutput>> anon_outputs;
+    std::vector<std::pair<CCmpPubKey, CAnonKeyImageInfo>> key_images;
+    for (int64_t i = 1; i <= num_anon_outputs; ++i) {
+        CKey key;
+        key.MakeNewKey(true);
+        CAnonOutput ao;
+        ao.pubkey = CCmpPubKey(key.GetPubKey());
+        memset(ao.commitment.data, 0, sizeof(ao.commitment.data));
+        ao.outpoint = COutPoint(InsecureRand256(), 1);
+        ao.nBlockHeight = 100 + i;
+        anon_outputs.emplace_back(i, ao);
+
+        key.MakeNewKey(true);
+        key_images.emplace_back(CCmpPubKey(key.GetPubKey()), CAnonKeyImageInfo(InsecureRand256(), 105));
+    }
+    const std::vector<std::pair<COutPoint, SpentCoin>> spent_coins{
+        {COutPoint(InsecureRand256(), 0), SpentCoin(Coin(CTxOut(1 * COIN, CScript() << OP_TRUE), 100, false), 105)}};
+
+    const auto write_rct_tables = [&]() {
+        CDBBatch batch(block_tree_db);
+        for (const auto& [index, ao] : anon_outputs) {
+            batch.Write(std::make_pair(uint8_t(DB_RCTOUTPUT), index), ao);
+            batch.Write(std::make_pair(uint8_t(DB_RCTOUTPUT_LINK), ao.pubkey), index);
+        }
+        for (const auto& [ki, data] : key_images) {
+            batch.Write(std::make_pair(uint8_t(DB_RCTKEYIMAGE), ki), data);
+        }
+        SpentCoinCacheUpdate spent_cache_update;
+        spent_cache_update.add = spent_coins;
+        block_tree_db.WriteSpentCache(batch, spent_cache_update);
+        BOOST_REQUIRE(block_tree_db.WriteBatch(batch));
+        block_tree_db.ApplySpentCache(spent_cache_update);
+    };
+    // Called after the snapshot is written, so loading it must restore the tables
+    const auto erase_rct_tables = [&]() {
+        CDBBatch batch(block_tree_db);
+        for (const auto& [index, ao] : anon_outputs) {
+            batch.Erase(std::make_pair(uint8_t(DB_RCTOUTPUT), index));
+            batch.Erase(std::make_pair(uint8_t(DB_RCTOUTPUT_LINK), ao.pubkey));
+        }
+        for (const auto& [ki, data] : key_images) {
+            batch.Erase(std::make_pair(uint8_t(DB_RCTKEYIMAGE), ki));
+        }
+        SpentCoinCacheUpdate spent_cache_update;
+        spent_cache_update.remove = spent_coins;
+        block_tree_db.WriteSpentCache(batch, spent_cache_update);
+        BOOST_REQUIRE(block_tree_db.WriteBatch(batch));
+        block_tree_db.ApplySpentCache(spent_cache_update);
+    };
+    const auto count_rct_rows = [&]() {
+        size_t rows{0};
+        for (const auto& [index, ao] : anon_outputs) {
+            CAnonOutput ao_read;
+            int64_t index_read;
+            if (block_tree_db.ReadRCTOutput(index, ao_read)) {
+                BOOST_CHECK(ao_read.pubkey == ao.pubkey);
+                BOOST_CHECK(ao_read.outpoint == ao.outpoint);
+                rows++;
+            }
+            if (block_tree_db.ReadRCTOutputLink(ao.pubkey, index_read)) {
+                BOOST_CHECK_EQUAL(index_read, index);
+                rows++;
+            }
+        }
+        for (const auto& [ki, data] : key_images) {
+            CAnonKeyImageInfo data_read;
+            if (block_tree_db.ReadRCTKeyImage(ki, data_read)) {
+                BOOST_CHECK(data_read.txid == data.txid);
+                rows++;
+            }
+        }
+        for (const auto& [outpoint, spent_coin] : spent_coins) {
+            SpentCoin spent_coin_read;
+            if (block_tree_db.ReadSpentCache(outpoint, spent_coin_read)) {
+                BOOST_CHECK_EQUAL(spent_coin_read.spent_height, spent_coin.spent_height);
+                rows++;
+            }
+        }
+        return rows;
+    };
+    const size_t num_rows{anon_outputs.size() * 2 + key_images.size() + spent_coins.size()};
+
+    write_rct_tables();
+    WITH_LOCK(::cs_main, chainman.ActiveTip()->nAnonOutputs = num_anon_outputs);
+    BOOST_CHECK_EQUAL(count_rct_rows(), num_rows);
+
+    // Nothing is written if the snapshot fails validation after the RCT sections are read
+    BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
+        m_node, m_path_root, [&](AutoFile& auto_infile, SnapshotMetadata& metadata) {
+            erase_rct_tables();
+            metadata.m_anon_output_count += 1;
+    }));
+    BOOST_CHECK_EQUAL(count_rct_rows(), 0U);
+
+    write_rct_tables();
+    BOOST_REQUIRE(CreateAndActivateUTXOSnapshot(
+        m_node, m_path_root, [&](AutoFile& auto_infile, SnapshotMetadata& metadata) {
+            BOOST_CHECK_EQUAL(metadata.m_anon_output_count, num_anon_outputs);
+            erase_rct_tables();
+    }));
+    BOOST_CHECK_EQUAL(count_rct_rows(), num_rows);
+    BOOST_CHECK_EQUAL(WITH_LOCK(::cs_main, return chainman.ActiveTip()->nAnonOutputs), num_anon_outputs);
+
+    fGlobeMode = globe_mode;
+}
+
 //! Test LoadBlockIndex behavior when multiple chainstates are in use.
 //!
 //! - First, verfiy that setBlockIndexCandidates is as expected when using a single,
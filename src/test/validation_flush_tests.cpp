@@ -2,12 +2,16 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 //
+#include <memusage.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <unordered_map>
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(validation_flush_tests, TestingSetup)
 
 //! Test utilities for detecting when we need to flush the coins cache based
@@ -47,7 +51,30 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
         BOOST_TEST_MESSAGE("CCoinsViewCache memory usage: " << view.DynamicMemoryUsage());
     };
 
-    constexpr size_t MAX_COINS_CACHE_BYTES = 1024 + 64; // Inc for Globe
+    // The nodes of cacheCoins are carved out of its pool resource, so the
+    // view's memory usage is the pool's chunks with their std::list nodes,
+    // the bucket array and the coins' heap data.
+    //
+    // See also: memusage::DynamicUsage() for the PoolAllocator.
+    const size_t CHUNK_USAGE{memusage::MallocUsage(sizeof(void*) * 3) + memusage::MallocUsage(CCoinsMapMemoryResource{}.ChunkSizeBytes())};
+
+    // cacheCoins grows its bucket array like any other unordered_map, record
+    // the bucket counts of a map as it is filled.
+    std::vector<size_t> bucket_counts;
+    std::unordered_map<int, int> bucket_model;
+    for (int i{0}; i < 1000; ++i) {
+        bucket_counts.push_back(bucket_model.bucket_count());
+        bucket_model.emplace(i, 0);
+    }
+    auto expected_usage = [&](size_t num_coins) {
+        return CHUNK_USAGE + memusage::MallocUsage(sizeof(void*) * bucket_counts.at(num_coins)) + num_coins * COIN_SIZE;
+    };
+
+    const size_t EMPTY_VIEW_SIZE{expected_usage(0)};
+
+    // Leave room for a few coins before the view is over 90% of the limit.
+    const size_t MAX_COINS_CACHE_BYTES{(EMPTY_VIEW_SIZE + 1024) * 10 / 9};
+    const size_t LARGE_THRESHOLD{MAX_COINS_CACHE_BYTES * 9 / 10};
 
     // Without any coins in the cache, we shouldn't need to flush.
     BOOST_CHECK_EQUAL(
@@ -57,9 +84,8 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
     // If the initial memory allocations of cacheCoins don't match these common
     // cases, we can't really continue to make assertions about memory usage.
     // End the test early.
-    if ((view.DynamicMemoryUsage() != 32 && view.DynamicMemoryUsage() != 16) || sizeof(Coin) != 112) {
+    if (view.DynamicMemoryUsage() != EMPTY_VIEW_SIZE || sizeof(Coin) != 56) {
         // Add a bunch of coins to see that we at least flip over to CRITICAL.
-
         for (int i{0}; i < 1000; ++i) {
             COutPoint res = add_coin(view);
             BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
@@ -74,65 +100,79 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
     }
 
     print_view_mem_usage(view);
-    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), is_64_bit ? 32U : 16U);
-
-    // We should be able to add COINS_UNTIL_CRITICAL coins to the cache before going CRITICAL.
-    // This is contingent not only on the dynamic memory usage of the Coins
-    // that we're adding (COIN_SIZE bytes per), but also on how much memory the
-    // cacheCoins (unordered_map) preallocates.
-    constexpr int COINS_UNTIL_CRITICAL{2};
-
-    for (int i{0}; i < COINS_UNTIL_CRITICAL; ++i) {
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), EMPTY_VIEW_SIZE);
+
+    // We should be able to add coins to the cache until the next one takes
+    // it over 90% of the limit. This is contingent on the dynamic memory
+    // usage of the Coins that we're adding (COIN_SIZE bytes per) and on the
+    // bucket array of cacheCoins, the nodes fit in the first chunk.
+    size_t num_coins{0};
+    while (expected_usage(num_coins + 1) <= LARGE_THRESHOLD) {
         COutPoint res = add_coin(view);
+        ++num_coins;
         print_view_mem_usage(view);
         BOOST_CHECK_EQUAL(view.AccessCoin(res).DynamicMemoryUsage(), COIN_SIZE);
+        BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), expected_usage(num_coins));
         BOOST_CHECK_EQUAL(
             chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
             CoinsCacheSizeState::OK);
     }
+    BOOST_CHECK(num_coins > 0);
 
-    // Adding some additional coins will push us over the edge to CRITICAL.
-    for (int i{0}; i < 4; ++i) {
+    // Then we're LARGE until the next coin takes us over the limit.
+    const size_t coins_until_large{num_coins};
+    while (expected_usage(num_coins + 1) <= MAX_COINS_CACHE_BYTES) {
         add_coin(view);
-        print_view_mem_usage(view);
-        if (chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0) ==
-            CoinsCacheSizeState::CRITICAL) {
-            break;
-        }
+        ++num_coins;
+        BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), expected_usage(num_coins));
+        BOOST_CHECK_EQUAL(
+            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
+            CoinsCacheSizeState::LARGE);
     }
+    BOOST_CHECK(num_coins > coins_until_large);
+    print_view_mem_usage(view);
 
+    // Adding another coin will push us over the edge to CRITICAL.
+    add_coin(view);
+    ++num_coins;
+    print_view_mem_usage(view);
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), expected_usage(num_coins));
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/0),
         CoinsCacheSizeState::CRITICAL);
 
     // Passing non-zero max mempool usage should allow us more headroom.
+    const size_t MAX_MEMPOOL_BYTES{MAX_COINS_CACHE_BYTES / 8};
+    const size_t MEMPOOL_LARGE_THRESHOLD{(MAX_COINS_CACHE_BYTES + MAX_MEMPOOL_BYTES) * 9 / 10};
     BOOST_CHECK_EQUAL(
-        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 10),
+        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, MAX_MEMPOOL_BYTES),
         CoinsCacheSizeState::OK);
 
-    for (int i{0}; i < 2; ++i) {
+    const size_t coins_until_critical{num_coins};
+    while (expected_usage(num_coins + 1) <= MEMPOOL_LARGE_THRESHOLD) {
         add_coin(view);
+        ++num_coins;
         print_view_mem_usage(view);
         BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, /*max_mempool_size_bytes=*/1 << 10),
+            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, MAX_MEMPOOL_BYTES),
             CoinsCacheSizeState::OK);
     }
+    BOOST_CHECK(num_coins > coins_until_critical);
 
     // Adding another coin with the additional mempool room will put us >90%
     // but not yet critical.
     add_coin(view);
+    ++num_coins;
     print_view_mem_usage(view);
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), expected_usage(num_coins));
 
-    // Only perform these checks on 64 bit hosts; I haven't done the math for 32.
-    if (is_64_bit) {
-        float usage_percentage = (float)view.DynamicMemoryUsage() / (MAX_COINS_CACHE_BYTES + (1 << 10));
-        BOOST_TEST_MESSAGE("CoinsTip usage percentage: " << usage_percentage);
-        BOOST_CHECK(usage_percentage >= 0.9);
-        BOOST_CHECK(usage_percentage < 1.0);
-        BOOST_CHECK_EQUAL(
-            chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 1 << 10),
-            CoinsCacheSizeState::LARGE);
-    }
+    float usage_percentage = (float)view.DynamicMemoryUsage() / (MAX_COINS_CACHE_BYTES + MAX_MEMPOOL_BYTES);
+    BOOST_TEST_MESSAGE("CoinsTip usage percentage: " << usage_percentage);
+    BOOST_CHECK(usage_percentage >= 0.9);
+    BOOST_CHECK(usage_percentage < 1.0);
+    BOOST_CHECK_EQUAL(
+        chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, MAX_MEMPOOL_BYTES),
+        CoinsCacheSizeState::LARGE);
 
     // Using the default max_* values permits way more coins to be added.
     for (int i{0}; i < 1000; ++i) {
@@ -142,20 +182,20 @@ BOOST_AUTO_TEST_CASE(getcoinscachesizestate)
             CoinsCacheSizeState::OK);
     }
 
-    // Flushing the view doesn't take us back to OK because cacheCoins has
-    // preallocated memory that doesn't get reclaimed even after flush.
-
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
         CoinsCacheSizeState::CRITICAL);
 
+    // Flushing the view releases the pool's chunks and the bucket array,
+    // taking us back to OK.
     view.SetBestBlock(InsecureRand256(), 5);
     BOOST_CHECK(view.Flush());
     print_view_mem_usage(view);
 
+    BOOST_CHECK_EQUAL(view.DynamicMemoryUsage(), EMPTY_VIEW_SIZE);
     BOOST_CHECK_EQUAL(
         chainstate.GetCoinsCacheSizeState(MAX_COINS_CACHE_BYTES, 0),
-        CoinsCacheSizeState::CRITICAL);
+        CoinsCacheSizeState::OK);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
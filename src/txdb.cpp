@@ -38,6 +38,11 @@ static constexpr uint8_t DB_HEAD_BLOCKS{'H'};
 static constexpr uint8_t DB_FLAG{'F'};
 static constexpr uint8_t DB_REINDEX_FLAG{'R'};
 static constexpr uint8_t DB_LAST_BLOCK{'l'};
+static constexpr uint8_t DB_BLOCK_INDEX_SNAPSHOT{'X'};
+static constexpr uint8_t DB_BLOCK_INDEX_JOURNAL{'J'};
+
+//! Version of the block index snapshot file format
+static constexpr uint32_t BLOCK_INDEX_SNAPSHOT_VERSION{1};
 
 /*
 static constexpr uint8_t DB_RCTOUTPUT = 'A';
@@ -198,6 +203,8 @@ size_t CCoinsViewDB::EstimateSize() const
 }
 
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles) : CDBWrapper(gArgs.GetDataDirNet() / "blocks" / "index", nCacheSize, fMemory, fWipe, false, compression, maxOpenFiles) {
+    // Entries written while a snapshot is recorded must be journaled, or the snapshot would be stale
+    m_block_index_journal = Exists(DB_BLOCK_INDEX_SNAPSHOT);
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -243,13 +250,18 @@ private:
 };
 
 std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor() const
+{
+    return Cursor(COutPoint{uint256::ZERO, 0});
+}
+
+std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor(const COutPoint& start) const
 {
     auto i = std::make_unique<CCoinsViewDBCursor>(
         const_cast<CDBWrapper&>(*m_db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COIN);
+    i->pcursor->Seek(CoinEntry(&start));
     // Cache key of first record
     if (i->pcursor->Valid()) {
         CoinEntry entry(&i->keyTmp.second);
@@ -300,6 +312,9 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     batch.Write(DB_LAST_BLOCK, nLastFile);
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
         batch.Write(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
+        if (m_block_index_journal) {
+            batch.Write(std::make_pair(DB_BLOCK_INDEX_JOURNAL, (*it)->GetBlockHash()), uint8_t{1});
+        }
     }
     return WriteBatch(batch, true);
 }
@@ -334,6 +349,14 @@ bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddres
 
 bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
                                            std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+    return ForEachAddressUnspentIndex(addressHash, type, [&](const CAddressUnspentKey& key, const CAddressUnspentValue& value) {
+        unspentOutputs.push_back(std::make_pair(key, value));
+        return true;
+    });
+}
+
+bool CBlockTreeDB::ForEachAddressUnspentIndex(const uint256& addressHash, int type,
+                                              const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& fn) {
     const std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
     pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
@@ -344,7 +367,9 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint256 addressHash, int type,
         if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
             CAddressUnspentValue nValue;
             if (pcursor->GetValue(nValue)) {
-                unspentOutputs.push_back(std::make_pair(key.second, nValue));
+                if (!fn(key.second, nValue)) {
+                    break;
+                }
                 pcursor->Next();
             } else {
                 return error("failed to get address unspent value");
@@ -374,6 +399,14 @@ bool CBlockTreeDB::EraseAddressIndex(const std::vector<std::pair<CAddressIndexKe
 bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
                                     std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                                     int start, int end) {
+    return ForEachAddressIndex(addressHash, type, start, end, [&](const CAddressIndexKey& key, CAmount value) {
+        addressIndex.push_back(std::make_pair(key, value));
+        return true;
+    });
+}
+
+bool CBlockTreeDB::ForEachAddressIndex(const uint256& addressHash, int type, int start, int end,
+                                       const std::function<bool(const CAddressIndexKey&, CAmount)>& fn) {
     const std::unique_ptr<CDBIterator> pcursor(NewIterator());
 
     if (start > 0 && end > 0) {
@@ -391,7 +424,9 @@ bool CBlockTreeDB::ReadAddressIndex(uint256 addressHash, int type,
             }
             CAmount nValue;
             if (pcursor->GetValue(nValue)) {
-                addressIndex.push_back(std::make_pair(key.second, nValue));
+                if (!fn(key.second, nValue)) {
+                    break;
+                }
                 pcursor->Next();
             } else {
                 return error("failed to get address index value");
@@ -472,9 +507,74 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
-bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+static bool LoadDiskBlockIndex(const uint256& hash, const CDiskBlockIndex& diskindex, const Consensus::Params& consensusParams,
+                               const std::function<CBlockIndex*(const uint256&)>& insertBlockIndex) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+{
+    // Construct block index object
+    CBlockIndex* pindexNew = insertBlockIndex(hash);
+    pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+    pindexNew->nHeight        = diskindex.nHeight;
+    pindexNew->nFile          = diskindex.nFile;
+    pindexNew->nDataPos       = diskindex.nDataPos;
+    pindexNew->nUndoPos       = diskindex.nUndoPos;
+    pindexNew->nVersion       = diskindex.nVersion;
+    pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+    pindexNew->nTime          = diskindex.nTime;
+    pindexNew->nBits          = diskindex.nBits;
+    pindexNew->nNonce         = diskindex.nNonce;
+    pindexNew->nStatus        = diskindex.nStatus;
+    pindexNew->nTx            = diskindex.nTx;
+
+    pindexNew->hashWitnessMerkleRoot    = diskindex.hashWitnessMerkleRoot;
+    pindexNew->nFlags                   = diskindex.nFlags & (uint32_t)~BLOCK_DELAYED;
+    pindexNew->bnStakeModifier          = diskindex.bnStakeModifier;
+    pindexNew->prevoutStake             = diskindex.prevoutStake;
+    //pindexNew->hashProof                = diskindex.hashProof;
+
+    pindexNew->nMoneySupply             = diskindex.nMoneySupply;
+    pindexNew->nAnonOutputs             = diskindex.nAnonOutputs;
+
+    if (pindexNew->nHeight == 0
+        && pindexNew->GetBlockHash() != Params().GetConsensus().hashGenesisBlock)
+        return error("LoadBlockIndex(): Genesis block hash incorrect: %s", pindexNew->ToString());
+
+    if (fGlobeMode) {
+        // only CheckProofOfWork for genesis blocks
+        if (diskindex.hashPrev.IsNull() && !CheckProofOfWork(pindexNew->GetBlockHash(),
+            pindexNew->nBits, Params().GetConsensus(), 0, Params().GetLastImportHeight()))
+            return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
+    } else
+    if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams)) {
+        return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
+    }
+    return true;
+}
+
+bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex,
+                                      const fs::path& snapshot_path)
 {
     AssertLockHeld(::cs_main);
+
+    uint256 snapshot_id;
+    if (Read(DB_BLOCK_INDEX_SNAPSHOT, snapshot_id)) {
+        if (!snapshot_path.empty()) {
+            std::optional<bool> loaded = LoadBlockIndexSnapshot(snapshot_path, snapshot_id, consensusParams, insertBlockIndex);
+            if (!loaded) {
+                return false;
+            }
+            if (*loaded) {
+                return LoadBlockIndexJournal(consensusParams, insertBlockIndex);
+            }
+        }
+        // Journaling is only needed while a snapshot is recorded
+        if (!EraseBlockIndexSnapshot()) {
+            return error("%s: Failed to erase block index snapshot record", __func__);
+        }
+    } else if (!snapshot_path.empty()) {
+        // Erased when last started without -blockindexsnapshot
+        LogPrintf("No block index snapshot recorded, loading the block index from the database\n");
+    }
+
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
     pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
 
@@ -485,44 +585,9 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
         if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
             CDiskBlockIndex diskindex;
             if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.ConstructBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                pindexNew->hashWitnessMerkleRoot    = diskindex.hashWitnessMerkleRoot;
-                pindexNew->nFlags                   = diskindex.nFlags & (uint32_t)~BLOCK_DELAYED;
-                pindexNew->bnStakeModifier          = diskindex.bnStakeModifier;
-                pindexNew->prevoutStake             = diskindex.prevoutStake;
-                //pindexNew->hashProof                = diskindex.hashProof;
-
-                pindexNew->nMoneySupply             = diskindex.nMoneySupply;
-                pindexNew->nAnonOutputs             = diskindex.nAnonOutputs;
-
-                if (pindexNew->nHeight == 0
-                    && pindexNew->GetBlockHash() != Params().GetConsensus().hashGenesisBlock)
-                    return error("LoadBlockIndex(): Genesis block hash incorrect: %s", pindexNew->ToString());
-
-                if (fGlobeMode) {
-                    // only CheckProofOfWork for genesis blocks
-                    if (diskindex.hashPrev.IsNull() && !CheckProofOfWork(pindexNew->GetBlockHash(),
-                        pindexNew->nBits, Params().GetConsensus(), 0, Params().GetLastImportHeight()))
-                        return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
-                } else
-                if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams)) {
-                    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
+                if (!LoadDiskBlockIndex(diskindex.ConstructBlockHash(), diskindex, consensusParams, insertBlockIndex)) {
+                    return false;
                 }
-
                 pcursor->Next();
             } else {
                 return error("%s: failed to read value", __func__);
@@ -535,6 +600,162 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
     return true;
 }
 
+std::optional<bool> CBlockTreeDB::LoadBlockIndexSnapshot(const fs::path& path, const uint256& snapshot_id, const Consensus::Params& consensusParams,
+                                                         const std::function<CBlockIndex*(const uint256&)>& insertBlockIndex)
+{
+    AssertLockHeld(::cs_main);
+
+    CAutoFile file{fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION};
+    if (file.IsNull()) {
+        LogPrintf("Block index snapshot %s not found, loading the block index from the database\n", fs::PathToString(path));
+        return false;
+    }
+
+    uint64_t num_entries;
+    try {
+        // Verify the whole file before inserting any entry, a partially
+        // loaded snapshot can't be replaced by the database entries
+        const int64_t file_size = fs::file_size(path);
+        if (file_size < (int64_t)(sizeof(uint32_t) + 32 + sizeof(uint64_t) + 32)) {
+            throw std::ios_base::failure("File too small");
+        }
+        CHashVerifier<CAutoFile> verifier(&file);
+        uint32_t version;
+        uint256 file_snapshot_id;
+        verifier >> version;
+        if (version != BLOCK_INDEX_SNAPSHOT_VERSION) {
+            LogPrintf("Unknown block index snapshot version %d, loading the block index from the database\n", version);
+            return false;
+        }
+        verifier >> file_snapshot_id;
+        if (file_snapshot_id != snapshot_id) {
+            LogPrintf("Block index snapshot is stale, loading the block index from the database\n");
+            return false;
+        }
+        verifier >> num_entries;
+        verifier.ignore(file_size - (sizeof(uint32_t) + 32 + sizeof(uint64_t) + 32));
+        uint256 checksum;
+        file >> checksum;
+        if (checksum != verifier.GetHash()) {
+            LogPrintf("Block index snapshot checksum mismatch, loading the block index from the database\n");
+            return false;
+        }
+        if (std::fseek(file.Get(), sizeof(uint32_t) + 32 + sizeof(uint64_t), SEEK_SET)) {
+            throw std::ios_base::failure("Seek failed");
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to read block index snapshot: %s, loading the block index from the database\n", e.what());
+        return false;
+    }
+
+    try {
+        for (uint64_t i = 0; i < num_entries; ++i) {
+            if (ShutdownRequested()) return std::nullopt;
+            uint256 hash;
+            CDiskBlockIndex diskindex;
+            file >> hash >> diskindex;
+            if (!LoadDiskBlockIndex(hash, diskindex, consensusParams, insertBlockIndex)) {
+                return std::nullopt;
+            }
+        }
+    } catch (const std::exception& e) {
+        error("%s: Failed to deserialize block index snapshot: %s", __func__, e.what());
+        return std::nullopt;
+    }
+    LogPrintf("Loaded %u block index entries from snapshot\n", num_entries);
+    return true;
+}
+
+bool CBlockTreeDB::LoadBlockIndexJournal(const Consensus::Params& consensusParams, const std::function<CBlockIndex*(const uint256&)>& insertBlockIndex)
+{
+    AssertLockHeld(::cs_main);
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX_JOURNAL, uint256()));
+
+    size_t num_entries = 0;
+    std::pair<uint8_t, uint256> key;
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX_JOURNAL) {
+        if (ShutdownRequested()) return false;
+        CDiskBlockIndex diskindex;
+        if (!Read(std::make_pair(DB_BLOCK_INDEX, key.second), diskindex)) {
+            return error("%s: Journaled block index entry %s not found", __func__, key.second.ToString());
+        }
+        if (!LoadDiskBlockIndex(key.second, diskindex, consensusParams, insertBlockIndex)) {
+            return false;
+        }
+        num_entries++;
+        pcursor->Next();
+    }
+    LogPrintf("Loaded %u block index entries written since the snapshot\n", num_entries);
+    return true;
+}
+
+bool CBlockTreeDB::EraseBlockIndexSnapshot()
+{
+    CDBBatch batch(*this);
+    batch.Erase(DB_BLOCK_INDEX_SNAPSHOT);
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX_JOURNAL, uint256()));
+    std::pair<uint8_t, uint256> key;
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX_JOURNAL) {
+        batch.Erase(key);
+        pcursor->Next();
+    }
+    m_block_index_journal = false;
+    return WriteBatch(batch, true);
+}
+
+bool CBlockTreeDB::WriteBlockIndexSnapshot(const fs::path& path, const std::vector<const CBlockIndex*>& blocks)
+{
+    AssertLockHeld(::cs_main);
+
+    // Journaled entries are covered by the new snapshot, forget the old one
+    // first so a failure below leaves no stale record behind
+    if (!EraseBlockIndexSnapshot()) {
+        return error("%s: Failed to erase block index snapshot record", __func__);
+    }
+
+    const uint256 snapshot_id{GetRandHash()};
+    try {
+        CAutoFile file{fsbridge::fopen(path + ".new", "wb"), SER_DISK, CLIENT_VERSION};
+        if (file.IsNull()) {
+            throw std::runtime_error("Open failed");
+        }
+        CHashWriter hasher(SER_DISK, CLIENT_VERSION);
+        file << BLOCK_INDEX_SNAPSHOT_VERSION << snapshot_id << (uint64_t)blocks.size();
+        hasher << BLOCK_INDEX_SNAPSHOT_VERSION << snapshot_id << (uint64_t)blocks.size();
+
+        CDataStream entry{SER_DISK, CLIENT_VERSION};
+        for (const CBlockIndex* pindex : blocks) {
+            entry.clear();
+            entry << pindex->GetBlockHash() << CDiskBlockIndex{pindex};
+            file.write(MakeByteSpan(entry));
+            hasher.write(MakeByteSpan(entry));
+        }
+        file << hasher.GetHash();
+
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(path + ".new", path)) {
+            throw std::runtime_error("Rename failed");
+        }
+    } catch (const std::exception& e) {
+        return error("%s: Failed to write block index snapshot: %s", __func__, e.what());
+    }
+
+    CDBBatch batch(*this);
+    batch.Write(DB_BLOCK_INDEX_SNAPSHOT, snapshot_id);
+    if (!WriteBatch(batch, true)) {
+        return error("%s: Failed to write block index snapshot record", __func__);
+    }
+    m_block_index_journal = true;
+    LogPrintf("Wrote %u block index entries to snapshot %s\n", blocks.size(), fs::PathToString(path));
+    return true;
+}
+
 size_t CBlockTreeDB::CountBlockIndex()
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
@@ -670,16 +891,75 @@ bool CBlockTreeDB::EraseRCTKeyImagesAfterHeight(int height)
     return WriteBatch(batch);
 };
 
+bool CBlockTreeDB::LoadSpentCache()
+{
+    std::vector<std::pair<COutPoint, SpentCoin>> coins;
+    size_t num_buckets = 0;
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(uint8_t(DB_SPENTCACHE_BUCKET));
+    while (pcursor->Valid()) {
+        std::pair<uint8_t, uint32_t> key;
+        if (!pcursor->GetKey(key) || key.first != DB_SPENTCACHE_BUCKET) {
+            break;
+        }
+        std::vector<std::pair<COutPoint, Coin>> bucket;
+        if (!pcursor->GetValue(bucket)) {
+            return error("%s: failed to read bucket %d", __func__, key.second);
+        }
+        for (const auto &it : bucket) {
+            coins.emplace_back(it.first, SpentCoin(it.second, key.second));
+        }
+        num_buckets++;
+        pcursor->Next();
+    }
+    m_spent_cache.Add(coins);
+    coins.clear();
+
+    // Records of earlier versions, one per coin
+    CDBBatch batch(*this);
+    pcursor->Seek(uint8_t(DB_SPENTCACHE));
+    while (pcursor->Valid()) {
+        if (ShutdownRequested()) return false;
+        std::pair<uint8_t, COutPoint> key;
+        if (!pcursor->GetKey(key) || key.first != DB_SPENTCACHE) {
+            break;
+        }
+        SpentCoin spent_coin;
+        if (pcursor->GetValue(spent_coin)) {
+            coins.emplace_back(key.second, spent_coin);
+        }
+        batch.Erase(key);
+        pcursor->Next();
+    }
+    if (!coins.empty()) {
+        LogPrintf("Moving %d spent cache entries into buckets.\n", coins.size());
+        SpentCoinCacheUpdate update;
+        update.add = std::move(coins);
+        WriteSpentCache(batch, update);
+        if (!WriteBatch(batch, true)) {
+            return error("%s: failed to write buckets", __func__);
+        }
+        ApplySpentCache(update);
+    }
+
+    LogPrintf("Loaded %d spent cache entries from %d buckets.\n", m_spent_cache.Size(), num_buckets);
+    return true;
+};
+
 bool CBlockTreeDB::ReadSpentCache(const COutPoint &outpoint, SpentCoin &coin)
 {
-    std::pair<uint8_t, COutPoint> key = std::make_pair(DB_SPENTCACHE, outpoint);
-    return Read(key, coin);
+    return m_spent_cache.Get(outpoint, coin);
 };
 
-bool CBlockTreeDB::EraseSpentCache(const COutPoint &outpoint)
+void CBlockTreeDB::WriteSpentCache(CDBBatch &batch, const SpentCoinCacheUpdate &update) const
 {
-    std::pair<uint8_t, COutPoint> key = std::make_pair(DB_SPENTCACHE, outpoint);
-    CDBBatch batch(*this);
-    batch.Erase(key);
-    return WriteBatch(batch);
+    for (const auto &[height, bucket] : m_spent_cache.GetChangedBuckets(update)) {
+        std::pair<uint8_t, uint32_t> key = std::make_pair(DB_SPENTCACHE_BUCKET, height);
+        if (bucket.empty()) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, bucket);
+        }
+    }
 };
@@ -10,6 +10,7 @@
 #include <dbwrapper.h>
 #include <sync.h>
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,7 @@
 #include <insight/timestampindex.h>
 #include <insight/balanceindex.h>
 #include <rctindex.h>
+#include <pos/spentcache.h>
 #include <primitives/block.h>
 
 class CBlockFileInfo;
@@ -36,7 +38,8 @@ struct bilingual_str;
 const char DB_RCTOUTPUT = 'A';
 const char DB_RCTOUTPUT_LINK = 'L';
 const char DB_RCTKEYIMAGE = 'K';
-const char DB_SPENTCACHE = 'S';
+const char DB_SPENTCACHE = 'S'; // Written by earlier versions, moved to DB_SPENTCACHE_BUCKET at startup
+const char DB_SPENTCACHE_BUCKET = 'Q';
 
 
 //! -dbcache default (MiB)
@@ -81,6 +84,9 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
 
+    //! Cursor starting at the first coin at or after start in key order.
+    std::unique_ptr<CCoinsViewCursor> Cursor(const COutPoint& start) const;
+
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
     size_t EstimateSize() const override;
@@ -92,6 +98,22 @@ public:
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
+private:
+    //! Record the hash of every block index entry written, set while a block index snapshot is recorded
+    bool m_block_index_journal{false};
+
+    //! The DB_SPENTCACHE_BUCKET records, loaded by LoadSpentCache()
+    SpentCoinCache m_spent_cache;
+
+    /** Load the snapshot at path if it matches snapshot_id, returns false to fall back to the database and nullopt on error. */
+    std::optional<bool> LoadBlockIndexSnapshot(const fs::path& path, const uint256& snapshot_id, const Consensus::Params& consensusParams,
+                                               const std::function<CBlockIndex*(const uint256&)>& insertBlockIndex)
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /** Load the entries written since the snapshot. */
+    bool LoadBlockIndexJournal(const Consensus::Params& consensusParams, const std::function<CBlockIndex*(const uint256&)>& insertBlockIndex)
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    bool EraseBlockIndexSnapshot();
+
 public:
     explicit CBlockTreeDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool compression = true, int maxOpenFiles = 1000);
 
@@ -106,11 +128,17 @@ public:
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
     bool ReadAddressUnspentIndex(uint256 addressHash, int type,
                                  std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
+    /** Call fn for each unspent output of the address in key order, stops early if fn returns false. */
+    bool ForEachAddressUnspentIndex(const uint256& addressHash, int type,
+                                    const std::function<bool(const CAddressUnspentKey&, const CAddressUnspentValue&)>& fn);
     bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
     bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
     bool ReadAddressIndex(uint256 addressHash, int type,
                           std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                           int start = 0, int end = 0);
+    /** Call fn for each delta of the address in height order, stops early if fn returns false. */
+    bool ForEachAddressIndex(const uint256& addressHash, int type, int start, int end,
+                             const std::function<bool(const CAddressIndexKey&, CAmount)>& fn);
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<std::pair<uint256, unsigned int> > &vect) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex, const CTimestampBlockIndexValue &logicalts);
@@ -121,7 +149,16 @@ public:
 
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+    /**
+     * Load the block index entries. If snapshot_path is set and the snapshot
+     * matches the database only the entries written since are read from the
+     * database.
+     */
+    bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex,
+                            const fs::path& snapshot_path = {})
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    /** Write blocks, which must match the block index entries in the database, to a snapshot at path. */
+    bool WriteBlockIndexSnapshot(const fs::path& path, const std::vector<const CBlockIndex*>& blocks)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     size_t CountBlockIndex();
 
@@ -138,8 +175,14 @@ public:
     bool EraseRCTKeyImage(const CCmpPubKey &ki);
     bool EraseRCTKeyImagesAfterHeight(int height);
 
+    /** Load the spent cache, moving the records of earlier versions into buckets. */
+    bool LoadSpentCache();
     bool ReadSpentCache(const COutPoint &outpoint, SpentCoin &coin);
-    bool EraseSpentCache(const COutPoint &outpoint);
+    /** Write the buckets changed by update to batch, the spent cache is unchanged until ApplySpentCache(). */
+    void WriteSpentCache(CDBBatch &batch, const SpentCoinCacheUpdate &update) const;
+    /** Apply update to the spent cache, once the batch it was written to is written. */
+    void ApplySpentCache(const SpentCoinCacheUpdate &update) { m_spent_cache.Apply(update); }
+    std::vector<std::pair<COutPoint, SpentCoin>> GetSpentCache() const { return m_spent_cache.GetAll(); }
 
     //bool WriteRCTOutputBatch(std::vector<std::pair<int64_t, CAnonOutput> > &vao);
 };
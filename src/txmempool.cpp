@@ -1279,7 +1279,7 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
                 coin = Coin(txout, MEMPOOL_HEIGHT, false);
                 if (out->IsType(OUTPUT_CT)) {
                     coin.nType = OUTPUT_CT;
-                    coin.commitment = ((CTxOutCT*)out)->commitment;
+                    coin.SetCommitment(((CTxOutCT*)out)->commitment);
                 }
                 return true;
             }
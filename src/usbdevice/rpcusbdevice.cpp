@@ -966,7 +966,7 @@ static RPCHelpMan initaccountfromdevice()
             throw JSONRPCError(RPC_INTERNAL_ERROR, "DB Write failed.");
         }
 
-        if (0 != pwallet->ExtKeyAddAccountToMaps(idAccount, sea)) {
+        if (0 != pwallet->ExtKeyAddAccountToMaps(&wdb, idAccount, sea)) {
             sea->FreeChains();
             wdb.TxnAbort();
             throw JSONRPCError(RPC_INTERNAL_ERROR, "ExtKeyAddAccountToMaps failed.");
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_UTIL_LRUCACHE_H
+#define GLOBE_UTIL_LRUCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace util {
+/**
+ * Map holding at most max_size entries, when full the least recently used
+ * entry is evicted to make room. A max_size of 0 disables the cache.
+ * Not thread safe, callers must provide their own locking.
+ */
+template <typename K, typename V>
+class LRUCache
+{
+private:
+    using List = std::list<std::pair<K, V>>;
+    size_t m_max_size;
+    List m_list; // Most recently used at the front
+    std::map<K, typename List::iterator> m_map;
+
+    void Trim()
+    {
+        while (m_list.size() > m_max_size) {
+            m_map.erase(m_list.back().first);
+            m_list.pop_back();
+        }
+    }
+
+public:
+    explicit LRUCache(size_t max_size) : m_max_size(max_size) {}
+
+    bool Get(const K& key, V& value)
+    {
+        auto it = m_map.find(key);
+        if (it == m_map.end()) {
+            return false;
+        }
+        m_list.splice(m_list.begin(), m_list, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    void Insert(const K& key, const V& value)
+    {
+        if (m_max_size == 0) {
+            return;
+        }
+        auto it = m_map.find(key);
+        if (it != m_map.end()) {
+            it->second->second = value;
+            m_list.splice(m_list.begin(), m_list, it->second);
+            return;
+        }
+        m_list.emplace_front(key, value);
+        m_map.emplace(key, m_list.begin());
+        Trim();
+    }
+
+    void Erase(const K& key)
+    {
+        auto it = m_map.find(key);
+        if (it == m_map.end()) {
+            return;
+        }
+        m_list.erase(it->second);
+        m_map.erase(it);
+    }
+
+    void Clear()
+    {
+        m_map.clear();
+        m_list.clear();
+    }
+
+    void SetMaxSize(size_t max_size)
+    {
+        m_max_size = max_size;
+        Trim();
+    }
+
+    size_t Size() const { return m_list.size(); }
+    size_t MaxSize() const { return m_max_size; }
+};
+} // namespace util
+
+#endif // GLOBE_UTIL_LRUCACHE_H
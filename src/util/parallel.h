@@ -0,0 +1,61 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_UTIL_PARALLEL_H
+#define GLOBE_UTIL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace util {
+/**
+ * Run fn(i) for every i in [0, n), spread over at most max_threads threads.
+ *
+ * The calling thread takes part in the work, so max_threads <= 1 (or n <= 1)
+ * runs everything inline without starting any threads.
+ * fn must not throw and must return true on success. Once any call fails no
+ * further items are started, and false is returned after all threads have
+ * been joined. Each index is processed at most once, in no particular order.
+ */
+template <typename Fn>
+bool ParallelFor(size_t n, int max_threads, Fn&& fn)
+{
+    size_t num_threads = std::min(n, (size_t)std::max(1, max_threads));
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            if (!fn(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto worker = [&]() {
+        size_t i;
+        while (!failed && (i = next++) < n) {
+            if (!fn(i)) {
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+    return !failed;
+}
+} // namespace util
+
+#endif // GLOBE_UTIL_PARALLEL_H
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/shardedqueue.h>
+
+#include <tinyformat.h>
+#include <util/thread.h>
+
+namespace util {
+ShardedTaskQueue::~ShardedTaskQueue()
+{
+    Stop();
+}
+
+void ShardedTaskQueue::Start(const std::string& thread_name, int num_threads, size_t max_queued_size)
+{
+    Stop();
+    m_max_queued_size = max_queued_size;
+    for (int i = 0; i < num_threads; ++i) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        Shard& shard = *m_shards[i];
+        shard.m_thread = std::thread(&util::TraceThread, strprintf("%s.%d", thread_name, i), [this, &shard] { Run(shard); });
+    }
+}
+
+void ShardedTaskQueue::Interrupt()
+{
+    for (auto& shard : m_shards) {
+        WITH_LOCK(shard->m_mutex, shard->m_interrupt = true);
+        shard->m_cond.notify_all();
+    }
+}
+
+void ShardedTaskQueue::Stop()
+{
+    Interrupt();
+    for (auto& shard : m_shards) {
+        if (shard->m_thread.joinable()) {
+            shard->m_thread.join();
+        }
+    }
+    m_shards.clear();
+}
+
+bool ShardedTaskQueue::HasRoom(uint64_t key, size_t size)
+{
+    if (m_shards.empty()) {
+        return false;
+    }
+    Shard& shard = *m_shards[key % m_shards.size()];
+    LOCK(shard.m_mutex);
+    return !shard.m_interrupt && (shard.m_queued_size == 0 || shard.m_queued_size + size <= m_max_queued_size);
+}
+
+bool ShardedTaskQueue::Enqueue(uint64_t key, size_t size, Task task)
+{
+    if (m_shards.empty()) {
+        return false;
+    }
+    Shard& shard = *m_shards[key % m_shards.size()];
+    {
+        LOCK(shard.m_mutex);
+        if (shard.m_interrupt || (shard.m_queued_size > 0 && shard.m_queued_size + size > m_max_queued_size)) {
+            return false;
+        }
+        shard.m_queued_size += size;
+        shard.m_tasks.emplace_back(size, std::move(task));
+    }
+    shard.m_cond.notify_one();
+    return true;
+}
+
+void ShardedTaskQueue::Run(Shard& shard)
+{
+    while (true) {
+        std::pair<size_t, Task> task;
+        {
+            WAIT_LOCK(shard.m_mutex, lock);
+            shard.m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(shard.m_mutex) { return shard.m_interrupt || !shard.m_tasks.empty(); });
+            if (shard.m_interrupt) {
+                return;
+            }
+            task = std::move(shard.m_tasks.front());
+            shard.m_tasks.pop_front();
+            shard.m_queued_size -= task.first;
+        }
+        task.second();
+    }
+}
+} // namespace util
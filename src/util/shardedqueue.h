@@ -0,0 +1,78 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_UTIL_SHARDEDQUEUE_H
+#define GLOBE_UTIL_SHARDEDQUEUE_H
+
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util {
+/**
+ * Worker threads each running the tasks of its own shard of keys.
+ *
+ * Tasks with the same key always run on the same thread in the order they
+ * were added, tasks with different keys may run concurrently.
+ * Each shard holds at most max_queued_size worth of tasks waiting to run, as
+ * measured by the size passed to Enqueue(). A task larger than that is only
+ * accepted by an empty shard.
+ */
+class ShardedTaskQueue
+{
+public:
+    using Task = std::function<void()>;
+
+    ~ShardedTaskQueue();
+
+    /** Start num_threads threads named thread_name.<n>, does nothing if num_threads < 1. */
+    void Start(const std::string& thread_name, int num_threads, size_t max_queued_size);
+
+    /** Stop accepting tasks and wake the threads, pending tasks are not run. */
+    void Interrupt();
+
+    /** Interrupt and join the threads, pending tasks are destroyed. */
+    void Stop();
+
+    /**
+     * Queue task to run on the thread of key's shard.
+     * @return false if the threads are not running or the shard is full, task is not queued
+     */
+    bool Enqueue(uint64_t key, size_t size, Task task);
+
+    /**
+     * Whether Enqueue(key, size, ...) would queue the task now. Stays true
+     * until a task is queued to the shard, as the threads only take tasks.
+     */
+    bool HasRoom(uint64_t key, size_t size);
+
+    size_t NumThreads() const { return m_shards.size(); }
+
+private:
+    struct Shard {
+        Mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque<std::pair<size_t, Task>> m_tasks GUARDED_BY(m_mutex);
+        size_t m_queued_size GUARDED_BY(m_mutex){0};
+        bool m_interrupt GUARDED_BY(m_mutex){false};
+        std::thread m_thread;
+    };
+
+    void Run(Shard& shard) EXCLUSIVE_LOCKS_REQUIRED(!shard.m_mutex);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    size_t m_max_queued_size{0};
+};
+} // namespace util
+
+#endif // GLOBE_UTIL_SHARDEDQUEUE_H
@@ -0,0 +1,171 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/sockepoll.h>
+
+#ifdef USE_EPOLL
+#include <logging.h>
+#include <util/syserror.h>
+#include <util/time.h>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+/** Number of events fetched per epoll_wait call, more are reported by the next call. */
+static constexpr size_t EPOLL_MAX_EVENTS{1024};
+
+SockEpoll::SockEpoll() : m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)}
+{
+    if (m_epoll_fd < 0) {
+        LogPrintf("epoll_create1 failed: %s\n", SysErrorString(errno));
+    }
+}
+
+SockEpoll::~SockEpoll()
+{
+    if (m_epoll_fd >= 0) {
+        close(m_epoll_fd);
+    }
+}
+
+static uint32_t EpollEvents(Sock::Event requested, bool edge_triggered)
+{
+    uint32_t events{0};
+    if (requested & Sock::RECV) {
+        events |= EPOLLIN;
+    }
+    if (requested & Sock::SEND) {
+        events |= EPOLLOUT;
+    }
+    if (edge_triggered) {
+        events |= EPOLLET;
+    }
+    return events;
+}
+
+bool SockEpoll::Update(const std::shared_ptr<const Sock>& sock, Sock::Event requested, bool edge_triggered)
+{
+    if (!IsValid()) {
+        return false;
+    }
+    auto it = m_registered.find(sock);
+    if (it != m_registered.end()) {
+        it->second.generation = m_generation;
+        if (it->second.requested == requested && it->second.edge_triggered == edge_triggered) {
+            return true;
+        }
+    }
+
+    const bool add{it == m_registered.end()};
+    if (add) {
+        it = m_registered.emplace(sock, Registration{requested, edge_triggered, m_generation}).first;
+    }
+
+    epoll_event ev{};
+    ev.events = EpollEvents(requested, edge_triggered);
+    // Nodes of m_registered are stable, point the event at the key
+    ev.data.ptr = const_cast<std::shared_ptr<const Sock>*>(&it->first);
+    if (epoll_ctl(m_epoll_fd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, sock->Get(), &ev) != 0) {
+        LogPrint(BCLog::NET, "epoll_ctl failed for socket %d: %s\n", sock->Get(), SysErrorString(errno));
+        if (add) {
+            m_registered.erase(it);
+        }
+        return false;
+    }
+    it->second.requested = requested;
+    it->second.edge_triggered = edge_triggered;
+    return true;
+}
+
+void SockEpoll::RemoveUnused()
+{
+    for (auto it = m_registered.begin(); it != m_registered.end();) {
+        if (it->second.generation != m_generation) {
+            // Closing the last reference would deregister it too, but other
+            // copies of the shared_ptr may keep the socket open a while longer.
+            epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first->Get(), nullptr);
+            it = m_registered.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    ++m_generation;
+}
+
+void SockEpoll::Remove(const std::shared_ptr<const Sock>& sock)
+{
+    const auto it = m_registered.find(sock);
+    if (it == m_registered.end()) {
+        return;
+    }
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first->Get(), nullptr);
+    m_registered.erase(it);
+}
+
+static Sock::Event OccurredEvents(uint32_t revents)
+{
+    Sock::Event occurred{0};
+    if (revents & EPOLLIN) {
+        occurred |= Sock::RECV;
+    }
+    if (revents & EPOLLOUT) {
+        occurred |= Sock::SEND;
+    }
+    if (revents & (EPOLLERR | EPOLLHUP)) {
+        occurred |= Sock::ERR;
+    }
+    return occurred;
+}
+
+int SockEpoll::WaitReady(std::chrono::milliseconds timeout)
+{
+    m_ready.resize(std::min(std::max(m_registered.size(), size_t{1}), EPOLL_MAX_EVENTS));
+    return epoll_wait(m_epoll_fd, m_ready.data(), m_ready.size(), count_milliseconds(timeout));
+}
+
+bool SockEpoll::Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock)
+{
+    for (auto& [sock, events] : events_per_sock) {
+        events.occurred = 0;
+    }
+    if (!IsValid()) {
+        return false;
+    }
+
+    const int num_ready = WaitReady(timeout);
+    if (num_ready < 0) {
+        return errno == EINTR;
+    }
+
+    for (int i = 0; i < num_ready; ++i) {
+        const auto& sock = *static_cast<const std::shared_ptr<const Sock>*>(m_ready[i].data.ptr);
+        const auto it = events_per_sock.find(sock);
+        if (it != events_per_sock.end()) {
+            it->second.occurred |= OccurredEvents(m_ready[i].events);
+        }
+    }
+    return true;
+}
+
+bool SockEpoll::Wait(std::chrono::milliseconds timeout, ReadySocks& ready)
+{
+    ready.clear();
+    if (!IsValid()) {
+        return false;
+    }
+
+    const int num_ready = WaitReady(timeout);
+    if (num_ready < 0) {
+        return errno == EINTR;
+    }
+
+    ready.reserve(num_ready);
+    for (int i = 0; i < num_ready; ++i) {
+        const auto& sock = *static_cast<const std::shared_ptr<const Sock>*>(m_ready[i].data.ptr);
+        ready.emplace_back(sock, OccurredEvents(m_ready[i].events));
+    }
+    return true;
+}
+#endif // USE_EPOLL
@@ -0,0 +1,100 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef GLOBE_UTIL_SOCKEPOLL_H
+#define GLOBE_UTIL_SOCKEPOLL_H
+
+#include <compat/compat.h>
+#include <util/sock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+
+/**
+ * Persistent set of sockets to wait on with epoll(7).
+ *
+ * Unlike `Sock::WaitMany()`, which hands every socket to the kernel on each
+ * call, sockets stay registered between waits and the kernel is only told
+ * about changes. Waiting costs time proportional to the number of sockets
+ * that became ready, not the number registered.
+ *
+ * Sockets registered with edge_triggered set report RECV once per arrival of
+ * new data. The caller must then keep treating the socket as readable until a
+ * read returns less than was asked for.
+ *
+ * Not thread safe, meant to be owned by a single socket handling thread.
+ */
+class SockEpoll
+{
+public:
+    SockEpoll();
+    ~SockEpoll();
+
+    SockEpoll(const SockEpoll&) = delete;
+    SockEpoll& operator=(const SockEpoll&) = delete;
+
+    /** Sockets reported ready by `Wait()` and the events that occurred on them. */
+    using ReadySocks = std::vector<std::pair<std::shared_ptr<const Sock>, Sock::Event>>;
+
+    /** Return false if the epoll instance could not be created. */
+    bool IsValid() const { return m_epoll_fd >= 0; }
+
+    /**
+     * Register sock, or update its registration if requested or
+     * edge_triggered changed. Only makes a system call when something changed.
+     * The socket is kept alive until it is dropped by `RemoveUnused()`.
+     * @return false if the kernel refused the registration
+     */
+    [[nodiscard]] bool Update(const std::shared_ptr<const Sock>& sock, Sock::Event requested, bool edge_triggered);
+
+    /** Deregister all sockets not passed to `Update()` since the previous call. */
+    void RemoveUnused();
+
+    /** Deregister sock, if it is registered. */
+    void Remove(const std::shared_ptr<const Sock>& sock);
+
+    /**
+     * Wait for events on the registered sockets and set `occurred` of the
+     * matching entries in events_per_sock. Entries of sockets that are not
+     * ready are set to 0. ERR is always reported.
+     * @return true on success (or timeout), false otherwise
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock);
+
+    /**
+     * Wait for events on the registered sockets and list the sockets that
+     * are ready in ready, the others are not visited. ERR is always reported.
+     * @return true on success (or timeout), false otherwise
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout, ReadySocks& ready);
+
+    size_t Size() const { return m_registered.size(); }
+
+private:
+    struct Registration {
+        Sock::Event requested;
+        bool edge_triggered;
+        uint64_t generation;
+    };
+
+    /** Fill m_ready, return the number of ready events or -1 with errno set. */
+    int WaitReady(std::chrono::milliseconds timeout);
+
+    using Registrations = std::unordered_map<std::shared_ptr<const Sock>, Registration, Sock::HashSharedPtrSock, Sock::EqualSharedPtrSock>;
+
+    int m_epoll_fd;
+    uint64_t m_generation{0};
+    Registrations m_registered;
+    std::vector<epoll_event> m_ready;
+};
+#endif // USE_EPOLL
+
+#endif // GLOBE_UTIL_SOCKEPOLL_H
@@ -25,6 +25,7 @@
 #include <logging.h>
 #include <logging/timer.h>
 #include <node/blockstorage.h>
+#include <node/inputprefetcher.h>
 #include <node/interface_ui.h>
 #include <node/utxo_snapshot.h>
 #include <policy/policy.h>
@@ -48,9 +49,11 @@
 #include <util/check.h> // For NDEBUG compile time check
 #include <util/hasher.h>
 #include <util/moneystr.h>
+#include <util/parallel.h>
 #include <util/rbf.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -62,7 +65,9 @@
 #include <smsg/manager.h>
 #include <pos/kernel.h>
 #include <pos/miner.h>
+#include <pos/delayedblocks.h>
 #include <anon.h>
+#include <blind.h>
 #include <rctindex.h>
 #include <insight/insight.h>
 #include <insight/balanceindex.h>
@@ -72,6 +77,7 @@
 #include <cassert>
 #include <chrono>
 #include <deque>
+#include <future>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -89,7 +95,16 @@ using node::CBlockIndexWorkComparator;
 using node::fImporting;
 using node::fPruneMode;
 using node::fReindex;
+using node::MAX_SNAPSHOT_THREADS;
 using node::ReadBlockFromDisk;
+using node::SNAPSHOT_ANON_OUTPUTS;
+using node::SNAPSHOT_CHUNK_ITEMS;
+using node::SNAPSHOT_COINS;
+using node::SNAPSHOT_END;
+using node::SNAPSHOT_KEY_IMAGES;
+using node::SNAPSHOT_SPENT_CACHE;
+using node::SNAPSHOT_VERSION;
+using node::SnapshotChunk;
 using node::SnapshotMetadata;
 using node::UndoReadFromDisk;
 using node::UnlinkPrunedFiles;
@@ -136,6 +151,9 @@ GlobalMutex g_best_block_mutex;
 std::condition_variable g_best_block_cv;
 uint256 g_best_block;
 bool g_parallel_script_checks{false};
+int g_input_prefetch_threads{node::DEFAULT_INPUT_PREFETCH_THREADS};
+int g_stake_precheck_threads{DEFAULT_STAKE_PRECHECK_THREADS};
+int g_loadblock_threads{0};
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
 unsigned int MIN_BLOCKS_TO_KEEP = 288;
@@ -170,27 +188,19 @@ bool DelayBlock(BlockManager &blockman, const std::shared_ptr<const CBlock> &pbl
 void CheckDelayedBlocks(BlockManager &blockman, BlockValidationState &state, const uint256 &block_hash) LOCKS_EXCLUDED(cs_main);
 
 std::map<uint256, StakeConflict> mapStakeConflict;
-std::map<COutPoint, uint256> mapStakeSeen;
-std::list<COutPoint> listStakeSeen;
+SeenStakeKernels g_stake_seen(MAX_STAKE_SEEN_SIZE);
+NetworkStakeWeight g_network_stake_weight;
 
 CoinStakeCache coinStakeCache GUARDED_BY(cs_main);
 CoinStakeCache smsgFeeCoinstakeCache;
 CoinStakeCache smsgDifficultyCoinstakeCache(180);
 
-size_t MAX_DELAYED_BLOCKS = 64;
+size_t MAX_DELAYED_BLOCKS = 1024;
+size_t MAX_DELAYED_BLOCKS_BYTES = 64 * 1024 * 1024;
 int64_t MAX_DELAY_BLOCK_SECONDS = 180;
+static constexpr uint64_t DELAYED_BLOCKS_DUMP_VERSION{1};
 
-class DelayedBlock
-{
-public:
-    DelayedBlock(const std::shared_ptr<const CBlock>& pblock, int node_id) : m_pblock(pblock), m_node_id(node_id) {
-        m_time = GetTime();
-    }
-    int64_t m_time;
-    std::shared_ptr<const CBlock> m_pblock;
-    int m_node_id;
-};
-std::list<DelayedBlock> list_delayed_blocks;
+DelayedBlockQueue g_delayed_blocks GUARDED_BY(cs_main);
 bool fVerifyingDB = false;
 static bool attempted_rct_index_repair = false;
 std::atomic_bool fSkipRangeproof(false);
@@ -1883,7 +1893,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState &state,
             } else
             if (coin.nType == OUTPUT_CT) {
                 vchAmount.resize(33);
-                memcpy(vchAmount.data(), coin.commitment.data, 33);
+                memcpy(vchAmount.data(), coin.GetCommitment().data, 33);
             }
 
             spent_outputs.emplace_back(vchAmount, scriptPubKey);
@@ -3247,28 +3257,6 @@ static void DoWarning(const bilingual_str& warning)
     }
 }
 
-static void ClearSpentCache(Chainstate &chainstate, CDBBatch &batch, int height)
-{
-    CBlockIndex* pblockindex = chainstate.m_chain[height];
-    if (!pblockindex) {
-        return;
-    }
-    CBlock block;
-    if (!ReadBlockFromDisk(block, pblockindex, chainstate.m_params.GetConsensus())) {
-        LogPrintf("%s: failed read block from disk (%d, %s)\n", __func__, height, pblockindex->GetBlockHash().ToString());
-        return;
-    }
-    for (int i = block.vtx.size() - 1; i >= 0; i--) {
-        const CTransaction &tx = *(block.vtx[i]);
-        for (const auto &txin : tx.vin) {
-            if (!txin.IsAnonInput()) {
-                std::pair<uint8_t, COutPoint> key = std::make_pair(DB_SPENTCACHE, txin.prevout);
-                batch.Erase(key);
-            }
-        }
-    }
-}
-
 bool FlushView(CCoinsViewCache *view, BlockValidationState& state, Chainstate &chainstate, bool fDisconnecting)
 {
     auto& pblocktree{chainstate.m_blockman.m_block_tree_db};
@@ -3315,10 +3303,15 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, Chainstate &c
                 return error("%s: EraseRCTOutputLink failed.", __func__);
             }
         }
-        for (const auto &it : view->spent_cache) {
-            if (!pblocktree->EraseSpentCache(it.first)) {
+        if (!view->spent_cache.empty()) {
+            CDBBatch batch(*pblocktree);
+            SpentCoinCacheUpdate spent_cache_update;
+            spent_cache_update.remove = std::move(view->spent_cache);
+            pblocktree->WriteSpentCache(batch, spent_cache_update);
+            if (!pblocktree->WriteBatch(batch)) {
                 return error("%s: EraseSpentCache failed.", __func__);
             }
+            pblocktree->ApplySpentCache(spent_cache_update);
         }
     } else {
         CDBBatch batch(*pblocktree);
@@ -3336,16 +3329,22 @@ bool FlushView(CCoinsViewCache *view, BlockValidationState& state, Chainstate &c
             std::pair<uint8_t, CCmpPubKey> key = std::make_pair(DB_RCTOUTPUT_LINK, it.first);
             batch.Write(key, it.second);
         }
-        for (const auto &it : view->spent_cache) {
-            std::pair<uint8_t, COutPoint> key = std::make_pair(DB_SPENTCACHE, it.first);
-            batch.Write(key, it.second);
-        }
-        if (state.m_spend_height > (int)MIN_BLOCKS_TO_KEEP) {
-            ClearSpentCache(chainstate, batch, state.m_spend_height - (MIN_BLOCKS_TO_KEEP+1));
-        }
+        // Spends deeper than MIN_BLOCKS_TO_KEEP are dropped a block at a time.
+        // While a snapshot chainstate is validated in the background, it only
+        // drops the buckets above its base, the buckets below are still needed
+        // by the background chainstate.
+        SpentCoinCacheUpdate spent_cache_update;
+        spent_cache_update.add = std::move(view->spent_cache);
+        spent_cache_update.drop_to = std::max(state.m_spend_height - (int)MIN_BLOCKS_TO_KEEP, 0);
+        if (chainstate.m_from_snapshot_blockhash && chainstate.m_chainman.IsSnapshotActive()) {
+            const CBlockIndex* snapshot_base = WITH_LOCK(::cs_main, return chainstate.m_blockman.LookupBlockIndex(*chainstate.m_from_snapshot_blockhash));
+            spent_cache_update.drop_from = snapshot_base ? snapshot_base->nHeight : spent_cache_update.drop_to;
+        }
+        pblocktree->WriteSpentCache(batch, spent_cache_update);
         if (!pblocktree->WriteBatch(batch)) {
             return error("%s: Write index data failed.", __func__);
         }
+        pblocktree->ApplySpentCache(spent_cache_update);
         if (0 != chainstate.m_chainman.m_smsgman->WriteCache(view->smsg_cache)) {
             return error("%s: smsgModule WriteCache failed.", __func__);
         }
@@ -3410,6 +3409,8 @@ void Chainstate::UpdateTip(const CBlockIndex* pindexNew)
         m_mempool->AddTransactionsUpdated(1);
     }
 
+    globe::g_network_stake_weight.SetTip(pindexNew);
+
     {
         LOCK(g_best_block_mutex);
         g_best_block = pindexNew->GetBlockHash();
@@ -3561,7 +3562,7 @@ public:
  *
  * The block is added to connectTrace if connection succeeds.
  */
-bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool)
+bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool, const CBlockIndex* pindex_next)
 {
     AssertLockHeld(cs_main);
     if (m_mempool) AssertLockHeld(m_mempool->cs);
@@ -3581,6 +3582,10 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
         pthisBlock = pblock;
     }
     const CBlock& blockConnecting = *pthisBlock;
+    // Read the inputs of the next block while this one is being connected.
+    if (pindex_next && g_input_prefetch_threads > 0 && (pindex_next->nStatus & BLOCK_HAVE_DATA)) {
+        m_input_prefetcher.Start(pindex_next->GetBlockPos(), m_params.GetConsensus(), CoinsDB(), *m_blockman.m_block_tree_db, CoinsTip(), g_input_prefetch_threads);
+    }
     // Apply the block atomically to the chain state.
     int64_t nTime2 = GetTimeMicros(); nTimeReadFromDiskTotal += nTime2 - nTime1;
     int64_t nTime3;
@@ -3593,6 +3598,7 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
         }
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
+            m_input_prefetcher.Wait();
             if (state.IsInvalid())
                 InvalidBlockFound(pindexNew, state);
             return error("%s: ConnectBlock %s failed, %s", __func__, pindexNew->GetBlockHash().ToString(), state.ToString());
@@ -3609,8 +3615,13 @@ bool Chainstate::ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew,
     if (!FlushStateToDisk(state, FlushStateMode::IF_NEEDED))
     {
         //RollBackRCTIndex(nLastValidRCTOutput, setConnectKi);
+        m_input_prefetcher.Wait();
         return false;
     }
+    if (pindex_next) {
+        size_t num_prefetched = m_input_prefetcher.Apply(CoinsTip());
+        LogPrint(BCLog::BENCH, "  - Prefetched %u coins for the next block\n", num_prefetched);
+    }
     int64_t nTime5 = GetTimeMicros(); nTimeChainState += nTime5 - nTime4;
     LogPrint(BCLog::BENCH, "  - Writing chainstate: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime5 - nTime4) * MILLI, nTimeChainState * MICRO, nTimeChainState * MILLI / nBlocksTotal);
     // Remove conflicting transactions from the mempool.;
@@ -3758,9 +3769,20 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
         }
         nHeight = nTargetHeight;
 
+        // Check the stakes of the new blocks together, ConnectBlock reuses the results
+        if (fGlobeMode && g_stake_precheck_threads > 0 && IsInitialBlockDownload()) {
+            m_stake_prechecker.Run(*this, vpindexToConnect, g_stake_precheck_threads);
+        }
+
         // Connect new blocks.
         for (CBlockIndex* pindexConnect : reverse_iterate(vpindexToConnect)) {
-            if (!ConnectTip(state, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
+            const CBlockIndex* pindex_next = pindexConnect != pindexMostWork ? pindexMostWork->GetAncestor(pindexConnect->nHeight + 1) : nullptr;
+            // Blocks read by the stake prechecks aren't read from disk again
+            std::shared_ptr<const CBlock> block_connect{pindexConnect == pindexMostWork ? pblock : nullptr};
+            if (!block_connect) {
+                block_connect = m_stake_prechecker.TakeBlock(pindexConnect);
+            }
+            if (!ConnectTip(state, pindexConnect, block_connect, connectTrace, disconnectpool, pindex_next)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (state.GetResult() != BlockValidationResult::BLOCK_MUTATED) {
@@ -4317,6 +4339,7 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
         TxValidationState tx_state;
         tx_state.SetStateInfo(block.nTime, -1, consensusParams, fGlobeMode, (globe::fBusyImporting && globe::fSkipRangeproof), true);
         tx_state.m_chainman = state.m_chainman;
+        tx_state.m_blind_scratch = state.m_blind_scratch;
         if (state.m_chainman) {
             tx_state.m_chainstate = &state.m_chainman->ActiveChainstate();
         }
@@ -5150,6 +5173,9 @@ bool Chainstate::LoadChainTip()
     PruneBlockIndexCandidates();
 
     tip = m_chain.Tip();
+    if (this == &m_chainman.ActiveChainstate()) {
+        globe::g_network_stake_weight.SetTip(tip);
+    }
     LogPrintf("Loaded best chain: hashBestChain=%s height=%d date=%s progress=%f\n",
               tip->GetBlockHash().ToString(),
               m_chain.Height(),
@@ -5540,6 +5566,47 @@ bool Chainstate::LoadGenesisBlock()
     return true;
 }
 
+namespace {
+/** A block read by LoadExternalBlockFile, waiting to be accepted. */
+struct ImportedBlock {
+    std::shared_ptr<CBlock> pblock;
+    FlatFilePos pos;
+    bool check; // Run the context free checks ahead of AcceptBlock
+};
+
+/** Limits of a batch of blocks checked together while importing. */
+static constexpr size_t IMPORT_BATCH_MAX_BLOCKS{1000};
+static constexpr size_t IMPORT_BATCH_MAX_BYTES{32 * 1024 * 1024};
+
+/**
+ * Run CheckBlock on the blocks of a batch, spread over num_threads threads.
+ * Blocks that pass are marked fChecked so AcceptBlock skips the checks, the
+ * others are checked again and rejected by AcceptBlock.
+ */
+void CheckImportedBlocks(std::vector<ImportedBlock>& blocks, const Consensus::Params& consensus_params, int num_threads)
+{
+    std::atomic<size_t> next{0};
+    util::ParallelFor(num_threads, num_threads, [&](size_t) {
+        // The shared blind_scratch can't be used concurrently
+        secp256k1_scratch_space* scratch = secp256k1_scratch_space_create(secp256k1_ctx_blind, 1024 * 1024);
+        if (!scratch) {
+            return true; // Left to AcceptBlock
+        }
+        size_t i;
+        while ((i = next++) < blocks.size()) {
+            if (!blocks[i].check || ShutdownRequested()) {
+                continue;
+            }
+            BlockValidationState state;
+            state.m_blind_scratch = scratch;
+            CheckBlock(*blocks[i].pblock, state, consensus_params);
+        }
+        secp256k1_scratch_space_destroy(secp256k1_ctx_blind, scratch);
+        return true;
+    });
+}
+} // namespace
+
 void Chainstate::LoadExternalBlockFile(
     FILE* fileIn,
     FlatFilePos* dbp,
@@ -5558,6 +5625,120 @@ void Chainstate::LoadExternalBlockFile(
     fBalancesIndex = gArgs.GetBoolArg("-balancesindex", globe::DEFAULT_BALANCESINDEX);
 
     int nLoaded = 0;
+
+    // Accept a block, returns false if loading should stop
+    auto accept_block = [&](ImportedBlock& imported) {
+        std::shared_ptr<CBlock>& pblock = imported.pblock;
+        FlatFilePos* block_pos = dbp ? &imported.pos : nullptr;
+        try {
+            const CBlock& block = *pblock;
+            uint256 hash = block.GetHash();
+            {
+                LOCK(cs_main);
+                // detect out of order blocks, and store them for later
+                if (hash != m_params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(block.hashPrevBlock)) {
+                    LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
+                            block.hashPrevBlock.ToString());
+                    if (block_pos && blocks_with_unknown_parent) {
+                        blocks_with_unknown_parent->emplace(block.hashPrevBlock, *block_pos);
+                    }
+                    return true;
+                }
+
+                // process in case the block isn't known yet
+                const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
+                if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
+                  BlockValidationState state;
+                  state.m_chainman = chainman;
+                  if (AcceptBlock(pblock, state, nullptr, true, block_pos, nullptr, true)) {
+                      nLoaded++;
+                  }
+                  if (state.IsError()) {
+                      return false;
+                  }
+                } else if (hash != m_params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
+                    LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
+                }
+            }
+
+            // Activate the genesis block so normal node progress can continue
+            if (hash == m_params.GetConsensus().hashGenesisBlock) {
+                BlockValidationState state;
+                state.m_chainman = chainman;
+                if (!ActivateBestChain(state, nullptr)) {
+                    return false;
+                }
+            }
+
+            NotifyHeaderTip(*this);
+
+            if (!blocks_with_unknown_parent) return true;
+
+            // Recursively process earlier encountered successors of this block
+            std::deque<uint256> queue;
+            queue.push_back(hash);
+            while (!queue.empty()) {
+                uint256 head = queue.front();
+                queue.pop_front();
+                auto range = blocks_with_unknown_parent->equal_range(head);
+                while (range.first != range.second) {
+                    std::multimap<uint256, FlatFilePos>::iterator it = range.first;
+                    std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
+                    if (ReadBlockFromDisk(*pblockrecursive, it->second, m_params.GetConsensus())) {
+                        LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
+                                head.ToString());
+                        LOCK(cs_main);
+                        BlockValidationState dummy;
+                        dummy.m_chainman = chainman;
+                        if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
+                            nLoaded++;
+                            queue.push_back(pblockrecursive->GetHash());
+                        }
+                    }
+                    range.first++;
+                    blocks_with_unknown_parent->erase(it);
+                    NotifyHeaderTip(*this);
+                }
+            }
+        } catch (const std::exception& e) {
+            LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
+        }
+        return true;
+    };
+
+    // Blocks are read in batches. The context free checks of a batch run on
+    // worker threads while the next batch is read and the previous one is
+    // accepted, in file order, on this thread.
+    std::vector<ImportedBlock> batch, batch_checking;
+    size_t batch_bytes{0};
+    std::future<void> checking;
+    const int num_threads{g_loadblock_threads};
+    bool stop{false};
+
+    // Start checking the current batch and accept the one checked before, returns false if loading should stop
+    auto next_batch = [&]() {
+        if (checking.valid()) {
+            checking.wait();
+        }
+        std::vector<ImportedBlock> checked = std::move(batch_checking);
+        batch_checking = std::move(batch);
+        batch.clear();
+        batch_bytes = 0;
+        if (!batch_checking.empty() && num_threads > 0) {
+            checking = std::async(std::launch::async, [&batch_checking, this, num_threads] {
+                util::ThreadRename("loadblkchk");
+                CheckImportedBlocks(batch_checking, m_params.GetConsensus(), num_threads);
+            });
+        }
+        for (auto& imported : checked) {
+            if (ShutdownRequested() || !accept_block(imported)) {
+                stop = true;
+                return false;
+            }
+        }
+        return true;
+    };
+
     try {
         // This takes over fileIn and calls fclose() on it in the CBufferedFile destructor
         CBufferedFile blkdat(fileIn, 2*MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE+8, SER_DISK, CLIENT_VERSION);
@@ -5593,85 +5774,36 @@ void Chainstate::LoadExternalBlockFile(
                     dbp->nPos = nBlockPos;
                 blkdat.SetLimit(nBlockPos + nSize);
                 std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-                CBlock& block = *pblock;
-                blkdat >> block;
+                blkdat >> *pblock;
                 nRewind = blkdat.GetPos();
 
-                uint256 hash = block.GetHash();
-                {
+                bool check{num_threads > 0};
+                if (check) {
+                    // Skip the checks of blocks that won't be accepted again
                     LOCK(cs_main);
-                    // detect out of order blocks, and store them for later
-                    if (hash != m_params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(block.hashPrevBlock)) {
-                        LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                block.hashPrevBlock.ToString());
-                        if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(block.hashPrevBlock, *dbp);
-                        }
-                        continue;
-                    }
-
-                    // process in case the block isn't known yet
-                    const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
-                    if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                      BlockValidationState state;
-                      state.m_chainman = chainman;
-                      if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
-                          nLoaded++;
-                      }
-                      if (state.IsError()) {
-                          break;
-                      }
-                    } else if (hash != m_params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
-                        LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
-                    }
-                }
-
-                // Activate the genesis block so normal node progress can continue
-                if (hash == m_params.GetConsensus().hashGenesisBlock) {
-                    BlockValidationState state;
-                    state.m_chainman = chainman;
-                    if (!ActivateBestChain(state, nullptr)) {
-                        break;
-                    }
-                }
-
-                NotifyHeaderTip(*this);
-
-                if (!blocks_with_unknown_parent) continue;
-
-                // Recursively process earlier encountered successors of this block
-                std::deque<uint256> queue;
-                queue.push_back(hash);
-                while (!queue.empty()) {
-                    uint256 head = queue.front();
-                    queue.pop_front();
-                    auto range = blocks_with_unknown_parent->equal_range(head);
-                    while (range.first != range.second) {
-                        std::multimap<uint256, FlatFilePos>::iterator it = range.first;
-                        std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (ReadBlockFromDisk(*pblockrecursive, it->second, m_params.GetConsensus())) {
-                            LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
-                                    head.ToString());
-                            LOCK(cs_main);
-                            BlockValidationState dummy;
-                            dummy.m_chainman = chainman;
-                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
-                                nLoaded++;
-                                queue.push_back(pblockrecursive->GetHash());
-                            }
-                        }
-                        range.first++;
-                        blocks_with_unknown_parent->erase(it);
-                        NotifyHeaderTip(*this);
-                    }
+                    const CBlockIndex* pindex = m_blockman.LookupBlockIndex(pblock->GetHash());
+                    check = !pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0;
                 }
+                batch.push_back({pblock, dbp ? *dbp : FlatFilePos(), check});
+                batch_bytes += nSize;
             } catch (const std::exception& e) {
                 LogPrintf("%s: Deserialize or I/O error - %s\n", __func__, e.what());
             }
+
+            if ((batch.size() >= IMPORT_BATCH_MAX_BLOCKS || batch_bytes >= IMPORT_BATCH_MAX_BYTES) && !next_batch()) {
+                break;
+            }
+        }
+        // Accept the remaining blocks only when the end of the file was reached
+        if (!stop && next_batch()) {
+            next_batch();
         }
     } catch (const std::runtime_error& e) {
         AbortNode(std::string("System error: ") + e.what());
     }
+    if (checking.valid()) {
+        checking.wait();
+    }
     LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
 }
 
@@ -6102,6 +6234,67 @@ bool ChainstateManager::ActivateSnapshot(
     return true;
 }
 
+namespace {
+/** The deserialized items of a SnapshotChunk, only the vector of its section is filled. */
+struct SnapshotChunkItems {
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    std::vector<std::pair<int64_t, CAnonOutput>> anon_outputs;
+    std::vector<std::pair<CCmpPubKey, CAnonKeyImageInfo>> key_images;
+    std::vector<std::pair<COutPoint, SpentCoin>> spent_cache;
+};
+
+template <typename K, typename V>
+void ReadSnapshotItems(CDataStream& stream, uint32_t count, std::vector<std::pair<K, V>>& items)
+{
+    items.resize(count);
+    for (auto& [key, value] : items) {
+        stream >> key >> value;
+    }
+}
+
+/**
+ * Deserialize the items of chunk. Returns false if the chunk is malformed,
+ * has items left over or has coins above base_height. Doesn't throw, may be
+ * called on several threads.
+ */
+bool ReadSnapshotChunk(const SnapshotChunk& chunk, int base_height, SnapshotChunkItems& items)
+{
+    if (chunk.m_count > SNAPSHOT_CHUNK_ITEMS ||
+        (!fGlobeMode && chunk.m_section != SNAPSHOT_COINS)) {
+        return false;
+    }
+    CDataStream stream{chunk.m_data, SER_DISK, CLIENT_VERSION};
+    try {
+        switch (chunk.m_section) {
+        case SNAPSHOT_COINS:
+            ReadSnapshotItems(stream, chunk.m_count, items.coins);
+            for (const auto& [outpoint, coin] : items.coins) {
+                if (coin.nHeight > base_height ||
+                    outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+                ) {
+                    return false;
+                }
+            }
+            break;
+        case SNAPSHOT_ANON_OUTPUTS:
+            ReadSnapshotItems(stream, chunk.m_count, items.anon_outputs);
+            break;
+        case SNAPSHOT_KEY_IMAGES:
+            ReadSnapshotItems(stream, chunk.m_count, items.key_images);
+            break;
+        case SNAPSHOT_SPENT_CACHE:
+            ReadSnapshotItems(stream, chunk.m_count, items.spent_cache);
+            break;
+        default:
+            return false;
+        }
+    } catch (const std::ios_base::failure&) {
+        return false;
+    }
+    return stream.empty();
+}
+} // namespace
+
 static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache, bool snapshot_loaded)
 {
     LOG_TIME_MILLIS_WITH_CATEGORY_MSG_ONCE(
@@ -6124,6 +6317,11 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
 
     uint256 base_blockhash = metadata.m_base_blockhash;
 
+    if (metadata.m_version != SNAPSHOT_VERSION) {
+        LogPrintf("[snapshot] unsupported snapshot version %d\n", metadata.m_version);
+        return false;
+    }
+
     CBlockIndex* snapshot_start_block = WITH_LOCK(::cs_main, return m_blockman.LookupBlockIndex(base_blockhash));
 
     if (!snapshot_start_block) {
@@ -6147,115 +6345,207 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
 
     const AssumeutxoData& au_data = *maybe_au_data;
 
-    COutPoint outpoint;
-    Coin coin;
     const uint64_t coins_count = metadata.m_coins_count;
     uint64_t coins_left = metadata.m_coins_count;
+    const int num_threads{std::min(GetNumCores(), MAX_SNAPSHOT_THREADS)};
 
     LogPrintf("[snapshot] loading coins from snapshot %s\n", base_blockhash.ToString());
     int64_t coins_processed{0};
 
-    while (coins_left > 0) {
-        try {
-            coins_file >> outpoint;
-            coins_file >> coin;
-        } catch (const std::ios_base::failure&) {
+    auto breakpoint_fnc = [] { /* TODO insert breakpoint here? */ };
+
+    // Flush the coins and check them against the assumeutxo hash, run once
+    // all coins are loaded, before the RCT tables following them are read.
+    auto finish_coins = [&]() {
+        if (coins_left > 0) {
             LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
                       coins_count - coins_left);
             return false;
         }
-        if (coin.nHeight > base_height ||
-            outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-        ) {
-            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
-        }
 
-        coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
+        // Important that we set this. This and the coins_cache accesses above are
+        // sort of a layer violation, but either we reach into the innards of
+        // CCoinsViewCache here or we have to invert some of the Chainstate to
+        // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
+        // method.
+        coins_cache.SetBestBlock(base_blockhash, 5);
+
+        LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
+            coins_count,
+            coins_cache.DynamicMemoryUsage() / (1000 * 1000),
+            base_blockhash.ToString());
+
+        // No need to acquire cs_main since this chainstate isn't being used yet.
+        FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
 
-        --coins_left;
-        ++coins_processed;
+        assert(coins_cache.GetBestBlock() == base_blockhash);
 
-        if (coins_processed % 1000000 == 0) {
-            LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
-                coins_processed,
-                static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+        // As above, okay to immediately release cs_main here since no other context knows
+        // about the snapshot_chainstate.
+        CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
+
+        const std::optional<CCoinsStats> maybe_stats = ComputeUTXOStats(CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, breakpoint_fnc);
+        if (!maybe_stats.has_value()) {
+            LogPrintf("[snapshot] failed to generate coins stats\n");
+            return false;
         }
 
-        // Batch write and flush (if we need to) every so often.
-        //
-        // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-        // means <5MB of memory imprecision.
-        if (coins_processed % 120000 == 0) {
-            if (ShutdownRequested()) {
+        // Assert that the deserialized chainstate contents match the expected assumeutxo value.
+        if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
+            LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
+                au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString());
+            return false;
+        }
+        return true;
+    };
+
+    // The RCT tables are shared by all chainstates and written to the block
+    // tree db directly, they are kept in memory until the whole snapshot is
+    // validated so a bad snapshot leaves nothing behind.
+    std::vector<SnapshotChunkItems> rct_items;
+    int64_t anon_outputs_loaded{0};
+    bool coins_loaded{false};
+
+    // Chunks are read from the file in batches, deserialized on num_threads
+    // threads and then applied in file order.
+    std::vector<SnapshotChunk> chunks;
+    std::vector<SnapshotChunkItems> chunk_items;
+    bool end_of_file{false};
+    while (!end_of_file) {
+        chunks.clear();
+        while (chunks.size() < (size_t)num_threads * 2) {
+            SnapshotChunk chunk;
+            try {
+                coins_file >> chunk;
+            } catch (const std::ios_base::failure&) {
+                LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
+                          coins_count - coins_left);
                 return false;
             }
+            if (chunk.m_section == SNAPSHOT_END) {
+                end_of_file = true;
+                break;
+            }
+            chunks.push_back(std::move(chunk));
+        }
 
-            const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                return snapshot_chainstate.GetCoinsCacheSizeState());
+        chunk_items.assign(chunks.size(), SnapshotChunkItems{});
+        if (!util::ParallelFor(chunks.size(), num_threads, [&](size_t i) {
+                return ReadSnapshotChunk(chunks[i], base_height, chunk_items[i]);
+            })) {
+            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins\n",
+                      coins_count - coins_left);
+            return false;
+        }
 
-            if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                // This is a hack - we don't know what the actual best block is, but that
-                // doesn't matter for the purposes of flushing the cache here. We'll set this
-                // to its correct value (`base_blockhash`) below after the coins are loaded.
-                coins_cache.SetBestBlock(GetRandHash(), 5);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            SnapshotChunkItems& items = chunk_items[i];
 
-                // No need to acquire cs_main since this chainstate isn't being used yet.
-                FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
-            }
-        }
-    }
+            if (chunks[i].m_section == SNAPSHOT_COINS) {
+                if (coins_loaded || items.coins.size() > coins_left) {
+                    LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
+                        coins_count);
+                    return false;
+                }
+                for (auto& [outpoint, coin] : items.coins) {
+                    coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
 
-    // Important that we set this. This and the coins_cache accesses above are
-    // sort of a layer violation, but either we reach into the innards of
-    // CCoinsViewCache here or we have to invert some of the Chainstate to
-    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
-    // method.
-    coins_cache.SetBestBlock(base_blockhash, 5);
+                    --coins_left;
+                    ++coins_processed;
 
-    bool out_of_coins{false};
-    try {
-        coins_file >> outpoint;
-    } catch (const std::ios_base::failure&) {
-        // We expect an exception since we should be out of coins.
-        out_of_coins = true;
-    }
-    if (!out_of_coins) {
-        LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
-            coins_count);
-        return false;
-    }
+                    if (coins_processed % 1000000 == 0) {
+                        LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
+                            coins_processed,
+                            static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
+                            coins_cache.DynamicMemoryUsage() / (1000 * 1000));
+                    }
 
-    LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
-        coins_count,
-        coins_cache.DynamicMemoryUsage() / (1000 * 1000),
-        base_blockhash.ToString());
+                    // Batch write and flush (if we need to) every so often.
+                    //
+                    // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
+                    // means <5MB of memory imprecision.
+                    if (coins_processed % 120000 == 0) {
+                        if (ShutdownRequested()) {
+                            return false;
+                        }
 
-    // No need to acquire cs_main since this chainstate isn't being used yet.
-    FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
+                        const auto snapshot_cache_state = WITH_LOCK(::cs_main,
+                            return snapshot_chainstate.GetCoinsCacheSizeState());
 
-    assert(coins_cache.GetBestBlock() == base_blockhash);
+                        if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
+                            // This is a hack - we don't know what the actual best block is, but that
+                            // doesn't matter for the purposes of flushing the cache here. We'll set this
+                            // to its correct value (`base_blockhash`) below after the coins are loaded.
+                            coins_cache.SetBestBlock(GetRandHash(), 5);
 
-    auto breakpoint_fnc = [] { /* TODO insert breakpoint here? */ };
+                            // No need to acquire cs_main since this chainstate isn't being used yet.
+                            FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+                        }
+                    }
+                }
+                continue;
+            }
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
+            if (!coins_loaded) {
+                if (!finish_coins()) {
+                    return false;
+                }
+                coins_loaded = true;
+            }
+
+            for (const auto& [index, ao] : items.anon_outputs) {
+                if (index < 1 || index > metadata.m_anon_output_count) {
+                    LogPrintf("[snapshot] bad snapshot - anon output %d out of range\n", index);
+                    return false;
+                }
+                ++anon_outputs_loaded;
+            }
+            rct_items.push_back(std::move(items));
+        }
+    }
 
-    const std::optional<CCoinsStats> maybe_stats = ComputeUTXOStats(CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, breakpoint_fnc);
-    if (!maybe_stats.has_value()) {
-        LogPrintf("[snapshot] failed to generate coins stats\n");
+    if (!coins_loaded && !finish_coins()) {
+        return false;
+    }
+    if (anon_outputs_loaded != metadata.m_anon_output_count) {
+        LogPrintf("[snapshot] bad snapshot - expected %d anon outputs, got %d\n",
+            metadata.m_anon_output_count, anon_outputs_loaded);
         return false;
     }
 
-    // Assert that the deserialized chainstate contents match the expected assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
-        LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
-            au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString());
+    CBlockTreeDB& block_tree_db{*m_blockman.m_block_tree_db};
+    CDBBatch rct_batch{block_tree_db};
+    std::vector<std::pair<COutPoint, SpentCoin>> spent_cache;
+    for (const SnapshotChunkItems& items : rct_items) {
+        for (const auto& [index, ao] : items.anon_outputs) {
+            std::pair<uint8_t, int64_t> key = std::make_pair(DB_RCTOUTPUT, index);
+            rct_batch.Write(key, ao);
+            std::pair<uint8_t, CCmpPubKey> link_key = std::make_pair(DB_RCTOUTPUT_LINK, ao.pubkey);
+            rct_batch.Write(link_key, index);
+        }
+        for (const auto& [ki, data] : items.key_images) {
+            std::pair<uint8_t, CCmpPubKey> key = std::make_pair(DB_RCTKEYIMAGE, ki);
+            rct_batch.Write(key, data);
+        }
+        spent_cache.insert(spent_cache.end(), items.spent_cache.begin(), items.spent_cache.end());
+        if (rct_batch.SizeEstimate() > (size_t)nDefaultDbBatchSize) {
+            if (!block_tree_db.WriteBatch(rct_batch)) {
+                LogPrintf("[snapshot] failed to write RCT tables\n");
+                return false;
+            }
+            rct_batch.Clear();
+        }
+    }
+    rct_items.clear();
+    // The spent cache is held in memory too, it is added in the last batch
+    SpentCoinCacheUpdate spent_cache_update;
+    spent_cache_update.add = std::move(spent_cache);
+    block_tree_db.WriteSpentCache(rct_batch, spent_cache_update);
+    if (!block_tree_db.WriteBatch(rct_batch, /*fSync=*/true)) {
+        LogPrintf("[snapshot] failed to write RCT tables\n");
         return false;
     }
+    block_tree_db.ApplySpentCache(spent_cache_update);
 
     snapshot_chainstate.m_chain.SetTip(*snapshot_start_block);
 
@@ -6307,6 +6597,14 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     index->nChainTx = au_data.nChainTx;
     snapshot_chainstate.setBlockIndexCandidates.insert(snapshot_start_block);
 
+    if (fGlobeMode) {
+        // The blocks below the snapshot are not connected, take the RCT index
+        // and supply state of the base block from the snapshot.
+        snapshot_start_block->nAnonOutputs = metadata.m_anon_output_count;
+        snapshot_start_block->nMoneySupply = metadata.m_money_supply;
+        m_blockman.m_dirty_blockindex.insert(snapshot_start_block);
+    }
+
     LogPrintf("[snapshot] validated snapshot (%.2f MB)\n",
         coins_cache.DynamicMemoryUsage() / (1000 * 1000));
     return true;
@@ -6527,17 +6825,17 @@ bool CoinStakeCache::InsertCoinStake(const uint256 &blockHash, const CTransactio
     return true;
 }
 
-static void EraseDelayedBlock(BlockManager &blockman, std::list<DelayedBlock>::iterator p, BlockValidationState &state) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+static void EraseDelayedBlock(BlockManager &blockman, const DelayedBlock &delayed_block, BlockValidationState &state) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     assert(state.m_chainman);
-    if (p->m_node_id > -1) {
+    if (delayed_block.m_node_id > -1) {
         if (state.m_peerman) {
-            state.m_peerman->MisbehavingById(p->m_node_id, 25, "Delayed block");
+            state.m_peerman->MisbehavingById(delayed_block.m_node_id, 25, "Delayed block");
         }
     }
 
     assert(state.m_chainman);
-    auto it = state.m_chainman->BlockIndex().find(p->m_pblock->GetHash());
+    auto it = state.m_chainman->BlockIndex().find(delayed_block.m_pblock->GetHash());
     if (it != state.m_chainman->BlockIndex().end()) {
         it->second.nFlags = it->second.nFlags & (uint32_t)~BLOCK_DELAYED;
         blockman.m_dirty_blockindex.insert(&it->second);
@@ -6552,14 +6850,18 @@ bool DelayBlock(BlockManager &blockman, const std::shared_ptr<const CBlock> &pbl
         state.nodeId = state.m_peerman->GetBlockSource(pblock->GetHash());
     }
     LogPrintf("Warning: %s - Previous stake modifier is null for block %s from peer %d.\n", __func__, pblock->GetHash().ToString(), state.nodeId);
-    while (list_delayed_blocks.size() >= MAX_DELAYED_BLOCKS) {
-        LogPrint(BCLog::NET, "Removing Delayed block %s, too many delayed.\n", pblock->GetHash().ToString());
-        EraseDelayedBlock(blockman, list_delayed_blocks.begin(), state);
-        list_delayed_blocks.erase(list_delayed_blocks.begin());
-    }
-    assert(list_delayed_blocks.size() < MAX_DELAYED_BLOCKS);
     state.nFlags |= BLOCK_DELAYED; // Mark to prevent further processing
-    list_delayed_blocks.emplace_back(pblock, state.nodeId);
+    if (g_delayed_blocks.Have(pblock->GetHash())) {
+        return true;
+    }
+    const size_t block_size = ::GetSerializeSize(*pblock, PROTOCOL_VERSION);
+    while (!g_delayed_blocks.Empty() &&
+           (g_delayed_blocks.Size() >= MAX_DELAYED_BLOCKS || g_delayed_blocks.TotalSize() + block_size > MAX_DELAYED_BLOCKS_BYTES)) {
+        auto oldest = g_delayed_blocks.TakeOldest();
+        LogPrint(BCLog::NET, "Removing Delayed block %s, too many delayed.\n", oldest->m_pblock->GetHash().ToString());
+        EraseDelayedBlock(blockman, *oldest, state);
+    }
+    g_delayed_blocks.Insert(pblock, state.nodeId, GetTime());
     return true;
 }
 
@@ -6573,34 +6875,118 @@ void CheckDelayedBlocks(BlockManager &blockman, BlockValidationState &state, con
         state.m_peerman = state.m_chainman->m_peerman;
     }
     //assert(state.m_peerman);
-    if (list_delayed_blocks.empty()) {
+
+    std::vector<DelayedBlock> process_blocks;
+    {
+        LOCK(cs_main);
+        if (g_delayed_blocks.Empty()) {
+            return;
+        }
+        process_blocks = g_delayed_blocks.TakeChildren(block_hash);
+
+        for (const auto &expired : g_delayed_blocks.TakeExpired(GetTime() - MAX_DELAY_BLOCK_SECONDS)) {
+            LogPrint(BCLog::NET, "Removing delayed block %s, timed out.\n", expired.m_pblock->GetHash().ToString());
+            EraseDelayedBlock(blockman, expired, state);
+        }
+    }
+
+    for (auto &p : process_blocks) {
+        LogPrint(BCLog::NET, "Processing delayed block %s prev %s.\n", p.m_pblock->GetHash().ToString(), block_hash.ToString());
+        state.m_chainman->ProcessNewBlock(p.m_pblock, false, /*min_pow_checked=*/true, nullptr); // Should update DoS if necessary, finding block through mapBlockSource
+    }
+}
+
+fs::path DelayedBlocksPath(const ArgsManager& argsman)
+{
+    return argsman.GetDataDirNet() / "delayedblocks.dat";
+}
+
+bool DumpDelayedBlocks(const fs::path& dump_path) LOCKS_EXCLUDED(cs_main)
+{
+    std::vector<DelayedBlock> blocks = WITH_LOCK(cs_main, return g_delayed_blocks.GetAll());
+
+    try {
+        FILE* filestr{fsbridge::fopen(dump_path + ".new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << DELAYED_BLOCKS_DUMP_VERSION;
+        file << (uint64_t)blocks.size();
+        for (const auto &delayed_block : blocks) {
+            file << *delayed_block.m_pblock;
+        }
+
+        if (!FileCommit(file.Get())) {
+            throw std::runtime_error("FileCommit failed");
+        }
+        file.fclose();
+        if (!RenameOver(dump_path + ".new", dump_path)) {
+            throw std::runtime_error("Rename failed");
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump delayed blocks: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    LogPrintf("Dumped %u delayed blocks\n", blocks.size());
+    return true;
+}
+
+void LoadDelayedBlocks(ChainstateManager &chainman, const fs::path& load_path) LOCKS_EXCLUDED(cs_main)
+{
+    FILE* filestr{fsbridge::fopen(load_path, "rb")};
+    if (!filestr) {
         return;
     }
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
 
-    int64_t now = GetTime();
-    std::vector<std::shared_ptr<const CBlock> > process_blocks;
-    {
+    // Blocks whose parent was connected since they were dumped
+    std::vector<std::shared_ptr<const CBlock>> process_blocks;
+    size_t num_restored = 0;
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != DELAYED_BLOCKS_DUMP_VERSION) {
+            LogPrintf("Unknown delayed blocks file version %d, ignoring.\n", version);
+            return;
+        }
+        uint64_t num_blocks;
+        file >> num_blocks;
+
+        // Restored blocks get a full delay period from startup
+        const int64_t now = GetTime();
         LOCK(cs_main);
-        std::list<DelayedBlock>::iterator p = list_delayed_blocks.begin();
-        while (p != list_delayed_blocks.end()) {
-            if (p->m_pblock->hashPrevBlock == block_hash) {
-                process_blocks.push_back(p->m_pblock);
-                p = list_delayed_blocks.erase(p);
+        const uint256 &genesis_hash = chainman.GetConsensus().hashGenesisBlock;
+        while (num_blocks--) {
+            auto pblock = std::make_shared<CBlock>();
+            file >> *pblock;
+
+            CBlockIndex *pindex = chainman.m_blockman.LookupBlockIndex(pblock->GetHash());
+            if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) || (pindex->nStatus & BLOCK_FAILED_MASK)) {
+                continue;
+            }
+            if (pindex->pprev &&
+                (!pindex->pprev->bnStakeModifier.IsNull() || pindex->pprev->GetBlockHash() == genesis_hash)) {
+                process_blocks.push_back(pblock);
                 continue;
             }
-            if (p->m_time + MAX_DELAY_BLOCK_SECONDS < now) {
-                LogPrint(BCLog::NET, "Removing delayed block %s, timed out.\n", p->m_pblock->GetHash().ToString());
-                EraseDelayedBlock(blockman, p, state);
-                p = list_delayed_blocks.erase(p);
+            if (g_delayed_blocks.Size() >= MAX_DELAYED_BLOCKS ||
+                g_delayed_blocks.TotalSize() + ::GetSerializeSize(*pblock, PROTOCOL_VERSION) > MAX_DELAYED_BLOCKS_BYTES) {
                 continue;
             }
-            ++p;
+            if (g_delayed_blocks.Insert(pblock, -1, now)) {
+                pindex->nFlags |= BLOCK_DELAYED;
+                num_restored++;
+            }
         }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize delayed blocks data on disk: %s. Continuing anyway.\n", e.what());
     }
+    LogPrintf("Restored %u delayed blocks, %u ready to process\n", num_restored, process_blocks.size());
 
-    for (auto &p : process_blocks) {
-        LogPrint(BCLog::NET, "Processing delayed block %s prev %s.\n", p->GetHash().ToString(), block_hash.ToString());
-        state.m_chainman->ProcessNewBlock(p, false, /*min_pow_checked=*/true, nullptr); // Should update DoS if necessary, finding block through mapBlockSource
+    for (const auto &pblock : process_blocks) {
+        chainman.ProcessNewBlock(pblock, /*force_processing=*/false, /*min_pow_checked=*/true, nullptr);
     }
 }
 
@@ -6724,7 +7110,12 @@ bool RemoveUnreceivedHeader(ChainstateManager &chainman, const uint256 &hash) EX
 
 size_t CountDelayedBlocks() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
-    return list_delayed_blocks.size();
+    return g_delayed_blocks.Size();
+}
+
+size_t DelayedBlocksBytes() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    return g_delayed_blocks.TotalSize();
 }
 
 bool ProcessDuplicateStakeHeader(BlockManager &blockman, CBlockIndex *pindex, NodeId nodeId) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
@@ -6802,52 +7193,25 @@ bool ProcessDuplicateStakeHeader(BlockManager &blockman, CBlockIndex *pindex, No
 bool AddToMapStakeSeen(const COutPoint &kernel, const uint256 &blockHash)
 {
     // Overwrites existing values
-
-    std::pair<std::map<COutPoint, uint256>::iterator,bool> ret;
-    ret = mapStakeSeen.insert(std::pair<COutPoint, uint256>(kernel, blockHash));
-    if (ret.second == false) { // existing element
-        ret.first->second = blockHash;
-    } else {
-        listStakeSeen.push_back(kernel);
-    }
-
+    g_stake_seen.Insert(kernel, blockHash);
     return true;
 };
 
 bool CheckStakeUnused(const COutPoint &kernel)
 {
-    std::map<COutPoint, uint256>::const_iterator mi = mapStakeSeen.find(kernel);
-    return (mi == mapStakeSeen.end());
+    return !g_stake_seen.Have(kernel);
 }
 
 bool CheckStakeUnique(const CBlock &block, bool fUpdate)
 {
-    LOCK(cs_main);
-
     uint256 blockHash = block.GetHash();
     const COutPoint &kernel = block.vtx[0]->vin[0].prevout;
 
-    std::map<COutPoint, uint256>::const_iterator mi = mapStakeSeen.find(kernel);
-    if (mi != mapStakeSeen.end()) {
-        if (mi->second == blockHash) {
-            return true;
-        }
-        return error("%s: Stake kernel for %s first seen on %s.", __func__, blockHash.ToString(), mi->second.ToString());
+    uint256 first_seen;
+    if (!g_stake_seen.CheckUnique(kernel, blockHash, first_seen, fUpdate)) {
+        return error("%s: Stake kernel for %s first seen on %s.", __func__, blockHash.ToString(), first_seen.ToString());
     }
-
-    if (!fUpdate) {
-        return true;
-    }
-
-    while (listStakeSeen.size() > globe::MAX_STAKE_SEEN_SIZE) {
-        const COutPoint &oldest = listStakeSeen.front();
-        if (1 != mapStakeSeen.erase(oldest)) {
-            LogPrintf("%s: Warning: mapStakeSeen did not erase %s %n\n", __func__, oldest.hash.ToString(), oldest.n);
-        }
-        listStakeSeen.pop_front();
-    }
-
-    return AddToMapStakeSeen(kernel, blockHash);
+    return true;
 };
 
 bool RebuildRollingIndices(ChainstateManager &chainman, CTxMemPool *mempool)
@@ -19,9 +19,13 @@
 #include <deploymentstatus.h>
 #include <fs.h>
 #include <node/blockstorage.h>
+#include <node/inputprefetcher.h>
+#include <pos/stakeprecheck.h>
 #include <policy/feerate.h>
 #include <policy/packages.h>
 #include <policy/policy.h>
+#include <pos/stakeseen.h>
+#include <pos/stakeweight.h>
 #include <script/script_error.h>
 #include <sync.h>
 #include <txdb.h>
@@ -43,6 +47,7 @@
 #include <utility>
 #include <vector>
 
+class ArgsManager;
 class Chainstate;
 class CBlockTreeDB;
 class CTxMemPool;
@@ -63,6 +68,10 @@ struct Params;
 static const int MAX_SCRIPTCHECK_THREADS = 15;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of threads checking blocks while importing */
+static const int MAX_LOADBLOCK_THREADS = 16;
+/** -loadblockthreads default (number of block checking threads, 0 = auto) */
+static const int DEFAULT_LOADBLOCK_THREADS = 0;
 static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
@@ -116,6 +125,12 @@ extern uint256 g_best_block;
  * False indicates all script checking is done on the main threadMessageHandler thread.
  */
 extern bool g_parallel_script_checks;
+/** Number of threads used to prefetch the inputs of the next block, 0 disables prefetching. */
+extern int g_input_prefetch_threads;
+/** Number of threads checking the stakes of the blocks to connect during IBD, 0 disables. */
+extern int g_stake_precheck_threads;
+/** Number of threads running the context free block checks ahead of AcceptBlock while reindexing or importing blocks, 0 disables them. */
+extern int g_loadblock_threads;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
 /** If the tip is older than this (in seconds), the node is considered to be in initial block download. */
@@ -144,6 +159,7 @@ static constexpr bool DEFAULT_ADDRESSINDEX = false;
 static constexpr bool DEFAULT_TIMESTAMPINDEX = false;
 static constexpr bool DEFAULT_SPENTINDEX = false;
 static constexpr bool DEFAULT_BALANCESINDEX = false;
+static constexpr bool DEFAULT_VOTEINDEX = false;
 static constexpr unsigned int DEFAULT_DB_MAX_OPEN_FILES = 1000;
 static constexpr bool DEFAULT_DB_COMPRESSION = false; // set to true for insight
 static constexpr bool DEFAULT_AUTOMATIC_BANS = true;
@@ -547,11 +563,18 @@ public:
     //! Manages the UTXO set, which is a reflection of the contents of `m_chain`.
     std::unique_ptr<CoinsViews> m_coins_views;
 
+    //! Reads the inputs of the next block into CoinsTip() while ConnectTip runs.
+    node::InputPrefetcher m_input_prefetcher;
+
 public:
     //! Reference to a BlockManager instance which itself is shared across all
     //! Chainstate instances.
     node::BlockManager& m_blockman;
 
+    //! Stakes of the blocks to connect next that passed CheckProofOfStake's
+    //! signature and kernel hash checks ahead of ConnectBlock.
+    StakePrechecker m_stake_prechecker;
+
     /** Chain parameters for this chainstate */
     /* TODO: replace with m_chainman.GetParams() */
     const CChainParams& m_params;
@@ -810,7 +833,7 @@ public:
 
 //private:
     bool ActivateBestChainStep(BlockValidationState& state, CBlockIndex* pindexMostWork, const std::shared_ptr<const CBlock>& pblock, bool& fInvalidFound, ConnectTrace& connectTrace) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
-    bool ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
+    bool ConnectTip(BlockValidationState& state, CBlockIndex* pindexNew, const std::shared_ptr<const CBlock>& pblock, ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool, const CBlockIndex* pindex_next = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
 
     void InvalidBlockFound(CBlockIndex* pindex, const BlockValidationState& state) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     CBlockIndex* FindMostWorkChain() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -1204,15 +1227,22 @@ public:
 
 extern std::map<uint256, StakeConflict> mapStakeConflict;
 extern CoinStakeCache coinStakeCache;
-extern std::map<COutPoint, uint256> mapStakeSeen;
-extern std::list<COutPoint> listStakeSeen;
+extern SeenStakeKernels g_stake_seen;
+extern NetworkStakeWeight g_network_stake_weight;
 
 bool RemoveUnreceivedHeader(ChainstateManager &chainman, const uint256 &hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 size_t CountDelayedBlocks() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+//! Total serialized size of the delayed blocks
+size_t DelayedBlocksBytes() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+fs::path DelayedBlocksPath(const ArgsManager& argsman);
+//! Write the delayed blocks to disk so they survive a restart
+bool DumpDelayedBlocks(const fs::path& dump_path) LOCKS_EXCLUDED(cs_main);
+//! Requeue the dumped blocks, blocks whose parent has been connected since are processed
+void LoadDelayedBlocks(ChainstateManager &chainman, const fs::path& load_path) LOCKS_EXCLUDED(cs_main);
 
 
 
-bool AddToMapStakeSeen(const COutPoint &kernel, const uint256 &blockHash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+bool AddToMapStakeSeen(const COutPoint &kernel, const uint256 &blockHash);
 bool CheckStakeUnused(const COutPoint &kernel);
 bool CheckStakeUnique(const CBlock &block, bool fUpdate=true);
 
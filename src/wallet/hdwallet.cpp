@@ -20,6 +20,7 @@
 #include <pos/miner.h>
 #include <util/message.h>
 #include <util/moneystr.h>
+#include <util/parallel.h>
 #include <util/translation.h>
 #include <script/script.h>
 #include <script/standard.h>
@@ -170,6 +171,10 @@ void CHDWallet::AddOptions(ArgsManager& argsman)
     argsman.AddArg("-stealthv1lookaheadsize=<n>", strprintf("Number of V1 stealth keys to look ahead during a rescan. (default: %u)", DEFAULT_STEALTH_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
     argsman.AddArg("-stealthv2lookaheadsize=<n>", strprintf("Number of V2 stealth keys to look ahead during a rescan. (default: %u)", DEFAULT_STEALTH_LOOKAHEAD_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
     argsman.AddArg("-extkeysaveancestors", strprintf("On saving a key from the lookahead pool, save all unsaved keys leading up to it too. (default: %s)", "true"), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-blindthreads=<n>", strprintf("Number of threads used to generate range proofs and ring signatures, 0 = number of cores. (default: %d)", DEFAULT_BLIND_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-lookaheadthreads=<n>", strprintf("Number of threads used to derive the lookahead pools, 0 = number of cores, at most the number of cores. (default: %d)", DEFAULT_LOOKAHEAD_THREADS), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-storedtxcache=<n>", strprintf("Number of wallet transactions to keep in memory after being read from the wallet database. (default: %u)", DEFAULT_STORED_TX_CACHE_SIZE), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
+    argsman.AddArg("-lazytxrecords", strprintf("Archive the transaction records that can no longer affect the balance, archived records are loaded on first access to the wallet history instead of at startup. (default: %u)", DEFAULT_LAZY_TX_RECORDS), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
     argsman.AddArg("-createdefaultmasterkey", strprintf("Generate a random master key and main account if no master key exists. (default: %s)", "false"), ArgsManager::ALLOW_ANY, OptionsCategory::PART_WALLET);
 
     argsman.AddArg("-staking", "Stake your coins to support network and gain reward (default: true)", ArgsManager::ALLOW_ANY, OptionsCategory::PART_STAKING);
@@ -763,13 +768,9 @@ bool CHDWallet::GetVote(int nHeight, uint32_t &token)
     return false;
 };
 
-bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
+/** Read the records stored under prefix, "rtx" for the live records and "rtxa" for the archived records */
+static void ReadTxRecords(CHDWalletDB *pwdb, const std::string &prefix, const std::function<void(const uint256&, CTransactionRecord&)> &fn)
 {
-    LogPrint(BCLog::HDWALLET, "Loading transaction records for %s.\n", GetName());
-
-    assert(pwdb);
-    LOCK(cs_wallet);
-
     Dbc *pcursor;
     if (!(pcursor = pwdb->GetCursor())) {
         throw std::runtime_error(strprintf("%s: cannot create DB cursor", __func__).c_str());
@@ -778,25 +779,39 @@ bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
     CDataStream ssKey(SER_DISK, CLIENT_VERSION);
     CDataStream ssValue(SER_DISK, CLIENT_VERSION);
 
-    std::string strType, sPrefix = "rtx";
+    std::string strType;
     uint256 txhash;
 
     unsigned int fFlags = DB_SET_RANGE;
-    ssKey << sPrefix;
+    ssKey << prefix;
     while (pwdb->ReadAtCursor(pcursor, ssKey, ssValue, fFlags) == 0) {
         fFlags = DB_NEXT;
         ssKey >> strType;
-        if (strType != sPrefix) {
+        if (strType != prefix) {
             break;
         }
 
         ssKey >> txhash;
         CTransactionRecord data;
         ssValue >> data;
-        LoadToWallet(txhash, data);
+        fn(txhash, data);
     }
 
     pcursor->close();
+};
+
+bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
+{
+    LogPrint(BCLog::HDWALLET, "Loading transaction records for %s.\n", GetName());
+
+    assert(pwdb);
+    LOCK(cs_wallet);
+
+    m_lazy_tx_records = gArgs.GetBoolArg("-lazytxrecords", DEFAULT_LAZY_TX_RECORDS);
+
+    ReadTxRecords(pwdb, "rtx", [this](const uint256 &txhash, CTransactionRecord &data) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        LoadToWallet(txhash, data);
+    });
 
     int32_t flag;
     if (!pwdb->ReadFlag("anon_vin_v2", flag)) {
@@ -854,6 +869,342 @@ bool CHDWallet::LoadTxRecords(CHDWalletDB *pwdb)
 
     WalletLogPrintf("mapRecords.size() = %u\n", mapRecords.size());
 
+    if (m_lazy_tx_records) {
+        return ArchiveSettledTxRecords(pwdb);
+    }
+    // Records archived while running with -lazytxrecords
+    return LoadArchivedTxRecords();
+};
+
+bool CHDWallet::LoadArchivedTxRecords()
+{
+    AssertLockHeld(cs_wallet);
+    if (m_archived_tx_records_loaded) {
+        return true;
+    }
+    m_archived_tx_records_loaded = true;
+
+    CHDWalletDB wdb(*m_database);
+    std::vector<uint256> loaded, superseded;
+    ReadTxRecords(&wdb, "rtxa", [&](const uint256 &txhash, CTransactionRecord &data) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        if (mapRecords.count(txhash)) {
+            superseded.push_back(txhash); // The live record was written later
+            return;
+        }
+        LoadToWallet(txhash, data);
+        loaded.push_back(txhash);
+    });
+    // Drop the stale archived copies, a record rewritten after a reorg is archived again once settled
+    for (const auto &txhash : superseded) {
+        if (!wdb.EraseArchivedTxRecord(txhash)) {
+            WalletLogPrintf("%s: EraseArchivedTxRecord failed for %s.\n", __func__, txhash.ToString());
+        }
+    }
+    for (const auto &txhash : loaded) {
+        for (const auto &prevout : mapRecords[txhash].vin) {
+            AddToSpends(prevout, txhash);
+        }
+    }
+
+    if (!loaded.empty()) {
+        WalletLogPrintf("Loaded %u archived transaction records.\n", loaded.size());
+    }
+    return true;
+};
+
+bool CHDWallet::ArchiveSettledTxRecords(CHDWalletDB *pwdb)
+{
+    AssertLockHeld(cs_wallet);
+    if (!HaveChain()) {
+        return true;
+    }
+    const std::optional<int> tip_height = chain().getHeight();
+    if (!tip_height || *tip_height <= TX_RECORD_ARCHIVE_DEPTH) {
+        return true;
+    }
+    const int max_height = *tip_height - TX_RECORD_ARCHIVE_DEPTH;
+
+    // Records with outputs waiting for the wallet to be unlocked
+    std::set<uint256> locked;
+    {
+        Dbc *pcursor;
+        if (!(pcursor = pwdb->GetCursor())) {
+            return werror("%s: Cannot create DB cursor.", __func__);
+        }
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        std::string strType;
+        COutPoint op;
+        unsigned int fFlags = DB_SET_RANGE;
+        ssKey << std::string("lao");
+        while (pwdb->ReadKeyAtCursor(pcursor, ssKey, fFlags) == 0) {
+            fFlags = DB_NEXT;
+            ssKey >> strType;
+            if (strType != "lao") {
+                break;
+            }
+            ssKey >> op;
+            locked.insert(op.hash);
+        }
+        pcursor->close();
+    }
+
+    auto is_settled = [&](const uint256 &txhash) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet) {
+        const auto mri = mapRecords.find(txhash);
+        if (mri != mapRecords.end()) {
+            const CTransactionRecord &rtx = mri->second;
+            return !rtx.HashUnset() && rtx.nIndex >= 0 && rtx.block_height > 0 && rtx.block_height <= max_height;
+        }
+        const auto mwi = mapWallet.find(txhash);
+        if (mwi != mapWallet.end()) {
+            const auto *conf = mwi->second.state<TxStateConfirmed>();
+            return conf && conf->confirmed_block_height <= max_height;
+        }
+        return false;
+    };
+
+    // Oldest first, a record is only archived after the wallet records it spends
+    std::vector<std::pair<std::pair<int, int>, uint256>> candidates;
+    for (const auto &ri : mapRecords) {
+        if (is_settled(ri.first) && !locked.count(ri.first)) {
+            candidates.push_back({{ri.second.block_height, ri.second.nIndex}, ri.first});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::set<uint256> archived;
+    for (const auto &candidate : candidates) {
+        const uint256 &txhash = candidate.second;
+        const CTransactionRecord &rtx = mapRecords[txhash];
+
+        // The spends of wallet outputs must stay loaded while the outputs are
+        bool settled = true;
+        for (const auto &prevout : rtx.vin) {
+            if (mapWallet.count(prevout.hash) ||
+                (mapRecords.count(prevout.hash) && !archived.count(prevout.hash))) {
+                settled = false;
+                break;
+            }
+        }
+        // Every owned output must be spent by a settled transaction
+        for (size_t i = 0; settled && i < rtx.vout.size(); ++i) {
+            const COutputRecord &r = rtx.vout[i];
+            if (r.nFlags & ORF_LOCKED) {
+                settled = false;
+                break;
+            }
+            if (!(r.nFlags & ORF_OWN_ANY) || r.n == OR_PLACEHOLDER_N) {
+                continue;
+            }
+            bool spent = false;
+            const auto range = mapTxSpends.equal_range(COutPoint(txhash, r.n));
+            for (auto it = range.first; it != range.second; ++it) {
+                if (is_settled(it->second)) {
+                    spent = true;
+                    break;
+                }
+            }
+            settled = spent;
+        }
+        if (settled) {
+            archived.insert(txhash);
+        }
+    }
+    if (archived.empty()) {
+        return true;
+    }
+
+    if (!pwdb->TxnBegin()) {
+        return werror("%s: TxnBegin failed.", __func__);
+    }
+    for (const auto &txhash : archived) {
+        if (!pwdb->ArchiveTxRecord(txhash, mapRecords[txhash])) {
+            pwdb->TxnAbort();
+            return werror("%s: ArchiveTxRecord failed for %s.", __func__, txhash.ToString());
+        }
+    }
+    if (!pwdb->TxnCommit()) {
+        return werror("%s: TxnCommit failed.", __func__);
+    }
+
+    // Archived records stay in memory until the wallet is reloaded
+    WalletLogPrintf("Archived %u settled transaction records.\n", archived.size());
+    return true;
+};
+
+bool CHDWallet::GetStoredTx(const uint256 &txhash, CStoredTransaction &stx, CHDWalletDB *pwdb) const
+{
+    uint64_t generation;
+    {
+        LOCK(cs_stored_tx_cache);
+        if (m_stored_tx_cache.Get(txhash, stx)) {
+            return true;
+        }
+        generation = m_stored_tx_cache_generation;
+    }
+    if (pwdb) {
+        return pwdb->ReadStoredTx(txhash, stx);
+    }
+    if (!CHDWalletDB(*m_database).ReadStoredTx(txhash, stx)) {
+        return false;
+    }
+    // Not cached if an entry was dropped while reading, the write may have been missed
+    LOCK(cs_stored_tx_cache);
+    if (generation == m_stored_tx_cache_generation) {
+        m_stored_tx_cache.Insert(txhash, stx);
+    }
+    return true;
+};
+
+bool CHDWallet::WriteStoredTx(CHDWalletDB *pwdb, const uint256 &txhash, const CStoredTransaction &stx) const
+{
+    bool rv = pwdb->WriteStoredTx(txhash, stx);
+    UncacheStoredTx(txhash);
+    return rv;
+};
+
+void CHDWallet::UncacheStoredTx(const uint256 &txhash) const
+{
+    LOCK(cs_stored_tx_cache);
+    m_stored_tx_cache.Erase(txhash);
+    m_stored_tx_cache_generation++;
+};
+
+bool CHDWallet::LoadCTOutputs(CHDWalletDB *pwdb)
+{
+    assert(pwdb);
+    AssertLockHeld(cs_wallet);
+
+    Dbc *pcursor;
+    if (!(pcursor = pwdb->GetCursor())) {
+        throw std::runtime_error(strprintf("%s: cannot create DB cursor", __func__).c_str());
+    }
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+
+    std::string strType, sPrefix = "cto";
+    COutPoint op;
+    std::vector<COutPoint> vErase;
+
+    unsigned int fFlags = DB_SET_RANGE;
+    ssKey << sPrefix;
+    while (pwdb->ReadAtCursor(pcursor, ssKey, ssValue, fFlags) == 0) {
+        fFlags = DB_NEXT;
+        ssKey >> strType;
+        if (strType != sPrefix) {
+            break;
+        }
+
+        ssKey >> op;
+        if (mapRecords.count(op.hash) == 0 || IsSpent(op)) {
+            vErase.push_back(op);
+            continue;
+        }
+        COwnedCTOutput cto;
+        ssValue >> cto;
+        mapCTOutputs[op] = cto;
+    }
+
+    pcursor->close();
+
+    for (const auto &op : vErase) {
+        pwdb->EraseOwnedCTOutput(op);
+    }
+
+    WalletLogPrintf("Loaded %u owned CT outputs, erased %u.\n", mapCTOutputs.size(), vErase.size());
+
+    return true;
+};
+
+int CHDWallet::UpdateCTOutputs(CHDWalletDB *pwdb, const uint256 &txhash, const CTransactionRecord &rtx, const CStoredTransaction &stx) const
+{
+    LOCK(cs_wallet);
+
+    for (const auto &r : rtx.vout) {
+        if ((r.nType != OUTPUT_CT && r.nType != OUTPUT_RINGCT) ||
+            !(r.nFlags & ORF_OWN_ANY)) {
+            continue;
+        }
+
+        COwnedCTOutput cto;
+        if (!stx.GetBlind(r.n, cto.blind.begin())) {
+            continue; // Not expanded yet
+        }
+        if (r.nType == OUTPUT_RINGCT &&
+            !stx.GetAnonPubkey(r.n, cto.pk)) {
+            continue;
+        }
+
+        COutPoint op(txhash, r.n);
+        auto it = mapCTOutputs.find(op);
+        if (it != mapCTOutputs.end() &&
+            it->second.blind == cto.blind &&
+            it->second.pk == cto.pk) {
+            continue;
+        }
+        mapCTOutputs[op] = cto;
+        if (pwdb && !pwdb->WriteOwnedCTOutput(op, cto)) {
+            return werrorN(1, "%s: WriteOwnedCTOutput failed for %s.", __func__, op.ToString());
+        }
+    }
+
+    return 0;
+};
+
+int CHDWallet::EraseSpentCTOutputs(CHDWalletDB *pwdb, const CTransactionRecord &rtx) const
+{
+    LOCK(cs_wallet);
+
+    for (const auto &prevout : rtx.vin) {
+        auto it = mapCTOutputs.find(prevout);
+        if (it == mapCTOutputs.end() || !IsSpent(prevout)) {
+            continue;
+        }
+        if (pwdb && !pwdb->EraseOwnedCTOutput(prevout)) {
+            return werrorN(1, "%s: EraseOwnedCTOutput failed for %s.", __func__, prevout.ToString());
+        }
+        mapCTOutputs.erase(it);
+    }
+
+    return 0;
+};
+
+bool CHDWallet::GetOwnedCTOutput(CHDWalletDB *pwdb, const COutPoint &op, const CTransactionRecord &rtx, COwnedCTOutput &cto, bool fNeedAnonIndex) const
+{
+    LOCK(cs_wallet);
+
+    auto it = mapCTOutputs.find(op);
+    if (it == mapCTOutputs.end()) {
+        CStoredTransaction stx;
+        if (!GetStoredTx(op.hash, stx)) {
+            return false;
+        }
+        UpdateCTOutputs(pwdb, op.hash, rtx, stx);
+        if ((it = mapCTOutputs.find(op)) == mapCTOutputs.end()) {
+            return false;
+        }
+    }
+
+    // Anon indices are assigned when the block is connected and change if the txn is reorged into a different block
+    COwnedCTOutput &entry = it->second;
+    if (fNeedAnonIndex &&
+        (entry.anon_index < 0 || entry.anon_index_block != rtx.blockHash)) {
+        int64_t index;
+        if (!chain().readRCTOutputLink(entry.pk, index)) {
+            return false;
+        }
+        cto = entry;
+        cto.anon_index = index;
+        if (GetDepthInMainChain(rtx) < 1) {
+            return true;
+        }
+        entry.anon_index = index;
+        entry.anon_index_block = rtx.blockHash;
+        if (pwdb) {
+            pwdb->WriteOwnedCTOutput(op, entry);
+        }
+    }
+    cto = entry;
     return true;
 };
 
@@ -1216,7 +1567,7 @@ bool CHDWallet::GetTransaction(const uint256 &txhash, CTransactionRef &tx) const
     const auto mri = mapRecords.find(txhash);
     if (mri != mapRecords.end()) {
         CStoredTransaction stx;
-        if (!CHDWalletDB(*m_database).ReadStoredTx(txhash, stx)) {
+        if (!GetStoredTx(txhash, stx)) {
             WalletLogPrintf("%s: ReadStoredTx failed for %s.\n", __func__, txhash.ToString());
             return false;
         }
@@ -1530,6 +1881,18 @@ DBErrors CHDWallet::LoadWallet()
     m_rescan_stealth_v1_lookahead = gArgs.GetIntArg("-stealthv1lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
     m_rescan_stealth_v2_lookahead = gArgs.GetIntArg("-stealthv2lookaheadsize", DEFAULT_STEALTH_LOOKAHEAD_SIZE);
     m_default_lookahead = gArgs.GetIntArg("-defaultlookaheadsize", DEFAULT_LOOKAHEAD_SIZE);
+    m_blind_threads = gArgs.GetIntArg("-blindthreads", DEFAULT_BLIND_THREADS);
+    if (m_blind_threads <= 0) {
+        m_blind_threads = GetNumCores();
+    }
+    m_lookahead_threads = gArgs.GetIntArg("-lookaheadthreads", DEFAULT_LOOKAHEAD_THREADS);
+    if (m_lookahead_threads <= 0 || m_lookahead_threads > GetNumCores()) {
+        m_lookahead_threads = GetNumCores();
+    }
+    {
+        LOCK(cs_stored_tx_cache);
+        m_stored_tx_cache.SetMaxSize(std::max((int64_t)0, gArgs.GetIntArg("-storedtxcache", DEFAULT_STORED_TX_CACHE_SIZE)));
+    }
 
     std::string sError;
     ProcessStakingSettings(sError);
@@ -1571,6 +1934,7 @@ DBErrors CHDWallet::LoadWallet()
 
         LoadAddressBook(&wdb);
         LoadTxRecords(&wdb);
+        LoadCTOutputs(&wdb);
         LoadVoteTokens(&wdb);
     }
 
@@ -1620,7 +1984,7 @@ void CHDWallet::Downgrade()
         }
 
         CStoredTransaction stx;
-        if (!wdb.ReadStoredTx(txhash, stx)) {
+        if (!GetStoredTx(txhash, stx, &wdb)) {
             WalletLogPrintf("Warning: ReadStoredTx failed for: %s.\n", txhash.ToString());
             continue;
         }
@@ -2356,7 +2720,7 @@ CAmount CHDWallet::GetOutputValue(const COutPoint &op, bool fAllowTXIndex) const
             return rec->nValue;
         }
         CStoredTransaction stx;
-        if (!CHDWalletDB(*m_database).ReadStoredTx(op.hash, stx)) { // TODO: cache / use mapTempWallet
+        if (!GetStoredTx(op.hash, stx)) { // TODO: use mapTempWallet
             WalletLogPrintf("%s: ReadStoredTx failed for %s.\n", __func__, op.hash.ToString());
             return 0;
         }
@@ -3234,6 +3598,46 @@ int CHDWallet::ExpandTempRecipients(std::vector<CTempRecipient> &vecSend, CStore
 };
 
 int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, std::string &sError)
+{
+    return AddCTData(coinControl, txout, r, m_blind_scratch, sError);
+};
+
+int CHDWallet::AddCTData(const CCoinControl *coinControl, std::vector<std::pair<CTxOutBase*, CTempRecipient*> > &vOutputs, std::string &sError)
+{
+    if (vOutputs.size() < 2 || m_blind_threads < 2) {
+        for (auto &o : vOutputs) {
+            if (0 != AddCTData(coinControl, o.first, *o.second, m_blind_scratch, sError)) {
+                return 1; // sError will be set
+            }
+        }
+        return 0;
+    }
+
+    // Each output is proven independently, bulletproofs need a scratch space per thread
+    std::vector<std::string> vErrors(vOutputs.size());
+    bool fOk = util::ParallelFor(vOutputs.size(), m_blind_threads, [&](size_t i) {
+        secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(secp256k1_ctx_blind, 1024 * 1024);
+        if (!scratch) {
+            vErrors[i] = "secp256k1_scratch_space_create failed.";
+            return false;
+        }
+        int rv = AddCTData(coinControl, vOutputs[i].first, *vOutputs[i].second, scratch, vErrors[i]);
+        secp256k1_scratch_space_destroy(secp256k1_ctx_blind, scratch);
+        return rv == 0;
+    });
+    if (!fOk) {
+        for (const auto &s : vErrors) {
+            if (!s.empty()) {
+                sError = s;
+                break;
+            }
+        }
+        return 1;
+    }
+    return 0;
+};
+
+int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, secp256k1_scratch_space *scratch, std::string &sError) const
 {
     secp256k1_pedersen_commitment *pCommitment = txout->GetPCommitment();
     std::vector<uint8_t> *pvRangeproof = txout->GetPRangeproof();
@@ -3282,13 +3686,13 @@ int CHDWallet::AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTe
         bp[0] = r.vBlind.data();
         assert(r.vBlind.size() == 32);
 
-        if (1 != secp256k1_bulletproof_rangeproof_prove(secp256k1_ctx_blind, m_blind_scratch, blind_gens,
+        if (1 != secp256k1_bulletproof_rangeproof_prove(secp256k1_ctx_blind, scratch, blind_gens,
             pvRangeproof->data(), &nRangeProofLen, &nValue, nullptr, bp, 1,
             &secp256k1_generator_const_h, 64, nonce.begin(), nullptr, 0)) {
             return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_prove failed.");
         }
 
-        if (1 != secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind, m_blind_scratch, blind_gens,
+        if (1 != secp256k1_bulletproof_rangeproof_verify(secp256k1_ctx_blind, scratch, blind_gens,
             pvRangeproof->data(), nRangeProofLen, nullptr, pCommitment, 1, 64, &secp256k1_generator_const_h, nullptr, 0)) {
             return wserrorN(1, sError, __func__, "secp256k1_bulletproof_rangeproof_verify failed.");
         }
@@ -3932,6 +4336,7 @@ int CHDWallet::AddStandardInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 }
             }
 
+            std::vector<std::pair<CTxOutBase*, CTempRecipient*> > vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -3952,11 +4357,12 @@ int CHDWallet::AddStandardInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                     }
 
                     assert(r.n < (int)txNew.vpout.size());
-                    if (0 != AddCTData(coinControl, txNew.vpout[r.n].get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.emplace_back(txNew.vpout[r.n].get(), &r);
                 }
             }
+            if (0 != AddCTData(coinControl, vBlindedOutputs, sError)) {
+                return 1; // sError will be set
+            }
 
             // Fill in dummy signatures for fee calculation.
             int nIn = 0;
@@ -4372,6 +4778,7 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
     unsigned int nBytes;
     {
         LOCK(cs_wallet);
+        CHDWalletDB wdb(*m_database);
 
         std::vector<std::pair<MapRecords_t::const_iterator, unsigned int> > setCoins;
         std::vector<COutputR> vAvailableCoins;
@@ -4483,6 +4890,7 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             txNew.vpout.push_back(outFee);
 
             bool fFirst = true;
+            std::vector<std::pair<CTxOutBase*, CTempRecipient*> > vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -4515,11 +4923,12 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                         GetStrongRandBytes2(&r.vBlind[0], 32);
                     } // else already prefilled
 
-                    if (0 != AddCTData(coinControl, txbout.get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.emplace_back(txbout.get(), &r);
                 }
             }
+            if (0 != AddCTData(coinControl, vBlindedOutputs, sError)) {
+                return 1; // sError will be set
+            }
 
             // Fill in dummy signatures for fee calculation.
             int nIn = 0;
@@ -4655,13 +5064,11 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             if (it != coinControl->m_inputData.end()) {
                 memcpy(&vInputBlinds[nIn * 32], it->second.blind.begin(), 32);
             } else {
-                CStoredTransaction stx;
-                if (!CHDWalletDB(*m_database).ReadStoredTx(txhash, stx)) {
-                    return werrorN(1, "%s: ReadStoredTx failed for %s.\n", __func__, txhash.ToString().c_str());
-                }
-                if (!stx.GetBlind(coin.second, &vInputBlinds[nIn * 32])) {
+                COwnedCTOutput cto;
+                if (!GetOwnedCTOutput(&wdb, prevout, coin.first->second, cto, false)) {
                     return werrorN(1, "%s: GetBlind failed for %s, %d.\n", __func__, txhash.ToString().c_str(), coin.second);
                 }
+                memcpy(&vInputBlinds[nIn * 32], cto.blind.begin(), 32);
             }
             vpBlinds.push_back(&vInputBlinds[nIn * 32]);
 
@@ -4753,7 +5160,7 @@ int CHDWallet::AddBlindedInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 const CScript &scriptPubKey = oR->scriptPubKey;
 
                 CStoredTransaction stx;
-                if (!CHDWalletDB(*m_database).ReadStoredTx(txhash, stx)) {
+                if (!GetStoredTx(txhash, stx)) {
                     return werrorN(1, "%s: ReadStoredTx failed for %s.\n", __func__, txhash.ToString().c_str());
                 }
                 std::vector<uint8_t> vchAmount;
@@ -4887,7 +5294,8 @@ int CHDWallet::PlaceRealOutputs(std::vector<std::vector<int64_t> > &vMI, size_t
                 const uint256 &txhash = coin.first->first;
                 COutPoint op(txhash, coin.second);
                 const CCmpPubKey *pk = nullptr;
-                CStoredTransaction stx;
+                COwnedCTOutput cto;
+                int64_t index = -1;
 
                 std::map<COutPoint, CInputData>::const_iterator it = coinControl->m_inputData.find(op);
                 if (it != coinControl->m_inputData.end()) {
@@ -4901,22 +5309,21 @@ int CHDWallet::PlaceRealOutputs(std::vector<std::vector<int64_t> > &vMI, size_t
                     }
                     memcpy(&vInputBlinds[k * 32], it->second.blind.data(), 32);
                 } else {
-                    if (!wdb.ReadStoredTx(txhash, stx)) {
-                        return wserrorN(1, sError, __func__, "ReadStoredTx failed for %s", txhash.ToString().c_str());
-                    }
-                    if (!stx.tx->vpout[coin.second]->IsType(OUTPUT_RINGCT)) {
+                    const COutputRecord *oR = coin.first->second.GetOutput(coin.second);
+                    if (!oR || oR->nType != OUTPUT_RINGCT) {
                         return wserrorN(1, sError, __func__, _("Not an anon output %s %d").translated, txhash.ToString().c_str(), coin.second);
                     }
-                    pk = &(((CTxOutRingCT*)stx.tx->vpout[coin.second].get())->pk);
-                    if (!stx.GetBlind(coin.second, &vInputBlinds[k * 32])) {
+                    if (!GetOwnedCTOutput(&wdb, op, coin.first->second, cto, true)) {
                         return werrorN(1, "%s: GetBlind failed for %s, %d.\n", __func__, txhash.ToString().c_str(), coin.second);
                     }
+                    pk = &cto.pk;
+                    index = cto.anon_index;
+                    memcpy(&vInputBlinds[k * 32], cto.blind.begin(), 32);
                 }
                 assert(pk);
 
-                int64_t index;
-
-                if (!chain().readRCTOutputLink(*pk, index)) {
+                if (index < 0 &&
+                    !chain().readRCTOutputLink(*pk, index)) {
                     return wserrorN(1, sError, __func__, _("Anon pubkey not found in db, %s").translated, HexStr(*pk));
                 }
                 if (setHave.count(index)) {
@@ -5289,6 +5696,7 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
             txNew.vpout.push_back(outFee);
 
             bool fFirst = true;
+            std::vector<std::pair<CTxOutBase*, CTempRecipient*> > vBlindedOutputs;
             for (size_t i = 0; i < vecSend.size(); ++i) {
                 auto &r = vecSend[i];
 
@@ -5317,11 +5725,12 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                         GetStrongRandBytes2(&r.vBlind[0], 32);
                     } // else prefilled already
 
-                    if (0 != AddCTData(coinControl, txbout.get(), r, sError)) {
-                        return 1; // sError will be set
-                    }
+                    vBlindedOutputs.emplace_back(txbout.get(), &r);
                 }
             }
+            if (0 != AddCTData(coinControl, vBlindedOutputs, sError)) {
+                return 1; // sError will be set
+            }
 
             std::set<int64_t> setHave; // Anon prev-outputs can only be used once per transaction.
             size_t nTotalInputs = 0;
@@ -5526,22 +5935,38 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                 }
             }
 
+            // The MLSAGs are prepared serially, as the split commitment blinds depend
+            // on the previous inputs, and then generated in parallel.
+            struct MLSAGInput {
+                uint8_t randSeed[32];
+                uint8_t blindSum[32] = {0};
+                size_t nCols, nRows, nSecretColumn;
+                std::vector<CKey> vsk;
+                std::vector<const uint8_t*> vpsk;
+                std::vector<uint8_t> vm;
+            };
+            std::vector<MLSAGInput> vMLSAGInputs(txNew.vin.size());
+
             for (size_t l = 0; l < txNew.vin.size(); ++l) {
                 auto &txin = txNew.vin[l];
 
                 uint32_t nSigInputs, nSigRingSize;
                 txin.GetAnonInfo(nSigInputs, nSigRingSize);
 
-                size_t nCols = nSigRingSize;
-                size_t nRows = nSigInputs + 1;
+                auto &mi = vMLSAGInputs[l];
+                size_t nCols = mi.nCols = nSigRingSize;
+                size_t nRows = mi.nRows = nSigInputs + 1;
+                mi.nSecretColumn = vSecretColumns[l];
 
-                uint8_t randSeed[32];
-                GetStrongRandBytes2(randSeed, 32);
+                GetStrongRandBytes2(mi.randSeed, 32);
 
-                std::vector<CKey> vsk(nSigInputs);
-                std::vector<const uint8_t*> vpsk(nRows), vpBlinds, vpInCommits(nCols * nSigInputs);
-                std::vector<uint8_t> vm(nCols * nRows * 33);
-                std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+                std::vector<CKey> &vsk = mi.vsk;
+                std::vector<const uint8_t*> &vpsk = mi.vpsk;
+                std::vector<uint8_t> &vm = mi.vm;
+                vsk.resize(nSigInputs);
+                vpsk.resize(nRows);
+                vm.resize(nCols * nRows * 33);
+                std::vector<const uint8_t*> vpBlinds, vpInCommits(nCols * nSigInputs);
                 std::vector<uint8_t> &vDL = txin.scriptWitness.stack[1];
                 std::vector<secp256k1_pedersen_commitment> vCommitments;
                 vCommitments.reserve(nCols * nSigInputs);
@@ -5569,7 +5994,7 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
                     }
                 }
 
-                uint8_t blindSum[32] = {0};
+                uint8_t *blindSum = mi.blindSum;
                 vpsk[nRows-1] = blindSum;
                 if (txNew.vin.size() == 1) {
                     vDL.resize((1 + (nSigInputs+1) * nSigRingSize) * 32); // extra element for C, extra row for commitment row
@@ -5628,11 +6053,22 @@ int CHDWallet::AddAnonInputs(CWalletTx &wtx, CTransactionRecord &rtx,
 
                     vpBlinds.pop_back();
                 }
+            }
 
-                uint256 txhash = txNew.GetHash();
-                if (0 != (rv = secp256k1_generate_mlsag(secp256k1_ctx_blind, vKeyImages.data(), &vDL[0], &vDL[32],
-                    randSeed, txhash.begin(), nCols, nRows, vSecretColumns[l],
-                    &vpsk[0], &vm[0]))) {
+            // Witness data is not covered by the txn hash
+            uint256 txhash = txNew.GetHash();
+            std::vector<int> vMLSAGResults(txNew.vin.size(), 0);
+            util::ParallelFor(txNew.vin.size(), m_blind_threads, [&](size_t l) {
+                auto &txin = txNew.vin[l];
+                auto &mi = vMLSAGInputs[l];
+                std::vector<uint8_t> &vDL = txin.scriptWitness.stack[1];
+                vMLSAGResults[l] = secp256k1_generate_mlsag(secp256k1_ctx_blind, txin.scriptData.stack[0].data(), &vDL[0], &vDL[32],
+                    mi.randSeed, txhash.begin(), mi.nCols, mi.nRows, mi.nSecretColumn,
+                    &mi.vpsk[0], &mi.vm[0]);
+                return vMLSAGResults[l] == 0;
+            });
+            for (size_t l = 0; l < vMLSAGResults.size(); ++l) {
+                if (0 != (rv = vMLSAGResults[l])) {
                     return wserrorN(1, sError, __func__, "secp256k1_generate_mlsag failed %d", rv);
                 }
             }
@@ -5747,7 +6183,6 @@ bool CHDWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_w
             if (wtxIn.tx->GetCoinStakeHeight(csHeight)
                 && csHeight > nBestHeight - (globe::MAX_STAKE_SEEN_SIZE * 1.5)) {
                 // Add to MapStakeSeen to prevent node submitting a block that would be rejected.
-                LOCK(cs_main);
                 const COutPoint &kernel = wtxIn.tx->vin[0].prevout;
                 uint256 hash = wtxIn.GetHash();
                 globe::AddToMapStakeSeen(kernel, hash);
@@ -5812,7 +6247,7 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
     } else
     if ((itr = mapRecords.find(hash)) != mapRecords.end()) {
         CStoredTransaction stx;
-        if (!CHDWalletDB(*m_database).ReadStoredTx(hash, stx)) { // TODO: cache / use mapTempWallet
+        if (!GetStoredTx(hash, stx)) { // TODO: use mapTempWallet
             WalletLogPrintf("%s: ReadStoredTx failed for %s.\n", __func__, hash.ToString());
         } else {
             RemoveFromTxSpends(hash, stx.tx);
@@ -5827,7 +6262,11 @@ int CHDWallet::UnloadTransaction(const uint256 &hash)
             ++it;
         }
 
+        for (auto it = mapCTOutputs.lower_bound(COutPoint(hash, 0)); it != mapCTOutputs.end() && it->first.hash == hash; ) {
+            it = mapCTOutputs.erase(it);
+        }
         mapRecords.erase(itr);
+        UncacheStoredTx(hash);
     } else {
         WalletLogPrintf("Warning: %s - tx not found in wallet! %s.\n", __func__, hash.ToString());
         return 1;
@@ -6205,7 +6644,7 @@ int CHDWallet::ExtKeyImportAccount(CHDWalletDB *pwdb, CStoredExtKey &sekIn, int6
         return werrorN(1, "DB Write failed.");
     }
 
-    if (0 != ExtKeyAddAccountToMaps(idAccount, sea)) {
+    if (0 != ExtKeyAddAccountToMaps(pwdb, idAccount, sea)) {
         sea->FreeChains();
         delete sea;
         return werrorN(1, "ExtKeyAddAccountToMap() failed.");
@@ -6557,7 +6996,7 @@ int CHDWallet::ExtKeyDeriveNewAccount(CHDWalletDB *pwdb, CExtKeyAccount *sea, co
         return werrorN(1, "%s: DB Write failed.", __func__);
     }
 
-    if (0 != ExtKeyAddAccountToMaps(idAccount, sea)) {
+    if (0 != ExtKeyAddAccountToMaps(pwdb, idAccount, sea)) {
         sea->FreeChains();
         return werrorN(1, "%s: ExtKeyAddAccountToMaps() failed.", __func__);
     }
@@ -6599,7 +7038,7 @@ int CHDWallet::ExtKeySetDefaultAccount(CHDWalletDB *pwdb, CKeyID &idNewDefault)
 
     ExtKeyAccountMap::iterator mi = mapExtAccounts.find(idNewDefault);
     if (mi == mapExtAccounts.end()) {
-        if (0 != ExtKeyAddAccountToMaps(idNewDefault, sea)) {
+        if (0 != ExtKeyAddAccountToMaps(pwdb, idNewDefault, sea)) {
             delete sea;
             return werrorN(1, "%s: ExtKeyAddAccountToMaps() failed.", __func__);
         }
@@ -6919,7 +7358,7 @@ int CHDWallet::ExtKeyLoadAccount(CHDWalletDB *pwdb, const CKeyID &idAccount)
 
     ExtKeyLoadAccountKeys(pwdb, sea);
 
-    if (0 != ExtKeyAddAccountToMaps(idAccount, sea, true)) {
+    if (0 != ExtKeyAddAccountToMaps(pwdb, idAccount, sea, true)) {
         sea->FreeChains();
         delete sea;
         return werrorN(1, "%s: ExtKeyAddAccountToMaps failed: %s.",  __func__, HDAccIDToString(idAccount));
@@ -7000,7 +7439,7 @@ int CHDWallet::ExtKeyLoadAccounts()
 
         ExtKeyLoadAccountKeys(&wdb, sea);
 
-        if (0 != ExtKeyAddAccountToMaps(idAccount, sea, false)) {
+        if (0 != ExtKeyAddAccountToMaps(&wdb, idAccount, sea, false)) {
             WalletLogPrintf("%s: ExtKeyAddAccountToMaps failed: %s\n", __func__, HDAccIDToString(idAccount));
             sea->FreeChains();
             delete sea;
@@ -7060,7 +7499,8 @@ int CHDWallet::ExtKeyLoadLoose()
             psek = mapExtKeys[ckeyId];
         }
         if (psek->IsReceiveEnabled()) {
-            ExtKeyAddLookAhead(psek);
+            ExtKeyLoadDerivedPubKeys(&wdb, psek);
+            ExtKeyAddLookAhead(&wdb, psek);
         }
     }
     pcursor->close();
@@ -7095,7 +7535,7 @@ int CHDWallet::ExtKeyLoadLoose()
     return 0;
 }
 
-int CHDWallet::ExtKeyReload(const CStoredExtKey *sek)
+int CHDWallet::ExtKeyReload(CHDWalletDB *pwdb, const CStoredExtKey *sek)
 {
     CKeyID idk = sek->GetID();
 
@@ -7138,13 +7578,13 @@ int CHDWallet::ExtKeyReload(const CStoredExtKey *sek)
     }
     psek->nLastLookAhead = 0;
     if (psek->IsReceiveEnabled()) {
-        ExtKeyAddLookAhead(psek);
+        ExtKeyAddLookAhead(pwdb, psek);
     }
 
     return 0;
 }
 
-int CHDWallet::ExtKeyAddLookAhead(CStoredExtKey *sek) const
+int CHDWallet::ExtKeyAddLookAhead(CHDWalletDB *pwdb, CStoredExtKey *sek) const
 {
     CKeyID derivedId, idk = sek->GetID();
     CPubKey pk;
@@ -7163,12 +7603,16 @@ int CHDWallet::ExtKeyAddLookAhead(CStoredExtKey *sek) const
 
     WalletLogPrintf("Adding %d keys to lookahead for loose chain %s from %d.\n", nLookAhead - nStart, HDKeyIDToString(idk), nChild);
 
+    if (nStart < (uint32_t)nLookAhead) {
+        sek->CacheDerivedPubKeys(nChild, (uint32_t)nLookAhead - nStart, m_lookahead_threads);
+    }
+
     for (uint32_t k = nStart; k < (uint32_t)nLookAhead; ++k) {
         bool fGotKey = false;
 
         uint32_t nMaxTries = 1000; // TODO: link to lookahead size
         for (uint32_t i = 0; i < nMaxTries; ++i) { // nMaxTries > lookahead pool
-            if (sek->DeriveKey(pk, nChild, nChildOut, false) != 0) {
+            if (sek->DerivePubKey(pk, nChild, nChildOut) != 0) {
                 WalletLogPrintf("Warning: %s - DeriveKey failed, chain %s, child %d.\n", __func__, HDKeyIDToString(idk), nChild);
                 nChild = nChildOut + 1;
                 continue;
@@ -7204,9 +7648,89 @@ int CHDWallet::ExtKeyAddLookAhead(CStoredExtKey *sek) const
         }
     }
 
+    ExtKeySaveDerivedPubKeys(pwdb, sek);
+
     return 0;
 }
 
+int CHDWallet::ExtKeyLoadDerivedPubKeys(CHDWalletDB *pwdb, CStoredExtKey *sek) const
+{
+    assert(pwdb);
+    CKeyID idChain = sek->GetID();
+
+    Dbc *pcursor;
+    if (!(pcursor = pwdb->GetCursor())) {
+        return werrorN(1, "%s: cannot create DB cursor", __func__);
+    }
+
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+
+    CKeyID idKey;
+    CPubKey pk;
+    std::string strType;
+    uint32_t nChild;
+    std::vector<uint32_t> vErase;
+
+    uint32_t fFlags = DB_SET_RANGE;
+    ssKey << std::string("edpk");
+    ssKey << idChain;
+    while (pwdb->ReadAtCursor(pcursor, ssKey, ssValue, fFlags) == 0) {
+        fFlags = DB_NEXT;
+
+        ssKey >> strType;
+        if (strType != "edpk") {
+            break;
+        }
+        ssKey >> idKey;
+        if (idKey != idChain) {
+            break;
+        }
+        ssKey >> nChild;
+        if (nChild < sek->nGenerated) {
+            vErase.push_back(nChild);
+            continue;
+        }
+        ssValue >> pk;
+        sek->mapDerivedPubKeys[nChild] = pk;
+    }
+    pcursor->close();
+
+    // Keys below nGenerated have been saved to the wallet
+    for (auto nChild : vErase) {
+        pwdb->EraseExtKeyDerivedPubKey(idChain, nChild);
+    }
+
+    if (LogAcceptCategory(BCLog::HDWALLET, BCLog::Level::Debug)) {
+        WalletLogPrintf("%s: chain %s, loaded %d, erased %d.\n", __func__, HDKeyIDToString(idChain), sek->mapDerivedPubKeys.size(), vErase.size());
+    }
+
+    return 0;
+};
+
+int CHDWallet::ExtKeySaveDerivedPubKeys(CHDWalletDB *pwdb, CStoredExtKey *sek) const
+{
+    assert(pwdb);
+    CKeyID idChain = sek->GetID();
+
+    for (auto nChild : sek->vDerivedPubKeysNew) {
+        auto mi = sek->mapDerivedPubKeys.find(nChild);
+        if (mi == sek->mapDerivedPubKeys.end()) {
+            continue;
+        }
+        if (!pwdb->WriteExtKeyDerivedPubKey(idChain, nChild, mi->second)) {
+            sek->vDerivedPubKeysNew.clear();
+            return werrorN(1, "%s: WriteExtKeyDerivedPubKey failed, chain %s, child %d.", __func__, HDKeyIDToString(idChain), nChild);
+        }
+    }
+    sek->vDerivedPubKeysNew.clear();
+
+    // Drop in-memory entries for keys that have already been generated
+    sek->mapDerivedPubKeys.erase(sek->mapDerivedPubKeys.begin(), sek->mapDerivedPubKeys.lower_bound(sek->nGenerated));
+
+    return 0;
+};
+
 int CHDWallet::ExtKeyPromoteKey(CStoredExtKey *sek, uint32_t nChildKey) const
 {
     CKeyID idk = sek->GetID();
@@ -7237,7 +7761,7 @@ int CHDWallet::ExtKeyPromoteKey(CStoredExtKey *sek, uint32_t nChildKey) const
     if (!wdb.WriteExtKey(idk, *sek)) {
         return werrorN(1, "%s: WriteExtKey failed.", __func__);
     }
-    ExtKeyAddLookAhead(sek);
+    ExtKeyAddLookAhead(&wdb, sek);
 
     if (!sek->IsTrackOnly() && !wdb.TxnCommit()) {
         return werrorN(1, "%s TxnCommit failed.", __func__);
@@ -7265,7 +7789,7 @@ int CHDWallet::ExtKeySaveAccountToDB(CHDWalletDB *pwdb, const CKeyID &idAccount,
     return 0;
 };
 
-int CHDWallet::ExtKeyAddAccountToMaps(const CKeyID &idAccount, CExtKeyAccount *sea, bool fAddToLookAhead)
+int CHDWallet::ExtKeyAddAccountToMaps(CHDWalletDB *pwdb, const CKeyID &idAccount, CExtKeyAccount *sea, bool fAddToLookAhead)
 {
     LogPrint(BCLog::HDWALLET, "%s %s\n", GetDisplayName(), __func__);
     AssertLockHeld(cs_wallet);
@@ -7287,7 +7811,8 @@ int CHDWallet::ExtKeyAddAccountToMaps(const CKeyID &idAccount, CExtKeyAccount *s
             }
 
             if (fAddToLookAhead) {
-                sea->AddLookAhead(i, (uint32_t)nLookAhead);
+                sea->AddLookAhead(i, (uint32_t)nLookAhead, m_lookahead_threads);
+                ExtKeySaveDerivedPubKeys(pwdb, sek);
             }
         }
 
@@ -7477,6 +8002,7 @@ int CHDWallet::PrepareLookahead()
 {
     WalletLogPrintf("Preparing Lookahead pools.\n");
 
+    CHDWalletDB wdb(GetDatabase());
     for (auto it = mapExtAccounts.cbegin(); it != mapExtAccounts.cend(); ++it) {
         CExtKeyAccount *sea = it->second;
         sea->ClearLookAhead();
@@ -7491,7 +8017,11 @@ int CHDWallet::PrepareLookahead()
                     nLookAhead = GetCompressedInt64(itV->second, nLookAhead);
                 }
 
-                sea->AddLookAhead(i, (uint32_t)nLookAhead);
+                if (sek->mapDerivedPubKeys.empty()) {
+                    ExtKeyLoadDerivedPubKeys(&wdb, sek);
+                }
+                sea->AddLookAhead(i, (uint32_t)nLookAhead, m_lookahead_threads);
+                ExtKeySaveDerivedPubKeys(&wdb, sek);
             }
         }
     }
@@ -7652,6 +8182,7 @@ int CHDWallet::ExtKeySaveKey(CHDWalletDB *pwdb, CExtKeyAccount *sea, const CKeyI
     if (!pwdb->WriteExtKey(idChain, *pc)) {
         return werrorN(1, "%s WriteExtKey failed.", __func__);
     }
+    ExtKeySaveDerivedPubKeys(pwdb, pc);
 
     if (fUpdateAcc) { // only necessary if nPack has changed
         CKeyID idAccount = sea->GetID();
@@ -8500,7 +9031,8 @@ int CHDWallet::NewExtKeyFromAccount(CHDWalletDB *pwdb, const CKeyID &idAccount,
     if (mvi != sekOut->mapValue.end()) {
         nLookAhead = GetCompressedInt64(mvi->second, nLookAhead);
     }
-    sea->AddLookAhead(chainNo, nLookAhead);
+    sea->AddLookAhead(chainNo, nLookAhead, m_lookahead_threads);
+    ExtKeySaveDerivedPubKeys(pwdb, sekOut);
 
     mapExtKeys[idNewChain] = sekOut;
 
@@ -9416,7 +9948,7 @@ bool CHDWallet::ProcessLockedBlindedOutputs()
         MapRecords_t::iterator mir;
         mir = mapRecords.find(op.hash);
         if (mir == mapRecords.end() ||
-            !wdb.ReadStoredTx(op.hash, stx)) {
+            !GetStoredTx(op.hash, stx, &wdb)) {
             WalletLogPrintf("%s: Error: mapRecord not found for %s.\n", __func__, op.ToString());
             continue;
         }
@@ -9471,12 +10003,15 @@ bool CHDWallet::ProcessLockedBlindedOutputs()
                 ProcessPlaceholder(*stx.tx.get(), rtx);
             }
 
+            setChanged.insert(op.hash);
             if (!wdb.WriteTxRecord(op.hash, rtx) ||
-                !wdb.WriteStoredTx(op.hash, stx)) {
+                !WriteStoredTx(&wdb, op.hash, stx) ||
+                0 != UpdateCTOutputs(&wdb, op.hash, rtx, stx)) {
+                for (const auto &txhash : setChanged) {
+                    UncacheStoredTx(txhash);
+                }
                 return false;
             }
-
-            setChanged.insert(op.hash);
         }
 
         nExpanded++;
@@ -9486,6 +10021,10 @@ bool CHDWallet::ProcessLockedBlindedOutputs()
 
     wdb.TxnCommit();
     }
+    // Other readers may have cached the uncommitted transactions
+    for (const auto &txhash : setChanged) {
+        UncacheStoredTx(txhash);
+    }
 
     // Trigger a rescan from the deepest anon out, spend info may need to be updated
     // Only possible if outputs were spent from a different wallet.
@@ -10406,7 +10945,7 @@ int CHDWallet::InsertTempTxn(const uint256 &txid, const CTransactionRecord *rtx)
     LOCK(cs_wallet);
 
     CStoredTransaction stx;
-    if (!CHDWalletDB(*m_database).ReadStoredTx(txid, stx)) {
+    if (!GetStoredTx(txid, stx)) {
         return werrorN(1, "%s: ReadStoredTx failed for %s.\n", __func__, txid.ToString().c_str());
     }
 
@@ -10991,7 +11530,7 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, c
     }
 
     CStoredTransaction stx;
-    if (!wdb.ReadStoredTx(txhash, stx)) {
+    if (!GetStoredTx(txhash, stx, &wdb)) {
         stx.vBlinds.clear();
     }
 
@@ -11093,7 +11632,9 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, c
 
         stx.tx = MakeTransactionRef(tx);
         if (!wdb.WriteTxRecord(txhash, rtx) ||
-            !wdb.WriteStoredTx(txhash, stx)) {
+            !WriteStoredTx(&wdb, txhash, stx) ||
+            0 != UpdateCTOutputs(&wdb, txhash, rtx, stx) ||
+            0 != EraseSpentCTOutputs(&wdb, rtx)) {
             return false;
         }
     }
@@ -11121,6 +11662,15 @@ bool CHDWallet::AddToRecord(CTransactionRecord &rtxIn, const CTransaction &tx, c
 
 CWallet::ScanResult CHDWallet::ScanForWalletTransactions(const uint256& start_block, int start_height, std::optional<int> max_height, const WalletRescanReserver& reserver, bool fUpdate, const bool save_progress)
 {
+    {
+        // Blocks deep enough to hold archived records may update them
+        LOCK(cs_wallet);
+        const std::optional<int> tip_height = chain().getHeight();
+        if (!tip_height || start_height <= *tip_height - TX_RECORD_ARCHIVE_DEPTH) {
+            LoadArchivedTxRecords();
+        }
+    }
+
     CExtKeyAccount *sea = nullptr;
 
     if (!IsLocked()) {
@@ -12043,14 +12593,10 @@ void CHDWallet::AvailableAnonCoins(std::vector<COutputR> &vCoins, const CCoinCon
             }
 
             if (spend_frozen && !include_tainted_frozen) {
-                // TODO: Store pubkey on COutputRecord - in scriptPubKey
-                CStoredTransaction stx;
-                int64_t index;
-                if (!wdb.ReadStoredTx(txid, stx) ||
-                    !stx.tx->vpout[r.n]->IsType(OUTPUT_RINGCT) ||
-                    !chain().readRCTOutputLink(((CTxOutRingCT*)stx.tx->vpout[r.n].get())->pk, index) ||
-                    IsBlacklistedAnonOutput(index) ||
-                    (!IsWhitelistedAnonOutput(index, time_now, consensusParams) && r.nValue > consensusParams.m_max_tainted_value_out)) {
+                COwnedCTOutput cto;
+                if (!GetOwnedCTOutput(&wdb, COutPoint(txid, r.n), rtx, cto, true) ||
+                    IsBlacklistedAnonOutput(cto.anon_index) ||
+                    (!IsWhitelistedAnonOutput(cto.anon_index, time_now, consensusParams) && r.nValue > consensusParams.m_max_tainted_value_out)) {
                     continue;
                 }
             }
@@ -14,10 +14,17 @@
 #include <key_io.h>
 #include <key/extkey.h>
 #include <key/stealth.h>
+#include <util/lrucache.h>
 
 using namespace wallet;
 
 static const size_t DEFAULT_STEALTH_LOOKAHEAD_SIZE = 5;
+static const int DEFAULT_BLIND_THREADS = 0; // 0 = number of cores
+static const int DEFAULT_LOOKAHEAD_THREADS = 0; // 0 = number of cores
+static const size_t DEFAULT_STORED_TX_CACHE_SIZE = 1000;
+static const bool DEFAULT_LAZY_TX_RECORDS = false;
+//! Depth a record and the spends of its outputs must reach before it can be archived, well past the deepest reorg
+static const int TX_RECORD_ARCHIVE_DEPTH = 2048;
 
 //! -fallbackfee default
 static const CAmount DEFAULT_FALLBACK_FEE_PART = 20000;
@@ -92,6 +99,29 @@ public:
     bool GetVote(int nHeight, uint32_t &token);
 
     bool LoadTxRecords(CHDWalletDB *pwdb);
+    /** Load the archived records, must be called before reading the full wallet history */
+    bool LoadArchivedTxRecords() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Archive the records that can no longer affect the balance, they are not read at the next startup */
+    bool ArchiveSettledTxRecords(CHDWalletDB *pwdb) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    /**
+     * Read a stored transaction, recently read transactions are kept in memory.
+     * If pwdb is set the transaction is read through it, and isn't cached as pwdb may be in an open db txn.
+     */
+    bool GetStoredTx(const uint256 &txhash, CStoredTransaction &stx, CHDWalletDB *pwdb = nullptr) const;
+    /** Write a stored transaction and drop it from the cache */
+    bool WriteStoredTx(CHDWalletDB *pwdb, const uint256 &txhash, const CStoredTransaction &stx) const;
+    /** Must be called when a stored transaction is written or erased, and after a db txn writing it ends */
+    void UncacheStoredTx(const uint256 &txhash) const;
+
+    /** Load the owned CT/RingCT output table, entries for spent outputs are erased */
+    bool LoadCTOutputs(CHDWalletDB *pwdb) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Add spend data for the owned blind and anon outputs of rtx, written to pwdb if set */
+    int UpdateCTOutputs(CHDWalletDB *pwdb, const uint256 &txhash, const CTransactionRecord &rtx, const CStoredTransaction &stx) const;
+    /** Erase the entries of the outputs spent by rtx, refilled from the stored transaction if the spend is abandoned */
+    int EraseSpentCTOutputs(CHDWalletDB *pwdb, const CTransactionRecord &rtx) const;
+    /** Get spend data for an owned blind or anon output, falls back to the stored transaction if not in the table */
+    bool GetOwnedCTOutput(CHDWalletDB *pwdb, const COutPoint &op, const CTransactionRecord &rtx, COwnedCTOutput &cto, bool fNeedAnonIndex) const;
 
     bool IsLocked() const override;
     bool EncryptWallet(const SecureString &strWalletPassphrase) override;
@@ -192,6 +222,8 @@ public:
     int ExpandTempRecipients(std::vector<CTempRecipient> &vecSend, CStoredExtKey *pc, std::string &sError);
 
     int AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Add CT data to several outputs, range proofs for independent outputs are generated in parallel */
+    int AddCTData(const CCoinControl *coinControl, std::vector<std::pair<CTxOutBase*, CTempRecipient*> > &vOutputs, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     bool SetChangeDest(const CCoinControl *coinControl, CTempRecipient &r, std::string &sError) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
@@ -274,10 +306,14 @@ public:
     /** Load loose extkeys to memory */
     int ExtKeyLoadLoose();
     /** Update in-memory loose extkey */
-    int ExtKeyReload(const CStoredExtKey *sek) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
-    /** Prepare loose extkey lookahead
+    int ExtKeyReload(CHDWalletDB *pwdb, const CStoredExtKey *sek) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Prepare loose extkey lookahead, newly derived pubkeys are saved to pwdb
      *  fake const for IsMine */
-    int ExtKeyAddLookAhead(CStoredExtKey *sek) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    int ExtKeyAddLookAhead(CHDWalletDB *pwdb, CStoredExtKey *sek) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Load the saved derived pubkey cache of a chain, entries below nGenerated are erased */
+    int ExtKeyLoadDerivedPubKeys(CHDWalletDB *pwdb, CStoredExtKey *sek) const;
+    /** Save pubkeys added to the derived pubkey cache of a chain since the last save */
+    int ExtKeySaveDerivedPubKeys(CHDWalletDB *pwdb, CStoredExtKey *sek) const;
     /** Promote loose extkey lookahead key to saved key
      *  fake const for IsMine */
     int ExtKeyPromoteKey(CStoredExtKey *sek, uint32_t nChildKey) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
@@ -286,7 +322,7 @@ public:
     /** Activate account in memory
      *  add to mapExtAccounts and mapExtKeys
      */
-    int ExtKeyAddAccountToMaps(const CKeyID &idAccount, CExtKeyAccount *sea, bool fAddToLookAhead = true) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    int ExtKeyAddAccountToMaps(CHDWalletDB *pwdb, const CKeyID &idAccount, CExtKeyAccount *sea, bool fAddToLookAhead = true) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     int ExtKeyRemoveAccountFromMapsAndFree(CExtKeyAccount *sea) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     int ExtKeyRemoveAccountFromMapsAndFree(const CKeyID &idAccount) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     int ExtKeyLoadAccountPacks();
@@ -554,6 +590,21 @@ public:
     size_t prefer_max_num_anon_inputs = 5; // if > x anon inputs are randomly selected attempt to reduce
     int m_mixin_selection_mode_default = 1;
     secp256k1_scratch_space *m_blind_scratch = nullptr;
+    int m_blind_threads = 1; // Threads used to generate range proofs and MLSAGs
+    int m_lookahead_threads = 1; // Threads used to derive the lookahead pools
+
+    // Full transactions are paged in from the db on demand, only the records are loaded at startup
+    mutable Mutex cs_stored_tx_cache;
+    mutable util::LRUCache<uint256, CStoredTransaction> m_stored_tx_cache GUARDED_BY(cs_stored_tx_cache){DEFAULT_STORED_TX_CACHE_SIZE};
+    //! Incremented when an entry is dropped, a read that raced a write is not cached
+    mutable uint64_t m_stored_tx_cache_generation GUARDED_BY(cs_stored_tx_cache){0};
+
+    // With -lazytxrecords settled records are archived and only loaded on first access to the history
+    bool m_lazy_tx_records = DEFAULT_LAZY_TX_RECORDS;
+    bool m_archived_tx_records_loaded GUARDED_BY(cs_wallet) = false;
+
+    // Spend data for owned unspent blind and anon outputs, lets coin selection run without reading stored transactions
+    mutable std::map<COutPoint, COwnedCTOutput> mapCTOutputs GUARDED_BY(cs_wallet);
 
     int m_collapse_spent_mode = 0;
     int m_min_collapse_depth = 3;
@@ -578,6 +629,8 @@ public:
 private:
     void ParseAddressForMetaData(const CTxDestination &addr, COutputRecord &rec);
 
+    int AddCTData(const CCoinControl *coinControl, CTxOutBase *txout, CTempRecipient &r, secp256k1_scratch_space *scratch, std::string &sError) const;
+
     template<typename... Params>
     bool werror(std::string fmt, Params... parameters) const {
         return error(("%s " + fmt).c_str(), GetDisplayName(), parameters...);
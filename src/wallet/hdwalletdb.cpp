@@ -107,6 +107,17 @@ bool CHDWalletDB::WriteExtKeyPack(const CKeyID &identifier, const uint32_t nPack
 };
 
 
+bool CHDWalletDB::WriteExtKeyDerivedPubKey(const CKeyID &idChain, uint32_t nChild, const CPubKey &pk)
+{
+    return WriteIC(PackKey("edpk", idChain, nChild), pk, true);
+};
+
+bool CHDWalletDB::EraseExtKeyDerivedPubKey(const CKeyID &idChain, uint32_t nChild)
+{
+    return EraseIC(PackKey("edpk", idChain, nChild));
+};
+
+
 bool CHDWalletDB::ReadExtStealthKeyPack(const CKeyID &identifier, const uint32_t nPack, std::vector<CEKAStealthKeyPack> &aksPak, uint32_t nFlags)
 {
     return m_batch->Read(PackKey(DBKeys::PART_SXADDRKEYPACK, identifier, nPack), aksPak, nFlags);
@@ -230,6 +241,17 @@ bool CHDWalletDB::EraseTxRecord(const uint256 &hash)
     return EraseIC(std::make_pair(std::string("rtx"), hash));
 };
 
+bool CHDWalletDB::ArchiveTxRecord(const uint256 &hash, const CTransactionRecord &rtx)
+{
+    return WriteIC(std::make_pair(std::string("rtxa"), hash), rtx, true)
+        && EraseIC(std::make_pair(std::string("rtx"), hash));
+};
+
+bool CHDWalletDB::EraseArchivedTxRecord(const uint256 &hash)
+{
+    return EraseIC(std::make_pair(std::string("rtxa"), hash));
+};
+
 
 bool CHDWalletDB::ReadStoredTx(const uint256 &hash, CStoredTransaction &stx, uint32_t nFlags)
 {
@@ -281,6 +303,17 @@ bool CHDWalletDB::EraseLockedAnonOut(const COutPoint &op)
 };
 
 
+bool CHDWalletDB::WriteOwnedCTOutput(const COutPoint &op, const COwnedCTOutput &cto)
+{
+    return WriteIC(std::make_pair(std::string("cto"), op), cto, true);
+};
+
+bool CHDWalletDB::EraseOwnedCTOutput(const COutPoint &op)
+{
+    return EraseIC(std::make_pair(std::string("cto"), op));
+};
+
+
 bool CHDWalletDB::ReadWalletSetting(const std::string &setting, std::string &json, uint32_t nFlags)
 {
     return m_batch->Read(std::make_pair(DBKeys::PART_WALLETSETTING, setting), json, nFlags);
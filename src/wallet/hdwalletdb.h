@@ -44,11 +44,13 @@ prefixes
 
     ckey
     cscript
+    cto                 - owned CT/RingCT output spend data: COutPoint - COwnedCTOutput
 
     defaultkey
 
     eacc                - extended account
     ecpk                - extended account stealth child key pack
+    edpk                - extended key derived pubkey cache, key: chain id, child index, value: CPubKey
     ek32                - bip32 extended keypair
     eknm                - named extended key
     epak                - extended account key pack
@@ -170,6 +172,25 @@ public:
     }
 };
 
+class COwnedCTOutput
+{
+// Spend data for an owned blind or anon output, saves reading the CStoredTransaction
+// stored in walletdb, key is outpoint
+public:
+    uint256 blind;
+    CCmpPubKey pk;              // Set for anon outputs
+    int64_t anon_index = -1;    // Index in the anon output set, -1 if unknown
+    uint256 anon_index_block;   // anon_index is only valid while the output is in this block
+
+    SERIALIZE_METHODS(COwnedCTOutput, obj)
+    {
+        READWRITE(obj.blind);
+        READWRITE(obj.pk);
+        READWRITE(obj.anon_index);
+        READWRITE(obj.anon_index_block);
+    }
+};
+
 class CStealthAddressIndexed
 {
 public:
@@ -360,6 +381,9 @@ public:
     bool ReadExtKeyPack(const CKeyID &identifier, const uint32_t nPack, std::vector<CEKAKeyPack> &ekPak, uint32_t nFlags=DB_READ_UNCOMMITTED);
     bool WriteExtKeyPack(const CKeyID &identifier, const uint32_t nPack, const std::vector<CEKAKeyPack> &ekPak);
 
+    bool WriteExtKeyDerivedPubKey(const CKeyID &idChain, uint32_t nChild, const CPubKey &pk);
+    bool EraseExtKeyDerivedPubKey(const CKeyID &idChain, uint32_t nChild);
+
     bool ReadExtStealthKeyPack(const CKeyID &identifier, const uint32_t nPack, std::vector<CEKAStealthKeyPack> &aksPak, uint32_t nFlags=DB_READ_UNCOMMITTED);
     bool WriteExtStealthKeyPack(const CKeyID &identifier, const uint32_t nPack, const std::vector<CEKAStealthKeyPack> &aksPak);
 
@@ -396,6 +420,9 @@ public:
 
     bool WriteTxRecord(const uint256 &hash, const CTransactionRecord &rtx);
     bool EraseTxRecord(const uint256 &hash);
+    /** Move a record to the archived records, which are not read at startup */
+    bool ArchiveTxRecord(const uint256 &hash, const CTransactionRecord &rtx);
+    bool EraseArchivedTxRecord(const uint256 &hash);
 
 
     bool ReadStoredTx(const uint256 &hash, CStoredTransaction &stx, uint32_t nFlags=DB_READ_UNCOMMITTED);
@@ -411,6 +438,9 @@ public:
     bool WriteLockedAnonOut(const COutPoint &op);
     bool EraseLockedAnonOut(const COutPoint &op);
 
+    bool WriteOwnedCTOutput(const COutPoint &op, const COwnedCTOutput &cto);
+    bool EraseOwnedCTOutput(const COutPoint &op);
+
 
     bool ReadWalletSetting(const std::string &setting, std::string &json, uint32_t nFlags=DB_READ_UNCOMMITTED);
     bool WriteWalletSetting(const std::string &setting, const std::string &json);
@@ -459,6 +459,8 @@ public:
             result.emplace(MakeWalletTx(*m_wallet, entry.second));
         }
         if (m_wallet_part) {
+            LOCK_ASSERTION(m_wallet_part->cs_wallet);
+            m_wallet_part->LoadArchivedTxRecords();
             for (auto mi = m_wallet_part->mapRecords.begin(); mi != m_wallet_part->mapRecords.end(); mi++) {
                 result.emplace(MakeWalletTx(*m_wallet_part, mi));
             }
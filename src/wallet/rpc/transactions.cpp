@@ -96,6 +96,17 @@ static void AddSmsgFundingInfo(const CTransaction &tx, UniValue &entry)
     }
 }
 
+/** Page in the settled records left on disk by -lazytxrecords */
+static void LoadArchivedTxRecords(CWallet &wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    if (!IsGlobeWallet(&wallet)) {
+        return;
+    }
+    CHDWallet *phdw = GetGlobeWallet(&wallet);
+    LOCK_ASSERTION(phdw->cs_wallet);
+    phdw->LoadArchivedTxRecords();
+}
+
 static void ListRecord(const CHDWallet *phdw, const uint256 &hash, const CTransactionRecord &rtx,
     const std::string &strAccount, int nMinDepth, bool with_tx_details, UniValue &ret, const isminefilter &filter) EXCLUSIVE_LOCKS_REQUIRED(phdw->cs_wallet)
 {
@@ -288,7 +299,7 @@ void RecordTxToJSON(interfaces::Chain& chain, const CHDWallet *phdw, const uint2
     entry.pushKV("details", details);
 
     CStoredTransaction stx;
-    if (CHDWalletDB(phdw->GetDatabase()).ReadStoredTx(hash, stx)) { // TODO: cache / use mapTempWallet
+    if (phdw->GetStoredTx(hash, stx)) { // TODO: use mapTempWallet
         std::string strHex = EncodeHexTx(*(stx.tx.get()), RPCSerializationFlags());
         entry.pushKV("hex", strHex);
 
@@ -834,7 +845,7 @@ RPCHelpMan listtransactions()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(request);
+    const std::shared_ptr<CWallet> pwallet = GetWalletForJSONRPCRequest(request);
     if (!pwallet) return UniValue::VNULL;
 
     // Make sure the results are valid at least up to the most recent block
@@ -872,6 +883,7 @@ RPCHelpMan listtransactions()
     std::vector<UniValue> ret;
     {
         LOCK(pwallet->cs_wallet);
+        LoadArchivedTxRecords(*pwallet);
         const CWallet::TxItems &txOrdered = pwallet->wtxOrdered;
 
         // iterate backwards until we have nCount items to return:
@@ -995,7 +1007,7 @@ RPCHelpMan listsinceblock()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(request);
+    const std::shared_ptr<CWallet> pwallet = GetWalletForJSONRPCRequest(request);
     if (!pwallet) return UniValue::VNULL;
 
     const CWallet& wallet = *pwallet;
@@ -1004,6 +1016,7 @@ RPCHelpMan listsinceblock()
     wallet.BlockUntilSyncedToCurrentChain();
 
     LOCK(wallet.cs_wallet);
+    LoadArchivedTxRecords(*pwallet);
 
     std::optional<int> height;    // Height of the specified block or the common ancestor, if the block provided was in a deactivated chain.
     std::optional<int> altheight; // Height of the specified block, even if it's in a deactivated chain.
@@ -1180,7 +1193,7 @@ RPCHelpMan gettransaction()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(request);
+const std::shared_ptr<CWallet> pwallet = GetWalletForJSONRPCRequest(request);
     if (!pwallet) return UniValue::VNULL;
 
     // Make sure the results are valid at least up to the most recent block
@@ -1204,9 +1217,13 @@ const std::shared_ptr<const CWallet> pwallet = GetWalletForJSONRPCRequest(reques
     auto it = pwallet->mapWallet.find(hash);
     if (it == pwallet->mapWallet.end()) {
         if (IsGlobeWallet(pwallet.get())) {
-            const CHDWallet *phdw = GetGlobeWallet(pwallet.get());
+            CHDWallet *phdw = GetGlobeWallet(pwallet.get());
             LOCK_ASSERTION(phdw->cs_wallet);
             MapRecords_t::const_iterator mri = phdw->mapRecords.find(hash);
+            if (mri == phdw->mapRecords.end()) {
+                phdw->LoadArchivedTxRecords();
+                mri = phdw->mapRecords.find(hash);
+            }
 
             if (mri != phdw->mapRecords.end()) {
                 const CTransactionRecord &rtx = mri->second;
@@ -17,6 +17,7 @@
 #include <rpc/server_util.h>
 #include <rpc/blockchain.h>
 #include <node/context.h>
+#include <index/voteindex.h>
 #include <node/blockstorage.h>
 #include <node/miner.h>
 #include <rpc/rawtransaction_util.h>
@@ -41,6 +42,7 @@
 #include <key/mnemonic.h>
 #include <pos/miner.h>
 #include <pos/kernel.h>
+#include <pos/stakeweight.h>
 #include <crypto/sha256.h>
 #include <warnings.h>
 #include <shutdown.h>
@@ -48,6 +50,8 @@
 
 #include <univalue.h>
 
+#include <limits>
+
 namespace wallet {
 extern void WalletTxToJSON(const CWallet& wallet, const CWalletTx& wtx, UniValue& entry, bool fFilterMode=false);
 }
@@ -1569,7 +1573,7 @@ static RPCHelpMan extkey()
                     wdb.TxnAbort();
                     throw JSONRPCError(RPC_MISC_ERROR, "WriteExtKey failed.");
                 }
-                pwallet->ExtKeyReload(pSek);
+                pwallet->ExtKeyReload(&wdb, pSek);
             }
 
             if (fAccount) {
@@ -2949,6 +2953,7 @@ static RPCHelpMan clearwallettransactions()
 
     {
         LOCK(pwallet->cs_wallet);
+        pwallet->LoadArchivedTxRecords();
 
         pwallet->ClearCachedBalances(); // Clear stakeable coins cache
 
@@ -3002,26 +3007,29 @@ static RPCHelpMan clearwallettransactions()
         }
 
         if (fRemoveAll) {
-            fFlags = DB_SET_RANGE;
-            ssKey.clear();
-            ssKey << std::string("rtx");
-            while (wdb.ReadKeyAtCursor(pcursor, ssKey, fFlags) == 0) {
-                fFlags = DB_NEXT;
-
-                ssKey >> strType;
-                if (strType != "rtx")
-                    break;
-                ssKey >> hash;
+            // Live and archived records
+            for (const std::string prefix : {"rtx", "rtxa"}) {
+                fFlags = DB_SET_RANGE;
+                ssKey.clear();
+                ssKey << prefix;
+                while (wdb.ReadKeyAtCursor(pcursor, ssKey, fFlags) == 0) {
+                    fFlags = DB_NEXT;
+
+                    ssKey >> strType;
+                    if (strType != prefix)
+                        break;
+                    ssKey >> hash;
+
+                    pwallet->UnloadTransaction(hash); // ignore failure
+
+                    if ((rv = pcursor->del(0)) != 0) {
+                        throw JSONRPCError(RPC_MISC_ERROR, "pcursor->del failed.");
+                    }
 
-                pwallet->UnloadTransaction(hash); // ignore failure
+                    // TODO: Remove CStoredTransaction
 
-                if ((rv = pcursor->del(0)) != 0) {
-                    throw JSONRPCError(RPC_MISC_ERROR, "pcursor->del failed.");
+                    nRecordsRemoved++;
                 }
-
-                // TODO: Remove CStoredTransaction
-
-                nRecordsRemoved++;
             }
         }
 
@@ -3384,8 +3392,7 @@ static void ParseRecords(
     bool have_stx = false;
     CStoredTransaction stx;
     if (show_blinding_factors) {
-        CHDWalletDB wdb(pwallet->GetDatabase());
-        if (wdb.ReadStoredTx(hash, stx)) {
+        if (pwallet->GetStoredTx(hash, stx)) {
             have_stx = true;
         }
     }
@@ -3701,15 +3708,16 @@ static RPCHelpMan filtertransactions()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    std::shared_ptr<const CWallet> wallet = GetWalletForJSONRPCRequest(request);
+    std::shared_ptr<CWallet> const wallet = GetWalletForJSONRPCRequest(request);
     if (!wallet) return UniValue::VNULL;
-    const CHDWallet *pwallet = GetGlobeWallet(wallet.get());
+    CHDWallet *const pwallet = GetGlobeWallet(wallet.get());
 
     // Make sure the results are valid at least up to the most recent block
     // the user could have gotten from another RPC command prior to now
     pwallet->BlockUntilSyncedToCurrentChain();
 
     LOCK(pwallet->cs_wallet);
+    pwallet->LoadArchivedTxRecords();
 
     unsigned int count     = 10;
     int          skip      = 0;
@@ -4461,7 +4469,8 @@ static RPCHelpMan getstakinginfo()
 
     uint64_t nWeight = pwallet->GetStakeWeight();
 
-    uint64_t nNetworkWeight = GetPoSKernelPS(pblockindex);
+    // Tracked as the tip changes, only walk the chain if no tip was set yet
+    uint64_t nNetworkWeight = globe::g_network_stake_weight.Height() < 0 ? GetPoSKernelPS(pblockindex) : globe::g_network_stake_weight.Weight();
 
     bool fStaking = nWeight && fIsStaking;
     uint64_t nExpectedTime = fStaking ? (Params().GetTargetSpacing() * nNetworkWeight / nWeight) : 0;
@@ -4906,7 +4915,7 @@ static RPCHelpMan listunspentanon()
         if (show_pubkeys) {
             CStoredTransaction stx;
             CCmpPubKey anon_pubkey;
-            if (!wdb.ReadStoredTx(out.txhash, stx)) {
+            if (!pwallet->GetStoredTx(out.txhash, stx, &wdb)) {
                 entry.pushKV("error", "Missing stored txn.");
             } else
             if (!stx.GetAnonPubkey(out.i, anon_pubkey)) {
@@ -5862,7 +5871,7 @@ static UniValue createsignatureinner(const JSONRPCRequest &request, ChainstateMa
             } else {
                 txout = MAKE_OUTPUT<CTxOutCT>();
                 CTxOutCT *txoct = (CTxOutCT*)txout.get();
-                txoct->commitment = coin.commitment;
+                txoct->commitment = coin.GetCommitment();
                 txoct->scriptPubKey = coin.out.scriptPubKey;
             }
         } else {
@@ -6194,9 +6203,8 @@ static void traceFrozenPrevout(WalletContext& context, const COutPoint &op_trace
 
         {
         LOCK(pwallet->cs_wallet);
-        CHDWalletDB wdb(pwallet->GetDatabase());
         CStoredTransaction stx;
-        if (!wdb.ReadStoredTx(op_trace.hash, stx)) {
+        if (!pwallet->GetStoredTx(op_trace.hash, stx)) {
             warnings.push_back(strprintf("ReadStoredTx failed %s", op_trace.hash.ToString()));
             continue;
         }
@@ -6388,7 +6396,7 @@ static void traceFrozenOutputs(WalletContext& context, UniValue &rv, CAmount min
                 int64_t anon_index = -1;
                 if (r.nType == OUTPUT_RINGCT) {
                     CStoredTransaction stx;
-                    if (!wdb.ReadStoredTx(txid, stx) ||
+                    if (!pwallet->GetStoredTx(txid, stx, &wdb) ||
                         !stx.tx->vpout[r.n]->IsType(OUTPUT_RINGCT) ||
                         !pwallet->chain().readRCTOutputLink(((CTxOutRingCT*)stx.tx->vpout[r.n].get())->pk, anon_index)) {
                         warnings.push_back(strprintf("Failed to get anon index for %s.%d", txid.ToString(), r.n));
@@ -6459,7 +6467,7 @@ static void traceFrozenOutputs(WalletContext& context, UniValue &rv, CAmount min
             TracedTx &traced_tx = traced_txnsi->second;
 
             CStoredTransaction stx;
-            if (!wdb.ReadStoredTx(txid, stx)) {
+            if (!pwallet->GetStoredTx(txid, stx, &wdb)) {
                 warnings.push_back(strprintf("ReadStoredTx failed %s", txid.ToString()));
                 continue;
             }
@@ -6671,6 +6679,11 @@ static RPCHelpMan debugwallet()
     }
 
     EnsureWalletIsUnlocked(pwallet);
+    {
+        // Checks run over the full history
+        LOCK(pwallet->cs_wallet);
+        pwallet->LoadArchivedTxRecords();
+    }
 
     if (list_frozen_outputs || spend_frozen_output) {
         {
@@ -6708,7 +6721,7 @@ static RPCHelpMan debugwallet()
                 if (r.nType == OUTPUT_RINGCT) {
                     CStoredTransaction stx;
 
-                    if (!wdb.ReadStoredTx(txid, stx) ||
+                    if (!pwallet->GetStoredTx(txid, stx, &wdb) ||
                         !stx.tx->vpout[r.n]->IsType(OUTPUT_RINGCT) ||
                         !pwallet->chain().readRCTOutputLink(((CTxOutRingCT*)stx.tx->vpout[r.n].get())->pk, anon_index) ||
                         IsBlacklistedAnonOutput(anon_index) ||
@@ -6834,8 +6847,7 @@ static RPCHelpMan debugwallet()
     if (clear_stakes_seen) {
         LOCK(cs_main);
         globe::mapStakeConflict.clear();
-        globe::mapStakeSeen.clear();
-        globe::listStakeSeen.clear();
+        globe::g_stake_seen.Clear();
         return "Cleared stakes seen.";
     }
 
@@ -7025,7 +7037,7 @@ static RPCHelpMan debugwallet()
                     continue;
                 }
                 CStoredTransaction stx;
-                if (!wdb.ReadStoredTx(txhash, stx)) {
+                if (!pwallet->GetStoredTx(txhash, stx, &wdb)) {
                     add_error("Missing stored txn.", txhash);
                     continue;
                 }
@@ -7444,23 +7456,28 @@ static RPCHelpMan transactionblinds()
                 },
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
-    std::shared_ptr<const CWallet> wallet = GetWalletForJSONRPCRequest(request);
+    std::shared_ptr<CWallet> const wallet = GetWalletForJSONRPCRequest(request);
     if (!wallet) return UniValue::VNULL;
-    const CHDWallet *pwallet = GetGlobeWallet(wallet.get());
+    CHDWallet *const pwallet = GetGlobeWallet(wallet.get());
 
     EnsureWalletIsUnlocked(pwallet);
 
     uint256 hash;
     hash.SetHex(request.params[0].get_str());
 
+    LOCK(pwallet->cs_wallet);
     MapRecords_t::const_iterator mri = pwallet->mapRecords.find(hash);
+    if (mri == pwallet->mapRecords.end()) {
+        pwallet->LoadArchivedTxRecords();
+        mri = pwallet->mapRecords.find(hash);
+    }
     if (mri == pwallet->mapRecords.end()) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid or non-wallet transaction id");
     }
 
     UniValue result(UniValue::VOBJ);
     CStoredTransaction stx;
-    if (!CHDWalletDB(pwallet->GetDatabase()).ReadStoredTx(hash, stx)) {
+    if (!pwallet->GetStoredTx(hash, stx)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No stored data found for txn");
     }
 
@@ -7763,6 +7780,7 @@ static RPCHelpMan votehistory()
                             {RPCResult::Type::NUM, "from_height", "The starting chain height"},
                             {RPCResult::Type::NUM, "to_height", "The ending chain height"},
                             {RPCResult::Type::NUM, "added", "Time setting was added"},
+                            {RPCResult::Type::NUM, "chain_votes", /*optional=*/true, "Number of blocks up to the tip in the height range casting the same vote, by any staker (only with -voteindex)"},
                         }},
                     }
                 },
@@ -7794,6 +7812,13 @@ static RPCHelpMan votehistory()
     bool current_only = request.params.size() > 0 ? GetBool(request.params[0]) : false;
     bool include_future = request.params.size() > 1 ? GetBool(request.params[1]) : false;
 
+    // Blocks in the range of a vote setting that cast the same vote, counted from the vote index
+    const auto push_chain_votes = [&](UniValue& vote, uint32_t token, int from_height, int to_height) {
+        if (const std::optional<int> num_votes = pwallet->chain().countIndexedVotes(token, from_height, to_height)) {
+            vote.pushKV("chain_votes", *num_votes);
+        }
+    };
+
     UniValue result(UniValue::VARR);
 
     if (current_only) {
@@ -7837,6 +7862,7 @@ static RPCHelpMan votehistory()
             vote.pushKV("from_height", vote_start);
             vote.pushKV("to_height", vote_end);
             vote.pushKV("added", v.nTimeAdded);
+            push_chain_votes(vote, v.nToken, vote_start, vote_end);
 
             size_t k = 0;
             for (k = 0; k < result.size(); k++) {
@@ -7864,6 +7890,7 @@ static RPCHelpMan votehistory()
         vote.pushKV("from_height", v.nStart);
         vote.pushKV("to_height", v.nEnd);
         vote.pushKV("added", v.nTimeAdded);
+        push_chain_votes(vote, v.nToken, v.nStart, v.nEnd);
         result.push_back(vote);
     }
 
@@ -7908,51 +7935,54 @@ static RPCHelpMan tallyvotes()
     int nStartHeight = request.params[1].getInt<int>();
     int nEndHeight = request.params[2].getInt<int>();
 
-    CBlock block;
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-
     std::map<int, int> mapVotes;
-    std::pair<std::map<int, int>::iterator, bool> ri;
-
     int nBlocks = 0;
-    CBlockIndex *pindex = chainman.ActiveChain().Tip();
-    if (pindex)
-    do {
-        if (pindex->nHeight < nStartHeight) {
-            break;
+
+    // voteToken is 0 if the coinstake casts no vote
+    const auto count_vote = [&](uint32_t voteToken) {
+        int option = 0; // default to abstain
+
+        // count only if related to current issue:
+        if ((int) (voteToken & 0xFFFF) == issue) {
+            option = (voteToken >> 16) & 0xFFFF;
         }
-        if (pindex->nHeight <= nEndHeight) {
-            if (!node::ReadBlockFromDisk(block, pindex, consensusParams)) {
-                continue;
-            }
+        mapVotes[option]++;
+        nBlocks++;
+    };
 
-            if (block.vtx.size() < 1
-                || !block.vtx[0]->IsCoinStake()) {
-                continue;
+    if (!ForEachActiveChainVote(chainman, nStartHeight, nEndHeight, [&](int height, const VoteIndex::Entry& entry) {
+            if (entry.coinstake) {
+                count_vote(entry.vote_token);
             }
+        })) {
+        // No usable vote index, read the blocks from disk
+        mapVotes.clear();
+        nBlocks = 0;
+
+        CBlock block;
+        const Consensus::Params& consensusParams = Params().GetConsensus();
+        CBlockIndex *pindex = chainman.ActiveChain().Tip();
+        if (pindex)
+        do {
+            if (pindex->nHeight < nStartHeight) {
+                break;
+            }
+            if (pindex->nHeight <= nEndHeight) {
+                if (!node::ReadBlockFromDisk(block, pindex, consensusParams)) {
+                    continue;
+                }
 
-            std::vector<uint8_t> &vData = ((CTxOutData*)block.vtx[0]->vpout[0].get())->vData;
-            if (vData.size() < 9 || vData[4] != DO_VOTE) {
-                ri = mapVotes.insert(std::pair<int, int>(0, 1));
-                if (!ri.second) ri.first->second++;
-            } else {
-                uint32_t voteToken;
-                memcpy(&voteToken, &vData[5], 4);
-                voteToken = le32toh(voteToken);
-                int option = 0; // default to abstain
-
-                // count only if related to current issue:
-                if ((int) (voteToken & 0xFFFF) == issue) {
-                    option = (voteToken >> 16) & 0xFFFF;
+                if (block.vtx.size() < 1
+                    || !block.vtx[0]->IsCoinStake()) {
+                    continue;
                 }
 
-                ri = mapVotes.insert(std::pair<int, int>(option, 1));
-                if (!ri.second) ri.first->second++;
+                uint32_t voteToken = 0;
+                GetCoinStakeVoteToken(*block.vtx[0], voteToken);
+                count_vote(voteToken);
             }
-
-            nBlocks++;
-        }
-    } while ((pindex = pindex->pprev));
+        } while ((pindex = pindex->pprev));
+    }
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("proposal", issue);
@@ -7971,6 +8001,96 @@ static RPCHelpMan tallyvotes()
     };
 };
 
+static RPCHelpMan getproposalvotes()
+{
+    return RPCHelpMan{"getproposalvotes",
+                "\nSummarise the votes cast on a proposal, or on every proposal voted on in the height range.\n"
+                "Requires -voteindex.\n",
+                {
+                    {"proposal", RPCArg::Type::NUM, RPCArg::DefaultHint{"all proposals"}, "The proposal id, 0 for all proposals."},
+                    {"height_start", RPCArg::Type::NUM, RPCArg::Default{0}, "The chain starting height, including."},
+                    {"height_end", RPCArg::Type::NUM, RPCArg::DefaultHint{"the current best block"}, "The chain ending height, including."},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "", {
+                        {RPCResult::Type::OBJ, "", "", {
+                            {RPCResult::Type::NUM, "proposal", "The proposal id"},
+                            {RPCResult::Type::NUM, "votes", "Number of blocks voting on the proposal"},
+                            {RPCResult::Type::NUM, "first_height", "Height of the first block voting on the proposal"},
+                            {RPCResult::Type::NUM, "last_height", "Height of the last block voting on the proposal"},
+                            {RPCResult::Type::OBJ_DYN, "options", "", {
+                                {RPCResult::Type::NUM, "n", "The number of votes cast for option n"},
+                            }},
+                        }},
+                    }
+                },
+                RPCExamples{
+            HelpExampleCli("getproposalvotes", "1") +
+            HelpExampleCli("getproposalvotes", "0 2000 30000") +
+            "\nAs a JSON-RPC call\n"
+            + HelpExampleRpc("getproposalvotes", "1, 2000, 30000")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager &chainman = EnsureAnyChainman(request.context);
+
+    if (!g_vote_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -voteindex");
+    }
+
+    int issue = request.params[0].isNull() ? 0 : request.params[0].getInt<int>();
+    if (issue < 0 || issue >= (1 << 16)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Proposal out of range.");
+    }
+    int height_start = request.params[1].isNull() ? 0 : request.params[1].getInt<int>();
+    int height_end = request.params[2].isNull() ? std::numeric_limits<int>::max() : request.params[2].getInt<int>();
+
+    struct ProposalVotes {
+        int votes{0};
+        int first_height{0};
+        int last_height{0};
+        std::map<int, int> options;
+    };
+    std::map<int, ProposalVotes> proposals;
+
+    if (!ForEachActiveChainVote(chainman, height_start, height_end, [&](int height, const VoteIndex::Entry& entry) {
+            if (!entry.coinstake || !entry.vote_token) {
+                return;
+            }
+            int proposal = entry.vote_token & 0xFFFF;
+            if (issue != 0 && proposal != issue) {
+                return;
+            }
+            ProposalVotes& p = proposals[proposal];
+            if (p.votes++ == 0) {
+                p.first_height = height;
+            }
+            p.last_height = height;
+            p.options[(entry.vote_token >> 16) & 0xFFFF]++;
+        })) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read votes, voteindex is still syncing or not in step with the active chain.");
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const auto& p : proposals) {
+        UniValue options(UniValue::VOBJ);
+        for (const auto& o : p.second.options) {
+            options.pushKV(ToString(o.first), o.second);
+        }
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("proposal", p.first);
+        obj.pushKV("votes", p.second.votes);
+        obj.pushKV("first_height", p.second.first_height);
+        obj.pushKV("last_height", p.second.last_height);
+        obj.pushKV("options", options);
+        result.push_back(obj);
+    }
+
+    return result;
+},
+    };
+};
+
 static RPCHelpMan buildscript()
 {
 return RPCHelpMan{"buildscript",
@@ -9374,7 +9494,9 @@ static RPCHelpMan verifyrawtransaction()
                 }
                 std::vector<uint8_t> vchCommitment = ParseHex(s);
                 CHECK_NONFATAL(vchCommitment.size() == 33);
-                memcpy(newcoin.commitment.data, vchCommitment.data(), 33);
+                secp256k1_pedersen_commitment commitment;
+                memcpy(commitment.data, vchCommitment.data(), 33);
+                newcoin.SetCommitment(commitment);
                 newcoin.nType = OUTPUT_CT;
             } else {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "\"amount\" or \"amount_commitment\" is required");
@@ -9465,7 +9587,7 @@ static RPCHelpMan verifyrawtransaction()
         } else
         if (coin.nType == OUTPUT_CT) {
             vchAmount.resize(33);
-            memcpy(vchAmount.data(), coin.commitment.data, 33);
+            memcpy(vchAmount.data(), coin.GetCommitment().data, 33);
         } else {
             throw JSONRPCError(RPC_MISC_ERROR, strprintf("Bad input type: %d", coin.nType));
         }
@@ -9883,6 +10005,7 @@ void RegisterNonWalletRPCCommands(CRPCTable &t)
 {
     static const CRPCCommand commands[]{
         {"governance",         &tallyvotes},
+        {"governance",         &getproposalvotes},
         {"rawtransactions", &rewindrangeproof},
         {"rawtransactions", &generatematchingblindfactor},
         {"rawtransactions", &buildscript},
@@ -38,8 +38,7 @@ HDWalletTestingSetup::~HDWalletTestingSetup()
     pwalletMain->Finalise();
     pwalletMain.reset();
 
-    globe::mapStakeSeen.clear();
-    globe::listStakeSeen.clear();
+    globe::g_stake_seen.Clear();
 }
 
 void StakeNBlocks(CHDWallet *pwallet, size_t nBlocks)
@@ -33,6 +33,11 @@ bool CZMQAbstractNotifier::NotifyBlockDisconnect(const CBlockIndex * /*CBlockInd
     return true;
 }
 
+bool CZMQAbstractNotifier::NotifyBlockAnon(const CBlock &/*block*/, const CBlockIndex * /*CBlockIndex*/, bool /*connected*/)
+{
+    return true;
+}
+
 bool CZMQAbstractNotifier::NotifyTransactionAcceptance(const CTransaction &/*transaction*/, uint64_t mempool_sequence)
 {
     return true;
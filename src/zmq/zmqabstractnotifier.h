@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 
+class CBlock;
 class CBlockIndex;
 class CTransaction;
 namespace smsg {
@@ -59,6 +60,8 @@ public:
     virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t mempool_sequence);
     // Notifies of transactions added to mempool or appearing in blocks
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    // Notifies of every block connection or disconnection, with the block data
+    virtual bool NotifyBlockAnon(const CBlock &block, const CBlockIndex *pindex, bool connected);
 
     virtual bool NotifyTransaction(const std::string &sWalletName, const CTransaction &transaction);
     virtual bool NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash);
@@ -111,6 +111,8 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
 
     factories["pubhashwtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashWalletTransactionNotifier>;
     factories["pubsmsg"] = CZMQAbstractNotifier::Create<CZMQPublishSMSGNotifier>;
+    factories["pubrawanonout"] = CZMQAbstractNotifier::Create<CZMQPublishRawAnonOutputNotifier>;
+    factories["pubkeyimage"] = CZMQAbstractNotifier::Create<CZMQPublishKeyImageNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -272,8 +274,8 @@ void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBloc
     }
 
     // Next we notify BlockConnect listeners for *all* blocks
-    TryForEachAndRemoveFailed(notifiers, [pindexConnected](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlockConnect(pindexConnected);
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindexConnected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockConnect(pindexConnected) && notifier->NotifyBlockAnon(*pblock, pindexConnected, true);
     });
 }
 
@@ -287,8 +289,8 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
     }
 
     // Next we notify BlockDisconnect listeners for *all* blocks
-    TryForEachAndRemoveFailed(notifiers, [pindexDisconnected](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlockDisconnect(pindexDisconnected);
+    TryForEachAndRemoveFailed(notifiers, [&pblock, pindexDisconnected](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockDisconnect(pindexDisconnected) && notifier->NotifyBlockAnon(*pblock, pindexDisconnected, false);
     });
 }
 
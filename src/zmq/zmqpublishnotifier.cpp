@@ -8,6 +8,7 @@
 #include <chainparams.h>
 #include <netbase.h>
 #include <node/blockstorage.h>
+#include <primitives/block.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <util/system.h>
@@ -17,6 +18,7 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <iterator>
 #include <map>
 #include <optional>
 #include <string>
@@ -38,6 +40,8 @@ static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
 static const char *MSG_HASHWTX   = "hashwtx";
 static const char *MSG_SMSG      = "smsg";
+static const char *MSG_RAWANONOUT = "rawanonout";
+static const char *MSG_KEYIMAGE  = "keyimage";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -341,6 +345,106 @@ bool CZMQPublishHashWalletTransactionNotifier::NotifyTransaction(const std::stri
     return SendZmqMessage(MSG_HASHWTX, data, 32 + nName);
 }
 
+// Write the header shared by the per block anon topics:
+//    <32-byte block hash> | <4-byte LE height> | <1-byte label>
+static void WriteBlockAnonHeader(std::vector<uint8_t> &data, const CBlockIndex *pindex, bool connected)
+{
+    const uint256 hash = pindex->GetBlockHash();
+    data.resize(32 + 4 + 1);
+    for (unsigned int i = 0; i < 32; i++) {
+        data[31 - i] = hash.begin()[i];
+    }
+    WriteLE32(&data[32], pindex->nHeight);
+    data[36] = connected ? /* Block (C)onnect */ 'C' : /* Block (D)isconnect */ 'D';
+}
+
+static void AppendHash(std::vector<uint8_t> &data, const uint256 &hash)
+{
+    data.insert(data.end(), std::make_reverse_iterator(hash.end()), std::make_reverse_iterator(hash.begin()));
+}
+
+static void AppendLE(std::vector<uint8_t> &data, const uint8_t *buf, size_t size)
+{
+    data.insert(data.end(), buf, buf + size);
+}
+
+bool CZMQPublishRawAnonOutputNotifier::NotifyBlockAnon(const CBlock &block, const CBlockIndex *pindex, bool connected)
+{
+    size_t num_anon_outputs = 0;
+    for (const auto &tx : block.vtx) {
+        for (const auto &txout : tx->vpout) {
+            if (txout->IsType(OUTPUT_RINGCT)) {
+                num_anon_outputs++;
+            }
+        }
+    }
+    if (num_anon_outputs == 0) {
+        return true;
+    }
+    LogPrint(BCLog::ZMQ, "Publish rawanonout %s, %d outputs to %s\n", pindex->GetBlockHash().GetHex(), num_anon_outputs, this->address);
+
+    // Indices are assigned in block order by ConnectBlock, the last one is stored in the block index
+    int64_t anon_index = pindex->nAnonOutputs - (int64_t)num_anon_outputs + 1;
+
+    // Header followed by a record per output:
+    //    <8-byte LE anon index> | <33-byte pubkey> | <33-byte commitment> | <32-byte txid> | <4-byte LE output n>
+    std::vector<uint8_t> data;
+    WriteBlockAnonHeader(data, pindex, connected);
+    data.reserve(data.size() + num_anon_outputs * (8 + 33 + 33 + 32 + 4));
+    uint8_t buf[8];
+    for (const auto &tx : block.vtx) {
+        for (size_t k = 0; k < tx->vpout.size(); ++k) {
+            if (!tx->vpout[k]->IsType(OUTPUT_RINGCT)) {
+                continue;
+            }
+            const CTxOutRingCT *txout = (const CTxOutRingCT*)tx->vpout[k].get();
+            WriteLE64(buf, anon_index++);
+            AppendLE(data, buf, 8);
+            data.insert(data.end(), txout->pk.begin(), txout->pk.begin() + 33);
+            data.insert(data.end(), txout->commitment.data, txout->commitment.data + 33);
+            AppendHash(data, tx->GetHash());
+            WriteLE32(buf, k);
+            AppendLE(data, buf, 4);
+        }
+    }
+    return SendZmqMessage(MSG_RAWANONOUT, data.data(), data.size());
+}
+
+bool CZMQPublishKeyImageNotifier::NotifyBlockAnon(const CBlock &block, const CBlockIndex *pindex, bool connected)
+{
+    // Header followed by a record per spent key image:
+    //    <33-byte key image> | <32-byte txid> | <4-byte LE input n>
+    std::vector<uint8_t> data;
+    WriteBlockAnonHeader(data, pindex, connected);
+    const size_t header_size = data.size();
+    uint8_t buf[4];
+    for (const auto &tx : block.vtx) {
+        for (size_t k = 0; k < tx->vin.size(); ++k) {
+            const CTxIn &txin = tx->vin[k];
+            if (!txin.IsAnonInput()) {
+                continue;
+            }
+            uint32_t nInputs, nRingSize;
+            txin.GetAnonInfo(nInputs, nRingSize);
+            if (txin.scriptData.stack.size() != 1 || txin.scriptData.stack[0].size() != nInputs * 33) {
+                continue;
+            }
+            const std::vector<uint8_t> &vKeyImages = txin.scriptData.stack[0];
+            for (size_t i = 0; i < nInputs; ++i) {
+                data.insert(data.end(), vKeyImages.begin() + i * 33, vKeyImages.begin() + (i + 1) * 33);
+                AppendHash(data, tx->GetHash());
+                WriteLE32(buf, k);
+                AppendLE(data, buf, 4);
+            }
+        }
+    }
+    if (data.size() == header_size) {
+        return true;
+    }
+    LogPrint(BCLog::ZMQ, "Publish keyimage %s, %d key images to %s\n", pindex->GetBlockHash().GetHex(), (data.size() - header_size) / (33 + 32 + 4), this->address);
+    return SendZmqMessage(MSG_KEYIMAGE, data.data(), data.size());
+}
+
 bool CZMQPublishSMSGNotifier::NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish smsg %s\n", hash.GetHex());
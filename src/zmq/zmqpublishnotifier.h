@@ -76,4 +76,16 @@ public:
     bool NotifySecureMessage(const smsg::SecureMessage *psmsg, const uint160 &hash) override;
 };
 
+class CZMQPublishRawAnonOutputNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlockAnon(const CBlock &block, const CBlockIndex *pindex, bool connected) override;
+};
+
+class CZMQPublishKeyImageNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlockAnon(const CBlock &block, const CBlockIndex *pindex, bool connected) override;
+};
+
 #endif // GLOBE_ZMQ_ZMQPUBLISHNOTIFIER_H
@@ -8,6 +8,11 @@
 # Test addressindex generation and fetching
 #
 
+import http.client
+import json
+import struct
+import urllib.parse
+
 from test_framework.test_globe import GlobeTestFramework, bytes_to_wif
 from test_framework.util import assert_equal
 from test_framework.script import taproot_construct
@@ -21,8 +26,8 @@ class AddressIndexTest(GlobeTestFramework):
         self.num_nodes = 4
         self.extra_args = [
             # Nodes 0/1 are "wallet" nodes
-            ['-debug',],
-            ['-debug', '-addressindex'],
+            ['-debug', '-rest'],
+            ['-debug', '-addressindex', '-rest'],
             # Nodes 2/3 are used for testing
             ['-debug', '-addressindex', '-dbcompression'],
             ['-debug', '-addressindex', '-dbcompression'],]
@@ -310,6 +315,89 @@ class AddressIndexTest(GlobeTestFramework):
         assert (len(utxos_with_info['utxos']) == 2)
         assert (utxos_with_info['utxos'][0]['height'] == 9)
 
+        self.log.info("Testing REST interface...")
+
+        def rest_get(node, path):
+            url = urllib.parse.urlparse(node.url)
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.request('GET', path)
+            resp = conn.getresponse()
+            return resp.status, resp.read()
+
+        utxos = nodes[1].getaddressutxos({"addresses": [address2]})
+        status, body = rest_get(nodes[1], '/rest/address/utxos/{}.json'.format(address2))
+        assert_equal(status, 200)
+        rest_utxos = json.loads(body)
+        assert_equal(len(rest_utxos), len(utxos))
+        utxo_key = lambda u: (u['txid'], u['outputIndex'])
+        assert_equal(sorted(rest_utxos, key=utxo_key), sorted(utxos, key=utxo_key))
+
+        status, body_bin = rest_get(nodes[1], '/rest/address/utxos/{}.bin'.format(address2))
+        assert_equal(status, 200)
+        bin_utxos = []
+        data = body_bin
+        while data:
+            # type, address hash, txid, output index, then amount, script and height
+            script_len = data[77]
+            bin_utxos.append({
+                'txid': data[33:65][::-1].hex(),
+                'outputIndex': struct.unpack('<I', data[65:69])[0],
+                'satoshis': struct.unpack('<q', data[69:77])[0],
+                'script': data[78:78 + script_len].hex(),
+                'height': struct.unpack('<i', data[78 + script_len:82 + script_len])[0],
+            })
+            data = data[82 + script_len:]
+        assert_equal(bin_utxos, [{k: u[k] for k in ('txid', 'outputIndex', 'satoshis', 'script', 'height')} for u in rest_utxos])
+
+        status, body = rest_get(nodes[1], '/rest/address/utxos/{}.hex'.format(address2))
+        assert_equal(status, 200)
+        assert_equal(bytes.fromhex(body.decode().strip()), body_bin)
+
+        deltas = nodes[1].getaddressdeltas({"addresses": [address2]})
+        status, body = rest_get(nodes[1], '/rest/address/deltas/{}.json'.format(address2))
+        assert_equal(status, 200)
+        rest_deltas = json.loads(body)
+        delta_key = lambda d: (d['height'], d['blockindex'], d['txid'], d['index'], d['satoshis'])
+        assert_equal(sorted(rest_deltas, key=delta_key), sorted(deltas, key=delta_key))
+
+        status, body_bin = rest_get(nodes[1], '/rest/address/deltas/{}.bin'.format(address2))
+        assert_equal(status, 200)
+        # type, address hash, height, block index, txid, index, spending, then amount
+        assert_equal(len(body_bin), 86 * len(rest_deltas))
+        bin_deltas = []
+        for i in range(0, len(body_bin), 86):
+            record = body_bin[i:i + 86]
+            bin_deltas.append({
+                'height': struct.unpack('>i', record[33:37])[0],
+                'blockindex': struct.unpack('>I', record[37:41])[0],
+                'txid': record[41:73][::-1].hex(),
+                'index': struct.unpack('<I', record[73:77])[0],
+                'satoshis': struct.unpack('<q', record[78:86])[0],
+            })
+        assert_equal(bin_deltas, [{k: d[k] for k in ('height', 'blockindex', 'txid', 'index', 'satoshis')} for d in rest_deltas])
+
+        status, body = rest_get(nodes[1], '/rest/address/deltas/{}.hex'.format(address2))
+        assert_equal(status, 200)
+        assert_equal(bytes.fromhex(body.decode().strip()), body_bin)
+
+        status, body = rest_get(nodes[1], '/rest/address/deltas/{}.json?start=3&end=3'.format(address2))
+        assert_equal(status, 200)
+        assert_equal(len(json.loads(body)), len(nodes[1].getaddressdeltas({"addresses": [address2], "start": 3, "end": 3})))
+
+        status, body = rest_get(nodes[1], '/rest/address/deltas/{}.json?start=3'.format(address2))
+        assert_equal(status, 400)
+        assert body.decode().startswith('Invalid range')
+
+        for endpoint in ('utxos', 'deltas'):
+            for fmt in ('json', 'bin', 'hex'):
+                status, body = rest_get(nodes[1], '/rest/address/{}/notanaddress.{}'.format(endpoint, fmt))
+                assert_equal(status, 400)
+                assert body.decode().startswith('Invalid address')
+
+                status, body = rest_get(nodes[0], '/rest/address/{}/{}.{}'.format(endpoint, address2, fmt))
+                assert_equal(status, 404)
+                assert body.decode().startswith('Address index is not enabled')
+
         # 256bit addresses
         self.log.info("Testing 256bit addresses...")
 
@@ -4,6 +4,7 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 from test_framework.test_globe import GlobeTestFramework
+from test_framework.util import assert_equal
 
 
 class BalancesIndexTest(GlobeTestFramework):
@@ -12,7 +13,7 @@ class BalancesIndexTest(GlobeTestFramework):
         self.num_nodes = 3
         self.extra_args = [
             ['-debug', ],
-            ['-debug', '-balancesindex', '-dbcompression'],
+            ['-debug', '-balancesindex', '-dbcompression', '-coinstatsindex'],
             ['-debug', '-balancesindex', '-dbcompression'], ]
 
     def skip_test_if_missing_module(self):
@@ -67,6 +68,31 @@ class BalancesIndexTest(GlobeTestFramework):
         txoutsetinfo = nodes[1].gettxoutsetinfo()
         assert (blockbalances['plain'] == txoutsetinfo['total_amount'])
 
+        self.log.info('Check the coinstatsindex supply matches the balances index')
+        for height in range(3):
+            blockbalances = nodes[1].getblockbalances(nodes[0].getblockhash(height))
+            supply = nodes[1].gettxoutsetinfo('none', height)['supply']
+            assert_equal(supply['plain'], blockbalances['plain'])
+            assert_equal(supply['blind'], blockbalances['blind'])
+            assert_equal(supply['anon'], blockbalances['anon'])
+            assert_equal(supply['moneysupply'], nodes[1].getblockheader(nodes[0].getblockhash(height))['moneysupply'])
+
+        self.log.info('Check the block subsidy is taken from the money supply')
+        for height in range(3):
+            txoutsetinfo = nodes[1].gettxoutsetinfo('none', height)
+            assert_equal(txoutsetinfo['total_unspendable_amount'], 0)
+            assert_equal(txoutsetinfo['block_info']['unspendable'], 0)
+            assert_equal(txoutsetinfo['block_info']['unspendables']['unclaimed_rewards'], 0)
+
+        txoutsetinfo = nodes[1].gettxoutsetinfo('muhash')
+        txoutsetinfo_scan = nodes[1].gettxoutsetinfo('muhash', use_index=False)
+        assert_equal(txoutsetinfo['muhash'], txoutsetinfo_scan['muhash'])
+        assert_equal(txoutsetinfo['txouts'], txoutsetinfo_scan['txouts'])
+        assert_equal(txoutsetinfo['txouts_blinded'], txoutsetinfo_scan['txouts_blinded'])
+        assert_equal(txoutsetinfo['total_amount'], txoutsetinfo_scan['total_amount'])
+        assert_equal(nodes[1].gettxoutsetinfo('none', 0)['txouts_anon'], 0)
+        assert (txoutsetinfo['txouts_anon'] > 0)
+
 
 if __name__ == '__main__':
     BalancesIndexTest().main()
@@ -3,7 +3,6 @@
 # Distributed under the MIT software license, see the accompanying
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-import re
 import json
 
 from test_framework.test_globe import GlobeTestFramework
@@ -17,7 +16,7 @@ class TxIndexTest(GlobeTestFramework):
         self.extra_args = [
             ['-debug', ],
             ['-debug', '-txindex', '-csindex', '-dbcompression'],
-            ['-debug', '-txindex', '-csindex', '-dbcompression'], ]
+            ['-debug', '-csindex', '-dbcompression'], ]
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -45,6 +44,9 @@ class TxIndexTest(GlobeTestFramework):
         r = nodes[1].getinsightinfo()
         assert (r['txindex'] is True)
         assert (r['coldstakeindex'] is True)
+        r = nodes[2].getinsightinfo()
+        assert (r['txindex'] is False)
+        assert (r['coldstakeindex'] is True)
 
         addrStake = nodes[2].getnewaddress('addrStake')
         addrSpend = nodes[2].getnewaddress('addrSpend', 'false', 'false', 'true')
@@ -89,7 +91,7 @@ class TxIndexTest(GlobeTestFramework):
             ro = nodes[0].listcoldstakeunspent(addrStake)
             assert (False), 'listcoldstakeunspent without -csindex.'
         except JSONRPCException as e:
-            assert (re.search('Requires -(?:cs|tx)index enabled', e.error['message']))
+            assert ('Requires -csindex enabled' in e.error['message'])
 
         self.stakeBlocks(1)
         ro = nodes[2].listcoldstakeunspent(addrStake)
@@ -137,6 +139,10 @@ class TxIndexTest(GlobeTestFramework):
         ro = nodes[1].listcoldstakeunspent(addrStake)
         assert (len(ro) == 3)
 
+        # Outputs spent after height are returned from the spent set
+        ro = nodes[2].listcoldstakeunspent(addrStake, 3, {'show_outpoints': True})
+        assert (json.dumps(nodes[1].listcoldstakeunspent(addrStake, 3, {'show_outpoints': True})) == json.dumps(ro))
+
         self.restart_node(1, extra_args=self.extra_args[1] + ['-wallet=default_wallet',])
 
         ro = nodes[1].listcoldstakeunspent(addrStake)
@@ -7,6 +7,10 @@
 # Test addressindex generation and fetching
 #
 
+import http.client
+import json
+import urllib.parse
+
 from test_framework.test_globe import GlobeTestFramework
 from test_framework.util import assert_equal
 
@@ -21,7 +25,7 @@ class SpentIndexTest(GlobeTestFramework):
             ['-debug','-spentindex'],
             # Nodes 2/3 are used for testing
             ['-debug','-spentindex', '-dbcompression'],
-            ['-debug','-spentindex', '-txindex', '-dbcompression'],]
+            ['-debug','-spentindex', '-txindex', '-dbcompression', '-rest'],]
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -144,6 +148,26 @@ class SpentIndexTest(GlobeTestFramework):
                 break
         assert (fFound)
 
+        print("Testing REST interface...")
+
+        url = urllib.parse.urlparse(nodes[3].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+
+        conn.request('GET', '/rest/spentinfo/{}-{}.json'.format(unspent[0]['txid'], unspent[0]['vout']))
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        assert_equal(json.loads(resp.read()), info)
+
+        conn.request('GET', '/rest/blockdeltas/{}.json'.format(block1_hash))
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        assert_equal(json.loads(resp.read())['deltas'], block['deltas'])
+
+        conn.request('GET', '/rest/blockdeltas/{}.bin'.format(block1_hash))
+        resp = conn.getresponse()
+        assert_equal(resp.status, 200)
+        assert_equal(resp.read()[:32][::-1].hex(), block1_hash)
+
         print("Passed\n")
 
 
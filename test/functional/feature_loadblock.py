@@ -8,9 +8,13 @@ Test the option to start a node with the option loadblock which loads
 a serialized blockchain from a file (usually called bootstrap.dat).
 To generate that file this test uses the helper scripts available
 in contrib/linearize.
+
+Also test that the blocks following an invalid block in the file are not
+accepted when the file is imported with -loadblockthreads.
 """
 
 import os
+import struct
 import subprocess
 import sys
 import tempfile
@@ -18,17 +22,21 @@ import urllib
 
 from test_framework.blocktools import COINBASE_MATURITY
 from test_framework.test_framework import GlobeTestFramework
-from test_framework.util import assert_equal
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
 
 
 class LoadblockTest(GlobeTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
-        self.num_nodes = 2
+        self.num_nodes = 3
         self.supports_cli = False
 
     def run_test(self):
         self.nodes[1].setnetworkactive(state=False)
+        self.nodes[2].setnetworkactive(state=False)
         self.generate(self.nodes[0], COINBASE_MATURITY, sync_fun=self.no_op)
 
         # Parsing the url of our node to get settings for config file
@@ -79,6 +87,24 @@ class LoadblockTest(GlobeTestFramework):
         assert_equal(self.nodes[1].getblockchaininfo()['blocks'], 100)
         assert_equal(self.nodes[0].getbestblockhash(), self.nodes[1].getbestblockhash())
 
+        self.log.info("Import a file with an invalid block using the threaded import")
+        bad_height = 50
+        bad_file = os.path.join(self.options.tmpdir, "bootstrap_bad.dat")
+        with open(bad_file, "wb") as f:
+            for height in range(1, 101):
+                block = bytearray.fromhex(self.nodes[0].getblock(self.nodes[0].getblockhash(height), 0))
+                if height == bad_height:
+                    # Flip a byte of the merkle root
+                    block[36] ^= 0xff
+                f.write(bytes.fromhex("0912060c"))
+                f.write(struct.pack("<I", len(block)))
+                f.write(block)
+        self.restart_node(2, extra_args=[f"-loadblock={bad_file}", "-loadblockthreads=2"])
+        assert_equal(self.nodes[2].getblockcount(), bad_height - 1)
+        assert_equal(self.nodes[2].getbestblockhash(), self.nodes[0].getblockhash(bad_height - 1))
+        for height in (bad_height, bad_height + 1, 100):
+            assert_raises_rpc_error(-5, "Block not found", self.nodes[2].getblockheader, self.nodes[0].getblockhash(height))
+
 
 if __name__ == '__main__':
     LoadblockTest().main()
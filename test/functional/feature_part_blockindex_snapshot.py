@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test loading the block index from a snapshot with -blockindexsnapshot."""
+
+import os
+
+from test_framework.test_globe import GlobeTestFramework
+from test_framework.util import assert_equal
+
+
+class BlockIndexSnapshotTest(GlobeTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [
+            ['-debug', ],
+            ['-debug', '-blockindexsnapshot'], ]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+        self.sync_all()
+
+    def kill_node(self, i):
+        # Stop without a clean shutdown, the snapshot is not rewritten
+        node = self.nodes[i]
+        node.process.kill()
+        node.process.wait()
+        node.running = False
+        node.process = None
+        node.rpc_connected = False
+        node.rpc = None
+
+    def restart_synced(self, i, extra_args, expected_msgs):
+        with self.nodes[i].assert_debug_log(expected_msgs):
+            self.start_node(i, extra_args=extra_args)
+        self.connect_nodes_bi(0, i)
+        self.sync_all()
+        assert_equal(self.nodes[i].getbestblockhash(), self.nodes[0].getbestblockhash())
+
+    def run_test(self):
+        nodes = self.nodes
+        snapshot_path = os.path.join(nodes[1].chain_path, 'blocks', 'index_snapshot.dat')
+
+        for i in range(len(nodes)):
+            nodes[i].reservebalance(True, 10000000)  # Stop staking
+
+        self.import_genesis_coins_a(nodes[0])
+        self.stakeBlocks(3)
+
+        self.log.info('Snapshot is written at shutdown and loaded at startup')
+        assert not os.path.exists(snapshot_path)
+        self.stop_node(1)
+        assert os.path.exists(snapshot_path)
+        self.restart_synced(1, self.extra_args[1], ['block index entries from snapshot'])
+
+        self.log.info('Entries written since the snapshot are read from the database')
+        self.stakeBlocks(2)
+        nodes[1].gettxoutsetinfo()  # Flush the block index
+        self.kill_node(1)
+        self.restart_synced(1, self.extra_args[1], ['block index entries from snapshot', 'block index entries written since the snapshot'])
+        assert_equal(nodes[1].getblockcount(), 5)
+
+        self.log.info('Snapshot is not used after running without -blockindexsnapshot')
+        self.stop_node(1)
+        # The snapshot record is erased, blocks connected from now on are not journaled
+        self.restart_synced(1, ['-debug', ], [])
+        self.stakeBlocks(1)
+        self.stop_node(1)
+        assert os.path.exists(snapshot_path)
+        with nodes[1].assert_debug_log(['No block index snapshot recorded'], unexpected_msgs=['block index entries from snapshot']):
+            self.start_node(1, extra_args=self.extra_args[1])
+        assert_equal(nodes[1].getblockcount(), 6)
+
+        self.log.info('A new snapshot is written at the next shutdown')
+        with nodes[1].assert_debug_log(['block index entries to snapshot']):
+            self.stop_node(1)
+        self.restart_synced(1, self.extra_args[1], ['block index entries from snapshot'])
+        assert_equal(nodes[1].getblockcount(), 6)
+
+
+if __name__ == '__main__':
+    BlockIndexSnapshotTest().main()
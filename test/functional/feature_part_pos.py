@@ -84,7 +84,11 @@ class PosTest(GlobeTestFramework):
         assert (ro[0]['amount'] == 10)
         assert (ro[0]['category'] == 'receive')
 
+        # At the tip the estimate is tracked, below it the chain is walked
         pos_difficulty1 = nodes[0].getposdifficulty()
+        tracked = nodes[0].getnetstakeweight()
+        assert (tracked['height'] == pos_difficulty1['height'])
+        assert (tracked['netstakeweight'] == pos_difficulty1['netstakeweight'])
         self.stakeBlocks(1)
         pos_difficulty = nodes[0].getposdifficulty(1)
         assert (pos_difficulty == pos_difficulty1)
@@ -240,6 +244,20 @@ class PosTest(GlobeTestFramework):
         assert (cs_info['pending_depth'] > 0.0)
         assert (cs_info['coin_in_stakeable_script'] == cs_info['currently_staking'] + cs_info['pending_depth'])
 
+        self.log.info('Test that the stakes checked ahead of time are used when reindexing')
+        self.sync_all()
+        height = nodes[1].getblockcount()
+        num_prechecked = min(height, 32)  # The first window ends at the first step of ActivateBestChain
+        expect_msgs = [
+            '{} of {} stakes passed, blocks 1 to {}'.format(num_prechecked, num_prechecked, num_prechecked),
+            'Using the precheck of coinstake',
+            'Using cached block',  # The blocks read for the prechecks are connected without reading them again
+        ]
+        with nodes[1].assert_debug_log(expect_msgs, timeout=60):
+            self.restart_node(1, self.extra_args[1] + ['-wallet=default_wallet', '-reindex', '-stakeprecheckthreads=2'])
+        self.wait_until(lambda: nodes[1].getblockcount() == height)
+        assert (nodes[1].getbestblockhash() == nodes[0].getbestblockhash())
+
 
 if __name__ == '__main__':
     PosTest().main()
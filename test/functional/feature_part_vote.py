@@ -11,6 +11,7 @@ class VoteTest(GlobeTestFramework):
         self.setup_clean_chain = True
         self.num_nodes = 3
         self.extra_args = [ ['-debug','-noacceptnonstdtxn','-reservebalance=10000000'] for i in range(self.num_nodes)]
+        self.extra_args[1].append('-voteindex')
 
     def skip_test_if_missing_module(self):
         self.skip_if_no_wallet()
@@ -59,6 +60,27 @@ class VoteTest(GlobeTestFramework):
         assert (ro['blocks_counted'] == 2)
         assert (ro['Option 3'] == '1, 50.00%')
 
+        self.sync_all()
+        # Node 1 counts from the vote index
+        assert (nodes[1].tallyvotes(1, 0, 10) == ro)
+        ro = nodes[1].getproposalvotes(1)
+        assert (len(ro) == 1)
+        assert (ro[0]['votes'] == 2)
+        assert (ro[0]['first_height'] == 1)
+        assert (ro[0]['last_height'] == 2)
+        assert (ro[0]['options'] == {'2': 1, '3': 1})
+        assert (len(nodes[1].getproposalvotes(0, 2, 2)) == 1)
+        assert (len(nodes[1].getproposalvotes(2)) == 0)
+
+        # votehistory counts the blocks casting the same vote from the vote index
+        assert ('chain_votes' not in nodes[0].votehistory()[0])
+        nodes[1].setvote(1, 3, 0, 10)
+        ro = nodes[1].votehistory()
+        assert (len(ro) == 1)
+        assert (ro[0]['chain_votes'] == 1)
+        ro = nodes[1].votehistory(True)
+        assert (ro[0]['chain_votes'] == 1)
+
         nodes[0].setvote(0, 0, 0, 0)
         assert (len(nodes[0].votehistory()) == 0)
 
@@ -49,6 +49,8 @@ class ZMQTest(GlobeTestFramework):
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"rawtx")
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashwtx")
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"smsg")
+        self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"rawanonout")
+        self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"keyimage")
 
         public_key, secret_key = self.zmq.curve_keypair()
         self.zmqSubSocket.setsockopt(zmq.CURVE_PUBLICKEY, public_key)
@@ -65,6 +67,7 @@ class ZMQTest(GlobeTestFramework):
                         '-zmqpubhashblock=%s' % ip_address, '-zmqpubhashtx=%s' % ip_address,
                         '-zmqpubrawblock=%s' % ip_address, '-zmqpubrawtx=%s' % ip_address,
                         '-zmqpubsmsg=%s' % ip_address,
+                        '-zmqpubrawanonout=%s' % ip_address, '-zmqpubkeyimage=%s' % ip_address,
                         '-zmqpubhashwtx=%s' % ip_address],
                        []]
         self.add_nodes(self.num_nodes, self.extra_args)
@@ -94,6 +97,24 @@ class ZMQTest(GlobeTestFramework):
                 return True
         return False
 
+    def waitForZmqBlockAnon(self, topic, record_size, txid_offset, txid):
+        # Returns the block hash, height and label of the message with a record from txid
+        for count in range(0, 200):
+            try:
+                msg = self.zmqSubSocket.recv_multipart(self.zmq.NOBLOCK)
+            except self.zmq.ZMQError:
+                time.sleep(0.25)
+                continue
+
+            if msg[0].decode('utf-8') != topic:
+                continue
+            body = msg[1]
+            assert ((len(body) - 37) % record_size == 0)
+            for i in range(37, len(body), record_size):
+                if body[i + txid_offset:i + txid_offset + 32].hex() == txid:
+                    return body[0:32].hex(), struct.unpack('<I', body[32:36])[0], chr(body[36])
+        return None
+
     def _zmq_test(self):
         nodes = self.nodes
 
@@ -202,6 +223,28 @@ class ZMQTest(GlobeTestFramework):
         ro = nodes[0].smsgzmqpush({"timefrom": int(time.time()) + 1})
         assert (ro['numsent'] == 0)
 
+        self.log.info('Test rawanonout and keyimage')
+        sx_addr1 = nodes[1].getnewstealthaddress()
+        txids = [nodes[1].sendtypeto('part', 'anon', [{'address': sx_addr1, 'amount': 1}, ]) for i in range(8)]
+        self.stakeBlocks(2, nStakeNode=1)
+
+        # Record: <8-byte anon index><33-byte pubkey><33-byte commitment><32-byte txid><4-byte output n>
+        rv = self.waitForZmqBlockAnon('rawanonout', 8 + 33 + 33 + 32 + 4, 8 + 33 + 33, txids[0])
+        assert (rv is not None)
+        assert (rv[0] == nodes[1].gettransaction(txids[0])['blockhash'])
+        assert (rv[1] == nodes[0].getblockheader(rv[0])['height'])
+        assert (rv[2] == 'C')
+
+        txid_spend = nodes[1].sendtypeto('anon', 'part', [{'address': address1, 'amount': 1}, ], '', '', 5)
+        self.stakeBlocks(1, nStakeNode=1)
+
+        # Record: <33-byte key image><32-byte txid><4-byte input n>
+        rv = self.waitForZmqBlockAnon('keyimage', 33 + 32 + 4, 33, txid_spend)
+        assert (rv is not None)
+        assert (rv[0] == nodes[1].gettransaction(txid_spend)['blockhash'])
+        assert (rv[1] == nodes[0].getblockheader(rv[0])['height'])
+        assert (rv[2] == 'C')
+
 
 if __name__ == '__main__':
     ZMQTest().main()
@@ -6,10 +6,12 @@
 """
 
 from test_framework.blocktools import COINBASE_MATURITY
+from test_framework.messages import deser_compact_size
 from test_framework.test_framework import GlobeTestFramework
 from test_framework.util import assert_equal, assert_raises_rpc_error
 
 import hashlib
+import struct
 from pathlib import Path
 
 
@@ -40,10 +42,25 @@ class DumptxoutsetTest(GlobeTestFramework):
             '09abf0e7b510f61ca6cf33bab104e9ee99b3528b371d27a2d4b39abb800fba7e')
 
         with open(str(expected_path), 'rb') as f:
-            digest = hashlib.sha256(f.read()).hexdigest()
-            # UTXO snapshot hash should be deterministic based on mocked time.
-            assert_equal(
-                digest, 'b1bacb602eacf5fbc9a7c2ef6eeb0d229c04e98bdf0c2ea5929012cd0eae3830')
+            # Metadata: base hash, coins count, version, anon outputs, money supply
+            assert_equal(f.read(32)[::-1].hex(), out['base_hash'])
+            assert_equal(struct.unpack('<QIqq', f.read(28))[:2], (100, 2))
+            coins_read = 0
+            while True:
+                section, count = struct.unpack('<BI', f.read(5))
+                data = f.read(deser_compact_size(f))
+                if section == 0:
+                    break
+                assert_equal(section, 1)
+                assert count > 0 and len(data) > 0
+                coins_read += count
+            assert_equal(coins_read, 100)
+            assert_equal(f.read(), b'')
+
+        # The file is deterministic, though the parts are read on several threads
+        out2 = node.dumptxoutset(FILENAME + '.2')
+        with open(str(expected_path), 'rb') as f, open(out2['path'], 'rb') as f2:
+            assert_equal(hashlib.sha256(f.read()).hexdigest(), hashlib.sha256(f2.read()).hexdigest())
 
         assert_equal(
             out['txoutset_hash'], '02588f3e85a36e70bfbb680c0a7b3fef05bc55ad33aa7d74be551460d07df03a')
@@ -350,6 +350,7 @@ BASE_SCRIPTS = [
 GLOBE_SCRIPTS = [
     'p2p_part_fork.py',
     'feature_part_pos.py',
+    'feature_part_blockindex_snapshot.py',
     'feature_part_extkey.py',
     'feature_part_stealth.py',
     'feature_part_blind.py',
@@ -383,6 +384,7 @@ GLOBE_SCRIPTS_EXT = [
     'rpc_part_tracefrozenoutputs.py',
     'feature_part_vote_extra.py',
     'wallet_part_unloadspent.py',
+    'wallet_part_ctoutputs.py',
     'p2p_part_dos.py',
     'feature_part_smsgpaidfee_ext.py',
 ]
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+from test_framework.test_globe import GlobeTestFramework
+from test_framework.util import assert_equal
+
+
+class WalletGlobeCTOutputsTest(GlobeTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [['-debug', '-noacceptnonstdtxn', '-reservebalance=10000000'] for i in range(self.num_nodes)]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def setup_network(self, split=False):
+        self.add_nodes(self.num_nodes, extra_args=self.extra_args)
+        self.start_nodes()
+        self.connect_nodes_bi(0, 1)
+
+    def find_unspent(self, node, txid):
+        for u in node.listunspentblind(0):
+            if u['txid'] == txid:
+                return u
+        return None
+
+    def run_test(self):
+        nodes = self.nodes
+
+        self.import_genesis_coins_a(nodes[0])
+        nodes[1].extkeyimportmaster(nodes[1].mnemonic('new')['master'])
+        sx_addr1 = nodes[1].getnewstealthaddress()
+        addr0 = nodes[0].getnewaddress()
+
+        txid_fund = nodes[0].sendtypeto('part', 'blind', [{'address': sx_addr1, 'amount': 2.0}, ])
+        self.stakeBlocks(1)
+        fund_output = self.find_unspent(nodes[1], txid_fund)
+        assert (fund_output is not None)
+        coincontrol = {'inputs': [{'tx': fund_output['txid'], 'n': fund_output['vout']}]}
+
+        self.log.info('Spend a blind output without relaying it')
+        self.disconnect_nodes(0, 1)
+        txid_spend = nodes[1].sendtypeto('blind', 'part', [{'address': addr0, 'amount': 0.5}, ], '', '', 4, 64, False, coincontrol)
+        assert (self.find_unspent(nodes[1], txid_fund) is None)
+
+        self.log.info('Entries for spent outputs are erased with the spend, none are left to erase at load')
+        # The higher relay fee keeps the spend out of the mempool so it can be abandoned
+        restart_args = self.extra_args[1] + ['-wallet=default_wallet', '-persistmempool=0', '-minrelaytxfee=0.01']
+        with nodes[1].assert_debug_log(['owned CT outputs, erased 0.']):
+            self.restart_node(1, restart_args)
+        assert (txid_spend not in nodes[1].getrawmempool())
+        assert (self.find_unspent(nodes[1], txid_fund) is None)
+
+        self.log.info('Abandoning the spend makes the output spendable again')
+        nodes[1].abandontransaction(txid_spend)
+        assert (self.find_unspent(nodes[1], txid_fund) is not None)
+        txid_respend = nodes[1].sendtypeto('blind', 'part', [{'address': addr0, 'amount': 0.5}, ], '', '', 4, 64, False, coincontrol)
+        assert (self.find_unspent(nodes[1], txid_fund) is None)
+
+        with nodes[1].assert_debug_log(['owned CT outputs, erased 0.']):
+            self.restart_node(1, self.extra_args[1] + ['-wallet=default_wallet'])
+        self.connect_nodes_bi(0, 1)
+        nodes[1].sendrawtransaction(nodes[1].getrawtransaction(txid_respend))
+        assert (self.wait_for_mempool(nodes[0], txid_respend))
+        self.stakeBlocks(1)
+        assert_equal(nodes[1].gettransaction(txid_respend)['confirmations'], 1)
+
+
+if __name__ == '__main__':
+    WalletGlobeCTOutputsTest().main()